@@ -16,57 +16,65 @@
 #include "ac/characterinfo.h"
 #include "util/stream.h"
 
+using AGS::Common::LEBinaryReader;
 using AGS::Common::Stream;
 
 
 void CharacterInfo::ReadFromFile(Stream *in)
 {
-    defview = in->ReadInt32();
-    talkview = in->ReadInt32();
-    view = in->ReadInt32();
-    room = in->ReadInt32();
-    prevroom = in->ReadInt32();
-    x = in->ReadInt32();
-    y = in->ReadInt32();
-    wait = in->ReadInt32();
-    flags = in->ReadInt32();
-    following = in->ReadInt16();
-    followinfo = in->ReadInt16();
-    idleview = in->ReadInt32();
-    idletime = in->ReadInt16();
-    idleleft = in->ReadInt16();
-    transparency = in->ReadInt16();
-    baseline = in->ReadInt16();
-    activeinv = in->ReadInt32();
-    talkcolor = in->ReadInt32();
-    thinkview = in->ReadInt32();
-    blinkview = in->ReadInt16();
-    blinkinterval = in->ReadInt16();
-    blinktimer = in->ReadInt16();
-    blinkframe = in->ReadInt16();
-    walkspeed_y = in->ReadInt16();
-    pic_yoffs = in->ReadInt16();
-    z = in->ReadInt32();
-    walkwait = in->ReadInt32();
-    speech_anim_speed = in->ReadInt16();
-    reserved1 = in->ReadInt16();
-    blocking_width = in->ReadInt16();
-    blocking_height = in->ReadInt16();;
-    index_id = in->ReadInt32();
-    pic_xoffs = in->ReadInt16();
-    walkwaitcounter = in->ReadInt16();
-    loop = in->ReadInt16();
-    frame = in->ReadInt16();
-    walking = in->ReadInt16();
-    animating = in->ReadInt16();
-    walkspeed = in->ReadInt16();
-    animspeed = in->ReadInt16();
-    in->ReadArrayOfInt16(inv, MAX_INV);
-    actx = in->ReadInt16();
-    acty = in->ReadInt16();
-    in->Read(name, 40);
-    in->Read(scrname, MAX_SCRIPT_NAME_LEN);
-    on = in->ReadInt8();
+    // the serialized character is a bit smaller than the struct
+    LEBinaryReader rd(in, false, sizeof(CharacterInfo));
+    ReadFromFile(rd);
+}
+
+void CharacterInfo::ReadFromFile(LEBinaryReader &in)
+{
+    defview = in.ReadInt32();
+    talkview = in.ReadInt32();
+    view = in.ReadInt32();
+    room = in.ReadInt32();
+    prevroom = in.ReadInt32();
+    x = in.ReadInt32();
+    y = in.ReadInt32();
+    wait = in.ReadInt32();
+    flags = in.ReadInt32();
+    following = in.ReadInt16();
+    followinfo = in.ReadInt16();
+    idleview = in.ReadInt32();
+    idletime = in.ReadInt16();
+    idleleft = in.ReadInt16();
+    transparency = in.ReadInt16();
+    baseline = in.ReadInt16();
+    activeinv = in.ReadInt32();
+    talkcolor = in.ReadInt32();
+    thinkview = in.ReadInt32();
+    blinkview = in.ReadInt16();
+    blinkinterval = in.ReadInt16();
+    blinktimer = in.ReadInt16();
+    blinkframe = in.ReadInt16();
+    walkspeed_y = in.ReadInt16();
+    pic_yoffs = in.ReadInt16();
+    z = in.ReadInt32();
+    walkwait = in.ReadInt32();
+    speech_anim_speed = in.ReadInt16();
+    reserved1 = in.ReadInt16();
+    blocking_width = in.ReadInt16();
+    blocking_height = in.ReadInt16();;
+    index_id = in.ReadInt32();
+    pic_xoffs = in.ReadInt16();
+    walkwaitcounter = in.ReadInt16();
+    loop = in.ReadInt16();
+    frame = in.ReadInt16();
+    walking = in.ReadInt16();
+    animating = in.ReadInt16();
+    walkspeed = in.ReadInt16();
+    animspeed = in.ReadInt16();
+    in.ReadArrayOfInt16(inv, MAX_INV);
+    actx = in.ReadInt16();
+    acty = in.ReadInt16();
+    in.Read(name, 40);
+    in.Read(scrname, MAX_SCRIPT_NAME_LEN);
+    on = in.ReadInt8();
 }
 
 void CharacterInfo::WriteToFile(Stream *out)
@@ -16,6 +16,7 @@
 #define __AC_CHARACTERINFO_H
 
 #include "ac/common_defines.h" // constants
+#include "util/binaryreader.h"
 
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
@@ -107,6 +108,7 @@ struct CharacterInfo {
 	void update_character_follower(int &char_index, int &numSheep, int *followingAsSheep, int &doing_nothing);
 
     void ReadFromFile(Common::Stream *in);
+    void ReadFromFile(Common::LEBinaryReader &in);
     void WriteToFile(Common::Stream *out);
 };
 
@@ -19,6 +19,7 @@
 #include "util/string_utils.h"      // fputstring, etc
 #include "util/string.h"
 #include "util/alignedstream.h"
+#include "util/binaryreader.h"
 #include "util/math.h"
 
 using namespace AGS::Common;
@@ -177,11 +178,11 @@ void GameSetupStruct::read_messages(Common::Stream *in, GameDataVersion data_ver
 
 void GameSetupStruct::ReadCharacters_Aligned(Stream *in)
 {
-    AlignedStream align_s(in, Common::kAligned_Read);
+    LEBinaryReader rd(in, true);
     for (int iteratorCount = 0; iteratorCount < numcharacters; ++iteratorCount)
     {
-        chars[iteratorCount].ReadFromFile(&align_s);
-        align_s.Reset();
+        chars[iteratorCount].ReadFromFile(rd);
+        rd.Reset();
     }
 }
 
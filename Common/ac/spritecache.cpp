@@ -658,13 +658,20 @@ int SpriteCache::SaveSpriteIndex(const char *filename, int spriteFileIDCheck, sp
 }
 
 int SpriteCache::InitFile(const char *filnam)
+{
+    return InitFile(Common::AssetManager::OpenAsset((char *)filnam),
+        Common::AssetManager::OpenAsset((char *)spindexfilename));
+}
+
+int SpriteCache::InitFile(Stream *sprite_file, Stream *index_file)
 {
     SpriteFileVersion vers;
     char buff[20];
     soff_t spr_initial_offs = 0;
     int spriteFileID = 0;
 
-    _stream.reset(Common::AssetManager::OpenAsset((char *)filnam));
+    std::unique_ptr<Stream> fidx(index_file);
+    _stream.reset(sprite_file);
     if (_stream == NULL)
         return -1;
 
@@ -719,7 +726,7 @@ int SpriteCache::InitFile(const char *filnam)
     EnlargeTo(topmost + 1);
 
     // if there is a sprite index file, use it
-    if (LoadSpriteIndexFile(spriteFileID, spr_initial_offs, topmost))
+    if (LoadSpriteIndexFile(fidx.release(), spriteFileID, spr_initial_offs, topmost))
     {
         // Succeeded
         return 0;
@@ -788,9 +795,8 @@ int SpriteCache::RebuildSpriteIndex(AGS::Common::Stream *in, sprkey_t topmost, S
     return 0;
 }
 
-bool SpriteCache::LoadSpriteIndexFile(int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost)
+bool SpriteCache::LoadSpriteIndexFile(Stream *fidx, int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost)
 {
-    Stream *fidx = Common::AssetManager::OpenAsset((char*)spindexfilename);
     if (fidx == NULL) 
     {
         return false;
@@ -125,6 +125,10 @@ public:
 
     // Loads sprite reference information and inits sprite stream
     int         InitFile(const char *filename);
+    // Same as above, but reads from the streams opened by the caller; takes
+    // ownership of both. Does not use the asset manager, so the sprite file
+    // may be initialized on another thread.
+    int         InitFile(Common::Stream *sprite_file, Common::Stream *index_file);
     // Tells if bitmaps in the file are compressed
     bool        IsFileCompressed() const;
     // Opens file stream
@@ -186,7 +190,7 @@ private:
     int _listend;
 
     // Loads sprite index file
-    bool        LoadSpriteIndexFile(int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost);
+    bool        LoadSpriteIndexFile(Common::Stream *fidx, int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost);
     // Rebuilds sprite index from the main sprite file
     int         RebuildSpriteIndex(AGS::Common::Stream *in, sprkey_t topmost, SpriteFileVersion vers);
     // Writes compressed sprite to the stream
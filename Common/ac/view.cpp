@@ -17,18 +17,19 @@
 #include "util/alignedstream.h"
 
 using AGS::Common::AlignedStream;
+using AGS::Common::LEBinaryReader;
 using AGS::Common::Stream;
 
-void ViewFrame::ReadFromFile(Stream *in)
+void ViewFrame::ReadFromFile(LEBinaryReader &in)
 {
-    pic = in->ReadInt32();
-    xoffs = in->ReadInt16();
-    yoffs = in->ReadInt16();
-    speed = in->ReadInt16();
-    flags = in->ReadInt32();
-    sound = in->ReadInt32();
-    reserved_for_future[0] = in->ReadInt32();
-    reserved_for_future[1] = in->ReadInt32();
+    pic = in.ReadInt32();
+    xoffs = in.ReadInt16();
+    yoffs = in.ReadInt16();
+    speed = in.ReadInt16();
+    flags = in.ReadInt32();
+    sound = in.ReadInt32();
+    reserved_for_future[0] = in.ReadInt32();
+    reserved_for_future[1] = in.ReadInt32();
 }
 
 void ViewFrame::WriteToFile(Stream *out)
@@ -95,11 +96,11 @@ void ViewLoopNew::ReadFromFile_v321(Stream *in)
 
 void ViewLoopNew::ReadFrames_Aligned(Stream *in)
 {
-    AlignedStream align_s(in, Common::kAligned_Read);
+    LEBinaryReader rd(in, true, numFrames * sizeof(ViewFrame));
     for (int i = 0; i < numFrames; ++i)
     {
-        frames[i].ReadFromFile(&align_s);
-        align_s.Reset();
+        frames[i].ReadFromFile(rd);
+        rd.Reset();
     }
 }
 
@@ -142,17 +143,18 @@ void ViewStruct::ReadFromFile(Stream *in)
 
 void ViewStruct272::ReadFromFile(Stream *in)
 {
-    numloops = in->ReadInt16();
+    LEBinaryReader rd(in, false, sizeof(ViewStruct272));
+    numloops = rd.ReadInt16();
     for (int i = 0; i < 16; ++i)
     {
-        numframes[i] = in->ReadInt16();
+        numframes[i] = rd.ReadInt16();
     }
-    in->ReadArrayOfInt32(loopflags, 16);
+    rd.ReadArrayOfInt32(loopflags, 16);
     for (int j = 0; j < 16; ++j)
     {
         for (int i = 0; i < 20; ++i)
         {
-            frames[j][i].ReadFromFile(in);
+            frames[j][i].ReadFromFile(rd);
         }
     }
 }
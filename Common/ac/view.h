@@ -16,6 +16,7 @@
 #define __AC_VIEW_H
 
 #include <vector>
+#include "util/binaryreader.h"
 
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
@@ -31,7 +32,7 @@ struct ViewFrame {
     int   reserved_for_future[2];
     ViewFrame() { pic = 0; xoffs = 0; yoffs = 0; speed = 0; }
 
-    void ReadFromFile(Common::Stream *in);
+    void ReadFromFile(Common::LEBinaryReader &in);
     void WriteToFile(Common::Stream *out);
 };
 
@@ -17,7 +17,9 @@
 #include "core/asset.h"
 #include "core/assetmanager.h"
 #include "debug/assert.h"
+#include "util/memorystream.h"
 #include "util/misc.h"
+#include "util/mmapstream.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 #include "util/stream.h"
@@ -177,6 +179,16 @@ AssetError AssetManager::ReadDataFileTOC(const String &data_file, AssetLibInfo &
     return _theAssetManager->OpenAssetAsStream(asset_name, open_mode, work_mode);
 }
 
+/* static */ Stream *AssetManager::OpenAssetMapped(const String &asset_name)
+{
+    assert(_theAssetManager != NULL);
+    if (!_theAssetManager)
+    {
+        return NULL;
+    }
+    return _theAssetManager->OpenAssetAsStream(asset_name, kFile_Open, kFile_Read, true);
+}
+
 AssetManager::AssetManager()
     : _assetLib(*new AssetLibInfo())
 {
@@ -393,9 +405,29 @@ bool AssetManager::GetAssetByPriority(const String &asset_name, AssetLocation &l
     return false;
 }
 
-Stream *AssetManager::OpenAssetAsStream(const String &asset_name, FileOpenMode open_mode, FileWorkMode work_mode)
+Stream *AssetManager::OpenAssetAsStream(const String &asset_name, FileOpenMode open_mode, FileWorkMode work_mode, bool map_data)
 {
     AssetLocation loc;
+    if (map_data && GetAssetByPriority(asset_name, loc, open_mode, work_mode))
+    {
+        _lastAssetSize = loc.Size;
+        MMapStream *ms = new MMapStream(loc.FileName, loc.Offset, loc.Size);
+        if (ms->IsValid())
+            return ms;
+        delete ms;
+        // mapping is not supported, read the whole asset into memory instead
+        Stream *s = File::OpenFileRead(loc.FileName);
+        if (!s)
+            return NULL;
+        std::vector<uint8_t> data((size_t)loc.Size);
+        if (!data.empty())
+        {
+            s->Seek(loc.Offset, kSeekBegin);
+            data.resize(s->Read(&data.front(), data.size()));
+        }
+        delete s;
+        return new MemoryStream(std::move(data));
+    }
     if (GetAssetByPriority(asset_name, loc, open_mode, work_mode))
     {
         Stream *s = File::OpenFile(loc.FileName, open_mode, work_mode);
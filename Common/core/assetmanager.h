@@ -112,6 +112,11 @@ public:
     static Stream       *OpenAsset(const String &asset_name,
                                    FileOpenMode open_mode = kFile_Open,
                                    FileWorkMode work_mode = kFile_Read);
+    // Opens the asset for reading as a stream over the asset's data only:
+    // the asset begins at position 0, and the stream length is asset's size.
+    // The data is mapped into memory when possible, or read into a buffer
+    // otherwise, so the stream gives direct access to it with GetDataView().
+    static Stream       *OpenAssetMapped(const String &asset_name);
 
 private:
     AssetManager();
@@ -138,7 +143,7 @@ private:
     bool        GetAssetFromLib(const String &asset_name, AssetLocation &loc, Common::FileOpenMode open_mode, Common::FileWorkMode work_mode);
     bool        GetAssetFromDir(const String &asset_name, AssetLocation &loc, Common::FileOpenMode open_mode, Common::FileWorkMode work_mode);
     bool        GetAssetByPriority(const String &asset_name, AssetLocation &loc, Common::FileOpenMode open_mode, Common::FileWorkMode work_mode);
-    Stream      *OpenAssetAsStream(const String &asset_name, FileOpenMode open_mode, FileWorkMode work_mode);
+    Stream      *OpenAssetAsStream(const String &asset_name, FileOpenMode open_mode, FileWorkMode work_mode, bool map_data = false);
 
     static AssetManager     *_theAssetManager;
     AssetSearchPriority     _searchPriority;
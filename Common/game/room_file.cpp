@@ -22,6 +22,7 @@
 #include "game/roomstruct.h"
 #include "gfx/bitmap.h"
 #include "script/cc_error.h"
+#include "util/binaryreader.h"
 #include "util/compress.h"
 #include "util/string_utils.h"
 
@@ -80,7 +81,7 @@ HRoomFileError OpenRoomFile(const String &filename, RoomDataSource &src)
     // Cleanup source struct
     src = RoomDataSource();
     // Try to open room file
-    Stream *in = AssetManager::OpenAsset(filename);
+    Stream *in = AssetManager::OpenAssetMapped(filename);
     if (in == NULL)
         return new RoomFileError(kRoomFileErr_FileOpenFailed, String::FromFormat("Filename: %s.", filename.GetCStr()));
     // Read room header
@@ -141,13 +142,13 @@ PBitmap fix_mask_area_size(const RoomStruct *room, PBitmap mask)
     return mask;
 }
 
-void ReadRoomObject(RoomObjectInfo &obj, Stream *in)
+void ReadRoomObject(RoomObjectInfo &obj, LEBinaryReader &in)
 {
-    obj.Sprite = in->ReadInt16();
-    obj.X = in->ReadInt16();
-    obj.Y = in->ReadInt16();
-    obj.Room = in->ReadInt16();
-    obj.IsOn = in->ReadInt16() != 0;
+    obj.Sprite = in.ReadInt16();
+    obj.X = in.ReadInt16();
+    obj.Y = in.ReadInt16();
+    obj.Room = in.ReadInt16();
+    obj.IsOn = in.ReadInt16() != 0;
 }
 
 void WriteRoomObject(const RoomObjectInfo &obj, Stream *out)
@@ -164,20 +165,21 @@ void WriteRoomObject(const RoomObjectInfo &obj, Stream *out)
 HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
 {
     char buffer[3000];
+    LEBinaryReader rd(in);
 
-    room->BackgroundBPP = in->ReadInt32();
+    room->BackgroundBPP = rd.ReadInt32();
     if (room->BackgroundBPP < 1)
         room->BackgroundBPP = 1;
 
-    room->WalkBehindCount = in->ReadInt16();
+    room->WalkBehindCount = rd.ReadInt16();
     if (room->WalkBehindCount > MAX_WALK_BEHINDS)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, String::FromFormat("Too many walk-behinds (in room: %d, max: %d).", room->WalkBehindCount, MAX_WALK_BEHINDS));
 
     // Walk-behinds baselines
     for (size_t i = 0; i < room->WalkBehindCount; ++i)
-        room->WalkBehinds[i].Baseline = in->ReadInt16();
+        room->WalkBehinds[i].Baseline = rd.ReadInt16();
 
-    room->HotspotCount = in->ReadInt32();
+    room->HotspotCount = rd.ReadInt32();
     if (room->HotspotCount == 0)
         room->HotspotCount = MIN_HOTSPOTS;
     if (room->HotspotCount > MAX_ROOM_HOTSPOTS)
@@ -186,19 +188,19 @@ HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_
     // Hotspots walk-to points
     for (size_t i = 0; i < room->HotspotCount; ++i)
     {
-        room->Hotspots[i].WalkTo.X = in->ReadInt16();
-        room->Hotspots[i].WalkTo.Y = in->ReadInt16();
+        room->Hotspots[i].WalkTo.X = rd.ReadInt16();
+        room->Hotspots[i].WalkTo.Y = rd.ReadInt16();
     }
 
     // Hotspots names and script names
     for (size_t i = 0; i < room->HotspotCount; ++i)
     {
         if (data_ver >= kRoomVersion_3415)
-            room->Hotspots[i].Name = StrUtil::ReadString(in);
+            room->Hotspots[i].Name = StrUtil::ReadString(rd.GetStream());
         else if (data_ver >= kRoomVersion_303a)
-            room->Hotspots[i].Name = String::FromStream(in);
+            room->Hotspots[i].Name = String::FromStream(rd.GetStream());
         else
-            room->Hotspots[i].Name = String::FromStreamCount(in, LEGACY_HOTSPOT_NAME_LEN);
+            room->Hotspots[i].Name = String::FromStreamCount(rd.GetStream(), LEGACY_HOTSPOT_NAME_LEN);
     }
 
     if (data_ver >= kRoomVersion_270)
@@ -206,105 +208,105 @@ HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_
         for (size_t i = 0; i < room->HotspotCount; ++i)
         {
             if (data_ver >= kRoomVersion_3415)
-                room->Hotspots[i].ScriptName = StrUtil::ReadString(in);
+                room->Hotspots[i].ScriptName = StrUtil::ReadString(rd.GetStream());
             else
-                room->Hotspots[i].ScriptName = String::FromStreamCount(in, MAX_SCRIPT_NAME_LEN);
+                room->Hotspots[i].ScriptName = String::FromStreamCount(rd.GetStream(), MAX_SCRIPT_NAME_LEN);
         }
     }
 
     // TODO: remove from format later
-    int polypoint_areas = in->ReadInt32();
+    int polypoint_areas = rd.ReadInt32();
     if (polypoint_areas > 0)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, "Legacy poly-point areas are no longer supported.");
 
     // Room edges
-    room->Edges.Top = in->ReadInt16();
-    room->Edges.Bottom = in->ReadInt16();
-    room->Edges.Left = in->ReadInt16();
-    room->Edges.Right = in->ReadInt16();
+    room->Edges.Top = rd.ReadInt16();
+    room->Edges.Bottom = rd.ReadInt16();
+    room->Edges.Left = rd.ReadInt16();
+    room->Edges.Right = rd.ReadInt16();
 
     // Room objects
-    room->ObjectCount = in->ReadInt16();
+    room->ObjectCount = rd.ReadInt16();
     if (room->ObjectCount > MAX_ROOM_OBJECTS)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, String::FromFormat("Too many objects (in room: %d, max: %d).", room->ObjectCount, MAX_ROOM_OBJECTS));
 
     for (size_t i = 0; i < (size_t)room->ObjectCount; ++i)
     {
-        ReadRoomObject(room->Objects[i], in);
+        ReadRoomObject(room->Objects[i], rd);
     }
 
     // Legacy interaction variables (were cut out)
-    int local_vars = in->ReadInt32();
+    int local_vars = rd.ReadInt32();
     if (local_vars > 0)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, "Interaction variables are no longer supported.");
     
-    room->RegionCount = in->ReadInt32();
+    room->RegionCount = rd.ReadInt32();
     if (room->RegionCount > MAX_ROOM_REGIONS)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, String::FromFormat("Too many regions (in room: %d, max: %d).", room->RegionCount, MAX_ROOM_REGIONS));
 
     // Interaction script links
-    room->EventHandlers.reset(InteractionScripts::CreateFromStream(in));
+    room->EventHandlers.reset(InteractionScripts::CreateFromStream(rd.GetStream()));
 
     for (size_t i = 0; i < room->HotspotCount; ++i)
     {
-        room->Hotspots[i].EventHandlers.reset(InteractionScripts::CreateFromStream(in));
+        room->Hotspots[i].EventHandlers.reset(InteractionScripts::CreateFromStream(rd.GetStream()));
     }
     for (size_t i = 0; i < room->ObjectCount; ++i)
     {
-        room->Objects[i].EventHandlers.reset(InteractionScripts::CreateFromStream(in));
+        room->Objects[i].EventHandlers.reset(InteractionScripts::CreateFromStream(rd.GetStream()));
     }
     for (size_t i = 0; i < room->RegionCount; ++i)
     {
-        room->Regions[i].EventHandlers.reset(InteractionScripts::CreateFromStream(in));
+        room->Regions[i].EventHandlers.reset(InteractionScripts::CreateFromStream(rd.GetStream()));
     }
 
     // Room object baselines
     for (size_t i = 0; i < room->ObjectCount; ++i)
-        room->Objects[i].Baseline = in->ReadInt32();
+        room->Objects[i].Baseline = rd.ReadInt32();
 
-    room->Width = in->ReadInt16();
-    room->Height = in->ReadInt16();
+    room->Width = rd.ReadInt16();
+    room->Height = rd.ReadInt16();
 
     for (size_t i = 0; i < (size_t)room->ObjectCount; ++i)
-        room->Objects[i].Flags = in->ReadInt16();
+        room->Objects[i].Flags = rd.ReadInt16();
     // TODO: remove this when we change gamedata format
-    in->ReadInt16();  // room->resolution
+    rd.ReadInt16();  // room->resolution
 
-    room->WalkAreaCount = in->ReadInt32();
+    room->WalkAreaCount = rd.ReadInt32();
     if (room->WalkAreaCount > MAX_WALK_AREAS + 1)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, String::FromFormat("Too many walkable areas (in room: %d, max: %d).", room->WalkAreaCount, MAX_WALK_AREAS + 1));
 
     for (size_t i = 0; i < room->WalkAreaCount; ++i)
-        room->WalkAreas[i].ScalingFar = in->ReadInt16();
+        room->WalkAreas[i].ScalingFar = rd.ReadInt16();
     for (size_t i = 0; i < room->WalkAreaCount; ++i)
-        room->WalkAreas[i].Light = in->ReadInt16();
+        room->WalkAreas[i].Light = rd.ReadInt16();
     for (size_t i = 0; i < room->WalkAreaCount; ++i)
-        room->WalkAreas[i].ScalingNear = in->ReadInt16();
+        room->WalkAreas[i].ScalingNear = rd.ReadInt16();
     for (size_t i = 0; i < room->WalkAreaCount; ++i)
-        room->WalkAreas[i].Top = in->ReadInt16();
+        room->WalkAreas[i].Top = rd.ReadInt16();
     for (size_t i = 0; i < room->WalkAreaCount; ++i)
-        room->WalkAreas[i].Bottom = in->ReadInt16();
-
-    in->Seek(LEGACY_ROOM_PASSWORD_LENGTH); // skip password
-    room->Options.StartupMusic = in->ReadInt8();
-    room->Options.SaveLoadDisabled = in->ReadInt8() != 0;
-    room->Options.PlayerCharOff = in->ReadInt8() != 0;
-    room->Options.PlayerView = in->ReadInt8();
-    room->Options.MusicVolume = (RoomVolumeMod)in->ReadInt8();
-    in->Seek(ROOM_LEGACY_OPTIONS_SIZE - 5);
+        room->WalkAreas[i].Bottom = rd.ReadInt16();
+
+    rd.Skip(LEGACY_ROOM_PASSWORD_LENGTH); // skip password
+    room->Options.StartupMusic = rd.ReadInt8();
+    room->Options.SaveLoadDisabled = rd.ReadInt8() != 0;
+    room->Options.PlayerCharOff = rd.ReadInt8() != 0;
+    room->Options.PlayerView = rd.ReadInt8();
+    room->Options.MusicVolume = (RoomVolumeMod)rd.ReadInt8();
+    rd.Skip(ROOM_LEGACY_OPTIONS_SIZE - 5);
     
-    room->MessageCount = in->ReadInt16();
-    room->GameID = in->ReadInt32();
+    room->MessageCount = rd.ReadInt16();
+    room->GameID = rd.ReadInt32();
 
     for (size_t i = 0; i < (size_t)room->MessageCount; ++i)
     {
-        room->MessageInfos[i].DisplayAs = in->ReadInt8();
-        room->MessageInfos[i].Flags = in->ReadInt8();
+        room->MessageInfos[i].DisplayAs = rd.ReadInt8();
+        room->MessageInfos[i].Flags = rd.ReadInt8();
     }
 
     for (size_t i = 0; i < (size_t)room->MessageCount; ++i)
     {
-        read_string_decrypt(in, buffer, sizeof(buffer));
+        read_string_decrypt(rd.GetStream(), buffer, sizeof(buffer));
         size_t len = strlen(buffer);
         if (len > 0 && (buffer[len - 1] == (char)ROOM_MESSAGE_FLAG_DISPLAYNEXT))
         {
@@ -319,38 +321,43 @@ HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_
     }
 
     // Very old format legacy room animations (FullAnimation)
-    int anim_count = in->ReadInt16();
+    int anim_count = rd.ReadInt16();
     if (anim_count > 0)
         return new RoomFileError(kRoomFileErr_IncompatibleEngine, "Room animations are no longer supported.");
 
     for (size_t i = 0; i < MAX_WALK_AREAS + 1; ++i)
-        room->WalkAreas[i].Light = in->ReadInt16();
+        room->WalkAreas[i].Light = rd.ReadInt16();
     for (size_t i = 0; i < room->RegionCount; ++i)
-        room->Regions[i].Light = in->ReadInt16();
+        room->Regions[i].Light = rd.ReadInt16();
     for (size_t i = 0; i < room->RegionCount; ++i)
-        room->Regions[i].Tint = in->ReadInt32();
+        room->Regions[i].Tint = rd.ReadInt32();
 
     update_polled_stuff_if_runtime();
     // Primary background
     Bitmap *mask = NULL;
-    load_lzw(in, &mask, room->BackgroundBPP, room->Palette);
+    if (!load_lzw(rd.GetStream(), &mask, room->BackgroundBPP, room->Palette))
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Unable to read the primary background.");
     room->BgFrames[0].Graphic.reset(mask);
 
     // Mask bitmaps
     update_polled_stuff_if_runtime();
-    loadcompressed_allegro(in, &mask, room->Palette);
+    if (!loadcompressed_allegro(rd.GetStream(), &mask, room->Palette))
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Unable to read the region mask.");
     room->RegionMask.reset(mask);
 
     update_polled_stuff_if_runtime();
-    loadcompressed_allegro(in, &mask, room->Palette);
+    if (!loadcompressed_allegro(rd.GetStream(), &mask, room->Palette))
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Unable to read the walkable area mask.");
     room->WalkAreaMask.reset(mask);
 
     update_polled_stuff_if_runtime();
-    loadcompressed_allegro(in, &mask, room->Palette);
+    if (!loadcompressed_allegro(rd.GetStream(), &mask, room->Palette))
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Unable to read the walk-behind mask.");
     room->WalkBehindMask.reset(mask);
 
     update_polled_stuff_if_runtime();
-    loadcompressed_allegro(in, &mask, room->Palette);
+    if (!loadcompressed_allegro(rd.GetStream(), &mask, room->Palette))
+        return new RoomFileError(kRoomFileErr_InconsistentData, "Unable to read the hotspot mask.");
     room->HotspotMask.reset(mask);
 
     return HRoomFileError::None();
@@ -428,7 +435,8 @@ HRoomFileError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion dat
     {
         update_polled_stuff_if_runtime();
         Bitmap *frame = NULL;
-        load_lzw(in, &frame, room->BackgroundBPP, room->BgFrames[i].Palette);
+        if (!load_lzw(in, &frame, room->BackgroundBPP, room->BgFrames[i].Palette))
+            return new RoomFileError(kRoomFileErr_InconsistentData, String::FromFormat("Unable to read the background %d.", (int)i));
         room->BgFrames[i].Graphic.reset(frame);
     }
     return HRoomFileError::None();
@@ -0,0 +1,484 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// The stretch is done in two passes for each destination line: the source
+// lines under it are summed into a line of 4-channel accumulators, which are
+// then summed into destination pixels. Both sums work on all four channels
+// of a pixel at once.
+//
+// 32-bit pixels are treated as four bytes with the alpha in the top byte,
+// which is what Allegro uses.
+//
+//=============================================================================
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <allegro.h>
+#include "core/types.h"
+#include "gfx/aastretch.h"
+#include "util/simd.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace AAStretch
+{
+
+// Fixed point precision of the source positions, same as in aastr
+const int AA_BITS     = 8;
+const int AA_SIZE     = 1 << AA_BITS;
+const int AA_MAX_SIZE = 1 << 12;
+const unsigned long AA_MAX_NUM = (unsigned long)AA_MAX_SIZE * AA_MAX_SIZE;
+
+//-----------------------------------------------------------------------------
+// Four float lanes, one per pixel channel
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_SSE2)
+
+typedef __m128 Vec4;
+
+inline Vec4 vec_zero() { return _mm_setzero_ps(); }
+inline Vec4 vec_load(const float *p) { return _mm_loadu_ps(p); }
+inline void vec_store(float *p, Vec4 v) { _mm_storeu_ps(p, v); }
+inline Vec4 vec_madd(Vec4 acc, Vec4 v, float w) { return _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(w))); }
+inline Vec4 vec_scale(Vec4 v, float s) { return _mm_mul_ps(v, _mm_set1_ps(s)); }
+inline float vec_alpha(Vec4 v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+// Spreads the four bytes of a pixel over the lanes
+inline Vec4 vec_unpack(uint32_t c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_cvtsi32_si128((int)c);
+    x = _mm_unpacklo_epi8(x, zero);
+    x = _mm_unpacklo_epi16(x, zero);
+    return _mm_cvtepi32_ps(x);
+}
+
+// Rounds the lanes and packs them back into four bytes, saturating at 255
+inline uint32_t vec_pack(Vec4 v)
+{
+    __m128i x = _mm_cvtps_epi32(v);
+    x = _mm_packs_epi32(x, x);
+    x = _mm_packus_epi16(x, x);
+    return (uint32_t)_mm_cvtsi128_si32(x);
+}
+
+#elif defined(AGS_SIMD_NEON)
+
+typedef float32x4_t Vec4;
+
+inline Vec4 vec_zero() { return vdupq_n_f32(0.f); }
+inline Vec4 vec_load(const float *p) { return vld1q_f32(p); }
+inline void vec_store(float *p, Vec4 v) { vst1q_f32(p, v); }
+inline Vec4 vec_madd(Vec4 acc, Vec4 v, float w) { return vmlaq_n_f32(acc, v, w); }
+inline Vec4 vec_scale(Vec4 v, float s) { return vmulq_n_f32(v, s); }
+inline float vec_alpha(Vec4 v) { return vgetq_lane_f32(v, 3); }
+
+inline Vec4 vec_unpack(uint32_t c)
+{
+    const uint16x8_t x = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(c)));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(x)));
+}
+
+inline uint32_t vec_pack(Vec4 v)
+{
+    const uint16x4_t x = vqmovn_u32(vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f))));
+    const uint8x8_t b = vqmovn_u16(vcombine_u16(x, x));
+    return vget_lane_u32(vreinterpret_u32_u8(b), 0);
+}
+
+#else
+
+struct Vec4
+{
+    float L[4];
+};
+
+inline Vec4 vec_zero() { Vec4 v = {{ 0.f, 0.f, 0.f, 0.f }}; return v; }
+inline Vec4 vec_load(const float *p) { Vec4 v = {{ p[0], p[1], p[2], p[3] }}; return v; }
+inline void vec_store(float *p, Vec4 v) { memcpy(p, v.L, sizeof(v.L)); }
+inline float vec_alpha(Vec4 v) { return v.L[3]; }
+
+inline Vec4 vec_madd(Vec4 acc, Vec4 v, float w)
+{
+    for (int i = 0; i < 4; ++i)
+        acc.L[i] += v.L[i] * w;
+    return acc;
+}
+
+inline Vec4 vec_scale(Vec4 v, float s)
+{
+    for (int i = 0; i < 4; ++i)
+        v.L[i] *= s;
+    return v;
+}
+
+inline Vec4 vec_unpack(uint32_t c)
+{
+    Vec4 v = {{ (float)(c & 0xFF), (float)((c >> 8) & 0xFF), (float)((c >> 16) & 0xFF), (float)(c >> 24) }};
+    return v;
+}
+
+inline uint32_t vec_pack(Vec4 v)
+{
+    uint32_t c = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        const int x = (int)(v.L[i] + 0.5f);
+        c |= (uint32_t)std::min(std::max(x, 0), 255) << (i * 8);
+    }
+    return c;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+// Sampling
+//-----------------------------------------------------------------------------
+
+// Source positions along one axis, in AA_BITS fixed point
+struct AxisStep
+{
+    int Pos;    // position of the first destination pixel's box
+    int Length; // distance from the first box to the last one
+    int Count;  // number of steps between the first box and the last one
+    int Box;    // size of the box
+};
+
+// Source pixels averaged into each destination pixel of one axis
+struct AxisSampling
+{
+    int                Taps;    // maximal number of pixels in a box
+    bool               Magnify; // whether the source pixels are used by several boxes
+    std::vector<int>   First;   // first source pixel of each box
+    std::vector<float> Weights; // Taps weights per box, normalized to 1
+};
+
+static void prepare_axis(int s, int sw, int dw, AxisStep &step)
+{
+    step.Pos = s << AA_BITS;
+    step.Length = sw << AA_BITS;
+    step.Count = dw;
+    step.Box = step.Length / dw;
+    if (step.Box < AA_SIZE)
+    {
+        // Magnifying: the boxes are a pixel wide, and the last one
+        // must end at the last source pixel
+        step.Count--;
+        step.Length -= AA_SIZE;
+        step.Box = AA_SIZE;
+    }
+}
+
+// Calculates the boxes for the destination pixels from dbeg to dend, stepping
+// from the first one with the same Bresenham algorithm as aastr does
+static void make_sampling(const AxisStep &step, int d, int dbeg, int dend, int src_end, AxisSampling &sampling)
+{
+    int xw = step.Count;
+    int yw = step.Length;
+    int inc = 0;
+    if (xw != 0 && (yw >= xw || yw <= -xw))
+    {
+        inc = yw / xw;
+        yw %= xw;
+    }
+    if (yw < 0)
+    {
+        inc -= 1;
+        yw += xw;
+    }
+    const int i1 = 2 * yw;
+    int dd = i1 - xw;
+    const int i2 = dd - xw;
+
+    int pos = step.Pos;
+    for (; d < dbeg; ++d)
+    {
+        if (dd >= 0)
+            pos += inc + 1, dd += i2;
+        else
+            pos += inc, dd += i1;
+    }
+
+    std::vector<int> boxes(dend - dbeg);
+    sampling.Taps = 1;
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        boxes[i] = pos;
+        const int count = ((pos + step.Box - 1) >> AA_BITS) - (pos >> AA_BITS) + 1;
+        sampling.Taps = std::max(sampling.Taps, count);
+        if (dd >= 0)
+            pos += inc + 1, dd += i2;
+        else
+            pos += inc, dd += i1;
+    }
+
+    sampling.Magnify = step.Box == AA_SIZE;
+    sampling.First.resize(boxes.size());
+    sampling.Weights.assign(boxes.size() * sampling.Taps, 0.f);
+    const float norm = 1.f / step.Box;
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        const int box = boxes[i];
+        const int first = box >> AA_BITS;
+        const int last = std::min((box + step.Box - 1) >> AA_BITS, src_end - 1);
+        sampling.First[i] = first;
+        float *weights = &sampling.Weights[i * sampling.Taps];
+        for (int x = first; x <= last; ++x)
+        {
+            const int lo = std::max(box, x << AA_BITS);
+            const int hi = std::min(box + step.Box, (x + 1) << AA_BITS);
+            weights[x - first] = (hi - lo) * norm;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Kernels
+//-----------------------------------------------------------------------------
+
+// Reads the source pixel into 4 float lanes. The top lane holds the pixel's
+// coverage, which is 255 for opaque pixels and 0 for the pixels of mask
+// color, or the alpha, which the color lanes are premultiplied by.
+template <int Depth, StretchMode Mode>
+inline Vec4 load_pixel(const unsigned char *line, int x)
+{
+    uint32_t c;
+    if (Depth == 16)
+    {
+        const unsigned int c16 = ((const uint16_t*)line)[x];
+        if (Mode == kStretch_Masked && c16 == MASK_COLOR_16)
+            return vec_zero();
+        c = getb16(c16) | (getg16(c16) << 8) | (getr16(c16) << 16);
+    }
+    else
+    {
+        c = ((const uint32_t*)line)[x];
+        if (Mode == kStretch_Masked && c == MASK_COLOR_32)
+            return vec_zero();
+        if (Mode == kStretch_Alpha)
+            return vec_scale(vec_unpack(c | 0xFF000000), (c >> 24) * (1.f / 255.f));
+    }
+    return vec_unpack(c | 0xFF000000);
+}
+
+// Converts the source line's pixels from beg to end
+template <int Depth, StretchMode Mode>
+inline void convert_line(const unsigned char *line, int beg, int end, float *out)
+{
+    for (int x = beg; x < end; ++x, out += 4)
+        vec_store(out, load_pixel<Depth, Mode>(line, x));
+}
+
+// Adds the source line's pixels from beg to end, multiplied by the weight
+template <int Depth, StretchMode Mode>
+inline void accumulate_line(const unsigned char *line, int beg, int end, float w, float *acc)
+{
+    for (int x = beg; x < end; ++x, acc += 4)
+        vec_store(acc, vec_madd(vec_load(acc), load_pixel<Depth, Mode>(line, x), w));
+}
+
+// Writes the averaged pixel
+template <int Depth, StretchMode Mode>
+inline void put_pixel(unsigned char *line, int x, Vec4 v)
+{
+    uint32_t c;
+    if (Mode == kStretch_Opaque)
+    {
+        c = vec_pack(v) & 0xFFFFFF;
+    }
+    else
+    {
+        const float a = vec_alpha(v);
+        if (Mode == kStretch_Masked)
+        {
+            // Same rule as in aastr: the pixel is transparent if the mask
+            // covers more than a half of it
+            if (a < 127.49f)
+                return;
+            if (a < 254.99f)
+                v = vec_scale(v, 255.f / a);
+            c = vec_pack(v) & 0xFFFFFF;
+        }
+        else
+        {
+            if (a < 0.5f)
+                c = 0;
+            else if (a < 254.99f)
+                c = (vec_pack(vec_scale(v, 255.f / a)) & 0xFFFFFF) | ((uint32_t)(a + 0.5f) << 24);
+            else
+                c = vec_pack(v);
+        }
+    }
+
+    if (Depth == 16)
+        ((uint16_t*)line)[x] = makecol16((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    else
+        ((uint32_t*)line)[x] = c;
+}
+
+// Sums the accumulators into the destination line; Taps is the number of
+// accumulators per destination pixel, or 0 when it's only known at run time
+template <int Depth, StretchMode Mode, int Taps>
+static void put_line(unsigned char *line, int dxbeg, int dxend, const float *acc, const AxisSampling &cols)
+{
+    const int taps = Taps > 0 ? Taps : cols.Taps;
+    const int *first = &cols.First[0];
+    const float *wx = &cols.Weights[0];
+    for (int dx = dxbeg; dx < dxend; ++dx, ++first, wx += taps)
+    {
+        const float *a = acc + *first * 4;
+        Vec4 v = vec_zero();
+        for (int t = 0; t < taps; ++t)
+            v = vec_madd(v, vec_load(a + t * 4), wx[t]);
+        put_pixel<Depth, Mode>(line, dx, v);
+    }
+}
+
+template <int Depth, StretchMode Mode>
+static void stretch(const Surface &src, const Surface &dst, int dxbeg, int dxend, int dybeg, int dyend,
+                    const AxisSampling &cols, const AxisSampling &rows)
+{
+    // The source pixels read by the destination lines; the lanes past
+    // the source width stay zero, they are there for the zero weighted taps
+    const int span_beg = cols.First.front();
+    const int span_len = cols.First.back() + cols.Taps - span_beg;
+    const int read_end = std::min(span_beg + span_len, src.Width);
+    const int line_len = span_len * 4;
+    std::vector<float> acc(line_len);
+    // Converted source lines when magnifying; the line y is kept in the
+    // slot y % Taps while the destination lines are using it
+    std::vector<float> cache(rows.Magnify ? line_len * rows.Taps : 0, 0.f);
+    std::vector<int> cached_y(rows.Taps, -1);
+
+    for (int dy = dybeg; dy < dyend; ++dy)
+    {
+        const int i = dy - dybeg;
+        const int row = rows.First[i];
+        const float *wy = &rows.Weights[i * rows.Taps];
+        const int taps = std::min(rows.Taps, src.Height - row);
+        if (!rows.Magnify)
+        {
+            // every source line is summed only once or twice
+            std::fill(acc.begin(), acc.end(), 0.f);
+            for (int t = 0; t < taps; ++t)
+            {
+                if (wy[t] != 0.f)
+                    accumulate_line<Depth, Mode>(src.Lines[row + t], span_beg, read_end, wy[t], &acc[0]);
+            }
+        }
+        else
+        {
+            // the source lines are blended into many destination lines, so
+            // they are converted once
+            for (int t = 0; t < taps; ++t)
+            {
+                const int y = row + t;
+                float *conv = &cache[(y % rows.Taps) * line_len];
+                if (cached_y[y % rows.Taps] != y)
+                {
+                    convert_line<Depth, Mode>(src.Lines[y], span_beg, read_end, conv);
+                    cached_y[y % rows.Taps] = y;
+                }
+                if (t == 0)
+                {
+                    for (int x = 0; x < line_len; x += 4)
+                        vec_store(&acc[x], vec_scale(vec_load(conv + x), wy[t]));
+                }
+                else
+                {
+                    for (int x = 0; x < line_len; x += 4)
+                        vec_store(&acc[x], vec_madd(vec_load(&acc[x]), vec_load(conv + x), wy[t]));
+                }
+            }
+        }
+
+        // the common magnifying and shrinking down to a half have fixed taps
+        const float *line_acc = &acc[0] - span_beg * 4;
+        if (cols.Taps == 2)
+            put_line<Depth, Mode, 2>(dst.Lines[dy], dxbeg, dxend, line_acc, cols);
+        else if (cols.Taps == 3)
+            put_line<Depth, Mode, 3>(dst.Lines[dy], dxbeg, dxend, line_acc, cols);
+        else
+            put_line<Depth, Mode, 0>(dst.Lines[dy], dxbeg, dxend, line_acc, cols);
+    }
+}
+
+template <int Depth>
+static void stretch_depth(const Surface &src, const Surface &dst, int dxbeg, int dxend, int dybeg, int dyend,
+                          const AxisSampling &cols, const AxisSampling &rows, StretchMode mode)
+{
+    switch (mode)
+    {
+    case kStretch_Opaque:
+        stretch<Depth, kStretch_Opaque>(src, dst, dxbeg, dxend, dybeg, dyend, cols, rows);
+        break;
+    case kStretch_Masked:
+        stretch<Depth, kStretch_Masked>(src, dst, dxbeg, dxend, dybeg, dyend, cols, rows);
+        break;
+    case kStretch_Alpha:
+        stretch<Depth, kStretch_Alpha>(src, dst, dxbeg, dxend, dybeg, dyend, cols, rows);
+        break;
+    }
+}
+
+bool IsSupported(int src_depth, int dst_depth, StretchMode mode)
+{
+    if (src_depth != dst_depth)
+        return false;
+    return src_depth == 32 || (src_depth == 16 && mode != kStretch_Alpha);
+}
+
+void Blit(const Surface &src, const Rect &src_rc, const Surface &dst, const Rect &dst_rc, StretchMode mode)
+{
+    const int sw = src_rc.GetWidth();
+    const int sh = src_rc.GetHeight();
+    const int dw = dst_rc.GetWidth();
+    const int dh = dst_rc.GetHeight();
+    if (sw <= 0 || sh <= 0 || dw <= 0 || dh <= 0)
+        return;
+
+    const int dxbeg = std::max(dst_rc.Left, dst.Clip.Left);
+    const int dxend = std::min(dst_rc.Right, dst.Clip.Right) + 1;
+    const int dybeg = std::max(dst_rc.Top, dst.Clip.Top);
+    const int dyend = std::min(dst_rc.Bottom, dst.Clip.Bottom) + 1;
+    if (dxbeg >= dxend || dybeg >= dyend)
+        return;
+
+    AxisStep xstep, ystep;
+    prepare_axis(src_rc.Left, sw, dw, xstep);
+    prepare_axis(src_rc.Top, sh, dh, ystep);
+    if ((unsigned long)xstep.Box * ystep.Box > AA_MAX_NUM)
+    {
+        xstep.Box = std::min(xstep.Box, AA_MAX_SIZE);
+        ystep.Box = std::min(ystep.Box, AA_MAX_SIZE);
+    }
+
+    AxisSampling cols, rows;
+    make_sampling(xstep, dst_rc.Left, dxbeg, dxend, src_rc.Right + 1, cols);
+    make_sampling(ystep, dst_rc.Top, dybeg, dyend, src_rc.Bottom + 1, rows);
+
+    if (src.ColorDepth == 16)
+        stretch_depth<16>(src, dst, dxbeg, dxend, dybeg, dyend, cols, rows, mode);
+    else
+        stretch_depth<32>(src, dst, dxbeg, dxend, dybeg, dyend, cols, rows, mode);
+}
+
+} // namespace AAStretch
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,68 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Antialiased stretching of 16- and 32-bit images.
+//
+// Each destination pixel is the area average of the source pixels under it,
+// sampled at the same positions as the aastr library does, so the results
+// match aastr's within rounding. Unlike aastr, the transparent pixels do not
+// darken the edges of a masked image, and 32-bit images with alpha channel
+// are averaged with premultiplied alpha. The inner loops use SSE2 or NEON
+// when available.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__AASTRETCH_H
+#define __AGS_CN_GFX__AASTRETCH_H
+
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace AAStretch
+{
+    enum StretchMode
+    {
+        // Average all pixels, destination pixels are all overwritten
+        kStretch_Opaque,
+        // Skip the pixels of mask color; destination pixels covered by
+        // the mask for more than a half are left as they are
+        kStretch_Masked,
+        // Weight the pixels by their alpha, the result has averaged alpha
+        kStretch_Alpha
+    };
+
+    // Pixel rows of an image, in the native pixel format
+    struct Surface
+    {
+        unsigned char **Lines;
+        int  Width;
+        int  Height;
+        int  ColorDepth;
+        Rect Clip;  // destination pixels outside are not written
+    };
+
+    // Tells if the images of the given color depths may be stretched
+    bool IsSupported(int src_depth, int dst_depth, StretchMode mode);
+    // Stretches the src_rc part of the source image onto dst_rc of the
+    // destination; both images must be of the supported color depth
+    void Blit(const Surface &src, const Rect &src_rc, const Surface &dst, const Rect &dst_rc, StretchMode mode);
+} // namespace AAStretch
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__AASTRETCH_H
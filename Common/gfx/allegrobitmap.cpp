@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include <aastr.h>
+#include "gfx/aastretch.h"
 #include "gfx/allegrobitmap.h"
 #include "debug/assert.h"
 
@@ -241,9 +242,28 @@ void Bitmap::StretchBlt(Bitmap *src, const Rect &src_rc, const Rect &dst_rc, Bit
 	}
 }
 
+// Stretches with AAStretch if it supports the bitmaps; returns false otherwise
+static bool aa_stretch_blit_fast(BITMAP *src, BITMAP *dst, const Rect &src_rc, const Rect &dst_rc, AAStretch::StretchMode mode)
+{
+	const int depth = bitmap_color_depth(dst);
+	if (!is_memory_bitmap(src) || !is_memory_bitmap(dst) ||
+		!AAStretch::IsSupported(bitmap_color_depth(src), depth, mode))
+		return false;
+
+	AAStretch::Surface src_surf = { src->line, src->w, src->h, bitmap_color_depth(src), RectWH(0, 0, src->w, src->h) };
+	AAStretch::Surface dst_surf = { dst->line, dst->w, dst->h, depth, RectWH(0, 0, dst->w, dst->h) };
+	if (dst->clip)
+		dst_surf.Clip = Rect(dst->cl, dst->ct, dst->cr - 1, dst->cb - 1);
+	AAStretch::Blit(src_surf, src_rc, dst_surf, dst_rc, mode);
+	return true;
+}
+
 void Bitmap::AAStretchBlt(Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
+	if (aa_stretch_blit_fast(al_src_bmp, _alBitmap, RectWH(0, 0, al_src_bmp->w, al_src_bmp->h), dst_rc,
+		mask == kBitmap_Transparency ? AAStretch::kStretch_Masked : AAStretch::kStretch_Opaque))
+		return;
 	// WARNING: For some evil reason Allegro expects dest and src bitmaps in different order for blit and draw_sprite
 	if (mask == kBitmap_Transparency)
 	{
@@ -261,11 +281,13 @@ void Bitmap::AAStretchBlt(Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask
 void Bitmap::AAStretchBlt(Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
+	if (aa_stretch_blit_fast(al_src_bmp, _alBitmap, src_rc, dst_rc,
+		mask == kBitmap_Transparency ? AAStretch::kStretch_Masked : AAStretch::kStretch_Opaque))
+		return;
 	if (mask == kBitmap_Transparency)
 	{
-		// TODO: aastr lib does not expose method for masked stretch blit; should do that at some point since 
-		// the source code is a gift-ware anyway
-		// aa_masked_blit(_alBitmap, al_src_bmp, src_rc.Left, src_rc.Top, src_rc.GetWidth(), src_rc.GetHeight(), dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
+		// TODO: aastr lib does not expose method for masked stretch blit; only 16- and 32-bit
+		// bitmaps are supported by AAStretch
 		throw "aa_masked_blit is not yet supported!";
 	}
 	else
@@ -276,6 +298,16 @@ void Bitmap::AAStretchBlt(Bitmap *src, const Rect &src_rc, const Rect &dst_rc, B
 	}
 }
 
+void Bitmap::AAStretchAlphaBlt(Bitmap *src, const Rect &dst_rc)
+{
+	BITMAP *al_src_bmp = src->_alBitmap;
+	if (aa_stretch_blit_fast(al_src_bmp, _alBitmap, RectWH(0, 0, al_src_bmp->w, al_src_bmp->h), dst_rc,
+		AAStretch::kStretch_Alpha))
+		return;
+	// aastr would lose the alpha channel, so do the plain stretch instead
+	stretch_sprite(_alBitmap, al_src_bmp, dst_rc.Left, dst_rc.Top, dst_rc.GetWidth(), dst_rc.GetHeight());
+}
+
 void Bitmap::TransBlendBlt(Bitmap *src, int dst_x, int dst_y)
 {
 	BITMAP *al_src_bmp = src->_alBitmap;
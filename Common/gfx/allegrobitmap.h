@@ -165,6 +165,8 @@ public:
     // Antia-aliased stretch-blit
     void    AAStretchBlt(Bitmap *src, const Rect &dst_rc, BitmapMaskOption mask = kBitmap_Copy);
     void    AAStretchBlt(Bitmap *src, const Rect &src_rc, const Rect &dst_rc, BitmapMaskOption mask = kBitmap_Copy);
+    // Anti-aliased stretch-blit of the 32-bit bitmap with alpha channel, averages pixels weighted by their alpha
+    void    AAStretchAlphaBlt(Bitmap *src, const Rect &dst_rc);
     // TODO: find more general way to call these operations, probably require pointer to Blending data struct?
     // Draw bitmap using translucency preset
     void    TransBlendBlt(Bitmap *src, int dst_x, int dst_y);
@@ -48,9 +48,19 @@ extern "C" {
 
 typedef struct ALOGG_OGG ALOGG_OGG;
 
+/* custom data source, read on demand while the ogg is decoded */
+typedef struct ALOGG_OGG_SOURCE {
+  void *source;                    /* passed to the functions below */
+  size_t (*read)(void *ptr, size_t size, size_t nmemb, void *source);
+  int (*seek)(void *source, long offset, int whence);
+  long (*tell)(void *source);
+  int (*close)(void *source);      /* called by alogg_destroy_ogg */
+} ALOGG_OGG_SOURCE;
+
 
 ALOGG_DLL_DECLSPEC ALOGG_OGG *alogg_create_ogg_from_buffer(void *data, int data_len);
 ALOGG_DLL_DECLSPEC ALOGG_OGG *alogg_create_ogg_from_file(FILE *f);
+ALOGG_DLL_DECLSPEC ALOGG_OGG *alogg_create_ogg_from_source(const ALOGG_OGG_SOURCE *source, int data_len);
 ALOGG_DLL_DECLSPEC void alogg_destroy_ogg(ALOGG_OGG *ogg);
 
 ALOGG_DLL_DECLSPEC int alogg_play_ogg(ALOGG_OGG *ogg, int buffer_len, int vol, int pan);
@@ -83,6 +83,15 @@ int apeg_advance_stream(APEG_STREAM *stream, int loop);
 int apeg_reset_stream(APEG_STREAM *stream);
 void apeg_close_stream(APEG_STREAM *stream);
 
+/* For players that decode ahead of the playback and time the frames
+ * themselves: the audio must be polled regularly, and every call to
+ * apeg_decode_video_frame passes the next frame to the display callback
+ * whether or not its time has come.
+ */
+int apeg_poll_audio(APEG_STREAM *stream);
+int apeg_decode_video_frame(APEG_STREAM *stream);
+double apeg_get_audio_time(APEG_STREAM *stream);
+
 int apeg_play_mpg(const char *filename, BITMAP *target, int loop,
                   int (*callback)(void));
 int apeg_play_memory_mpg(void *buffer, BITMAP *target, int loop,
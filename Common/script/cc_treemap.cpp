@@ -15,24 +15,86 @@
 #include <cstring>
 #include "cc_treemap.h"
 
+// the number of slots is always a power of two
+static const size_t InitialSlotCount = 256;
+
+// FNV-1a; also returns the length of the key
+static unsigned int hashKey(const char *key, size_t *len) {
+    unsigned int hash = 2166136261u;
+    const char *p = key;
+    for (; *p; ++p) {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+    *len = p - key;
+    return hash;
+}
+
+ccTreeMap::ccTreeMap()
+    : slots(InitialSlotCount, 0) {
+}
+
+unsigned int ccTreeMap::findSlot(const char *key, size_t len, unsigned int hash) const {
+    const unsigned int mask = slots.size() - 1;
+    unsigned int slot = hash & mask;
+    for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+        const Entry &entry = entries[slots[slot] - 1];
+        if ((entry.hash == hash) && (entry.key.size() == len) &&
+            (memcmp(entry.key.c_str(), key, len) == 0))
+            break;
+    }
+    return slot;
+}
+
+void ccTreeMap::grow() {
+    slots.assign(slots.size() * 2, 0);
+    const unsigned int mask = slots.size() - 1;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        unsigned int slot = entries[i].hash & mask;
+        while (slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = i + 1;
+    }
+}
+
 int ccTreeMap::findValue(const char *key) {
-	if (!key || strlen(key) <= 0) { return -1; }
-    std::string cppkey(key);
-    if (this->storage.count(cppkey) <= 0) { return -1; }
-    return this->storage[cppkey];
+    if (!key || !key[0]) { return -1; }
+    size_t len;
+    const unsigned int hash = hashKey(key, &len);
+    const int index = slots[findSlot(key, len, hash)];
+    if (index == 0) { return -1; }
+    return entries[index - 1].value;
 }
 
 void ccTreeMap::addEntry(const char* ntx, int p_value) {
-    // don't add if it's an empty string or if it's already here
-    if (!ntx || strlen(ntx) <= 0) { return; }
+    // don't add if it's an empty string; if it's already here, replace the value
+    if (!ntx || !ntx[0]) { return; }
 
-    this->storage[std::string(ntx)] = p_value;
+    size_t len;
+    const unsigned int hash = hashKey(ntx, &len);
+    unsigned int slot = findSlot(ntx, len, hash);
+    if (slots[slot] != 0) {
+        entries[slots[slot] - 1].value = p_value;
+        return;
+    }
+    // keep the table at most three quarters full
+    if ((entries.size() + 1) * 4 > slots.size() * 3) {
+        grow();
+        slot = findSlot(ntx, len, hash);
+    }
+    Entry entry;
+    entry.key.assign(ntx, len);
+    entry.hash = hash;
+    entry.value = p_value;
+    entries.push_back(entry);
+    slots[slot] = entries.size();
 }
 
 void ccTreeMap::clear() {
-    this->storage.clear();
+    entries.clear();
+    slots.assign(slots.size(), 0);
 }
 
 ccTreeMap::~ccTreeMap() {
-    this->storage.clear();
-}
\ No newline at end of file
+    clear();
+}
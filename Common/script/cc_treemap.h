@@ -19,18 +19,32 @@
 #ifndef __CC_TREEMAP_H
 #define __CC_TREEMAP_H
 
-#include <map>
 #include <string>
+#include <vector>
 
-// Mimics original interface but uses a std::map for storage
+// Mimics original interface but uses a hash table for storage. The lookup
+// hashes the key in place, without making a copy of it, and compares the
+// stored strings only when their hash and length match.
 struct ccTreeMap {
+    ccTreeMap();
     int findValue(const char *key);
     void addEntry(const char *ntx, int p_value);
     void clear();
     ~ccTreeMap();
 
 private:
-    std::map<std::string, int> storage;
+    struct Entry {
+        std::string key;
+        unsigned int hash;
+        int value;
+    };
+
+    // returns the slot which has the key, or the empty slot to put it in
+    unsigned int findSlot(const char *key, size_t len, unsigned int hash) const;
+    void grow();
+
+    std::vector<Entry> entries; // in the order they were added
+    std::vector<int> slots;     // entry index + 1, or 0 if the slot is free
 };
 
-#endif // __CC_TREEMAP_H
\ No newline at end of file
+#endif // __CC_TREEMAP_H
@@ -0,0 +1,348 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// BinaryReader is a helper for deserializing large amounts of data made of
+// the basic types. Unlike Stream, its methods are not virtual and are inlined,
+// and they read from the internal buffer, which is refilled from the stream
+// in big chunks. If the stream keeps its data in memory (see GetDataView),
+// the reader reads it directly instead.
+//
+// As the reader takes more data from the stream than was actually read, the
+// stream's position is not valid while the reader is in use. Sync() gives the
+// unread data back to the stream; it is called when the reader is destroyed,
+// and by GetStream(), which should be used to pass the stream to the
+// functions that read from it directly. The reader continues from the
+// stream's position after that.
+// Streams that cannot seek are read without buffering, by calling their own
+// methods, so that proxy streams (such as AlignedStream) work as usual.
+//
+// In the aligned mode the reader skips the data padding the same way as
+// AlignedStream does; Reset() reads the padding at the end of the struct.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__BINARYREADER_H
+#define __AGS_CN_UTIL__BINARYREADER_H
+
+#include <string.h>
+#include <vector>
+#include "util/bbop.h"
+#include "util/stream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+template <DataEndianess TEndianess>
+class BinaryReader
+{
+public:
+    static const size_t DefaultBufferSize = 8192;
+
+    // The buffer size may be reduced when the amount of data to read is known
+    explicit BinaryReader(Stream *in, bool aligned = false, size_t buffer_size = DefaultBufferSize)
+        : _in(in)
+        , _view(in->GetDataView())
+        , _buffered(_view == NULL && in->CanSeek())
+        , _direct(_view == NULL && !_buffered)
+        , _bufferSize(buffer_size > sizeof(int64_t) ? buffer_size : sizeof(int64_t))
+        , _start(NULL)
+        , _cur(NULL)
+        , _end(NULL)
+        , _aligned(aligned)
+        , _block(0)
+        , _maxAlignment(0)
+    {
+    }
+
+    ~BinaryReader()
+    {
+        Reset();
+        Sync();
+    }
+
+    // Gives the unread data back to the stream
+    void Sync()
+    {
+        if (!_start)
+            return;
+        if (_view)
+            _in->Seek(_cur - _start);
+        else if (_end > _cur)
+            _in->Seek(-(soff_t)(_end - _cur));
+        _start = _cur = _end = NULL;
+    }
+
+    // Returns the stream for reading from it directly
+    inline Stream *GetStream()
+    {
+        Sync();
+        return _in;
+    }
+
+    // Reads the padding at the end of the aligned struct and begins the next one
+    void Reset()
+    {
+        if (!_aligned)
+            return;
+        ReadPadding(_maxAlignment);
+        _maxAlignment = 0;
+        _block = 0;
+    }
+
+    inline int8_t ReadInt8()
+    {
+        if (_direct)
+            return ReadDirect(&Stream::ReadInt8, sizeof(int8_t));
+        int8_t val = 0;
+        ReadValue(&val, sizeof(val));
+        return val;
+    }
+
+    inline bool ReadBool()
+    {
+        return ReadInt8() != 0;
+    }
+
+    inline int16_t ReadInt16()
+    {
+        if (_direct)
+            return ReadDirect(&Stream::ReadInt16, sizeof(int16_t));
+        int16_t val = 0;
+        ReadValue(&val, sizeof(val));
+        return MustSwapBytes() ? BBOp::SwapBytesInt16(val) : val;
+    }
+
+    inline int32_t ReadInt32()
+    {
+        if (_direct)
+            return ReadDirect(&Stream::ReadInt32, sizeof(int32_t));
+        int32_t val = 0;
+        ReadValue(&val, sizeof(val));
+        return MustSwapBytes() ? BBOp::SwapBytesInt32(val) : val;
+    }
+
+    inline int64_t ReadInt64()
+    {
+        if (_direct)
+            return ReadDirect(&Stream::ReadInt64, sizeof(int64_t));
+        int64_t val = 0;
+        ReadValue(&val, sizeof(val));
+        return MustSwapBytes() ? BBOp::SwapBytesInt64(val) : val;
+    }
+
+    // Reads raw bytes, returns the number of bytes read
+    inline size_t Read(void *buffer, size_t size)
+    {
+        if (_aligned)
+            _block += size;
+        return ReadBytes((uint8_t*)buffer, size);
+    }
+
+    // Skips the number of bytes
+    inline void Skip(size_t size)
+    {
+        if (_aligned)
+            _block += size;
+        SkipBytes(size);
+    }
+
+    // Read array methods return the number of full elements read
+    inline size_t ReadArrayOfInt16(int16_t *buffer, size_t count)
+    {
+        if (_direct)
+            return ReadArrayDirect(&Stream::ReadArrayOfInt16, buffer, count);
+        count = ReadArray(buffer, sizeof(int16_t), count);
+        if (MustSwapBytes())
+            for (size_t i = 0; i < count; ++i)
+                buffer[i] = BBOp::SwapBytesInt16(buffer[i]);
+        return count;
+    }
+
+    inline size_t ReadArrayOfInt32(int32_t *buffer, size_t count)
+    {
+        if (_direct)
+            return ReadArrayDirect(&Stream::ReadArrayOfInt32, buffer, count);
+        count = ReadArray(buffer, sizeof(int32_t), count);
+        if (MustSwapBytes())
+            for (size_t i = 0; i < count; ++i)
+                buffer[i] = BBOp::SwapBytesInt32(buffer[i]);
+        return count;
+    }
+
+private:
+    static inline bool MustSwapBytes()
+    {
+        return kDefaultSystemEndianess != TEndianess;
+    }
+
+    template <typename T, typename TStream>
+    inline T ReadDirect(T (TStream::*read_fn)(), size_t size)
+    {
+        if (_aligned)
+        {
+            ReadPadding(size);
+            _block += size;
+        }
+        return (_in->*read_fn)();
+    }
+
+    template <typename T, typename TStream>
+    inline size_t ReadArrayDirect(size_t (TStream::*read_fn)(T*, size_t), T *buffer, size_t count)
+    {
+        if (_aligned)
+            ReadPadding(sizeof(T));
+        count = (_in->*read_fn)(buffer, count);
+        if (_aligned)
+            _block += count * sizeof(T);
+        return count;
+    }
+
+    inline void ReadValue(void *val, size_t size)
+    {
+        if (_aligned)
+        {
+            ReadPadding(size);
+            _block += size;
+        }
+        if ((size_t)(_end - _cur) >= size)
+        {
+            memcpy(val, _cur, size);
+            _cur += size;
+        }
+        else
+        {
+            ReadBytes((uint8_t*)val, size);
+        }
+    }
+
+    inline size_t ReadArray(void *buffer, size_t elem_size, size_t count)
+    {
+        if (_aligned)
+        {
+            ReadPadding(elem_size);
+            _block += elem_size * count;
+        }
+        return ReadBytes((uint8_t*)buffer, elem_size * count) / elem_size;
+    }
+
+    // Same padding rules as in AlignedStream
+    void ReadPadding(size_t next_type)
+    {
+        if (next_type == 0 || next_type % sizeof(int16_t) != 0)
+            return;
+        size_t pad = _block % next_type;
+        if (pad)
+        {
+            SkipBytes(next_type - pad);
+            _block += next_type - pad;
+        }
+        if (next_type > _maxAlignment)
+            _maxAlignment = next_type;
+        if (_block % sizeof(int64_t) == 0)
+            _block = 0;
+    }
+
+    size_t ReadBytes(uint8_t *buffer, size_t size)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            if (_cur == _end)
+            {
+                // large reads, and reads from the unbuffered stream, go
+                // straight to the stream
+                if (_direct || (_buffered && size - done >= _bufferSize))
+                {
+                    Sync();
+                    done += _in->Read(buffer + done, size - done);
+                    break;
+                }
+                if (!Fill())
+                    break;
+            }
+            size_t chunk = size - done;
+            if (chunk > (size_t)(_end - _cur))
+                chunk = _end - _cur;
+            memcpy(buffer + done, _cur, chunk);
+            _cur += chunk;
+            done += chunk;
+        }
+        return done;
+    }
+
+    void SkipBytes(size_t size)
+    {
+        size_t avail = _end - _cur;
+        if (size <= avail)
+        {
+            _cur += size;
+            return;
+        }
+        _cur = _end;
+        size -= avail;
+        Sync();
+        if (_view || _buffered)
+        {
+            _in->Seek(size);
+            return;
+        }
+        for (; size > 0; --size)
+            _in->ReadByte();
+    }
+
+    // Gets more data from the stream; returns false if there's nothing left
+    bool Fill()
+    {
+        Sync();
+        if (_view)
+        {
+            const soff_t pos = _in->GetPosition();
+            const soff_t len = _in->GetLength();
+            if (pos >= len)
+                return false;
+            _start = _cur = _view + pos;
+            _end = _view + len;
+            return true;
+        }
+        if (_buf.empty())
+            _buf.resize(_bufferSize);
+        size_t n = _in->Read(&_buf.front(), _buf.size());
+        if (n == 0)
+            return false;
+        _start = _cur = &_buf.front();
+        _end = _cur + n;
+        return true;
+    }
+
+    Stream              *_in;
+    const uint8_t       *_view;     // stream's data, if it is in memory
+    const bool           _buffered;
+    const bool           _direct;   // read through the stream's methods
+    const size_t         _bufferSize;
+    std::vector<uint8_t> _buf;
+    const uint8_t       *_start;    // data taken from the stream
+    const uint8_t       *_cur;      // next unread byte
+    const uint8_t       *_end;
+    const bool           _aligned;
+    size_t               _block;    // bytes read in the current aligned block
+    size_t               _maxAlignment;
+};
+
+typedef BinaryReader<kLittleEndian> LEBinaryReader;
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__BINARYREADER_H
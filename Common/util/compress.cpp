@@ -335,7 +335,7 @@ void save_lzw(Stream *out, const Bitmap *bmpp, const color *pall)
   out->Seek(toret, kSeekBegin);
 }
 
-void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
+bool load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
 {
   soff_t        uncompsiz;
   int           *loptr;
@@ -343,21 +343,31 @@ void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
   int           arin;
 
   in->Read(&pall[0], sizeof(color)*256);
-  maxsize = in->ReadInt32();
+  long maxsize = in->ReadInt32();
   uncompsiz = in->ReadInt32();
 
   uncompsiz += in->GetPosition();
-  outbytes = 0; putbytes = 0;
 
   update_polled_stuff_if_runtime();
-  membuffer = lzwexpand_to_mem(in);
+  membuffer = lzwexpand_to_mem(in, maxsize);
   update_polled_stuff_if_runtime();
+  if (membuffer == NULL || maxsize < 8) {
+    free(membuffer);
+    return false;
+  }
 
   loptr = (int *)&membuffer[0];
   membuffer += 8;
 #if defined(AGS_BIG_ENDIAN)
   loptr[0] = AGS::Common::BBOp::SwapBytesInt32(loptr[0]);
   loptr[1] = AGS::Common::BBOp::SwapBytesInt32(loptr[1]);
+#endif
+  // the image must fit in the expanded data
+  if (loptr[0] <= 0 || loptr[1] <= 0 || (long long)loptr[0] * loptr[1] > maxsize - 8) {
+    free(membuffer - 8);
+    return false;
+  }
+#if defined(AGS_BIG_ENDIAN)
   int bitmapNumPixels = loptr[0]*loptr[1]/ dst_bpp;
   switch (dst_bpp) // bytes per pixel!
   {
@@ -392,8 +402,10 @@ void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
   update_polled_stuff_if_runtime();
 
   Bitmap *bmm = BitmapHelper::CreateBitmap((loptr[0] / dst_bpp), loptr[1], dst_bpp * 8);
-  if (bmm == NULL)
-    quit("!load_room: not enough memory to load room background");
+  if (bmm == NULL) {
+    free(membuffer - 8);
+    return false;
+  }
 
   update_polled_stuff_if_runtime();
 
@@ -414,6 +426,7 @@ void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
   update_polled_stuff_if_runtime();
 
   *dst_bmp = bmm;
+  return true;
 }
 
 void savecompressed_allegro(Stream *out, const Bitmap *bmpp, const color *pall)
@@ -430,7 +443,7 @@ void savecompressed_allegro(Stream *out, const Bitmap *bmpp, const color *pall)
   free(wgtbl);
 }
 
-void loadcompressed_allegro(Stream *in, Bitmap **bimpp, color *pall)
+bool loadcompressed_allegro(Stream *in, Bitmap **bimpp, color *pall)
 {
   short widd,hitt;
   int   ii;
@@ -439,7 +452,7 @@ void loadcompressed_allegro(Stream *in, Bitmap **bimpp, color *pall)
   hitt = in->ReadInt16();
   Bitmap *bim = BitmapHelper::CreateBitmap(widd, hitt, 8);
   if (bim == NULL)
-    quit("!load_room: not enough memory to decompress masks");
+    return false;
 
   for (ii = 0; ii < hitt; ii++) {
     cunpackbitl(&bim->GetScanLineForWriting(ii)[0], widd, in);
@@ -450,4 +463,5 @@ void loadcompressed_allegro(Stream *in, Bitmap **bimpp, color *pall)
   in->Seek(768);  // skip palette
 
   *bimpp = bim;
+  return true;
 }
@@ -32,8 +32,9 @@ int  cunpackbitl32(unsigned int *line, int size, Common::Stream *in);
 //=============================================================================
 
 void save_lzw(Common::Stream *out, const Common::Bitmap *bmpp, const color *pall);
-void load_lzw(Common::Stream *in, Common::Bitmap **bmm, int dst_bpp, color *pall);
+// Returns false if the image data is corrupt or there is not enough memory
+bool load_lzw(Common::Stream *in, Common::Bitmap **bmm, int dst_bpp, color *pall);
 void savecompressed_allegro(Common::Stream *out, const Common::Bitmap *bmpp, const color *pall);
-void loadcompressed_allegro(Common::Stream *in, Common::Bitmap **bimpp, color *pall);
+bool loadcompressed_allegro(Common::Stream *in, Common::Bitmap **bimpp, color *pall);
 
 #endif // __AC_COMPRESS_H
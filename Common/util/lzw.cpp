@@ -34,9 +34,6 @@ using namespace AGS; // FIXME later
 #include <io.h>
 #endif
 
-int insert(int, int);
-void _delete(int);
-
 #define N 4096
 #define F 16
 #define THRESHOLD 3
@@ -48,12 +45,21 @@ void _delete(int);
 #define root (node+1+N+N+N)
 #define NIL -1
 
-char *lzbuffer;
-int *node;
-int pos;
-long outbytes = 0, maxsize = 0, putbytes = 0;
+namespace
+{
+
+// The compressor's state, kept apart for each compression
+struct LzwCompressor
+{
+  char *lzbuffer;
+  int *node;
+  int pos;
+
+  int insert(int i, int run);
+  void _delete(int z);
+};
 
-int insert(int i, int run)
+int LzwCompressor::insert(int i, int run)
 {
   int c, j, k, l, n, match;
   int *p;
@@ -93,7 +99,7 @@ int insert(int i, int run)
   return match;
 }
 
-void _delete(int z)
+void LzwCompressor::_delete(int z)
 {
   int j;
 
@@ -125,10 +131,17 @@ void _delete(int z)
   }
 }
 
+} // namespace
+
+// Keeps all of its state locally, so that it may be used by several threads
 void lzwcompress(Common::Stream *lzw_in, Common::Stream *out)
 {
   int ch, i, run, len, match, size, mask;
   char buf[17];
+  LzwCompressor lz;
+  char *&lzbuffer = lz.lzbuffer;
+  int *&node = lz.node;
+  int &pos = lz.pos;
 
   lzbuffer = (char *)malloc(N + F + (N + 1 + N + N + 256) * sizeof(int));       // 28.5 k !
   if (lzbuffer == NULL) {
@@ -156,14 +169,14 @@ void lzwcompress(Common::Stream *lzw_in, Common::Stream *out)
   do {
     ch = lzw_in->ReadByte();
     if (i >= N - F) {
-      _delete(i + F - N);
+      lz._delete(i + F - N);
       lzbuffer[i + F] = lzbuffer[i + F - N] = ch;
     } else {
-      _delete(i + F);
+      lz._delete(i + F);
       lzbuffer[i + F] = ch;
     }
 
-    match = insert(i, run);
+    match = lz.insert(i, run);
     if (ch == -1) {
       run--;
       len--;
@@ -183,7 +196,6 @@ void lzwcompress(Common::Stream *lzw_in, Common::Stream *out)
 
       if (!((mask += mask) & 0xFF)) {
         out->WriteArray(buf, size, 1);
-        outbytes += size;
         size = mask = 1;
         buf[0] = 0;
       }
@@ -193,86 +205,131 @@ void lzwcompress(Common::Stream *lzw_in, Common::Stream *out)
 
   if (size > 1) {
     out->WriteArray(buf, size, 1);
-    outbytes += size;
   }
 
   free(lzbuffer);
 }
 
-int expand_to_mem = 0;
-unsigned char *membfptr = NULL;
-void myputc(int ccc, Stream *out)
+namespace
 {
-  if (maxsize > 0) {
-    putbytes++;
-    if (putbytes > maxsize)
-      return;
-  }
 
-  outbytes++;
-  if (expand_to_mem) {
-    membfptr[0] = ccc;
-    membfptr++;
-  } else
-    out->WriteInt8(ccc);
-}
+// Reads the compressed data from the stream
+struct LzwStreamInput
+{
+  Common::Stream *In;
+
+  inline int ReadByte() { return In->ReadByte(); }
+  inline short ReadInt16() { return In->ReadInt16(); }
+  inline bool EOS() const { return In->EOS(); }
+};
 
-void lzwexpand(Stream *lzw_in, Stream *out)
+// Reads the compressed data directly from the stream's memory
+struct LzwMemoryInput
+{
+  const unsigned char *Ptr;
+  const unsigned char *End;
+
+  inline int ReadByte() { return Ptr < End ? *Ptr++ : -1; }
+  inline short ReadInt16()
+  {
+    if (End - Ptr < 2) {
+      Ptr = End;
+      return 0;
+    }
+    // the data is little-endian
+    short val = (short)(Ptr[0] | (Ptr[1] << 8));
+    Ptr += 2;
+    return val;
+  }
+  inline bool EOS() const { return Ptr >= End; }
+};
+
+// Returns false if the data ends before max_size bytes are expanded, or
+// there is not enough memory
+template <class TInput>
+bool lzwexpand(TInput &lzw_in, unsigned char *membuff, long max_size)
 {
   int bits, ch, i, j, len, mask;
   char *lzbuffer;
-//  printf(" UnShrinking: %s ",filena);
-  putbytes = 0;
+  long putbytes = 0;
+  unsigned char *membfptr = membuff;
 
   lzbuffer = (char *)malloc(N);
-  if (lzbuffer == NULL) {
-    quit("compress.cpp: unable to decompress: insufficient memory");
-  }
+  if (lzbuffer == NULL)
+    return false;
   i = N - F;
 
   // this end condition just checks for EOF, which is no good to us
-  while ((bits = lzw_in->ReadByte()) != -1) {
+  while ((bits = lzw_in.ReadByte()) != -1) {
     for (mask = 0x01; mask & 0xFF; mask <<= 1) {
       if (bits & mask) {
         // MACPORT FIX: read to short and expand
         short jshort = 0;
-        jshort = lzw_in->ReadInt16();
+        jshort = lzw_in.ReadInt16();
         j = jshort;
 
         len = ((j >> 12) & 15) + 3;
         j = (i - j - 1) & (N - 1);
 
         while (len--) {
-          myputc(lzbuffer[i] = lzbuffer[j], out);
+          lzbuffer[i] = lzbuffer[j];
+          if (putbytes++ < max_size)
+            *membfptr++ = lzbuffer[i];
           j = (j + 1) & (N - 1);
           i = (i + 1) & (N - 1);
         }
       } else {
-        ch = lzw_in->ReadByte();
-        myputc(lzbuffer[i] = ch, out);
+        ch = lzw_in.ReadByte();
+        lzbuffer[i] = ch;
+        if (putbytes++ < max_size)
+          *membfptr++ = ch;
         i = (i + 1) & (N - 1);
       }
 
-      if ((putbytes >= maxsize) && (maxsize > 0))
+      if (putbytes >= max_size)
         break;
 
-      if ((lzw_in->EOS()) && (maxsize > 0))
-        quit("Read error decompressing image - file is corrupt");
+      if (lzw_in.EOS()) {
+        free(lzbuffer);
+        return false;
+      }
     }                           // end for mask
 
-    if ((putbytes >= maxsize) && (maxsize > 0))
+    if (putbytes >= max_size)
       break;
   }
 
   free(lzbuffer);
-  expand_to_mem = 0;
+  return putbytes >= max_size;
 }
 
-unsigned char *lzwexpand_to_mem(Common::Stream *in)
+} // namespace
+
+// Expands the data into the memory buffer of max_size bytes; keeps all of
+// its state locally, so that it may be used by several threads at once
+unsigned char *lzwexpand_to_mem(Common::Stream *lzw_in, long max_size)
 {
-  unsigned char *membuff = (unsigned char *)malloc(maxsize + 10);
-  expand_to_mem = 1;
-  membfptr = membuff;
-  lzwexpand(in, NULL);
+  if (max_size <= 0)
+    return NULL;
+  unsigned char *membuff = (unsigned char *)malloc(max_size + 10);
+  if (membuff == NULL)
+    return NULL;
+
+  bool expanded;
+  // if the data is in memory, decode it from there without the stream calls
+  const unsigned char *data = lzw_in->GetDataView();
+  if (data) {
+    const unsigned char *data_at = data + lzw_in->GetPosition();
+    LzwMemoryInput input = { data_at, data + lzw_in->GetLength() };
+    expanded = lzwexpand(input, membuff, max_size);
+    lzw_in->Seek(input.Ptr - data_at);
+  } else {
+    LzwStreamInput input = { lzw_in };
+    expanded = lzwexpand(input, membuff, max_size);
+  }
+  if (!expanded) {
+    free(membuff);
+    return NULL;
+  }
   return membuff;
 }
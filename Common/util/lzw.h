@@ -21,9 +21,10 @@
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
 
+// Both the compression and expansion are reentrant
 void lzwcompress(Common::Stream *lzw_in, Common::Stream *out);
-unsigned char *lzwexpand_to_mem(Common::Stream *in);
-
-extern long outbytes, maxsize, putbytes;
+// Expands the data into the newly allocated buffer of max_size bytes; returns
+// NULL if the data is corrupt or there is not enough memory
+unsigned char *lzwexpand_to_mem(Common::Stream *in, long max_size);
 
 #endif // __AGS_CN_UTIL__LZW_H
@@ -0,0 +1,239 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/memorystream.h"
+#include "util/math.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MemoryStream::MemoryStream(const uint8_t *cbuf, size_t buf_sz, DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _cbuf(cbuf)
+    , _len(cbuf ? buf_sz : 0)
+    , _pos(0)
+    , _mode(kFile_Read)
+    , _vbuf(NULL)
+{
+}
+
+MemoryStream::MemoryStream(std::vector<uint8_t> &buf, FileWorkMode work_mode, DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _cbuf(buf.empty() ? NULL : &buf.front())
+    , _len(buf.size())
+    , _pos(0)
+    , _mode(work_mode)
+    , _vbuf(&buf)
+{
+}
+
+MemoryStream::MemoryStream(std::vector<uint8_t> &&buf, DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _pos(0)
+    , _mode(kFile_Read)
+    , _vbuf(NULL)
+    , _ownBuf(std::move(buf))
+{
+    _cbuf = _ownBuf.empty() ? NULL : &_ownBuf.front();
+    _len = _ownBuf.size();
+}
+
+MemoryStream::MemoryStream(DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _cbuf(NULL)
+    , _len(0)
+    , _pos(0)
+    , _mode(kFile_Read)
+    , _vbuf(NULL)
+{
+}
+
+MemoryStream::~MemoryStream()
+{
+}
+
+void MemoryStream::Close()
+{
+    _cbuf = NULL;
+    _vbuf = NULL;
+    _ownBuf.clear();
+    _len = 0;
+    _pos = 0;
+}
+
+bool MemoryStream::Flush()
+{
+    return true;
+}
+
+const uint8_t *MemoryStream::GetDataView() const
+{
+    return _cbuf;
+}
+
+bool MemoryStream::IsValid() const
+{
+    return _cbuf != NULL || _vbuf != NULL;
+}
+
+bool MemoryStream::EOS() const
+{
+    return _pos >= _len;
+}
+
+soff_t MemoryStream::GetLength() const
+{
+    return _len;
+}
+
+soff_t MemoryStream::GetPosition() const
+{
+    return _pos;
+}
+
+bool MemoryStream::CanRead() const
+{
+    return IsValid() && _mode != kFile_Write;
+}
+
+bool MemoryStream::CanWrite() const
+{
+    return _vbuf != NULL && _mode != kFile_Read;
+}
+
+bool MemoryStream::CanSeek() const
+{
+    return IsValid();
+}
+
+size_t MemoryStream::Read(void *buffer, size_t size)
+{
+    if (EOS() || !buffer)
+    {
+        return 0;
+    }
+    size = Math::Min(size, _len - _pos);
+    memcpy(buffer, _cbuf + _pos, size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::ReadByte()
+{
+    if (EOS())
+    {
+        return -1;
+    }
+    return _cbuf[_pos++];
+}
+
+int16_t MemoryStream::ReadInt16()
+{
+    int16_t val = 0;
+    if (_len - _pos >= sizeof(int16_t))
+    {
+        memcpy(&val, _cbuf + _pos, sizeof(int16_t));
+        _pos += sizeof(int16_t);
+        ConvertInt16(val);
+    }
+    else
+    {
+        Read(&val, sizeof(int16_t));
+    }
+    return val;
+}
+
+int32_t MemoryStream::ReadInt32()
+{
+    int32_t val = 0;
+    if (_len - _pos >= sizeof(int32_t))
+    {
+        memcpy(&val, _cbuf + _pos, sizeof(int32_t));
+        _pos += sizeof(int32_t);
+        ConvertInt32(val);
+    }
+    else
+    {
+        Read(&val, sizeof(int32_t));
+    }
+    return val;
+}
+
+int64_t MemoryStream::ReadInt64()
+{
+    int64_t val = 0;
+    if (_len - _pos >= sizeof(int64_t))
+    {
+        memcpy(&val, _cbuf + _pos, sizeof(int64_t));
+        _pos += sizeof(int64_t);
+        ConvertInt64(val);
+    }
+    else
+    {
+        Read(&val, sizeof(int64_t));
+    }
+    return val;
+}
+
+size_t MemoryStream::Write(const void *buffer, size_t size)
+{
+    if (!CanWrite() || !buffer)
+    {
+        return 0;
+    }
+    if (_pos + size > _vbuf->size())
+    {
+        _vbuf->resize(_pos + size);
+    }
+    if (size > 0)
+    {
+        memcpy(&_vbuf->front() + _pos, buffer, size);
+    }
+    _cbuf = _vbuf->empty() ? NULL : &_vbuf->front();
+    _len = _vbuf->size();
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::WriteByte(uint8_t b)
+{
+    uint8_t val = b;
+    return Write(&val, 1) == 1 ? b : -1;
+}
+
+soff_t MemoryStream::Seek(soff_t offset, StreamSeek origin)
+{
+    if (!CanSeek())
+    {
+        return -1;
+    }
+
+    soff_t pos;
+    switch (origin)
+    {
+    case kSeekBegin:    pos = offset; break;
+    case kSeekCurrent:  pos = _pos + offset; break;
+    case kSeekEnd:      pos = _len + offset; break;
+    default:
+        return -1;
+    }
+    _pos = (size_t)Math::Clamp(pos, (soff_t)0, (soff_t)_len);
+    return _pos;
+}
+
+} // namespace Common
+} // namespace AGS
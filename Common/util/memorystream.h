@@ -0,0 +1,94 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// MemoryStream reads and writes data in a memory buffer.
+//
+// The stream may either work over a buffer owned by someone else, in which
+// case the buffer must stay alive for as long as the stream is used, or own
+// the buffer moved into it. Writing is only supported when the stream works
+// over std::vector, which grows as necessary.
+//
+// Since the data is in memory, the stream gives direct access to it with
+// GetDataView().
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MEMORYSTREAM_H
+#define __AGS_CN_UTIL__MEMORYSTREAM_H
+
+#include <vector>
+#include "util/datastream.h"
+#include "util/file.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MemoryStream : public DataStream
+{
+public:
+    // Read-only stream over the borrowed buffer
+    MemoryStream(const uint8_t *cbuf, size_t buf_sz, DataEndianess stream_endianess = kLittleEndian);
+    // Stream over the borrowed vector; in write mode the data is written
+    // starting from the vector's beginning, and the vector is enlarged when
+    // necessary
+    MemoryStream(std::vector<uint8_t> &buf, FileWorkMode work_mode, DataEndianess stream_endianess = kLittleEndian);
+    // Read-only stream that owns the buffer
+    MemoryStream(std::vector<uint8_t> &&buf, DataEndianess stream_endianess = kLittleEndian);
+    virtual ~MemoryStream();
+
+    virtual void    Close();
+    virtual bool    Flush();
+    virtual const uint8_t *GetDataView() const;
+
+    // Is stream valid (underlying data initialized properly)
+    virtual bool    IsValid() const;
+    // Is end of stream
+    virtual bool    EOS() const;
+    // Total length of stream (if known)
+    virtual soff_t  GetLength() const;
+    // Current position (if known)
+    virtual soff_t  GetPosition() const;
+    virtual bool    CanRead() const;
+    virtual bool    CanWrite() const;
+    virtual bool    CanSeek() const;
+
+    virtual size_t  Read(void *buffer, size_t size);
+    virtual int32_t ReadByte();
+    virtual int16_t ReadInt16();
+    virtual int32_t ReadInt32();
+    virtual int64_t ReadInt64();
+    virtual size_t  Write(const void *buffer, size_t size);
+    virtual int32_t WriteByte(uint8_t b);
+
+    virtual soff_t  Seek(soff_t offset, StreamSeek origin);
+
+protected:
+    // Lets the subclasses provide the buffer later
+    MemoryStream(DataEndianess stream_endianess);
+
+    const uint8_t           *_cbuf;
+    size_t                   _len;
+    size_t                   _pos;
+    FileWorkMode             _mode;
+
+private:
+    std::vector<uint8_t>    *_vbuf;
+    std::vector<uint8_t>     _ownBuf;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MEMORYSTREAM_H
@@ -0,0 +1,162 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#if defined (WINDOWS_VERSION)
+#include <windows.h>
+#elif !defined (PSP_VERSION)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "util/mmapstream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MMapStream::MMapStream(const String &file_name, soff_t offset, soff_t size, DataEndianess stream_endianess)
+    : MemoryStream(stream_endianess)
+    , _mapping(NULL)
+    , _mappingSize(0)
+#if defined (WINDOWS_VERSION)
+    , _fileMapping(NULL)
+#endif
+{
+    Open(file_name, offset, size);
+}
+
+MMapStream::~MMapStream()
+{
+    Close();
+}
+
+#if defined (WINDOWS_VERSION)
+
+void MMapStream::Open(const String &file_name, soff_t offset, soff_t size)
+{
+    HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || offset < 0 || offset > file_size.QuadPart)
+    {
+        CloseHandle(file);
+        return;
+    }
+    if (size < 0 || offset + size > file_size.QuadPart)
+        size = file_size.QuadPart - offset;
+    if (size == 0)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    // The view must begin at the allocation granularity boundary
+    SYSTEM_INFO sys_info;
+    GetSystemInfo(&sys_info);
+    const soff_t map_offset = offset - offset % sys_info.dwAllocationGranularity;
+    const size_t map_size = (size_t)(size + (offset - map_offset));
+    HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!file_mapping)
+        return;
+    void *mapping = MapViewOfFile(file_mapping, FILE_MAP_READ,
+        (DWORD)((uint64_t)map_offset >> 32), (DWORD)(map_offset & 0xFFFFFFFF), map_size);
+    if (!mapping)
+    {
+        CloseHandle(file_mapping);
+        return;
+    }
+    _fileMapping = file_mapping;
+    _mapping = mapping;
+    _mappingSize = map_size;
+    _cbuf = (const uint8_t*)mapping + (offset - map_offset);
+    _len = (size_t)size;
+}
+
+void MMapStream::Close()
+{
+    if (_mapping)
+    {
+        UnmapViewOfFile(_mapping);
+        CloseHandle((HANDLE)_fileMapping);
+    }
+    _mapping = NULL;
+    _fileMapping = NULL;
+    _mappingSize = 0;
+    MemoryStream::Close();
+}
+
+#elif !defined (PSP_VERSION)
+
+void MMapStream::Open(const String &file_name, soff_t offset, soff_t size)
+{
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || offset < 0 || offset > st.st_size)
+    {
+        close(fd);
+        return;
+    }
+    if (size < 0 || offset + size > st.st_size)
+        size = st.st_size - offset;
+    if (size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // The mapping must begin at the page boundary
+    const soff_t page_size = sysconf(_SC_PAGESIZE);
+    const soff_t map_offset = offset - offset % page_size;
+    const size_t map_size = (size_t)(size + (offset - map_offset));
+    void *mapping = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, (off_t)map_offset);
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return;
+    _mapping = mapping;
+    _mappingSize = map_size;
+    _cbuf = (const uint8_t*)mapping + (offset - map_offset);
+    _len = (size_t)size;
+}
+
+void MMapStream::Close()
+{
+    if (_mapping)
+        munmap(_mapping, _mappingSize);
+    _mapping = NULL;
+    _mappingSize = 0;
+    MemoryStream::Close();
+}
+
+#else // no memory mapping
+
+void MMapStream::Open(const String &file_name, soff_t offset, soff_t size)
+{
+}
+
+void MMapStream::Close()
+{
+    MemoryStream::Close();
+}
+
+#endif
+
+} // namespace Common
+} // namespace AGS
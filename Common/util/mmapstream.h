@@ -0,0 +1,58 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// MMapStream is a read-only stream over a file region mapped into memory.
+//
+// The stream's position 0 corresponds to the beginning of the region, and
+// its length is the length of the region; this lets one to read an asset
+// packed into a library file as if it was a separate file.
+// The mapping fails on platforms that do not support it, in which case the
+// stream is not valid.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MMAPSTREAM_H
+#define __AGS_CN_UTIL__MMAPSTREAM_H
+
+#include "util/memorystream.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MMapStream : public MemoryStream
+{
+public:
+    // Maps the region of the file; negative size means "till the end of file"
+    MMapStream(const String &file_name, soff_t offset = 0, soff_t size = -1,
+        DataEndianess stream_endianess = kLittleEndian);
+    virtual ~MMapStream();
+
+    virtual void    Close();
+
+private:
+    void            Open(const String &file_name, soff_t offset, soff_t size);
+
+    void            *_mapping;      // beginning of the mapped pages
+    size_t           _mappingSize;
+#if defined (WINDOWS_VERSION)
+    void            *_fileMapping;  // file mapping object handle
+#endif
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MMAPSTREAM_H
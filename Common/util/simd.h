@@ -0,0 +1,31 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Detects the vector instruction set available to the compiled code.
+// Defines AGS_SIMD_SSE2 or AGS_SIMD_NEON and includes the matching intrinsics
+// header; code that relies on either must keep a plain C++ fallback.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__SIMD_H
+#define __AGS_CN_UTIL__SIMD_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGS_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AGS_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#endif // __AGS_CN_UTIL__SIMD_H
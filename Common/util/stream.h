@@ -38,6 +38,11 @@ public:
     virtual bool HasErrors() const { return false; }
     // Flush stream buffer to the underlying device
     virtual bool Flush() = 0;
+    // Returns pointer to the whole stream data, if the stream keeps it in
+    // memory, letting the caller read it without copying. The data is
+    // GetLength() bytes long; the stream position is not changed.
+    // Returns NULL if the stream does not support direct access.
+    virtual const uint8_t *GetDataView() const { return NULL; }
 
     //-----------------------------------------------------
     // Helper methods
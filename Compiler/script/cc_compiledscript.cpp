@@ -5,8 +5,8 @@
 #include "cc_compiledscript.h"
 #include "script/script_common.h"       // macro definitions
 #include "cc_symboltable.h"     // symbolTable
-#include "script/cc_options.h"      // ccGetOption
-#include "script/cc_error.h"
+#include "script/cc_options.h"      // SCOPT_* flags
+#include "cc_compilerstate.h"
 
 void ccCompiledScript::write_cmd(int cmdd) {
     write_code(cmdd);
@@ -43,6 +43,21 @@ ccCompiledScript::ccCompiledScript() {
     ax_val_type = 0;
     ax_val_scope = 0;
 }
+ccCompiledScript::ccCompiledScript(const ccCompiledScript &src)
+    : ccScript(src) {
+    // the code was copied without the spare space, so the next write reallocates it
+    codeallocated = codesize;
+    for (numfunctions = 0; numfunctions < src.numfunctions; numfunctions++) {
+        functions[numfunctions] = (char*)malloc(strlen(src.functions[numfunctions])+20);
+        strcpy(functions[numfunctions],src.functions[numfunctions]);
+        funccodeoffs[numfunctions] = src.funccodeoffs[numfunctions];
+        funcnumparams[numfunctions] = src.funcnumparams[numfunctions];
+    }
+    cur_sp = src.cur_sp;
+    next_line = src.next_line;
+    ax_val_type = src.ax_val_type;
+    ax_val_scope = src.ax_val_scope;
+}
 ccCompiledScript::~ccCompiledScript() {
     shutdown();
 }
@@ -126,12 +141,12 @@ int ccCompiledScript::remove_any_import (const char*namm, SymbolDef *oldSym) {
         return 0;
     // if this import has been referenced, flag an error
     if (sym.entries[sidx].flags & SFLG_ACCESSED) {
-        cc_error("Already referenced name as import; you must define it before using it");
+        cc_compile_error("Already referenced name as import; you must define it before using it");
         return -1;
     }
     // if they set the No Override Imports flag, don't allow it
-    if (ccGetOption(SCOPT_NOIMPORTOVERRIDE)) {
-        cc_error("Variable '%s' is already imported", namm);
+    if (ccGetCompileOption(SCOPT_NOIMPORTOVERRIDE)) {
+        cc_compile_error("Variable '%s' is already imported", namm);
         return -1;
     }
 
@@ -193,7 +208,7 @@ int ccCompiledScript::add_new_export(const char*namm,int etype,long eoffs, int n
         export_addr = (int32_t*)realloc(export_addr, sizeof(int32_t) * exportsCapacity);
     }
     if (eoffs >= 0x00ffffff) {
-        cc_error("export offset too high; script data size too large?");
+        cc_compile_error("export offset too high; script data size too large?");
         return -1;
     }
     char *newName = (char*)malloc(strlen(namm)+20);
@@ -47,6 +47,8 @@ struct ccCompiledScript: public ccScript {
     void ccCompiledScript::write_chunk(intptr_t **nested_chunk, int index, intptr_t chunk_size, bool dispose, int fixup_start, int fixup_stop, int32_t adjust);
 
     ccCompiledScript();
+    // copies the script together with the compiler's data about it
+    ccCompiledScript(const ccCompiledScript &src);
     virtual ~ccCompiledScript();
 };
 
@@ -0,0 +1,32 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include "cc_compilerstate.h"
+
+// error formatting is specific to the program that uses the compiler
+extern void cc_error_at_line(char *buffer, const char *error_msg);
+extern void cc_error_without_line(char *buffer, const char *error_msg);
+
+thread_local int ccCompileError = 0;
+thread_local int ccCompileErrorLine = 0;
+thread_local char ccCompileErrorString[400];
+thread_local const char *ccCompileScriptName = "";
+thread_local int ccCompileLine = 0;
+thread_local int ccCompileOptions = 0;
+
+void cc_compile_error(const char *descr, ...)
+{
+    char displbuf[1000];
+    va_list ap;
+
+    va_start(ap, descr);
+    vsprintf(displbuf, descr, ap);
+    va_end(ap);
+
+    if (ccCompileLine > 0)
+        cc_error_at_line(ccCompileErrorString, displbuf);
+    else
+        cc_error_without_line(ccCompileErrorString, displbuf);
+
+    ccCompileError = 1;
+    ccCompileErrorLine = ccCompileLine;
+}
@@ -0,0 +1,21 @@
+#ifndef __CC_COMPILERSTATE_H
+#define __CC_COMPILERSTATE_H
+
+// The compiler's error state, current line and options. They are kept per
+// thread, so that several scripts may be compiled at once; ccCompileText
+// takes the options from script/cc_options.h and copies the error into
+// script/cc_error.h, the batch compiler reports it with every result.
+extern thread_local int  ccCompileError;          // set to non-zero if error occurs
+extern thread_local int  ccCompileErrorLine;      // line number of the error
+extern thread_local char ccCompileErrorString[400];
+extern thread_local const char *ccCompileScriptName; // name of currently compiling script
+extern thread_local int  ccCompileLine;           // line currently being compiled
+extern thread_local int  ccCompileOptions;        // SCOPT_* flags
+
+extern void cc_compile_error(const char *descr, ...);
+
+inline int ccGetCompileOption(int optbit) {
+    return (ccCompileOptions & optbit) ? 1 : 0;
+}
+
+#endif // __CC_COMPILERSTATE_H
@@ -12,7 +12,7 @@ struct ccInternalList {
     long *script;
     int pos;
     int lineAtEnd;
-    int cancelCurrentLine;  // whether to set currentline=-10 if end reached
+    int cancelCurrentLine;  // whether to set ccCompileLine=-10 if end reached
 
     void startread();
     long peeknext();
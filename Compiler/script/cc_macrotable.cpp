@@ -2,7 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cc_macrotable.h"
-#include "script/cc_error.h"
+#include "cc_compilerstate.h"
 
 void MacroTable::shutdown() {
     int rr;
@@ -13,6 +13,7 @@ void MacroTable::shutdown() {
         name[rr]=NULL;
     }
     num = 0;
+    nameIndex.clear();
 }
 void MacroTable::merge(MacroTable *others) {
 
@@ -22,35 +23,33 @@ void MacroTable::merge(MacroTable *others) {
 
 }
 int MacroTable::find_name(char* namm) {
-    int ss;
-    for (ss=0;ss<num;ss++) {
-        if (strcmp(namm,name[ss])==0) return ss;
-    }
-    return -1;
+    return nameIndex.findValue(namm);
 }
 void MacroTable::add(char*namm,char*mac) {
     if (find_name(namm) >= 0) {
-        cc_error("macro '%s' already defined",namm);
+        cc_compile_error("macro '%s' already defined",namm);
         return;
     }
     if (num>=MAXDEFINES) {
-        cc_error("too many macros defined");
+        cc_compile_error("too many macros defined");
         return;
     }
     name[num]=(char*)malloc(strlen(namm)+5);
     strcpy(name[num],namm);
     macro[num]=(char*)malloc(strlen(mac)+5);
     strcpy(macro[num],mac);
+    nameIndex.addEntry(namm, num);
     num++;
 }
 void MacroTable::remove(int index) {
     if ((index < 0) || (index >= num)) {
-        cc_error("MacroTable::Remove: index out of range");
+        cc_compile_error("MacroTable::Remove: index out of range");
         return;
     }
     // just blank out the entry, don't bother to remove it
+    nameIndex.addEntry(name[index], -1);
     name[index][0] = 0;
     macro[index][0] = 0;
 }
 
-MacroTable macros;
\ No newline at end of file
+thread_local MacroTable macros;
\ No newline at end of file
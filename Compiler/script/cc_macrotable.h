@@ -1,6 +1,8 @@
 #ifndef __CC_MACROTABLE_H
 #define __CC_MACROTABLE_H
 
+#include "script/cc_treemap.h"
+
 #define MAX_LINE_LENGTH 500
 #define MAXDEFINES 1500
 struct MacroTable {
@@ -8,7 +10,8 @@ struct MacroTable {
     char*name[MAXDEFINES];
     char*macro[MAXDEFINES];
     void init() {
-        num=0; }
+        num=0;
+        nameIndex.clear(); }
     void shutdown();
     int  find_name(char*);
     void add(char*,char*);
@@ -18,9 +21,12 @@ struct MacroTable {
     MacroTable() {
         init();
     }
+
+private:
+    ccTreeMap nameIndex;  // index of the macro by its name
 };
 
 
-extern MacroTable macros;
+extern thread_local MacroTable macros;
 
 #endif // __CC_MACROTABLE_H
\ No newline at end of file
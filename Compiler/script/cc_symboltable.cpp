@@ -10,6 +10,26 @@ symbolTable::symbolTable() {
 	stringStructSym = 0;
 }
 
+symbolTable::symbolTable(const symbolTable &src) {
+    *this = src;
+}
+
+symbolTable &symbolTable::operator=(const symbolTable &src) {
+    if (this == &src)
+        return *this;
+    // the cached names are owned by the table they were made for
+    clear_name_cache();
+    normalIntSym = src.normalIntSym;
+    normalStringSym = src.normalStringSym;
+    normalFloatSym = src.normalFloatSym;
+    normalVoidSym = src.normalVoidSym;
+    nullSym = src.nullSym;
+    stringStructSym = src.stringStructSym;
+    entries = src.entries;
+    symbolTree = src.symbolTree;
+    return *this;
+}
+
 int SymbolTableEntry::get_num_args() {
 	// TODO: assert is func?
     return sscope % 100;
@@ -46,11 +66,15 @@ int SymbolTableEntry::get_propset() {
     return toret;
 }
 
-void symbolTable::reset() {
+void symbolTable::clear_name_cache() {
 	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
 		free(it->second);
 	}
 	nameGenCache.clear();
+}
+
+void symbolTable::reset() {
+	clear_name_cache();
 
 	entries.clear();
 
@@ -194,8 +218,9 @@ std::string symbolTable::get_name_string(int idx) {
 }
 
 const char *symbolTable::get_name(int idx) {
-	if (nameGenCache.count(idx) > 0) {
-		return nameGenCache[idx];
+	std::map<int, char*>::iterator cached = nameGenCache.find(idx);
+	if (cached != nameGenCache.end()) {
+		return cached->second;
 	}
 
 	std::size_t actualIdx = idx & STYPE_MASK;
@@ -244,4 +269,4 @@ int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
     return nss;
 }
 
-symbolTable sym;
+thread_local symbolTable sym;
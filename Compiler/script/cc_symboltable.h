@@ -48,6 +48,9 @@ struct symbolTable {
 	std::vector<SymbolTableEntry> entries;
 
     symbolTable();
+    // copies the symbols; the generated names are not shared
+    symbolTable(const symbolTable &src);
+    symbolTable &operator=(const symbolTable &src);
     void reset();    // clears table
     int  find(const char*);  // returns ID of symbol, or -1
     int  add_ex(const char*,int,char);  // adds new symbol of type and size
@@ -68,9 +71,11 @@ private:
     std::vector<char *> symbolTreeNames;
 
     int  add_operator(const char*, int priority, int vcpucmd); // adds new operator
+    void clear_name_cache();
 };
 
 
-extern symbolTable sym;
+// the symbol table of the script being compiled on this thread
+extern thread_local symbolTable sym;
 
 #endif //__CC_SYMBOLTABLE_H
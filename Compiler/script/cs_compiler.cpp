@@ -2,7 +2,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
 #include "cs_compiler.h"
+#include "cc_compilerstate.h"
 #include "cc_macrotable.h"
 #include "cc_compiledscript.h"
 #include "cc_symboltable.h"
@@ -12,6 +17,9 @@
 
 #include "cs_prepro.h"
 #include "cs_parser.h"
+#include "cs_optimizer.h"
+
+extern int ccCompOptions; // in script/cc_options
 
 const char *ccSoftwareVersion = "1.0";
 
@@ -22,6 +30,73 @@ static int capacityHeaders=0;
 
 MacroTable predefinedMacros;
 
+// options that change the way the headers are compiled
+static int get_header_options() {
+    const int headerOptions[] = { SCOPT_EXPORTALL, SCOPT_LINENUMBERS,
+        SCOPT_NOIMPORTOVERRIDE, SCOPT_OLDSTRINGS };
+    int toret = 0;
+    for (int i = 0; i < sizeof(headerOptions) / sizeof(headerOptions[0]); i++) {
+        if (ccGetCompileOption(headerOptions[i]))
+            toret |= headerOptions[i];
+    }
+    return toret;
+}
+
+static const char *get_header_name(int index) {
+    if (defaultHeaderNames[index] != NULL)
+        return defaultHeaderNames[index];
+    return "Internal header file";
+}
+
+// The compiler's state after compiling the default headers. The headers are
+// the same for most of the scripts in the game, so the next compilation
+// with the same headers and options starts from this state instead of
+// compiling them again. The headers are compared by their contents, since
+// the callers usually pass new copies of them every time.
+struct HeaderCache {
+    std::vector<std::string> headers;
+    std::vector<std::string> names;
+    int options;
+    symbolTable sym;
+    ccCompiledScript *scrip;
+
+    HeaderCache() : options(0), scrip(NULL) {}
+    ~HeaderCache() { clear(); }
+
+    void clear() {
+        delete scrip;
+        scrip = NULL;
+        headers.clear();
+        names.clear();
+    }
+
+    bool is_valid() {
+        if ((scrip == NULL) || (headers.size() != numheaders) ||
+            (options != get_header_options()))
+            return false;
+        for (int t = 0; t < numheaders; t++) {
+            if ((headers[t] != defaultheaders[t]) ||
+                (names[t] != get_header_name(t)))
+                return false;
+        }
+        return true;
+    }
+
+    void save(const symbolTable &headerSym, ccCompiledScript *headerScrip) {
+        clear();
+        for (int t = 0; t < numheaders; t++) {
+            headers.push_back(defaultheaders[t]);
+            names.push_back(get_header_name(t));
+        }
+        options = get_header_options();
+        sym = headerSym;
+        scrip = new ccCompiledScript(*headerScrip);
+    }
+};
+
+// the cache is kept per thread, along with the symbol table it is made of
+static thread_local HeaderCache headerCache;
+
 int ccAddDefaultHeader(char* nhead, char *nName)
 {
     if (numheaders >= capacityHeaders)
@@ -54,39 +129,47 @@ void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
+static ccScript *compile_text(const char *texo, const char *scriptName) {
     int t;
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
-
-    sym.reset();
+    ccCompiledScript *cctemp;
     preproc_startup(&predefinedMacros);
 
     if (scriptName == NULL)
         scriptName = "Main script";
 
-    ccError = 0;
-    ccErrorLine = 0;
+    ccCompileError = 0;
+    ccCompileErrorLine = 0;
 
-    for (t=0;t<numheaders;t++) {
-        if (defaultHeaderNames[t] != NULL)
-            ccCurScriptName = defaultHeaderNames[t];
-        else
-            ccCurScriptName = "Internal header file";
+    if (headerCache.is_valid()) {
+        cctemp = new ccCompiledScript(*headerCache.scrip);
+        sym = headerCache.sym;
+    }
+    else {
+        cctemp = new ccCompiledScript();
+        cctemp->init();
+        sym.reset();
 
-        cctemp->start_new_section(ccCurScriptName);
-        cc_compile(defaultheaders[t],cctemp);
-        if (ccError) break;
+        for (t=0;t<numheaders;t++) {
+            ccCompileScriptName = get_header_name(t);
+            cctemp->start_new_section(ccCompileScriptName);
+            cc_compile(defaultheaders[t],cctemp);
+            if (ccCompileError) break;
+        }
+
+        if (ccCompileError)
+            headerCache.clear();
+        else
+            headerCache.save(sym, cctemp);
     }
 
-    if (!ccError) {
-        ccCurScriptName = scriptName;
-        cctemp->start_new_section(ccCurScriptName);
+    if (!ccCompileError) {
+        ccCompileScriptName = scriptName;
+        cctemp->start_new_section(ccCompileScriptName);
         cc_compile(texo,cctemp);
     }
     preproc_shutdown();
 
-    if (ccError) {
+    if (ccCompileError) {
         cctemp->shutdown();
         delete cctemp;
         return NULL;
@@ -117,13 +200,19 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
             (sym.get_type(t) != SYM_LOCALVAR)) continue;
 
         if (sym.entries[t].flags & SFLG_IMPORTED) continue;
-        if (ccGetOption(SCOPT_SHOWWARNINGS)==0) ;
+        if (ccGetCompileOption(SCOPT_SHOWWARNINGS)==0) ;
         else if ((sym.entries[t].flags & SFLG_ACCESSED)==0) {
             printf("warning: variable '%s' is never used\n",sym.get_friendly_name(t).c_str());
         }
     }
 
-    if (ccGetOption(SCOPT_EXPORTALL)) {
+    if (ccGetCompileOption(SCOPT_OPTIMIZE)) {
+        // this must be done before the function addresses are exported;
+        // the code is kept as is if the optimizer fails to analyze it
+        cc_optimize(cctemp);
+    }
+
+    if (ccGetCompileOption(SCOPT_EXPORTALL)) {
         // export all functions
         for (t=0;t<cctemp->numfunctions;t++) {
             if (cctemp->add_new_export(cctemp->functions[t],EXPORT_FUNCTION,
@@ -138,3 +227,57 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
     cctemp->free_extra();
     return cctemp;
 }
+
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
+    // the compiler has its own state on every thread; this takes the shared
+    // options and reports the result through the shared error state
+    ccCompileOptions = ccCompOptions;
+    ccScript *compiled = compile_text(texo, scriptName);
+    ccError = ccCompileError;
+    ccErrorLine = ccCompileErrorLine;
+    ccCurScriptName = ccCompileScriptName;
+    if (ccCompileError)
+        strcpy(ccErrorString, ccCompileErrorString);
+    return compiled;
+}
+
+static void compile_batch_jobs(const ccCompileJob *jobs, int numJobs,
+    ccCompileResult *results, std::atomic<int> *nextJob) {
+    for (int i = (*nextJob)++; i < numJobs; i = (*nextJob)++) {
+        ccCompileOptions = jobs[i].options;
+        results[i].script = compile_text(jobs[i].script, jobs[i].scriptName);
+        if ((results[i].script == NULL) || (ccCompileError != 0)) {
+            delete results[i].script;
+            results[i].script = NULL;
+            results[i].errorLine = ccCompileErrorLine;
+            results[i].errorString = ccCompileErrorString;
+            results[i].errorScriptName = ccCompileScriptName;
+        }
+    }
+}
+
+int ccCompileTextBatch(const ccCompileJob *jobs, int numJobs,
+    ccCompileResult *results, int numThreads) {
+    if (numThreads <= 0)
+        numThreads = std::thread::hardware_concurrency();
+    if (numThreads > numJobs)
+        numThreads = numJobs;
+    if (numThreads < 1)
+        numThreads = 1;
+
+    // every script is compiled from scratch, or from the headers, on its
+    // thread, so the results do not depend on which thread got which script
+    std::atomic<int> nextJob(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++)
+        threads.push_back(std::thread(compile_batch_jobs, jobs, numJobs, results, &nextJob));
+    for (int t = 0; t < numThreads; t++)
+        threads[t].join();
+
+    int failed = 0;
+    for (int i = 0; i < numJobs; i++) {
+        if (results[i].script == NULL)
+            failed++;
+    }
+    return failed;
+}
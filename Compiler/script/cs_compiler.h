@@ -13,6 +13,7 @@
 #ifndef __CS_COMPILER_H
 #define __CS_COMPILER_H
 
+#include <string>
 #include "script/cc_script.h"  // ccScript
 
 // ********* SCRIPT COMPILATION FUNCTIONS **************
@@ -34,6 +35,32 @@ extern void ccSetSoftwareVersion(const char *version);
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
 
+// a script to compile with ccCompileTextBatch
+struct ccCompileJob {
+    const char *script;
+    const char *scriptName;
+    int options;            // compiler options (SCOPT_*) for this script
+};
+
+// the outcome of compiling one script with ccCompileTextBatch
+struct ccCompileResult {
+    ccScript *script;       // NULL on failure
+    int errorLine;
+    std::string errorString;
+    std::string errorScriptName; // the script or header the error is in
+
+    ccCompileResult() : script(NULL), errorLine(0) {}
+};
+
+// compile the scripts on several threads, each with the default headers and
+// macros; 'numThreads' of 0 uses one thread per CPU core. The results are put
+// in the order of the jobs and are the same as if the scripts were compiled
+// one by one with ccCompileText. The headers, macros and software version
+// must not be changed until this returns.
+// Returns the number of scripts that failed to compile.
+extern int ccCompileTextBatch(const ccCompileJob *jobs, int numJobs,
+    ccCompileResult *results, int numThreads);
+
 extern const char *ccSoftwareVersion;
 
 #endif // __CS_COMPILER_H
\ No newline at end of file
@@ -0,0 +1,951 @@
+#include <limits.h>
+#include <string.h>
+#include <vector>
+#include "cs_optimizer.h"
+#include "cc_compiledscript.h"
+#include "script/script_common.h"       // macro definitions
+
+namespace
+{
+
+// number of arguments of each instruction
+const int sccmd_argcount[CC_NUM_SCCMDS] =
+{
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2,   // 0 - 9
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2,   // 10 - 19
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1,   // 20 - 29
+    1, 1, 2, 1, 1, 1, 1, 1, 1, 1,   // 30 - 39
+    2, 2, 1, 2, 2, 1, 2, 1, 1, 0,   // 40 - 49
+    1, 1, 0, 2, 2, 2, 2, 2, 2, 2,   // 50 - 59
+    2, 2, 2, 1, 1, 2, 2, 1, 0, 0,   // 60 - 69
+    1, 1, 3, 2                      // 70 - 73
+};
+
+// registers are represented as bits in the usage masks
+const int REGMASK_ALL = 0xFF;
+// the only registers whose values are tracked; the rest are always
+// considered to be in use
+const int REGMASK_TRACKED = (1 << SREG_AX) | (1 << SREG_BX) | (1 << SREG_CX) | (1 << SREG_DX);
+const int NUM_REGISTERS = 8;
+
+// how many times the passes are repeated at most, since each of them
+// may open up new opportunities for the others
+const int MAX_OPTIMIZER_ROUNDS = 8;
+// how many instructions may be between the PUSHREG and POPREG to combine
+const int MAX_PUSHPOP_DISTANCE = 8;
+
+inline int RegBit(int32_t reg)
+{
+    return (reg >= 0 && reg < NUM_REGISTERS) ? (1 << reg) : REGMASK_ALL;
+}
+
+inline bool IsTracked(int32_t reg)
+{
+    return reg >= 0 && reg < NUM_REGISTERS && (REGMASK_TRACKED & (1 << reg)) != 0;
+}
+
+struct ScriptInstr
+{
+    int32_t Code;
+    int32_t Args[MAX_SCMD_ARGS];
+    char    Fixups[MAX_SCMD_ARGS];  // fixup type of each argument, 0 if none
+    int32_t Pos;        // position in the original code
+    int     Target;     // index of the instruction the jump goes to
+    bool    Entry;      // function entry, may be called from anywhere
+    bool    Label;      // may be reached not only from the previous instruction
+    bool    Removed;
+
+    ScriptInstr()
+        : Code(0), Pos(0), Target(0), Entry(false), Label(false), Removed(false)
+    {
+        memset(Args, 0, sizeof(Args));
+        memset(Fixups, 0, sizeof(Fixups));
+    }
+
+    inline int ArgCount() const { return sccmd_argcount[Code]; }
+    inline bool IsJump() const { return Code == SCMD_JMP || Code == SCMD_JZ || Code == SCMD_JNZ; }
+
+    bool HasFixups() const
+    {
+        for (int a = 0; a < MAX_SCMD_ARGS; ++a)
+            if (Fixups[a])
+                return true;
+        return false;
+    }
+
+    void SetLiteral(int32_t reg, int32_t value)
+    {
+        Code = SCMD_LITTOREG;
+        Args[0] = reg;
+        Args[1] = value;
+        Args[2] = 0;
+        memset(Fixups, 0, sizeof(Fixups));
+    }
+};
+
+// Tells which registers the instruction reads and writes
+void GetRegUsage(const ScriptInstr &in, int &use, int &def)
+{
+    const int r1 = RegBit(in.Args[0]);
+    const int r2 = RegBit(in.Args[1]);
+    const int sp = 1 << SREG_SP;
+    const int mar = 1 << SREG_MAR;
+    const int ax = 1 << SREG_AX;
+    use = 0;
+    def = 0;
+    switch (in.Code)
+    {
+    case SCMD_LINENUM:
+    case SCMD_THISBASE:
+    case SCMD_LOOPCHECKOFF:
+    case SCMD_NUMFUNCARGS:
+    case SCMD_SUBREALSTACK:
+    case SCMD_JMP:
+        break;
+    case SCMD_JZ:
+    case SCMD_JNZ:
+        use = ax;
+        break;
+    case SCMD_LITTOREG:
+    case SCMD_NEWUSEROBJECT:
+        def = r1;
+        break;
+    case SCMD_REGTOREG:
+        use = r1;
+        def = r2;
+        break;
+    case SCMD_ADD:
+    case SCMD_SUB:
+        // these work with the stack if given the stack pointer
+        use = r1 | sp;
+        def = r1;
+        break;
+    case SCMD_MUL:
+    case SCMD_FADD:
+    case SCMD_FSUB:
+    case SCMD_NOTREG:
+    case SCMD_CREATESTRING:
+    case SCMD_NEWARRAY:
+        use = r1;
+        def = r1;
+        break;
+    case SCMD_MEMREAD:
+    case SCMD_MEMREADB:
+    case SCMD_MEMREADW:
+    case SCMD_MEMREADPTR:
+        use = mar;
+        def = r1;
+        break;
+    case SCMD_MEMWRITE:
+    case SCMD_MEMWRITEB:
+    case SCMD_MEMWRITEW:
+    case SCMD_MEMWRITEPTR:
+    case SCMD_MEMINITPTR:
+    case SCMD_DYNAMICBOUNDS:
+        use = mar | r1;
+        break;
+    case SCMD_WRITELIT:
+    case SCMD_ZEROMEMORY:
+    case SCMD_MEMZEROPTR:
+    case SCMD_CHECKNULL:
+        use = mar;
+        break;
+    case SCMD_MEMZEROPTRND:
+        use = mar | ax;
+        break;
+    case SCMD_LOADSPOFFS:
+        use = sp;
+        def = mar;
+        break;
+    case SCMD_PUSHREG:
+        use = r1 | sp;
+        def = sp;
+        break;
+    case SCMD_POPREG:
+        use = sp;
+        def = r1 | sp;
+        break;
+    case SCMD_PUSHREAL:
+    case SCMD_CHECKBOUNDS:
+    case SCMD_CHECKNULLREG:
+        use = r1;
+        break;
+    case SCMD_CALLOBJ:
+        use = r1;
+        def = 1 << SREG_OP;
+        break;
+    case SCMD_MULREG:
+    case SCMD_DIVREG:
+    case SCMD_ADDREG:
+    case SCMD_SUBREG:
+    case SCMD_BITAND:
+    case SCMD_BITOR:
+    case SCMD_ISEQUAL:
+    case SCMD_NOTEQUAL:
+    case SCMD_GREATER:
+    case SCMD_LESSTHAN:
+    case SCMD_GTE:
+    case SCMD_LTE:
+    case SCMD_AND:
+    case SCMD_OR:
+    case SCMD_MODREG:
+    case SCMD_XORREG:
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+    case SCMD_FMULREG:
+    case SCMD_FDIVREG:
+    case SCMD_FADDREG:
+    case SCMD_FSUBREG:
+    case SCMD_FGREATER:
+    case SCMD_FLESSTHAN:
+    case SCMD_FGTE:
+    case SCMD_FLTE:
+    case SCMD_STRINGSEQUAL:
+    case SCMD_STRINGSNOTEQ:
+        use = r1 | r2;
+        def = r1;
+        break;
+    default:
+        // calls, returns, and anything unknown
+        use = REGMASK_ALL;
+        def = REGMASK_ALL;
+        break;
+    }
+}
+
+// Calculates the integer operation the way the engine does;
+// returns false if the result cannot be known at compile time
+bool FoldIntOp(int32_t code, int32_t a, int32_t b, int32_t &result)
+{
+    const uint32_t ua = (uint32_t)a;
+    const uint32_t ub = (uint32_t)b;
+    switch (code)
+    {
+    case SCMD_ADD:
+    case SCMD_ADDREG:     result = (int32_t)(ua + ub); return true;
+    case SCMD_SUB:
+    case SCMD_SUBREG:     result = (int32_t)(ua - ub); return true;
+    case SCMD_MUL:
+    case SCMD_MULREG:     result = (int32_t)(ua * ub); return true;
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+        // leave the errors for the run time
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return false;
+        result = (code == SCMD_DIVREG) ? a / b : a % b;
+        return true;
+    case SCMD_BITAND:     result = a & b; return true;
+    case SCMD_BITOR:      result = a | b; return true;
+    case SCMD_XORREG:     result = a ^ b; return true;
+    case SCMD_ISEQUAL:    result = a == b; return true;
+    case SCMD_NOTEQUAL:   result = a != b; return true;
+    case SCMD_GREATER:    result = a > b; return true;
+    case SCMD_LESSTHAN:   result = a < b; return true;
+    case SCMD_GTE:        result = a >= b; return true;
+    case SCMD_LTE:        result = a <= b; return true;
+    case SCMD_AND:        result = a && b; return true;
+    case SCMD_OR:         result = a || b; return true;
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+        if (b < 0 || b >= 32)
+            return false;
+        result = (code == SCMD_SHIFTLEFT) ? (int32_t)(ua << b) : a >> b;
+        return true;
+    default:
+        return false;
+    }
+}
+
+inline bool IsIntRegOp(int32_t code)
+{
+    switch (code)
+    {
+    case SCMD_MULREG: case SCMD_DIVREG: case SCMD_ADDREG: case SCMD_SUBREG:
+    case SCMD_BITAND: case SCMD_BITOR: case SCMD_ISEQUAL: case SCMD_NOTEQUAL:
+    case SCMD_GREATER: case SCMD_LESSTHAN: case SCMD_GTE: case SCMD_LTE:
+    case SCMD_AND: case SCMD_OR: case SCMD_MODREG: case SCMD_XORREG:
+    case SCMD_SHIFTLEFT: case SCMD_SHIFTRIGHT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+class ScriptOptimizer
+{
+public:
+    ScriptOptimizer(ccCompiledScript *scrip) : _scrip(scrip) {}
+
+    // Reads the script's code; fails if it contains something unexpected
+    bool Decode();
+    void Optimize();
+    // Writes the code back, updating everything that refers to it
+    void Encode();
+
+private:
+    bool IsCodePosition(int32_t pos) const;
+    void MarkEntry(int32_t pos);
+    int32_t MapPosition(int32_t pos) const;
+    // Gets rid of the removed instructions and updates the jumps
+    void Compact();
+    void MarkLabels();
+    int  FollowJumps(int i) const;
+    bool CanMoveOverPush(const ScriptInstr &in, int32_t pop_reg) const;
+
+    // The optimization passes; each returns whether it changed anything
+    bool RemoveUnreachable();
+    bool ThreadJumps();
+    bool MergePushPop();
+    bool FoldConstants();
+    bool RemoveDeadWrites();
+
+    ccCompiledScript        *_scrip;
+    std::vector<ScriptInstr> _code;
+    // original code position -> original instruction index, -1 if not
+    // at the instruction start
+    std::vector<int>         _posToInstr;
+    // original instruction index -> current instruction index
+    std::vector<int>         _origToInstr;
+    // current instruction index -> new code position, set by Encode
+    std::vector<int32_t>     _newPos;
+};
+
+bool ScriptOptimizer::IsCodePosition(int32_t pos) const
+{
+    return pos >= 0 && pos < (int32_t)_posToInstr.size() && _posToInstr[pos] >= 0;
+}
+
+void ScriptOptimizer::MarkEntry(int32_t pos)
+{
+    const int i = _posToInstr[pos];
+    if (i < (int)_code.size())
+        _code[i].Entry = true;
+}
+
+int32_t ScriptOptimizer::MapPosition(int32_t pos) const
+{
+    return _newPos[_origToInstr[_posToInstr[pos]]];
+}
+
+bool ScriptOptimizer::Decode()
+{
+    const int32_t codesize = _scrip->codesize;
+    _posToInstr.assign(codesize + 1, -1);
+    std::vector<int> arg_owner(codesize, -1);
+    for (int32_t pos = 0; pos < codesize;)
+    {
+        ScriptInstr in;
+        in.Code = (int32_t)_scrip->code[pos];
+        if (in.Code <= 0 || in.Code >= CC_NUM_SCCMDS)
+            return false;
+        const int argc = in.ArgCount();
+        if (pos + argc >= codesize)
+            return false;
+        in.Pos = pos;
+        _posToInstr[pos] = (int)_code.size();
+        for (int a = 0; a < argc; ++a)
+        {
+            in.Args[a] = (int32_t)_scrip->code[pos + 1 + a];
+            arg_owner[pos + 1 + a] = (int)_code.size();
+        }
+        _code.push_back(in);
+        pos += argc + 1;
+    }
+    const int count = (int)_code.size();
+    _posToInstr[codesize] = count;
+
+    for (int i = 0; i < _scrip->numfixups; ++i)
+    {
+        // these patch the global data, not the code
+        if (_scrip->fixuptypes[i] == FIXUP_DATADATA)
+            continue;
+        const int32_t pos = _scrip->fixups[i];
+        if (pos < 0 || pos >= codesize || arg_owner[pos] < 0)
+            return false;
+        ScriptInstr &in = _code[arg_owner[pos]];
+        const int a = pos - in.Pos - 1;
+        if (in.Fixups[a] != 0)
+            return false;
+        in.Fixups[a] = _scrip->fixuptypes[i];
+        if (in.Fixups[a] == FIXUP_FUNCTION)
+        {
+            if (!IsCodePosition(in.Args[a]))
+                return false;
+            MarkEntry(in.Args[a]);
+        }
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        ScriptInstr &in = _code[i];
+        if (in.IsJump())
+        {
+            // jumps are relative to the end of the instruction
+            const int32_t target = in.Pos + 2 + in.Args[0];
+            if (in.Fixups[0] || !IsCodePosition(target))
+                return false;
+            in.Target = _posToInstr[target];
+        }
+        else if (in.Code == SCMD_THISBASE)
+        {
+            if (!IsCodePosition(in.Args[0]))
+                return false;
+        }
+    }
+
+    for (int i = 0; i < _scrip->numfunctions; ++i)
+    {
+        if (!IsCodePosition(_scrip->funccodeoffs[i]))
+            return false;
+        MarkEntry(_scrip->funccodeoffs[i]);
+    }
+    for (int i = 0; i < _scrip->numexports; ++i)
+    {
+        if ((_scrip->export_addr[i] >> 24) != EXPORT_FUNCTION)
+            continue;
+        const int32_t pos = _scrip->export_addr[i] & 0x00ffffff;
+        if (!IsCodePosition(pos))
+            return false;
+        MarkEntry(pos);
+    }
+    for (int i = 0; i < _scrip->numSections; ++i)
+    {
+        if (!IsCodePosition(_scrip->sectionOffsets[i]))
+            return false;
+    }
+    if (count > 0)
+        _code[0].Entry = true;
+
+    _origToInstr.resize(count + 1);
+    for (int i = 0; i <= count; ++i)
+        _origToInstr[i] = i;
+    MarkLabels();
+    return true;
+}
+
+void ScriptOptimizer::Optimize()
+{
+    typedef bool (ScriptOptimizer::*OptimizerPass)();
+    static const OptimizerPass passes[] =
+    {
+        &ScriptOptimizer::RemoveUnreachable,
+        &ScriptOptimizer::ThreadJumps,
+        &ScriptOptimizer::MergePushPop,
+        &ScriptOptimizer::FoldConstants,
+        &ScriptOptimizer::RemoveDeadWrites
+    };
+
+    for (int round = 0; round < MAX_OPTIMIZER_ROUNDS; ++round)
+    {
+        bool changed = false;
+        for (size_t p = 0; p < sizeof(passes) / sizeof(passes[0]); ++p)
+        {
+            if ((this->*passes[p])())
+            {
+                Compact();
+                changed = true;
+            }
+        }
+        if (!changed)
+            break;
+    }
+}
+
+void ScriptOptimizer::Encode()
+{
+    const int count = (int)_code.size();
+    _newPos.resize(count + 1);
+    int32_t pos = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        _newPos[i] = pos;
+        pos += 1 + _code[i].ArgCount();
+    }
+    _newPos[count] = pos;
+
+    // the fixups may only be removed, so there's always enough space for them
+    std::vector<int32_t> fixups;
+    std::vector<char> fixuptypes;
+    for (int i = 0; i < count; ++i)
+    {
+        const ScriptInstr &in = _code[i];
+        const int32_t at = _newPos[i];
+        _scrip->code[at] = in.Code;
+        for (int a = 0; a < in.ArgCount(); ++a)
+        {
+            int32_t arg = in.Args[a];
+            if (in.IsJump())
+                arg = _newPos[in.Target] - (at + 2);
+            else if (in.Code == SCMD_THISBASE || in.Fixups[a] == FIXUP_FUNCTION)
+                arg = MapPosition(arg);
+            _scrip->code[at + 1 + a] = arg;
+            if (in.Fixups[a])
+            {
+                fixups.push_back(at + 1 + a);
+                fixuptypes.push_back(in.Fixups[a]);
+            }
+        }
+    }
+    for (int i = 0; i < _scrip->numfixups; ++i)
+    {
+        if (_scrip->fixuptypes[i] == FIXUP_DATADATA)
+        {
+            fixups.push_back(_scrip->fixups[i]);
+            fixuptypes.push_back(FIXUP_DATADATA);
+        }
+    }
+    _scrip->numfixups = (int)fixups.size();
+    if (!fixups.empty())
+    {
+        memcpy(_scrip->fixups, &fixups.front(), fixups.size() * sizeof(int32_t));
+        memcpy(_scrip->fixuptypes, &fixuptypes.front(), fixuptypes.size());
+    }
+
+    for (int i = 0; i < _scrip->numfunctions; ++i)
+        _scrip->funccodeoffs[i] = MapPosition(_scrip->funccodeoffs[i]);
+    for (int i = 0; i < _scrip->numexports; ++i)
+    {
+        const int32_t etype = _scrip->export_addr[i] >> 24;
+        if (etype == EXPORT_FUNCTION)
+            _scrip->export_addr[i] = MapPosition(_scrip->export_addr[i] & 0x00ffffff) | (etype << 24);
+    }
+    for (int i = 0; i < _scrip->numSections; ++i)
+        _scrip->sectionOffsets[i] = MapPosition(_scrip->sectionOffsets[i]);
+    _scrip->codesize = pos;
+}
+
+void ScriptOptimizer::Compact()
+{
+    const int count = (int)_code.size();
+    // removed instructions are mapped to the next one that is kept
+    std::vector<int> remap(count + 1);
+    int kept = 0;
+    bool entry = false;
+    for (int i = 0; i < count; ++i)
+    {
+        remap[i] = kept;
+        ScriptInstr &in = _code[i];
+        if (in.Removed)
+        {
+            entry |= in.Entry;
+            continue;
+        }
+        in.Entry |= entry;
+        entry = false;
+        if (i != kept)
+            _code[kept] = in;
+        kept++;
+    }
+    remap[count] = kept;
+    _code.resize(kept);
+    for (int i = 0; i < kept; ++i)
+    {
+        if (_code[i].IsJump())
+            _code[i].Target = remap[_code[i].Target];
+    }
+    for (size_t i = 0; i < _origToInstr.size(); ++i)
+        _origToInstr[i] = remap[_origToInstr[i]];
+    MarkLabels();
+}
+
+void ScriptOptimizer::MarkLabels()
+{
+    const int count = (int)_code.size();
+    for (int i = 0; i < count; ++i)
+        _code[i].Label = _code[i].Entry;
+    for (int i = 0; i < count; ++i)
+    {
+        if (_code[i].IsJump() && _code[i].Target < count)
+            _code[_code[i].Target].Label = true;
+    }
+}
+
+bool ScriptOptimizer::RemoveUnreachable()
+{
+    const int count = (int)_code.size();
+    std::vector<bool> reached(count, false);
+    std::vector<int> pending;
+    for (int i = 0; i < count; ++i)
+    {
+        if (_code[i].Entry)
+            pending.push_back(i);
+    }
+    while (!pending.empty())
+    {
+        const int i = pending.back();
+        pending.pop_back();
+        if (i >= count || reached[i])
+            continue;
+        reached[i] = true;
+        const ScriptInstr &in = _code[i];
+        if (in.IsJump())
+            pending.push_back(in.Target);
+        if (in.Code != SCMD_JMP && in.Code != SCMD_RET)
+            pending.push_back(i + 1);
+    }
+
+    bool changed = false;
+    for (int i = 0; i < count; ++i)
+    {
+        if (!reached[i])
+        {
+            _code[i].Removed = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+int ScriptOptimizer::FollowJumps(int i) const
+{
+    const int count = (int)_code.size();
+    const ScriptInstr &in = _code[i];
+    // The engine counts the backward unconditional jumps as loop iterations,
+    // to detect the hung scripts; the resulting jump must be counted the
+    // same way as the chain it replaces.
+    int target = in.Target;
+    bool counted = in.Code == SCMD_JMP && target <= i;
+    for (int hops = 0; target < count && hops < count; ++hops)
+    {
+        const ScriptInstr &next = _code[target];
+        if (next.Removed)
+            break;
+        int next_target;
+        bool next_counted = counted;
+        if (next.Code == SCMD_JMP)
+        {
+            next_target = next.Target;
+            next_counted |= next.Target <= target;
+        }
+        else if (in.Code != SCMD_JMP && next.Code == in.Code)
+        {
+            // the condition is the same, so this one is taken too
+            next_target = next.Target;
+        }
+        else if (in.Code != SCMD_JMP && next.IsJump())
+        {
+            // the opposite condition, this one is never taken
+            next_target = target + 1;
+        }
+        else
+        {
+            break;
+        }
+        if (next_target == target)
+            break; // endless loop
+        const bool result_counted = in.Code == SCMD_JMP && next_target <= i;
+        if (result_counted != next_counted)
+            break;
+        target = next_target;
+        counted = next_counted;
+    }
+    return target;
+}
+
+bool ScriptOptimizer::ThreadJumps()
+{
+    const int count = (int)_code.size();
+    bool changed = false;
+    for (int i = 0; i < count; ++i)
+    {
+        ScriptInstr &in = _code[i];
+        if (in.Removed || !in.IsJump())
+            continue;
+        const int target = FollowJumps(i);
+        if (target != in.Target)
+        {
+            in.Target = target;
+            if (target < count)
+                _code[target].Label = true;
+            changed = true;
+        }
+
+        // "jz skip; jmp far; skip:" becomes "jnz far"; unless "jmp far"
+        // goes backwards, as that is counted as the loop iteration
+        if (in.Code != SCMD_JMP && in.Target == i + 2)
+        {
+            ScriptInstr &next = _code[i + 1];
+            if (next.Code == SCMD_JMP && !next.Removed && !next.Label && next.Target > i + 1)
+            {
+                in.Code = (in.Code == SCMD_JZ) ? SCMD_JNZ : SCMD_JZ;
+                in.Target = next.Target;
+                if (in.Target < count)
+                    _code[in.Target].Label = true;
+                next.Removed = true;
+                changed = true;
+                continue;
+            }
+        }
+
+        // jump to the next instruction
+        if (in.Target == i + 1)
+        {
+            in.Removed = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::CanMoveOverPush(const ScriptInstr &in, int32_t pop_reg) const
+{
+    int use, def;
+    GetRegUsage(in, use, def);
+    if (((use | def) & RegBit(pop_reg)) != 0)
+        return false;
+    for (int a = 0; a < MAX_SCMD_ARGS; ++a)
+    {
+        if (in.Fixups[a] == FIXUP_STACK)
+            return false;
+    }
+    switch (in.Code)
+    {
+    case SCMD_LITTOREG:
+    case SCMD_REGTOREG:
+    case SCMD_MEMREAD:
+    case SCMD_MEMREADB:
+    case SCMD_MEMREADW:
+        return true;
+    case SCMD_LOADSPOFFS:
+        // must not address the pushed value itself
+        return in.Args[0] > (int32_t)sizeof(int32_t);
+    default:
+        return false;
+    }
+}
+
+// "push r1; <...>; pop r2" becomes "r2 = r1; <...>", if the instructions
+// in between do not use r2 and the stack
+bool ScriptOptimizer::MergePushPop()
+{
+    const int count = (int)_code.size();
+    bool changed = false;
+    for (int i = 0; i < count; ++i)
+    {
+        ScriptInstr &push = _code[i];
+        if (push.Removed || push.Code != SCMD_PUSHREG || push.Args[0] == SREG_SP)
+            continue;
+        int pop = -1;
+        for (int k = i + 1; k < count && k <= i + 1 + MAX_PUSHPOP_DISTANCE; ++k)
+        {
+            if (_code[k].Label)
+                break;
+            if (_code[k].Code == SCMD_POPREG)
+            {
+                pop = k;
+                break;
+            }
+        }
+        if (pop < 0 || _code[pop].Args[0] == SREG_SP)
+            continue;
+        const int32_t src = push.Args[0];
+        const int32_t dst = _code[pop].Args[0];
+        bool can_merge = true;
+        for (int k = i + 1; k < pop && can_merge; ++k)
+            can_merge = CanMoveOverPush(_code[k], dst);
+        if (!can_merge)
+            continue;
+
+        for (int k = i + 1; k < pop; ++k)
+        {
+            if (_code[k].Code == SCMD_LOADSPOFFS)
+                _code[k].Args[0] -= sizeof(int32_t);
+        }
+        if (src == dst)
+        {
+            push.Removed = true;
+        }
+        else
+        {
+            push.Code = SCMD_REGTOREG;
+            push.Args[0] = src;
+            push.Args[1] = dst;
+        }
+        _code[pop].Removed = true;
+        changed = true;
+        i = pop;
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::FoldConstants()
+{
+    const int count = (int)_code.size();
+    bool changed = false;
+    bool known[NUM_REGISTERS];
+    int32_t value[NUM_REGISTERS];
+    memset(known, 0, sizeof(known));
+    for (int i = 0; i < count; ++i)
+    {
+        ScriptInstr &in = _code[i];
+        if (in.Removed)
+            continue;
+        // the values may be anything if we came here from elsewhere
+        if (in.Label)
+            memset(known, 0, sizeof(known));
+
+        const int32_t r1 = in.Args[0];
+        const int32_t r2 = in.Args[1];
+        int32_t result;
+        if (in.Code == SCMD_LITTOREG)
+        {
+            if (IsTracked(r1) && !in.HasFixups())
+            {
+                if (known[r1] && value[r1] == in.Args[1])
+                {
+                    in.Removed = true;
+                    changed = true;
+                }
+                known[r1] = true;
+                value[r1] = in.Args[1];
+                continue;
+            }
+        }
+        else if (in.Code == SCMD_REGTOREG)
+        {
+            if (IsTracked(r1) && known[r1] && IsTracked(r2))
+            {
+                if (known[r2] && value[r2] == value[r1])
+                    in.Removed = true;
+                else
+                    in.SetLiteral(r2, value[r1]);
+                known[r2] = true;
+                value[r2] = value[r1];
+                changed = true;
+                continue;
+            }
+        }
+        else if (in.Code == SCMD_ADD || in.Code == SCMD_SUB || in.Code == SCMD_MUL)
+        {
+            if (IsTracked(r1) && known[r1] && !in.HasFixups() &&
+                FoldIntOp(in.Code, value[r1], in.Args[1], result))
+            {
+                in.SetLiteral(r1, result);
+                value[r1] = result;
+                changed = true;
+                continue;
+            }
+        }
+        else if (in.Code == SCMD_NOTREG)
+        {
+            if (IsTracked(r1) && known[r1])
+            {
+                in.SetLiteral(r1, !value[r1]);
+                value[r1] = !value[r1];
+                changed = true;
+                continue;
+            }
+        }
+        else if (IsIntRegOp(in.Code))
+        {
+            if (IsTracked(r2) && known[r2])
+            {
+                if (IsTracked(r1) && known[r1] && FoldIntOp(in.Code, value[r1], value[r2], result))
+                {
+                    in.SetLiteral(r1, result);
+                    value[r1] = result;
+                    changed = true;
+                    continue;
+                }
+                if (r1 != SREG_SP && (in.Code == SCMD_ADDREG || in.Code == SCMD_MULREG))
+                {
+                    in.Code = (in.Code == SCMD_ADDREG) ? SCMD_ADD : SCMD_MUL;
+                    in.Args[1] = value[r2];
+                    changed = true;
+                }
+            }
+        }
+        else if (in.Code == SCMD_JZ || in.Code == SCMD_JNZ)
+        {
+            if (known[SREG_AX])
+            {
+                const bool taken = (in.Code == SCMD_JZ) == (value[SREG_AX] == 0);
+                if (!taken)
+                {
+                    in.Removed = true;
+                    changed = true;
+                    continue;
+                }
+                // a backward jump would be counted as the loop iteration
+                if (in.Target > i)
+                {
+                    in.Code = SCMD_JMP;
+                    changed = true;
+                }
+            }
+        }
+
+        int use, def;
+        GetRegUsage(in, use, def);
+        for (int r = 0; r < NUM_REGISTERS; ++r)
+        {
+            if (def & (1 << r))
+                known[r] = false;
+        }
+        if (in.Code == SCMD_JMP || in.Code == SCMD_RET)
+            memset(known, 0, sizeof(known));
+    }
+    return changed;
+}
+
+// Removes the register assignments whose values are never read
+bool ScriptOptimizer::RemoveDeadWrites()
+{
+    const int count = (int)_code.size();
+    std::vector<int> use(count), def(count), live_in(count, 0), live_out(count, 0);
+    for (int i = 0; i < count; ++i)
+        GetRegUsage(_code[i], use[i], def[i]);
+
+    for (bool again = true; again;)
+    {
+        again = false;
+        for (int i = count - 1; i >= 0; --i)
+        {
+            const ScriptInstr &in = _code[i];
+            int out = 0;
+            if (in.Code != SCMD_JMP && in.Code != SCMD_RET)
+                out |= (i + 1 < count) ? live_in[i + 1] : REGMASK_ALL;
+            if (in.IsJump())
+                out |= (in.Target < count) ? live_in[in.Target] : REGMASK_ALL;
+            live_out[i] = out;
+            const int in_mask = use[i] | (out & ~def[i]);
+            if (in_mask != live_in[i])
+            {
+                live_in[i] = in_mask;
+                again = true;
+            }
+        }
+    }
+
+    bool changed = false;
+    for (int i = 0; i < count; ++i)
+    {
+        ScriptInstr &in = _code[i];
+        int32_t reg;
+        if (in.Code == SCMD_LITTOREG)
+            reg = in.Args[0];
+        else if (in.Code == SCMD_REGTOREG)
+            reg = in.Args[1];
+        else
+            continue;
+        const bool self_copy = in.Code == SCMD_REGTOREG && in.Args[0] == in.Args[1];
+        if (self_copy || (IsTracked(reg) && (live_out[i] & RegBit(reg)) == 0))
+        {
+            in.Removed = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+} // namespace
+
+int cc_optimize(ccCompiledScript *scrip)
+{
+    ScriptOptimizer optimizer(scrip);
+    if (!optimizer.Decode())
+        return -1;
+    optimizer.Optimize();
+    optimizer.Encode();
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef __CS_OPTIMIZER_H
+#define __CS_OPTIMIZER_H
+
+struct ccCompiledScript;
+
+// Optimizes the code of the compiled script in place: removes dead code,
+// threads jumps, folds constants and gets rid of redundant stack and
+// register operations. Line number instructions are never moved or merged,
+// so the line reported for every remaining instruction stays the same.
+// Must be called after the whole script was compiled, but before exports
+// are added for the functions and the extra compiler data is freed.
+// Returns 0 on success, or -1 if the code was left as is because it
+// could not be analyzed.
+extern int cc_optimize(ccCompiledScript *scrip);
+
+#endif // __CS_OPTIMIZER_H
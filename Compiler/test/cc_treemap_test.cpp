@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include "gtest/gtest.h"
 #include "script/cc_treemap.h"
 
@@ -55,3 +56,27 @@ TEST(TreeMap, Clear) {
 	symbolTree.clear();
 	ASSERT_TRUE (symbolTree.findValue("a") == -1);
 }
+
+TEST(TreeMap, ManyEntries) {
+	ccTreeMap symbolTree;
+	char name[20];
+	for (int i = 0; i < 5000; i++) {
+		sprintf(name, "sym%d", i);
+		symbolTree.addEntry(name, i);
+	}
+	for (int i = 0; i < 5000; i++) {
+		sprintf(name, "sym%d", i);
+		ASSERT_TRUE (symbolTree.findValue(name) == i);
+	}
+	ASSERT_TRUE (symbolTree.findValue("sym5000") == -1);
+	ASSERT_TRUE (symbolTree.findValue("sym") == -1);
+}
+
+TEST(TreeMap, Copy) {
+	ccTreeMap symbolTree;
+	symbolTree.addEntry("a", 500);
+	ccTreeMap copy = symbolTree;
+	symbolTree.addEntry("b", 501);
+	ASSERT_TRUE (copy.findValue("a") == 500);
+	ASSERT_TRUE (copy.findValue("b") == -1);
+}
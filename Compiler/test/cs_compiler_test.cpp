@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cs_compiler.h"
+#include "script/cc_error.h"
+#include "script/cc_options.h"
+#include "script/script_common.h"
+
+extern thread_local char *last_seen_cc_error;
+extern int ccCompOptions; // in script/cc_options
+
+namespace {
+
+char headerText[] = "\
+    import int GetValue(int a);\
+    import int unusedImport;\
+    managed struct Point {\
+      int x;\
+      int y;\
+    };\
+    import int GetSum(Point *p);\
+    ";
+
+const char *mainScript = "\
+    int counter;\
+    int GetSum(Point *p) {\
+      return p.x + p.y + GetValue(counter);\
+    }\
+    int Run() {\
+      counter++;\
+      return counter;\
+    }\
+    ";
+
+void expectSameScript(ccScript *a, ccScript *b) {
+    ASSERT_EQ(a->codesize, b->codesize);
+    EXPECT_EQ(0, memcmp(a->code, b->code, a->codesize * sizeof(a->code[0])));
+    ASSERT_EQ(a->globaldatasize, b->globaldatasize);
+    ASSERT_EQ(a->numfixups, b->numfixups);
+    EXPECT_EQ(0, memcmp(a->fixups, b->fixups, a->numfixups * sizeof(a->fixups[0])));
+    ASSERT_EQ(a->numimports, b->numimports);
+    for (int i = 0; i < a->numimports; ++i)
+        EXPECT_STREQ(a->imports[i], b->imports[i]);
+    ASSERT_EQ(a->numexports, b->numexports);
+    for (int i = 0; i < a->numexports; ++i) {
+        EXPECT_STREQ(a->exports[i], b->exports[i]);
+        EXPECT_EQ(a->export_addr[i], b->export_addr[i]);
+    }
+    ASSERT_EQ(a->numSections, b->numSections);
+    for (int i = 0; i < a->numSections; ++i) {
+        EXPECT_STREQ(a->sectionNames[i], b->sectionNames[i]);
+        EXPECT_EQ(a->sectionOffsets[i], b->sectionOffsets[i]);
+    }
+}
+
+} // namespace
+
+TEST(Compile, HeaderCacheGivesSameScript) {
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(headerText, "Header");
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+
+    ccScript *first = ccCompileText(mainScript, "Main");
+    ASSERT_NE((ccScript *)NULL, first) << last_seen_cc_error;
+    // the second compilation starts from the cached header state, and
+    // must not see the symbols or the imports used by the first one
+    ccScript *second = ccCompileText(mainScript, "Main");
+    ASSERT_NE((ccScript *)NULL, second);
+    expectSameScript(first, second);
+
+    ccSetOption(SCOPT_EXPORTALL, 0);
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+    ccRemoveDefaultHeaders();
+    delete first;
+    delete second;
+}
+
+TEST(Compile, HeaderCacheDetectsChanges) {
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(headerText, "Header");
+
+    const char *useImport = "int Test() { return unusedImport; }";
+    ccScript *script = ccCompileText(useImport, "Main");
+    ASSERT_NE((ccScript *)NULL, script);
+    delete script;
+
+    // the header is changed in place, so only its contents tell about it
+    char *import = strstr(headerText, "unusedImport");
+    ASSERT_NE((char *)NULL, import);
+    import[0] = 'x';
+    script = ccCompileText(useImport, "Main");
+    EXPECT_EQ((ccScript *)NULL, script);
+    EXPECT_NE(0, ccError);
+    import[0] = 'u';
+
+    // the options that affect the headers are checked as well
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    script = ccCompileText(useImport, "Main");
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+    ASSERT_NE((ccScript *)NULL, script);
+    ASSERT_LT(0, script->codesize);
+    EXPECT_EQ(SCMD_LINENUM, script->code[0]);
+    delete script;
+
+    ccRemoveDefaultHeaders();
+}
+
+TEST(Compile, BatchMatchesOneByOne) {
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(headerText, "Header");
+
+    const int numJobs = 12;
+    std::vector<std::string> scripts(numJobs);
+    std::vector<std::string> names(numJobs);
+    ccCompileJob jobs[numJobs];
+    for (int i = 0; i < numJobs; ++i) {
+        char buf[300];
+        if (i % 4 == 3) {
+            // a script that fails on its second line
+            sprintf(buf, "int Room%d() {\n  return unknownSymbol%d;\n}\n", i, i);
+        }
+        else {
+            sprintf(buf, "int counter%d = %d;\nint Room%d(Point *p) {\n  return p.x * %d + GetValue(counter%d);\n}\n",
+                i, i, i, i, i);
+        }
+        scripts[i] = buf;
+        sprintf(buf, "room%d.asc", i);
+        names[i] = buf;
+        jobs[i].script = scripts[i].c_str();
+        jobs[i].scriptName = names[i].c_str();
+        jobs[i].options = SCOPT_EXPORTALL | ((i % 2) ? SCOPT_LINENUMBERS : 0);
+    }
+
+    ccCompileResult results[numJobs];
+    EXPECT_EQ(3, ccCompileTextBatch(jobs, numJobs, results, 4));
+
+    for (int i = 0; i < numJobs; ++i) {
+        ccSetOption(~0, 0);
+        ccSetOption(jobs[i].options, 1);
+        ccScript *expected = ccCompileText(jobs[i].script, jobs[i].scriptName);
+        if (i % 4 == 3) {
+            EXPECT_EQ((ccScript *)NULL, expected);
+            EXPECT_EQ((ccScript *)NULL, results[i].script);
+            EXPECT_EQ(2, results[i].errorLine);
+            EXPECT_EQ(names[i], results[i].errorScriptName);
+        }
+        else {
+            ASSERT_NE((ccScript *)NULL, expected);
+            ASSERT_NE((ccScript *)NULL, results[i].script) << results[i].errorString;
+            expectSameScript(expected, results[i].script);
+        }
+        delete expected;
+        delete results[i].script;
+    }
+    ccSetOption(~0, 0);
+    ccRemoveDefaultHeaders();
+}
+
+// Clears the compiler options for a test and restores them afterwards
+struct CompileOptionsGuard {
+    const int savedOptions;
+    CompileOptionsGuard() : savedOptions(ccCompOptions) { ccSetOption(~0, 0); }
+    ~CompileOptionsGuard() { ccSetOption(~0, 0); ccSetOption(savedOptions, 1); }
+};
+
+// Compile-speed microbenchmark: compiles a large generated script a few
+// times and records the average time per compilation as "CompileMs".
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST(CompileSpeed, DISABLED_LargeScript) {
+    const int numFunctions = 400;
+    std::string script = "struct Vector {\n  int x;\n  int y;\n  int z;\n};\n";
+    for (int i = 0; i < numFunctions; ++i) {
+        char buf[600];
+        sprintf(buf,
+            "Vector vec%d;\n"
+            "int total%d;\n"
+            "int Update%d(int count, int step) {\n"
+            "  int sum = 0;\n"
+            "  for (int index = 0; index < count; index++) {\n"
+            "    vec%d.x += step * index;\n"
+            "    vec%d.y = vec%d.x - (index << 2);\n"
+            "    if (vec%d.y > 100 && step != 0) {\n"
+            "      sum += vec%d.y / step;\n"
+            "    }\n"
+            "  }\n"
+            "  total%d += sum;\n"
+            "  return total%d;\n"
+            "}\n",
+            i, i, i, i, i, i, i, i, i, i);
+        script += buf;
+    }
+
+    ccRemoveDefaultHeaders();
+    CompileOptionsGuard options;
+    const int runs = 5;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; ++run) {
+        ccScript *compiled = ccCompileText(script.c_str(), "Benchmark");
+        ASSERT_NE((ccScript *)NULL, compiled) << last_seen_cc_error;
+        delete compiled;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / runs;
+    RecordProperty("CompileMs", (int)ms);
+}
@@ -0,0 +1,410 @@
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cs_parser.h"
+#include "script/cc_compilerstate.h"
+#include "script/cs_optimizer.h"
+#include "script/cs_compiler.h"
+#include "script/cc_symboltable.h"
+#include "script/cc_options.h"
+#include "script/script_common.h"
+
+extern ccCompiledScript *newScriptFixture();
+
+namespace
+{
+
+const int ArgCount[CC_NUM_SCCMDS] =
+{
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 1, 2, 2, 1, 2, 1, 1, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 1, 1, 2, 2, 1, 0, 0, 1, 1, 3, 2
+};
+
+// A minimal interpreter for the compiled code, following the engine's
+// rules for the instructions that the test scripts use
+class TestMachine
+{
+public:
+    static const int32_t GlobalBase = 0x1000;
+    static const int32_t StackBase = 0x10000;
+    static const int32_t MemorySize = 0x20000;
+    static const int MaxNest = 50;
+
+    TestMachine(const ccCompiledScript *scrip)
+        : BackJumps(0)
+        , _scrip(scrip)
+        , _code(scrip->code, scrip->code + scrip->codesize)
+        , _mem(MemorySize, 0)
+    {
+        memcpy(&_mem[GlobalBase], scrip->globaldata, scrip->globaldatasize);
+        for (int i = 0; i < scrip->numfixups; ++i)
+        {
+            const int32_t pos = scrip->fixups[i];
+            switch (scrip->fixuptypes[i])
+            {
+            case FIXUP_GLOBALDATA: _code[pos] += GlobalBase; break;
+            case FIXUP_DATADATA: Write(GlobalBase + pos, 4, Read(GlobalBase + pos, 4) + GlobalBase); break;
+            case FIXUP_FUNCTION: break;
+            default: ADD_FAILURE() << "unsupported fixup type " << (int)scrip->fixuptypes[i];
+            }
+        }
+    }
+
+    // Runs the function and returns what it left in AX
+    int32_t Call(const char *func_name, int32_t arg0 = 0, int32_t arg1 = 0)
+    {
+        int32_t entry = -1;
+        for (int i = 0; i < _scrip->numfunctions; ++i)
+            if (strcmp(_scrip->functions[i], func_name) == 0)
+                entry = _scrip->funccodeoffs[i];
+        EXPECT_LE(0, entry) << func_name;
+        memset(_reg, 0, sizeof(_reg));
+        _reg[SREG_SP] = StackBase;
+        Push(arg1);
+        Push(arg0);
+        Push(0); // return address
+        int nest = 0;
+        _thisbase[0] = 0;
+        _funcstart[0] = entry;
+        for (int32_t pc = entry, steps = 0; steps < 1000000; ++steps)
+        {
+            if (pc < 0 || pc >= (int32_t)_code.size())
+            {
+                ADD_FAILURE() << "pc out of code: " << pc;
+                return 0;
+            }
+            const int32_t op = (int32_t)_code[pc];
+            const int32_t a1 = (ArgCount[op] > 0) ? (int32_t)_code[pc + 1] : 0;
+            const int32_t a2 = (ArgCount[op] > 1) ? (int32_t)_code[pc + 2] : 0;
+            int32_t &r1 = _reg[a1 & 7];
+            int32_t &r2 = _reg[a2 & 7];
+            int32_t next = pc + 1 + ArgCount[op];
+            switch (op)
+            {
+            case SCMD_LINENUM: Lines.push_back(a1); break;
+            case SCMD_THISBASE: _thisbase[nest] = a1; break;
+            case SCMD_LOOPCHECKOFF: break;
+            case SCMD_ADD: r1 += a2; break;
+            case SCMD_SUB: r1 -= a2; break;
+            case SCMD_MUL: r1 *= a2; break;
+            case SCMD_REGTOREG: r2 = r1; break;
+            case SCMD_LITTOREG: r1 = a2; break;
+            case SCMD_WRITELIT: Write(_reg[SREG_MAR], a1, a2); break;
+            case SCMD_ZEROMEMORY:
+                for (int32_t i = 0; i < a1; ++i)
+                    Write(_reg[SREG_MAR] + i, 1, 0);
+                break;
+            case SCMD_MEMREAD: r1 = Read(_reg[SREG_MAR], 4); break;
+            case SCMD_MEMREADW: r1 = (int16_t)Read(_reg[SREG_MAR], 2); break;
+            case SCMD_MEMREADB: r1 = (uint8_t)Read(_reg[SREG_MAR], 1); break;
+            case SCMD_MEMWRITE: Write(_reg[SREG_MAR], 4, r1); break;
+            case SCMD_MEMWRITEW: Write(_reg[SREG_MAR], 2, r1); break;
+            case SCMD_MEMWRITEB: Write(_reg[SREG_MAR], 1, r1); break;
+            case SCMD_LOADSPOFFS: _reg[SREG_MAR] = _reg[SREG_SP] - a1; break;
+            case SCMD_PUSHREG: Push(r1); break;
+            case SCMD_POPREG: r1 = Pop(); break;
+            case SCMD_MULREG: r1 *= r2; break;
+            case SCMD_DIVREG: EXPECT_NE(0, r2); r1 = r2 ? r1 / r2 : 0; break;
+            case SCMD_MODREG: EXPECT_NE(0, r2); r1 = r2 ? r1 % r2 : 0; break;
+            case SCMD_ADDREG: r1 += r2; break;
+            case SCMD_SUBREG: r1 -= r2; break;
+            case SCMD_BITAND: r1 &= r2; break;
+            case SCMD_BITOR: r1 |= r2; break;
+            case SCMD_XORREG: r1 ^= r2; break;
+            case SCMD_SHIFTLEFT: r1 <<= r2; break;
+            case SCMD_SHIFTRIGHT: r1 >>= r2; break;
+            case SCMD_ISEQUAL: r1 = r1 == r2; break;
+            case SCMD_NOTEQUAL: r1 = r1 != r2; break;
+            case SCMD_GREATER: r1 = r1 > r2; break;
+            case SCMD_LESSTHAN: r1 = r1 < r2; break;
+            case SCMD_GTE: r1 = r1 >= r2; break;
+            case SCMD_LTE: r1 = r1 <= r2; break;
+            case SCMD_AND: r1 = r1 && r2; break;
+            case SCMD_OR: r1 = r1 || r2; break;
+            case SCMD_NOTREG: r1 = !r1; break;
+            case SCMD_CHECKBOUNDS: EXPECT_TRUE(r1 >= 0 && r1 < a2); break;
+            case SCMD_JZ: if (_reg[SREG_AX] == 0) next += a1; break;
+            case SCMD_JNZ: if (_reg[SREG_AX] != 0) next += a1; break;
+            case SCMD_JMP:
+                next += a1;
+                if (a1 < 0)
+                    BackJumps++;
+                break;
+            case SCMD_CALL:
+                Push(next);
+                EXPECT_LT(nest + 1, (int)MaxNest);
+                next = (_thisbase[nest] == 0) ? r1 : _funcstart[nest] + (r1 - _thisbase[nest]);
+                nest++;
+                _thisbase[nest] = 0;
+                _funcstart[nest] = next;
+                break;
+            case SCMD_RET:
+                next = Pop();
+                nest--;
+                if (next == 0)
+                    return _reg[SREG_AX];
+                break;
+            default:
+                ADD_FAILURE() << "unsupported instruction " << op;
+                return 0;
+            }
+            pc = next;
+        }
+        ADD_FAILURE() << "script takes too long";
+        return 0;
+    }
+
+    std::vector<int32_t> Lines;
+    int BackJumps;
+
+private:
+    int32_t Read(int32_t addr, int size)
+    {
+        if (addr < 0 || addr + size > MemorySize)
+        {
+            ADD_FAILURE() << "bad address " << addr;
+            return 0;
+        }
+        int32_t val = 0;
+        memcpy(&val, &_mem[addr], size);
+        return val;
+    }
+
+    void Write(int32_t addr, int size, int32_t val)
+    {
+        if (addr < 0 || addr + size > MemorySize)
+        {
+            ADD_FAILURE() << "bad address " << addr;
+            return;
+        }
+        memcpy(&_mem[addr], &val, size);
+    }
+
+    void Push(int32_t val)
+    {
+        Write(_reg[SREG_SP], 4, val);
+        _reg[SREG_SP] += 4;
+    }
+
+    int32_t Pop()
+    {
+        _reg[SREG_SP] -= 4;
+        return Read(_reg[SREG_SP], 4);
+    }
+
+    const ccCompiledScript *_scrip;
+    std::vector<intptr_t> _code;
+    std::vector<uint8_t> _mem;
+    int32_t _reg[8];
+    int32_t _thisbase[MaxNest];
+    int32_t _funcstart[MaxNest];
+};
+
+ccCompiledScript *compileScript(const char *inpl, bool optimize)
+{
+    ccCompiledScript *scrip = newScriptFixture();
+    ccCompileOptions = SCOPT_LINENUMBERS;
+    int compileResult = cc_compile(inpl, scrip);
+    ccCompileOptions = 0;
+    EXPECT_EQ(0, compileResult);
+    if (optimize)
+        EXPECT_EQ(0, cc_optimize(scrip));
+    return scrip;
+}
+
+int countInstructions(const ccCompiledScript *scrip, int32_t code)
+{
+    int count = 0;
+    for (int32_t pc = 0; pc < scrip->codesize; pc += 1 + ArgCount[scrip->code[pc]])
+        if (scrip->code[pc] == code)
+            count++;
+    return count;
+}
+
+const char *loopsScript = "\
+int arr[20];\n\
+int sum(int n)\n\
+{\n\
+  int s = 0;\n\
+  int i;\n\
+  for (i = 0; i < n; i++)\n\
+  {\n\
+    if (i % 3 == 0)\n\
+      continue;\n\
+    arr[i] = i * 2 + 1;\n\
+    s += arr[i];\n\
+  }\n\
+  while (s > 50)\n\
+  {\n\
+    s -= 7;\n\
+    if (s == 60)\n\
+      break;\n\
+  }\n\
+  do\n\
+  {\n\
+    s += 2;\n\
+  } while (s < 10);\n\
+  switch (n)\n\
+  {\n\
+    case 1: s += 100; break;\n\
+    case 2:\n\
+    case 3: s += 200;\n\
+    default: s += 1;\n\
+  }\n\
+  return s;\n\
+}\n";
+
+const char *callsScript = "\
+int g;\n\
+int fib(int n)\n\
+{\n\
+  if (n < 2)\n\
+    return n;\n\
+  return fib(n - 1) + fib(n - 2);\n\
+}\n\
+void add(int a, int b)\n\
+{\n\
+  g += a * b + (10 - 4) / 2;\n\
+}\n\
+int test(int n, int m)\n\
+{\n\
+  g = 0;\n\
+  add(n, m);\n\
+  add(m, 3 << 2);\n\
+  if (n > 5 && m > 5 || n == m)\n\
+    return g + fib(n);\n\
+  else\n\
+    return g - fib(m);\n\
+  return -1;\n\
+}\n";
+
+} // namespace
+
+TEST(Optimizer, FoldsConstants) {
+    const char *inpl = "\
+        int f()\n\
+        {\n\
+          int a = 2 + 3 * 4;\n\
+          return a + ((2 + 3 * 4) << 2) - 100 / 7 % 5;\n\
+        }\n";
+    ccCompiledScript *plain = compileScript(inpl, false);
+    ccCompiledScript *opt = compileScript(inpl, true);
+
+    EXPECT_EQ(TestMachine(plain).Call("f"), TestMachine(opt).Call("f"));
+    EXPECT_EQ(66, TestMachine(opt).Call("f"));
+    EXPECT_EQ(0, countInstructions(opt, SCMD_MULREG));
+    EXPECT_EQ(0, countInstructions(opt, SCMD_DIVREG));
+    EXPECT_EQ(0, countInstructions(opt, SCMD_MODREG));
+    EXPECT_EQ(0, countInstructions(opt, SCMD_SHIFTLEFT));
+    EXPECT_EQ(0, countInstructions(opt, SCMD_PUSHREG));
+    EXPECT_LT(opt->codesize, plain->codesize);
+}
+
+TEST(Optimizer, RemovesDeadCode) {
+    const char *inpl = "\
+        int f(int x)\n\
+        {\n\
+          if (x > 0)\n\
+            return 1;\n\
+          else\n\
+            return 2;\n\
+          return 3;\n\
+        }\n";
+    ccCompiledScript *plain = compileScript(inpl, false);
+    ccCompiledScript *opt = compileScript(inpl, true);
+
+    EXPECT_EQ(1, TestMachine(opt).Call("f", 5));
+    EXPECT_EQ(2, TestMachine(opt).Call("f", -5));
+    // only the two reachable returns are left
+    EXPECT_EQ(2, countInstructions(opt, SCMD_RET));
+    EXPECT_LT(countInstructions(opt, SCMD_RET), countInstructions(plain, SCMD_RET));
+}
+
+TEST(Optimizer, ThreadsJumps) {
+    const char *inpl = "\
+        int f(int x)\n\
+        {\n\
+          int r = 0;\n\
+          if (x > 0)\n\
+          {\n\
+            if (x > 10)\n\
+              r = 2;\n\
+            else\n\
+              r = 1;\n\
+          }\n\
+          else\n\
+            r = 3;\n\
+          return r;\n\
+        }\n";
+    ccCompiledScript *plain = compileScript(inpl, false);
+    ccCompiledScript *opt = compileScript(inpl, true);
+
+    for (int x = -2; x < 15; ++x)
+        EXPECT_EQ(TestMachine(plain).Call("f", x), TestMachine(opt).Call("f", x));
+    // no jump leads to another unconditional jump
+    for (int32_t pc = 0; pc < opt->codesize; pc += 1 + ArgCount[opt->code[pc]]) {
+        const int32_t code = opt->code[pc];
+        if (code != SCMD_JMP && code != SCMD_JZ && code != SCMD_JNZ)
+            continue;
+        const int32_t target = pc + 2 + opt->code[pc + 1];
+        ASSERT_LT(target, opt->codesize);
+        EXPECT_NE(SCMD_JMP, opt->code[target]);
+        EXPECT_NE(0, opt->code[pc + 1]);
+    }
+}
+
+TEST(Optimizer, KeepsLoopsAndLineNumbers) {
+    ccCompiledScript *plain = compileScript(loopsScript, false);
+    ccCompiledScript *opt = compileScript(loopsScript, true);
+    EXPECT_LT(opt->codesize, plain->codesize);
+
+    for (int n = 0; n < 20; ++n) {
+        TestMachine plainRun(plain);
+        TestMachine optRun(opt);
+        EXPECT_EQ(plainRun.Call("sum", n), optRun.Call("sum", n)) << "n = " << n;
+        // the same lines are reported in the same order
+        EXPECT_EQ(plainRun.Lines, optRun.Lines) << "n = " << n;
+        // loop iterations are counted the same for detecting hung scripts
+        EXPECT_EQ(plainRun.BackJumps > 0, optRun.BackJumps > 0) << "n = " << n;
+    }
+}
+
+TEST(Optimizer, KeepsCallsAndGlobals) {
+    ccCompiledScript *plain = compileScript(callsScript, false);
+    ccCompiledScript *opt = compileScript(callsScript, true);
+    EXPECT_LT(opt->codesize, plain->codesize);
+
+    for (int n = 0; n < 10; ++n) {
+        for (int m = 0; m < 10; m += 3) {
+            TestMachine plainRun(plain);
+            TestMachine optRun(opt);
+            EXPECT_EQ(plainRun.Call("test", n, m), optRun.Call("test", n, m)) << n << ", " << m;
+            EXPECT_EQ(plainRun.Lines, optRun.Lines);
+        }
+    }
+}
+
+TEST(Optimizer, CompileTextOption) {
+    ccScript *plain = ccCompileText(callsScript, "test");
+    ASSERT_NE((ccScript *)NULL, plain);
+    ccSetOption(SCOPT_OPTIMIZE, 1);
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccScript *opt = ccCompileText(callsScript, "test");
+    ccSetOption(SCOPT_OPTIMIZE, 0);
+    ccSetOption(SCOPT_EXPORTALL, 0);
+    ASSERT_NE((ccScript *)NULL, opt);
+
+    EXPECT_LT(opt->codesize, plain->codesize);
+    // exported function addresses point at the optimized code
+    ASSERT_EQ(3, opt->numexports);
+    for (int i = 0; i < opt->numexports; ++i) {
+        const int32_t addr = opt->export_addr[i] & 0x00ffffff;
+        ASSERT_LT(addr, opt->codesize);
+        EXPECT_EQ(SCMD_THISBASE, opt->code[addr]);
+        EXPECT_EQ(addr, opt->code[addr + 1]);
+    }
+    delete plain;
+    delete opt;
+}
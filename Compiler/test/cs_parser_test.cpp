@@ -5,7 +5,7 @@
 
 extern int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip);
 
-char *last_seen_cc_error = 0;
+thread_local char *last_seen_cc_error = 0;
 
 void cc_error_at_line(char *buffer, const char *error_msg)
 {
@@ -538,6 +538,8 @@ builtin managed struct Room {
 #ifdef SCRIPT_API_v350
   /// Gets the room camera
   import static readonly attribute Camera *Camera;
+  /// Starts loading the room in the background, so that it is entered faster
+  import static void Preload(int room);
 #endif
 };
 
@@ -3,16 +3,16 @@
 //
 
 #include <stdio.h>
-#include "script/cc_error.h"
-
-extern int currentline; // in script/script_common
+#include "script/cc_compilerstate.h"
 
+// Only the script compiler reports errors at a line in the Editor, and it
+// keeps that line per thread
 void cc_error_at_line(char *buffer, const char *error_msg)
 {
-    sprintf(ccErrorString, "Error (line %d): %s", currentline, error_msg);
+    sprintf(buffer, "Error (line %d): %s", ccCompileLine, error_msg);
 }
 
 void cc_error_without_line(char *buffer, const char *error_msg)
 {
-    sprintf(ccErrorString, "Error (line unknown): %s", error_msg);
+    sprintf(buffer, "Error (line unknown): %s", error_msg);
 }
@@ -21,8 +21,9 @@
 #include <utility>
 #include "util/string.h"
 
-namespace AGS { namespace Common {class Stream;}}
+namespace AGS { namespace Common {class Stream; struct AssetLocation;}}
 using AGS::Common::Stream;
+using AGS::Common::AssetLocation;
 using AGS::Common::String;
 
 // Looks for valid asset library everywhere and returns path, or empty string if failed
@@ -45,6 +46,8 @@ AssetPath get_audio_clip_assetpath(int bundling_type, const String &filename);
 // Returns the path to the voice-over asset
 AssetPath get_voice_over_assetpath(const String &filename);
 
+// Finds the file containing the asset, and asset's position within it
+bool LocateAsset(const AssetPath &path, AssetLocation &loc);
 // Creates PACKFILE stream from AGS asset.
 // This function is supposed to be used only when you have to create Allegro
 // object, passing PACKFILE stream to constructor.
@@ -18,6 +18,7 @@
 #include "debug/debug_log.h"
 #include "game/roomstruct.h"
 #include "media/audio/audio.h"
+#include "media/audio/audiocore.h"
 #include "media/audio/soundclip.h"
 #include "script/runtimescriptvalue.h"
 
@@ -65,7 +66,7 @@ void AudioChannel_SetPanning(ScriptAudioChannel *channel, int newPanning)
     if ((channels[channel->id] != NULL) &&
         (channels[channel->id]->done == 0))
     {
-        channels[channel->id]->set_panning(((newPanning + 100) * 255) / 200);
+        audio_core_clip_set_panning(channels[channel->id], ((newPanning + 100) * 255) / 200);
         channels[channel->id]->panningAsPercentage = newPanning;
     }
 }
@@ -154,7 +155,7 @@ void AudioChannel_SetSpeed(ScriptAudioChannel *channel, int new_speed)
     if ((channels[channel->id] != NULL) &&
         (channels[channel->id]->done == 0))
     {
-        channels[channel->id]->set_speed(new_speed);
+        audio_core_clip_set_speed(channels[channel->id], new_speed);
     }
 }
 
@@ -171,7 +172,7 @@ void AudioChannel_Seek(ScriptAudioChannel *channel, int newPosition)
     if ((channels[channel->id] != NULL) &&
         (channels[channel->id]->done == 0))
     {
-        channels[channel->id]->seek(newPosition);
+        audio_core_clip_seek(channels[channel->id], newPosition);
     }
 }
 
@@ -3235,12 +3235,6 @@ RuntimeScriptValue Sc_Character_SetActiveInventory(void *self, const RuntimeScri
     API_OBJCALL_VOID_POBJ(CharacterInfo, Character_SetActiveInventory, ScriptInvItem);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetAnimating(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetAnimating);
-}
-
 // int (CharacterInfo *chaa)
 RuntimeScriptValue Sc_Character_GetAnimationSpeed(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3349,12 +3343,6 @@ RuntimeScriptValue Sc_Character_SetDiagonalWalking(void *self, const RuntimeScri
     API_OBJCALL_VOID_PINT(CharacterInfo, Character_SetDiagonalWalking);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetFrame(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetFrame);
-}
-
 // void (CharacterInfo *chaa, int newval)
 RuntimeScriptValue Sc_Character_SetFrame(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3371,12 +3359,6 @@ RuntimeScriptValue Sc_Character_GetHasExplicitTint(void *self, const RuntimeScri
     API_OBJCALL_INT(CharacterInfo, Character_GetHasExplicitTint);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetID(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetID);
-}
-
 // int (CharacterInfo *chaa)
 RuntimeScriptValue Sc_Character_GetIdleView(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3431,12 +3413,6 @@ RuntimeScriptValue Sc_Character_SetIgnoreWalkbehinds(void *self, const RuntimeSc
     API_OBJCALL_VOID_PINT(CharacterInfo, Character_SetIgnoreWalkbehinds);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetLoop(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetLoop);
-}
-
 // void (CharacterInfo *chaa, int newval)
 RuntimeScriptValue Sc_Character_SetLoop(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3461,12 +3437,6 @@ RuntimeScriptValue Sc_Character_SetMovementLinkedToAnimation(void *self, const R
     API_OBJCALL_VOID_PINT(CharacterInfo, Character_SetMovementLinkedToAnimation);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetMoving(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetMoving);
-}
-
 // int (CharacterInfo *chaa)
 RuntimeScriptValue Sc_Character_GetDestinationX(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3503,12 +3473,6 @@ RuntimeScriptValue Sc_Character_GetPreviousRoom(void *self, const RuntimeScriptV
     API_OBJCALL_INT(CharacterInfo, Character_GetPreviousRoom);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetRoom(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetRoom);
-}
-
 // int (CharacterInfo *chaa)
 RuntimeScriptValue Sc_Character_GetScaleMoveSpeed(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3651,12 +3615,6 @@ RuntimeScriptValue Sc_Character_SetTurnBeforeWalking(void *self, const RuntimeSc
     API_OBJCALL_VOID_PINT(CharacterInfo, Character_SetTurnBeforeWalking);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetView(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetView);
-}
-
 // int (CharacterInfo *chaa)
 RuntimeScriptValue Sc_Character_GetWalkSpeedX(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3669,36 +3627,18 @@ RuntimeScriptValue Sc_Character_GetWalkSpeedY(void *self, const RuntimeScriptVal
     API_OBJCALL_INT(CharacterInfo, Character_GetWalkSpeedY);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetX(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetX);
-}
-
 // void (CharacterInfo *chaa, int newval)
 RuntimeScriptValue Sc_Character_SetX(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
     API_OBJCALL_VOID_PINT(CharacterInfo, Character_SetX);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetY(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetY);
-}
-
 // void (CharacterInfo *chaa, int newval)
 RuntimeScriptValue Sc_Character_SetY(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
     API_OBJCALL_VOID_PINT(CharacterInfo, Character_SetY);
 }
 
-// int (CharacterInfo *chaa)
-RuntimeScriptValue Sc_Character_GetZ(void *self, const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_OBJCALL_INT(CharacterInfo, Character_GetZ);
-}
-
 // void (CharacterInfo *chaa, int newval)
 RuntimeScriptValue Sc_Character_SetZ(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -3789,7 +3729,7 @@ void RegisterCharacterAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
 
 	ccAddExternalObjectFunction("Character::get_ActiveInventory",       Sc_Character_GetActiveInventory);
 	ccAddExternalObjectFunction("Character::set_ActiveInventory",       Sc_Character_SetActiveInventory);
-	ccAddExternalObjectFunction("Character::get_Animating",             Sc_Character_GetAnimating);
+	ccAddExternalTypedFunction("Character::get_Animating",              API_TYPED_OBJFUNC(Character_GetAnimating));
 	ccAddExternalObjectFunction("Character::get_AnimationSpeed",        Sc_Character_GetAnimationSpeed);
 	ccAddExternalObjectFunction("Character::set_AnimationSpeed",        Sc_Character_SetAnimationSpeed);
 	ccAddExternalObjectFunction("Character::get_Baseline",              Sc_Character_GetBaseline);
@@ -3810,13 +3750,13 @@ void RegisterCharacterAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
 	ccAddExternalObjectFunction("Character::get_DestinationY",          Sc_Character_GetDestinationY);
 	ccAddExternalObjectFunction("Character::get_DiagonalLoops",         Sc_Character_GetDiagonalWalking);
 	ccAddExternalObjectFunction("Character::set_DiagonalLoops",         Sc_Character_SetDiagonalWalking);
-	ccAddExternalObjectFunction("Character::get_Frame",                 Sc_Character_GetFrame);
+	ccAddExternalTypedFunction("Character::get_Frame",                  API_TYPED_OBJFUNC(Character_GetFrame));
 	ccAddExternalObjectFunction("Character::set_Frame",                 Sc_Character_SetFrame);
     if (base_api < kScriptAPI_v341)
         ccAddExternalObjectFunction("Character::get_HasExplicitTint",       Sc_Character_GetHasExplicitTint_Old);
     else
 	    ccAddExternalObjectFunction("Character::get_HasExplicitTint",       Sc_Character_GetHasExplicitTint);
-	ccAddExternalObjectFunction("Character::get_ID",                    Sc_Character_GetID);
+	ccAddExternalTypedFunction("Character::get_ID",                     API_TYPED_OBJFUNC(Character_GetID));
 	ccAddExternalObjectFunction("Character::get_IdleView",              Sc_Character_GetIdleView);
 	ccAddExternalObjectFunction("Character::geti_InventoryQuantity",    Sc_Character_GetIInventoryQuantity);
 	ccAddExternalObjectFunction("Character::seti_InventoryQuantity",    Sc_Character_SetIInventoryQuantity);
@@ -3826,18 +3766,18 @@ void RegisterCharacterAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
 	ccAddExternalObjectFunction("Character::set_IgnoreScaling",         Sc_Character_SetIgnoreScaling);
 	ccAddExternalObjectFunction("Character::get_IgnoreWalkbehinds",     Sc_Character_GetIgnoreWalkbehinds);
 	ccAddExternalObjectFunction("Character::set_IgnoreWalkbehinds",     Sc_Character_SetIgnoreWalkbehinds);
-	ccAddExternalObjectFunction("Character::get_Loop",                  Sc_Character_GetLoop);
+	ccAddExternalTypedFunction("Character::get_Loop",                   API_TYPED_OBJFUNC(Character_GetLoop));
 	ccAddExternalObjectFunction("Character::set_Loop",                  Sc_Character_SetLoop);
 	ccAddExternalObjectFunction("Character::get_ManualScaling",         Sc_Character_GetIgnoreScaling);
 	ccAddExternalObjectFunction("Character::set_ManualScaling",         Sc_Character_SetManualScaling);
 	ccAddExternalObjectFunction("Character::get_MovementLinkedToAnimation",Sc_Character_GetMovementLinkedToAnimation);
 	ccAddExternalObjectFunction("Character::set_MovementLinkedToAnimation",Sc_Character_SetMovementLinkedToAnimation);
-	ccAddExternalObjectFunction("Character::get_Moving",                Sc_Character_GetMoving);
+	ccAddExternalTypedFunction("Character::get_Moving",                 API_TYPED_OBJFUNC(Character_GetMoving));
 	ccAddExternalObjectFunction("Character::get_Name",                  Sc_Character_GetName);
 	ccAddExternalObjectFunction("Character::set_Name",                  Sc_Character_SetName);
 	ccAddExternalObjectFunction("Character::get_NormalView",            Sc_Character_GetNormalView);
 	ccAddExternalObjectFunction("Character::get_PreviousRoom",          Sc_Character_GetPreviousRoom);
-	ccAddExternalObjectFunction("Character::get_Room",                  Sc_Character_GetRoom);
+	ccAddExternalTypedFunction("Character::get_Room",                   API_TYPED_OBJFUNC(Character_GetRoom));
 	ccAddExternalObjectFunction("Character::get_ScaleMoveSpeed",        Sc_Character_GetScaleMoveSpeed);
 	ccAddExternalObjectFunction("Character::set_ScaleMoveSpeed",        Sc_Character_SetScaleMoveSpeed);
 	ccAddExternalObjectFunction("Character::get_ScaleVolume",           Sc_Character_GetScaleVolume);
@@ -3862,20 +3802,20 @@ void RegisterCharacterAPI(ScriptAPIVersion base_api, ScriptAPIVersion compat_api
 	ccAddExternalObjectFunction("Character::set_Transparency",          Sc_Character_SetTransparency);
 	ccAddExternalObjectFunction("Character::get_TurnBeforeWalking",     Sc_Character_GetTurnBeforeWalking);
 	ccAddExternalObjectFunction("Character::set_TurnBeforeWalking",     Sc_Character_SetTurnBeforeWalking);
-	ccAddExternalObjectFunction("Character::get_View",                  Sc_Character_GetView);
+	ccAddExternalTypedFunction("Character::get_View",                   API_TYPED_OBJFUNC(Character_GetView));
 	ccAddExternalObjectFunction("Character::get_WalkSpeedX",            Sc_Character_GetWalkSpeedX);
 	ccAddExternalObjectFunction("Character::get_WalkSpeedY",            Sc_Character_GetWalkSpeedY);
-	ccAddExternalObjectFunction("Character::get_X",                     Sc_Character_GetX);
+	ccAddExternalTypedFunction("Character::get_X",                      API_TYPED_OBJFUNC(Character_GetX));
 	ccAddExternalObjectFunction("Character::set_X",                     Sc_Character_SetX);
-	ccAddExternalObjectFunction("Character::get_x",                     Sc_Character_GetX);
+	ccAddExternalTypedFunction("Character::get_x",                      API_TYPED_OBJFUNC(Character_GetX));
 	ccAddExternalObjectFunction("Character::set_x",                     Sc_Character_SetX);
-	ccAddExternalObjectFunction("Character::get_Y",                     Sc_Character_GetY);
+	ccAddExternalTypedFunction("Character::get_Y",                      API_TYPED_OBJFUNC(Character_GetY));
 	ccAddExternalObjectFunction("Character::set_Y",                     Sc_Character_SetY);
-	ccAddExternalObjectFunction("Character::get_y",                     Sc_Character_GetY);
+	ccAddExternalTypedFunction("Character::get_y",                      API_TYPED_OBJFUNC(Character_GetY));
 	ccAddExternalObjectFunction("Character::set_y",                     Sc_Character_SetY);
-	ccAddExternalObjectFunction("Character::get_Z",                     Sc_Character_GetZ);
+	ccAddExternalTypedFunction("Character::get_Z",                      API_TYPED_OBJFUNC(Character_GetZ));
 	ccAddExternalObjectFunction("Character::set_Z",                     Sc_Character_SetZ);
-	ccAddExternalObjectFunction("Character::get_z",                     Sc_Character_GetZ);
+	ccAddExternalTypedFunction("Character::get_z",                      API_TYPED_OBJFUNC(Character_GetZ));
 	ccAddExternalObjectFunction("Character::set_z",                     Sc_Character_SetZ);
 
     ccAddExternalObjectFunction("Character::get_HasExplicitLight",      Sc_Character_HasExplicitLight);
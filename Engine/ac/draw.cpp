@@ -40,6 +40,7 @@
 #include "ac/screenoverlay.h"
 #include "ac/sprite.h"
 #include "ac/spritelistentry.h"
+#include "ac/spritetransformcache.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "ac/viewframe.h"
@@ -60,6 +61,7 @@
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/blender.h"
+#include "gfx/tint.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -1167,8 +1169,22 @@ void apply_tint_or_light(int actspsindex, int light_level,
          // to LitBlendBlt defines how much it will be darkened/lightened by.
          
          int lit_amnt;
-         active_spr->FillTransparent();
          // It's a light level, not a tint
+         if (Tint::IsSupported(coldept)) {
+             // darken or lighten towards the near black or white color
+             const int level = light_level < 0 ? 8 : 248;
+             const Tint::PixelFormat format = Tint::GetPixelFormat(coldept);
+             const uint32_t color = makecol_depth(coldept, level, level, level);
+             const int width = Math::Min(active_spr->GetWidth(), oldwas->GetWidth());
+             const int height = Math::Min(active_spr->GetHeight(), oldwas->GetHeight());
+             for (int y = 0; y < height; ++y)
+                 Tint::LightLine(oldwas->GetScanLine(y), active_spr->GetScanLineForWriting(y), width, format, color, abs(light_level) * 2);
+             if (oldwas != blitFrom)
+                 delete oldwas;
+             return;
+         }
+
+         active_spr->FillTransparent();
          if (game.color_depth == 1) {
              // 256-col
              lit_amnt = (250 - ((-light_level) * 5)/2);
@@ -1198,6 +1214,17 @@ void apply_tint_or_light(int actspsindex, int light_level,
 
 }
 
+// Stretches the sprite over the whole bitmap, antialiased if that is enabled
+static void stretch_sprite_onto(Bitmap *dst, int sppic, int newwidth, int newheight) {
+  const Rect dst_rc = RectWH(0, 0, newwidth, newheight);
+  if (!(IS_ANTIALIAS_SPRITES))
+      dst->StretchBlt(spriteset[sppic], dst_rc, Common::kBitmap_Transparency);
+  else if (game.SpriteInfos[sppic].Flags & SPF_ALPHACHANNEL)
+      dst->AAStretchAlphaBlt(spriteset[sppic], dst_rc);
+  else
+      dst->AAStretchBlt(spriteset[sppic], dst_rc, Common::kBitmap_Transparency);
+}
+
 // Draws the specified 'sppic' sprite onto actsps[useindx] at the
 // specified width and height, and flips the sprite if necessary.
 // Returns 1 if something was drawn to actsps; returns 0 if no
@@ -1226,17 +1253,12 @@ int scale_and_flip_sprite(int useindx, int coldept, int zoom_level,
       if (isMirrored) {
           Bitmap *tempspr = BitmapHelper::CreateBitmap(newwidth, newheight,coldept);
           tempspr->Fill (actsps[useindx]->GetMaskColor());
-          if ((IS_ANTIALIAS_SPRITES) && ((game.SpriteInfos[sppic].Flags & SPF_ALPHACHANNEL) == 0))
-              tempspr->AAStretchBlt (spriteset[sppic], RectWH(0, 0, newwidth, newheight), Common::kBitmap_Transparency);
-          else
-              tempspr->StretchBlt (spriteset[sppic], RectWH(0, 0, newwidth, newheight), Common::kBitmap_Transparency);
+          stretch_sprite_onto(tempspr, sppic, newwidth, newheight);
           active_spr->FlipBlt(tempspr, 0, 0, Common::kBitmap_HFlip);
           delete tempspr;
       }
-      else if ((IS_ANTIALIAS_SPRITES) && ((game.SpriteInfos[sppic].Flags & SPF_ALPHACHANNEL) == 0))
-          active_spr->AAStretchBlt(spriteset[sppic],RectWH(0,0,newwidth,newheight), Common::kBitmap_Transparency);
       else
-          active_spr->StretchBlt(spriteset[sppic],RectWH(0,0,newwidth,newheight), Common::kBitmap_Transparency);
+          stretch_sprite_onto(active_spr, sppic, newwidth, newheight);
 
       /*  AASTR2 version of code (doesn't work properly, gives black borders)
       if (IS_ANTIALIAS_SPRITES) {
@@ -1278,6 +1300,63 @@ int scale_and_flip_sprite(int useindx, int coldept, int zoom_level,
   return actsps_used;
 }
 
+// Draws the 'sppic' sprite onto actsps[useindx] scaled, flipped and tinted
+// as requested, using software transforms. The result is shared through the
+// transformed sprite cache, so a frame already drawn with the same parameters,
+// by this or any other character or object, is simply copied from there.
+void draw_transformed_sprite(int useindx, int coldept, int sppic, int zoom_level,
+                             int newwidth, int newheight, int isMirrored,
+                             int light_level, int tint_amount, int tint_red,
+                             int tint_green, int tint_blue, int tint_light) {
+
+  const bool do_tint = (light_level != 0) || (tint_amount != 0);
+  // 8-bit results depend on the current palette, so they are not cached
+  const bool use_cache = (zoom_level != 100 || isMirrored || do_tint) && coldept > 8;
+  SpriteTransformKey key;
+  if (use_cache) {
+      key.Sprite = sppic;
+      key.ColorDepth = coldept;
+      key.Width = newwidth;
+      key.Height = newheight;
+      key.Zoom = zoom_level;
+      key.Mirrored = isMirrored;
+      key.TintRed = tint_red;
+      key.TintGreen = tint_green;
+      key.TintBlue = tint_blue;
+      key.TintAmount = tint_amount;
+      key.TintLight = tint_light;
+      key.LightLevel = light_level;
+      key.Antialias = (IS_ANTIALIAS_SPRITES) ? 1 : 0;
+      Bitmap *cached = get_transformed_sprite(key);
+      if (cached) {
+          actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, cached->GetWidth(), cached->GetHeight());
+          actsps[useindx]->Blit(cached, 0, 0, 0, 0, cached->GetWidth(), cached->GetHeight());
+          return;
+      }
+  }
+
+  // draw the base sprite, scaled and flipped as appropriate
+  int actspsUsed = scale_and_flip_sprite(useindx, coldept, zoom_level,
+      sppic, newwidth, newheight, isMirrored);
+
+  if (do_tint) {
+      // if possible, direct read from the source image
+      Bitmap *comeFrom = NULL;
+      if (!actspsUsed)
+          comeFrom = spriteset[sppic];
+
+      apply_tint_or_light(useindx, light_level, tint_amount, tint_red,
+          tint_green, tint_blue, tint_light, coldept, comeFrom);
+  }
+  else if (!actspsUsed) {
+      // no scaling, flipping or tinting was done, so just blit it normally
+      actsps[useindx]->Blit(spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
+  }
+
+  if (use_cache)
+      store_transformed_sprite(key, actsps[useindx]);
+}
+
 
 
 // create the actsps[aa] image with the object drawn correctly
@@ -1415,33 +1494,17 @@ int construct_object_gfx(int aa, int *drawnWidth, int *drawnHeight, bool alwaysU
 
     // Not cached, so draw the image
 
-    int actspsUsed = 0;
     if (!hardwareAccelerated)
     {
-        // draw the base sprite, scaled and flipped as appropriate
-        actspsUsed = scale_and_flip_sprite(useindx, coldept, zoom_level,
-            objs[aa].num, sprwidth, sprheight, isMirrored);
+        // draw the sprite scaled, flipped and tinted as appropriate
+        draw_transformed_sprite(useindx, coldept, objs[aa].num, zoom_level,
+            sprwidth, sprheight, isMirrored, light_level, tint_level,
+            tint_red, tint_green, tint_blue, tint_light);
     }
     else
     {
         // ensure actsps exists
         actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, game.SpriteInfos[objs[aa].num].Width, game.SpriteInfos[objs[aa].num].Height);
-    }
-
-    // direct read from source bitmap, where possible
-    Bitmap *comeFrom = NULL;
-    if (!actspsUsed)
-        comeFrom = spriteset[objs[aa].num];
-
-    // apply tints or lightenings where appropriate, else just copy
-    // the source bitmap
-    if (!hardwareAccelerated && ((tint_level > 0) || (light_level != 0)))
-    {
-        apply_tint_or_light(useindx, light_level, tint_level, tint_red,
-            tint_green, tint_blue, tint_light, coldept,
-            comeFrom);
-    }
-    else if (!actspsUsed) {
         actsps[useindx]->Blit(spriteset[objs[aa].num],0,0,0,0,game.SpriteInfos[objs[aa].num].Width, game.SpriteInfos[objs[aa].num].Height);
     }
 
@@ -1559,6 +1622,18 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
             return;
     }
 
+    if (Tint::IsSupported(srcimg->GetColorDepth())) {
+        // light_level is between -100 and 100 normally; 0-100 in
+        // this case when it's a RGB tint
+        const Tint::Table &table = Tint::GetTable(srcimg->GetColorDepth(), red, grn, blu, luminance);
+        const int amount = light_level >= 100 ? Tint::FullAmount : (light_level * 25) / 10;
+        const int width = Math::Min(ds->GetWidth(), srcimg->GetWidth());
+        const int height = Math::Min(ds->GetHeight(), srcimg->GetHeight());
+        for (int y = 0; y < height; ++y)
+            Tint::TintLine(srcimg->GetScanLine(y), ds->GetScanLineForWriting(y), width, table, amount);
+        return;
+    }
+
     // For performance reasons, we have a seperate blender for
     // when light is being adjusted and when it is not.
     // If luminance >= 250, then normal brightness, otherwise darken
@@ -1759,40 +1834,23 @@ void prepare_characters_for_drawing() {
         // If cache needs to be re-drawn
         if (!charcache[aa].inUse) {
 
-            // create the base sprite in actsps[useindx], which will
-            // be scaled and/or flipped, as appropriate
-            int actspsUsed = 0;
+            // create the sprite in actsps[useindx], which will be
+            // scaled, flipped and tinted, as appropriate
             if (!gfxDriver->HasAcceleratedTransform())
             {
-                actspsUsed = scale_and_flip_sprite(
-                    useindx, coldept, zoom_level, sppic,
-                    newwidth, newheight, isMirrored);
+                draw_transformed_sprite(useindx, coldept, sppic, zoom_level,
+                    newwidth, newheight, isMirrored, light_level, tint_amount,
+                    tint_red, tint_green, tint_blue, tint_light);
             }
             else 
             {
                 // ensure actsps exists
                 actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, game.SpriteInfos[sppic].Width, game.SpriteInfos[sppic].Height);
+                actsps[useindx]->Blit (spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
             }
 
             our_eip = 335;
 
-            if (((light_level != 0) || (tint_amount != 0)) &&
-                (!gfxDriver->HasAcceleratedTransform())) {
-                    // apply the lightening or tinting
-                    Bitmap *comeFrom = NULL;
-                    // if possible, direct read from the source image
-                    if (!actspsUsed)
-                        comeFrom = spriteset[sppic];
-
-                    apply_tint_or_light(useindx, light_level, tint_amount, tint_red,
-                        tint_green, tint_blue, tint_light, coldept,
-                        comeFrom);
-            }
-            else if (!actspsUsed) {
-                // no scaling, flipping or tinting was done, so just blit it normally
-                actsps[useindx]->Blit (spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
-            }
-
             // update the character cache with the new image
             charcache[aa].inUse = 1;
             //charcache[aa].image = BitmapHelper::CreateBitmap_ (coldept, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
@@ -29,6 +29,7 @@
 #include "font/fonts.h"
 #include "gui/guimain.h"
 #include "ac/spritecache.h"
+#include "ac/spritetransformcache.h"
 #include "script/runtimescriptvalue.h"
 #include "gfx/gfx_def.h"
 #include "gfx/gfx_util.h"
@@ -69,6 +70,7 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         {
             int tt;
             // force a refresh of any cached object or character images
+            invalidate_transformed_sprite(sds->dynamicSpriteNumber);
             if (croom != NULL) 
             {
                 for (tt = 0; tt < croom->numobj; tt++) 
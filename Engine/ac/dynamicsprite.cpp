@@ -30,6 +30,7 @@
 #include "game/roomstruct.h"
 #include "gui/guibutton.h"
 #include "ac/spritecache.h"
+#include "ac/spritetransformcache.h"
 #include "platform/base/override_defines.h"
 #include "gfx/graphicsdriver.h"
 #include "script/runtimescriptvalue.h"
@@ -167,6 +168,7 @@ void DynamicSprite_CopyTransparencyMask(ScriptDynamicSprite *sds, int sourceSpri
     }
 
     BitmapHelper::CopyTransparency(target, source, dst_has_alpha, src_has_alpha);
+    invalidate_transformed_sprite(sds->slot);
 }
 
 void DynamicSprite_ChangeCanvasSize(ScriptDynamicSprite *sds, int width, int height, int x, int y) 
@@ -449,6 +451,7 @@ ScriptDynamicSprite* DynamicSprite_CreateFromBackground(int frame, int x1, int y
 void add_dynamic_sprite(int gotSlot, Bitmap *redin, bool hasAlpha) {
 
   spriteset.Set(gotSlot, redin);
+  invalidate_transformed_sprite(gotSlot);
 
   game.SpriteInfos[gotSlot].Flags = SPF_DYNAMICALLOC;
 
@@ -474,6 +477,7 @@ void free_dynamic_sprite (int gotSlot) {
 
   delete spriteset[gotSlot];
   spriteset.Set(gotSlot, NULL);
+  invalidate_transformed_sprite(gotSlot);
 
   game.SpriteInfos[gotSlot].Flags = 0;
   game.SpriteInfos[gotSlot].Width = 0;
@@ -107,8 +107,7 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
         ccDialogOptionsRendering.Unserialize(index, serializedData, dataSize);
     }
     else if (strcmp(objectType, "UserObject") == 0) {
-        ScriptUserObject *suo = new ScriptUserObject();
-        suo->Unserialize(index, serializedData, dataSize);
+        globalScriptUserObject.Unserialize(index, serializedData, dataSize);
     }
     else if (!unserialize_audio_script_object(index, objectType, serializedData, dataSize)) 
     {
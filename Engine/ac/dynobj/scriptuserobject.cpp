@@ -21,18 +21,7 @@ const char *ScriptUserObject::GetType()
     return "UserObject";
 }
 
-ScriptUserObject::ScriptUserObject()
-    : _size(0)
-    , _data(NULL)
-{
-}
-
-ScriptUserObject::~ScriptUserObject()
-{
-    delete [] _data;
-}
-
-/* static */ std::pair<char*, ScriptUserObject*> ScriptUserObject::CreateManaged(size_t size)
+char *ScriptUserObject::CreateManaged(size_t size)
 {
     // Ideally we should not be registering internal data address here, but managed object itself.
     // We do so for the following reason:
@@ -45,96 +34,93 @@ ScriptUserObject::~ScriptUserObject()
     // and pass that as an argument into the script function. The question is: how to detect when
     // this is necessary because byte-code does not contain any distinct operation for this case.
     //
-    ScriptUserObject *suo = new ScriptUserObject();
-    suo->Create(NULL, size);
-    ccRegisterManagedObject(suo->GetData(), suo);
-    return std::make_pair(suo->GetData(), suo);
+    char *address = Create(NULL, size);
+    ccRegisterManagedObject(address, this);
+    return address;
 }
 
-void ScriptUserObject::Create(const char *data, size_t size)
+/* static */ char *ScriptUserObject::Create(const char *data, size_t size)
 {
-    delete [] _data;
-    _data = NULL;
-
-    _size = size;
-    if (_size > 0)
-    {
-        _data = new char[size];
-        if (data)
-            memcpy(_data, data, _size);
-        else
-            memset(_data, 0, _size);
-    }
+    char *block = new char[HeaderSize + size];
+    *(int32_t*)block = size;
+    char *address = block + HeaderSize;
+    if (data)
+        memcpy(address, data, size);
+    else
+        memset(address, 0, size);
+    return address;
 }
 
 int ScriptUserObject::Dispose(const char *address, bool force)
 {
-    delete this;
+    delete [] (address - HeaderSize);
     return 1;
 }
 
 int ScriptUserObject::Serialize(const char *address, char *buffer, int bufsize)
 {
-    if (_size > bufsize)
+    const int32_t size = GetSize(address);
+    if (size > bufsize)
         // buffer not big enough, ask for a bigger one
-        return -_size;
+        return -size;
 
-    memcpy(buffer, _data, _size);
-    return _size;
+    memcpy(buffer, address, size);
+    return size;
 }
 
 void ScriptUserObject::Unserialize(int index, const char *serializedData, int dataSize)
 {
-    Create(serializedData, dataSize);
-    ccRegisterUnserializedObject(index, GetData(), this);
+    ccRegisterUnserializedObject(index, Create(serializedData, dataSize), this);
 }
 
 void ScriptUserObject::Read(const char *address, intptr_t offset, void *dest, int size)
 {
-    memcpy(dest, _data + offset, size);
+    memcpy(dest, address + offset, size);
 }
 
 uint8_t ScriptUserObject::ReadInt8(const char *address, intptr_t offset)
 {
-    return *(uint8_t*)(_data + offset);
+    return *(uint8_t*)(address + offset);
 }
 
 int16_t ScriptUserObject::ReadInt16(const char *address, intptr_t offset)
 {
-    return *(int16_t*)(_data + offset);
+    return *(int16_t*)(address + offset);
 }
 
 int32_t ScriptUserObject::ReadInt32(const char *address, intptr_t offset)
 {
-    return *(int32_t*)(_data + offset);
+    return *(int32_t*)(address + offset);
 }
 
 float ScriptUserObject::ReadFloat(const char *address, intptr_t offset)
 {
-    return *(float*)(_data + offset);
+    return *(float*)(address + offset);
 }
 
 void ScriptUserObject::Write(const char *address, intptr_t offset, void *src, int size)
 {
-    memcpy((void*)(_data + offset), src, size);
+    memcpy((void*)(address + offset), src, size);
 }
 
 void ScriptUserObject::WriteInt8(const char *address, intptr_t offset, uint8_t val)
 {
-    *(uint8_t*)(_data + offset) = val;
+    *(uint8_t*)(address + offset) = val;
 }
 
 void ScriptUserObject::WriteInt16(const char *address, intptr_t offset, int16_t val)
 {
-    *(int16_t*)(_data + offset) = val;
+    *(int16_t*)(address + offset) = val;
 }
 
 void ScriptUserObject::WriteInt32(const char *address, intptr_t offset, int32_t val)
 {
-    *(int32_t*)(_data + offset) = val;
+    *(int32_t*)(address + offset) = val;
 }
 
 void ScriptUserObject::WriteFloat(const char *address, intptr_t offset, float val)
 {
-    *(float*)(_data + offset) = val;
+    *(float*)(address + offset) = val;
 }
+
+ScriptUserObject globalScriptUserObject;
@@ -18,17 +18,17 @@
 #ifndef __AGS_EE_DYNOBJ__SCRIPTUSERSTRUCT_H
 #define __AGS_EE_DYNOBJ__SCRIPTUSERSTRUCT_H
 
-#include <utility>
 #include "ac/dynobj/cc_agsdynamicobject.h"
 
+// All the user objects share one manager, so that they do not take a
+// manager slot in the runtime script values each. The object's size is
+// kept in a header right before its data, similar to the dynamic arrays.
 struct ScriptUserObject : ICCDynamicObject
 {
 public:
-    ScriptUserObject();
-    virtual ~ScriptUserObject();
-
-    static std::pair<char*, ScriptUserObject*> CreateManaged(size_t size);
-    void Create(const char *data, size_t size);
+    // Creates new object of the given size and registers it in the managed pool;
+    // returns the object's data address
+    char *CreateManaged(size_t size);
 
     // return the type name of the object
     virtual const char *GetType();
@@ -50,18 +50,21 @@ public:
     virtual void    WriteInt32(const char *address, intptr_t offset, int32_t val);
     virtual void    WriteFloat(const char *address, intptr_t offset, float val);
 
-    inline size_t   GetSize() const { return _size; }
-    inline char    *GetData() const { return _data; }
-
-private:
     // NOTE: we use signed int for Size at the moment, because the managed
     // object interface's Serialize() function requires the object to return
     // negative value of size in case the provided buffer was not large
     // enough. Since this interface is also a part of Plugin API, we would
     // need more significant change to program before we could use different
     // approach.
-    int32_t  _size;
-    char    *_data;
+    static inline int32_t GetSize(const char *address) { return *(const int32_t*)(address - HeaderSize); }
+
+private:
+    // Size of the header put before the object data; keeps the data 8-byte aligned
+    static const size_t HeaderSize = 8;
+
+    static char *Create(const char *data, size_t size);
 };
 
+extern ScriptUserObject globalScriptUserObject;
+
 #endif // __AGS_EE_DYNOBJ__SCRIPTUSERSTRUCT_H
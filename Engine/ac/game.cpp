@@ -46,6 +46,7 @@
 #include "ac/richgamemedia.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/runtime_defines.h"
 #include "ac/screenoverlay.h"
@@ -83,6 +84,7 @@
 #include "util/alignedstream.h"
 #include "util/directory.h"
 #include "util/filestream.h" // TODO: needed only because plugins expect file handle
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/string_utils.h"
 
@@ -196,6 +198,8 @@ String saveGameParent;
 
 const char* sgnametemplate = "agssave.%03d";
 String saveGameSuffix;
+// Path of the savegame which is being written in background
+String savingGamePath;
 
 int game_paused=0;
 char pexbuf[STD_BUFFER_SIZE];
@@ -422,6 +426,8 @@ bool SetSaveGameDirectoryPath(const char *newFolder, bool explicit_path)
     if (!Directory::CreateDirectory(newSaveGameDir))
         return false;
     newSaveGameDir.AppendChar('/');
+    // the savegame being written uses the current directory
+    wait_for_savegame_write();
 
     char newFolderTempFile[260];
     strcpy(newFolderTempFile, newSaveGameDir);
@@ -519,6 +525,8 @@ void free_do_once_tokens()
 void unload_game_file() {
     int bb, ee;
 
+    cancel_room_preload();
+
     for (bb = 0; bb < game.numcharacters; bb++) {
         if (game.charScripts != NULL)
             delete game.charScripts[bb];
@@ -583,14 +591,22 @@ void unload_game_file() {
     moduleInstFork.resize(0);
     moduleInst.resize(0);
     scriptModules.resize(0);
-    repExecAlways.moduleHasFunction.resize(0);
-    lateRepExecAlways.moduleHasFunction.resize(0);
-    getDialogOptionsDimensionsFunc.moduleHasFunction.resize(0);
-    renderDialogOptionsFunc.moduleHasFunction.resize(0);
-    getDialogOptionUnderCursorFunc.moduleHasFunction.resize(0);
-    runDialogOptionMouseClickHandlerFunc.moduleHasFunction.resize(0);
-    runDialogOptionKeyPressHandlerFunc.moduleHasFunction.resize(0);
-    runDialogOptionRepExecFunc.moduleHasFunction.resize(0);
+    repExecAlways.moduleFunction.resize(0);
+    lateRepExecAlways.moduleFunction.resize(0);
+    getDialogOptionsDimensionsFunc.moduleFunction.resize(0);
+    renderDialogOptionsFunc.moduleFunction.resize(0);
+    getDialogOptionUnderCursorFunc.moduleFunction.resize(0);
+    runDialogOptionMouseClickHandlerFunc.moduleFunction.resize(0);
+    runDialogOptionKeyPressHandlerFunc.moduleFunction.resize(0);
+    runDialogOptionRepExecFunc.moduleFunction.resize(0);
+    repExecAlways.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    lateRepExecAlways.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    getDialogOptionsDimensionsFunc.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    renderDialogOptionsFunc.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    getDialogOptionUnderCursorFunc.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    runDialogOptionMouseClickHandlerFunc.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    runDialogOptionKeyPressHandlerFunc.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
+    runDialogOptionRepExecFunc.globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
     numScriptModules = 0;
 
     if (game.audioClipCount > 0)
@@ -1161,31 +1177,61 @@ void save_game(int slotn, const char*descript) {
     // Screenshot
     create_savegame_screenshot(screenShot);
 
+    // the previous savegame may still be written to the same file
+    wait_for_savegame_write();
+
     Common::PStream out = StartSavegame(nametouse, descript, screenShot);
     if (out == NULL)
         quit("save_game: unable to open savegame file for writing");
 
     update_polled_stuff_if_runtime();
 
-    // Actual dynamic game data is saved here
-    SaveGameState(out);
-
+    // The screenshot is encoded here, as it uses the game's palette
+    std::vector<uint8_t> screenShotData;
     if (screenShot != NULL)
     {
-        int screenShotOffset = out->GetPosition() - sizeof(RICH_GAME_MEDIA_HEADER);
-        int screenShotSize = write_screen_shot_for_vista(out.get(), screenShot);
-
+        MemoryStream screenShotStream(screenShotData, Common::kFile_Write);
+        write_screen_shot_for_vista(&screenShotStream, screenShot);
+        delete screenShot;
         update_polled_stuff_if_runtime();
+    }
 
-        out.reset(Common::File::OpenFile(nametouse, Common::kFile_Open, Common::kFile_ReadWrite));
-        out->Seek(12, kSeekBegin);
-        out->WriteInt32(screenShotOffset);
-        out->Seek(4);
-        out->WriteInt32(screenShotSize);
+    // Actual dynamic game data is saved here; the game state is copied
+    // at once, and the file is written in background
+    HSaveError err = SaveGameStateAsync(out, screenShotData);
+    if (!err)
+    {
+        Debug::Printf(kDbgMsg_Error, "ERROR: failed to save game state: %s", err->FullMessage().GetCStr());
+        out.reset();
+        Common::File::DeleteFile(nametouse);
+        Display("ERROR: Unable to save the game.");
+        return;
     }
+    savingGamePath = nametouse;
+}
 
-    if (screenShot != NULL)
-        delete screenShot;
+// Tells the player that the background savegame write has failed, and
+// removes the incomplete file; the error itself is logged by the writer
+static void report_savegame_write(HSaveError err)
+{
+    String path = savingGamePath;
+    savingGamePath.Empty();
+    if (err)
+        return;
+    Common::File::DeleteFile(path);
+    Display("ERROR: Unable to save the game.");
+}
+
+void update_savegame_write()
+{
+    HSaveError err;
+    if (PollSavegameWrite(err))
+        report_savegame_write(err);
+}
+
+void wait_for_savegame_write()
+{
+    report_savegame_write(WaitForSavegameWrite());
 }
 
 char rbuffer[200];
@@ -1796,6 +1842,7 @@ bool try_restore_save(int slot)
 
 bool try_restore_save(const Common::String &path, int slot)
 {
+    wait_for_savegame_write();
     bool data_overwritten;
     HSaveError err = load_game(path, slot, data_overwritten);
     if (!err)
@@ -2154,12 +2201,6 @@ RuntimeScriptValue Sc_Game_DoOnceOnly(const RuntimeScriptValue *params, int32_t
     API_SCALL_INT_POBJ(Game_DoOnceOnly, const char);
 }
 
-// int (int red, int grn, int blu)
-RuntimeScriptValue Sc_Game_GetColorFromRGB(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT_PINT3(Game_GetColorFromRGB);
-}
-
 // int (int viewNumber, int loopNumber)
 RuntimeScriptValue Sc_Game_GetFrameCountForLoop(const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -2431,7 +2472,7 @@ void RegisterGameAPI()
     ccAddExternalStaticFunction("Game::StopAudio^1",                            Sc_Game_StopAudio);
     ccAddExternalStaticFunction("Game::ChangeTranslation^1",                    Sc_Game_ChangeTranslation);
     ccAddExternalStaticFunction("Game::DoOnceOnly^1",                           Sc_Game_DoOnceOnly);
-    ccAddExternalStaticFunction("Game::GetColorFromRGB^3",                      Sc_Game_GetColorFromRGB);
+    ccAddExternalTypedFunction("Game::GetColorFromRGB^3",                       API_TYPED_FUNC(Game_GetColorFromRGB));
     ccAddExternalStaticFunction("Game::GetFrameCountForLoop^2",                 Sc_Game_GetFrameCountForLoop);
     ccAddExternalStaticFunction("Game::GetLocationName^2",                      Sc_Game_GetLocationName);
     ccAddExternalStaticFunction("Game::GetLoopCountForView^1",                  Sc_Game_GetLoopCountForView);
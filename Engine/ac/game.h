@@ -127,6 +127,12 @@ void free_do_once_tokens();
 // Free all the memory associated with the game
 void unload_game_file();
 void save_game(int slotn, const char*descript);
+// Checks if the savegame being written in background is complete, and
+// tells the player if it has failed
+void update_savegame_write();
+// Waits until the savegame being written in background is complete, and
+// tells the player if it has failed
+void wait_for_savegame_write();
 bool read_savedgame_description(const Common::String &savedgame, Common::String &description);
 bool read_savedgame_screenshot(const Common::String &savedgame, int &want_shot);
 void save_game_data(Common::Stream *out);
@@ -60,6 +60,7 @@ struct GameSetup {
     MouseSpeedDef mouse_speed_def;
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     int   Supersampling;
+    bool  profile_scripts; // collect script performance statistics
 
     ScreenSetup Screen;
 
@@ -42,6 +42,7 @@
 #include "ac/system.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "game/savegame.h"
 #include "gui/guidialog.h"
 #include "main/engine.h"
 #include "main/game_start.h"
@@ -51,6 +52,7 @@
 #include "script/script.h"
 #include "script/script_runtime.h"
 #include "ac/spritecache.h"
+#include "ac/spritetransformcache.h"
 #include "gfx/graphicsdriver.h"
 #include "core/assetmanager.h"
 #include "main/game_file.h"
@@ -119,6 +121,7 @@ void RestoreGameSlot(int slnum) {
 }
 
 void DeleteSaveSlot (int slnum) {
+    wait_for_savegame_write();
     String nametouse;
     nametouse = get_save_game_path(slnum);
     unlink (nametouse);
@@ -280,6 +283,7 @@ int RunAGSGame (const char *newgame, unsigned int mode, int data) {
         quitprintf("!RunAGSGame: error loading new game file:\n%s", err->FullMessage().GetCStr());
 
     spriteset.Reset();
+    clear_transformed_sprite_cache();
     if (spriteset.InitFile("acsprset.spr"))
         quit("!RunAGSGame: error loading new sprites");
 
@@ -37,6 +37,7 @@
 #include "ac/record.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/screen.h"
 #include "ac/string.h"
@@ -50,6 +51,7 @@
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "debug/out.h"
+#include "game/room_file.h"
 #include "game/room_version.h"
 #include "media/audio/audio.h"
 #include "platform/base/agsplatformdriver.h"
@@ -211,6 +213,13 @@ const char* Room_GetMessages(int index) {
     return CreateNewScriptString(buffer);
 }
 
+void Room_Preload(int room)
+{
+    if ((room < 0) || (room >= MAX_ROOMS))
+        quitprintf("!Room.Preload: invalid room number %d", room);
+    preload_room(room);
+}
+
 ScriptCamera* Room_GetCamera()
 {
     ScriptCamera *camera = new ScriptCamera();
@@ -377,6 +386,11 @@ void adjust_viewport_to_room()
     play.SetRoomCameraSize(new_room_view.GetSize());
 }
 
+String get_room_filename(int room_num)
+{
+    return String::FromFormat("room%d.crm", room_num);
+}
+
 // forchar = playerchar on NewRoom, or NULL if restore saved game
 void load_new_room(int newnum, CharacterInfo*forchar) {
 
@@ -389,14 +403,22 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     set_color_depth(8);
     displayed_room=newnum;
 
-    room_filename.Format("room%d.crm", newnum);
+    room_filename = get_room_filename(newnum);
 
     update_polled_stuff_if_runtime();
 
     // load the room from disk
     our_eip=200;
     thisroom.GameID = NO_GAME_ID_IN_ROOM_FILE;
-    load_room(room_filename, &thisroom, game.SpriteInfos);
+    WalkBehindTables walk_behinds;
+    if (take_preloaded_room(newnum, thisroom, walk_behinds)) {
+        HRoomFileError err = UpdateRoomData(&thisroom, (RoomFileVersion)thisroom.DataVersion, game.SpriteInfos);
+        if (!err)
+            quitprintf("Unable to load the room file '%s'.\n%s.", room_filename.GetCStr(), err->FullMessage().GetCStr());
+    } else {
+        cancel_room_preload();
+        load_room(room_filename, &thisroom, game.SpriteInfos);
+    }
 
     if ((thisroom.GameID != NO_GAME_ID_IN_ROOM_FILE) &&
         (thisroom.GameID != game.uniqueid)) {
@@ -464,7 +486,10 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
 
     set_color_depth(game.GetColorDepth());
 
-    recache_walk_behinds();
+    if (walk_behinds.Exists)
+        recache_walk_behinds(walk_behinds);
+    else
+        recache_walk_behinds();
 
     our_eip=205;
     // setup objects
@@ -903,9 +928,15 @@ void compile_room_script() {
     if (roominstFork == NULL)
         quitprintf("Unable to create forked room instance: %s", ccErrorString);
 
-    repExecAlways.roomHasFunction = true;
-    lateRepExecAlways.roomHasFunction = true;
-    getDialogOptionsDimensionsFunc.roomHasFunction = true;
+    // export indexes found in the previous room's script are not valid anymore
+    repExecAlways.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    lateRepExecAlways.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    getDialogOptionsDimensionsFunc.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    renderDialogOptionsFunc.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    getDialogOptionUnderCursorFunc.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    runDialogOptionMouseClickHandlerFunc.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    runDialogOptionKeyPressHandlerFunc.roomFunction = SCRIPT_FUNC_UNRESOLVED;
+    runDialogOptionRepExecFunc.roomFunction = SCRIPT_FUNC_UNRESOLVED;
 }
 
 int bg_just_changed = 0;
@@ -985,66 +1016,12 @@ RuntimeScriptValue Sc_Room_SetTextProperty(const RuntimeScriptValue *params, int
     API_SCALL_BOOL_POBJ2(Room_SetTextProperty, const char, const char);
 }
 
-// int ()
-RuntimeScriptValue Sc_Room_GetBottomEdge(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetBottomEdge);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetColorDepth(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetColorDepth);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetHeight(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetHeight);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetLeftEdge(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetLeftEdge);
-}
-
 // const char* (int index)
 RuntimeScriptValue Sc_Room_GetMessages(const RuntimeScriptValue *params, int32_t param_count)
 {
     API_SCALL_OBJ_PINT(const char, myScriptStringImpl, Room_GetMessages);
 }
 
-// int ()
-RuntimeScriptValue Sc_Room_GetMusicOnLoad(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetMusicOnLoad);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetObjectCount(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetObjectCount);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetRightEdge(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetRightEdge);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetTopEdge(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetTopEdge);
-}
-
-// int ()
-RuntimeScriptValue Sc_Room_GetWidth(const RuntimeScriptValue *params, int32_t param_count)
-{
-    API_SCALL_INT(Room_GetWidth);
-}
-
 // void (int xx,int yy,int mood)
 RuntimeScriptValue Sc_ProcessClick(const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -1065,17 +1042,18 @@ void RegisterRoomAPI()
     ccAddExternalStaticFunction("Room::SetProperty^2",                      Sc_Room_SetProperty);
     ccAddExternalStaticFunction("Room::SetTextProperty^2",                  Sc_Room_SetTextProperty);
     ccAddExternalStaticFunction("Room::ProcessClick^3",                     Sc_ProcessClick);
+    ccAddExternalTypedFunction("Room::Preload^1",                           API_TYPED_FUNC(Room_Preload));
     ccAddExternalStaticFunction("ProcessClick",                             Sc_ProcessClick);
-    ccAddExternalStaticFunction("Room::get_BottomEdge",                     Sc_Room_GetBottomEdge);
-    ccAddExternalStaticFunction("Room::get_ColorDepth",                     Sc_Room_GetColorDepth);
-    ccAddExternalStaticFunction("Room::get_Height",                         Sc_Room_GetHeight);
-    ccAddExternalStaticFunction("Room::get_LeftEdge",                       Sc_Room_GetLeftEdge);
+    ccAddExternalTypedFunction("Room::get_BottomEdge",                      API_TYPED_FUNC(Room_GetBottomEdge));
+    ccAddExternalTypedFunction("Room::get_ColorDepth",                      API_TYPED_FUNC(Room_GetColorDepth));
+    ccAddExternalTypedFunction("Room::get_Height",                          API_TYPED_FUNC(Room_GetHeight));
+    ccAddExternalTypedFunction("Room::get_LeftEdge",                        API_TYPED_FUNC(Room_GetLeftEdge));
     ccAddExternalStaticFunction("Room::geti_Messages",                      Sc_Room_GetMessages);
-    ccAddExternalStaticFunction("Room::get_MusicOnLoad",                    Sc_Room_GetMusicOnLoad);
-    ccAddExternalStaticFunction("Room::get_ObjectCount",                    Sc_Room_GetObjectCount);
-    ccAddExternalStaticFunction("Room::get_RightEdge",                      Sc_Room_GetRightEdge);
-    ccAddExternalStaticFunction("Room::get_TopEdge",                        Sc_Room_GetTopEdge);
-    ccAddExternalStaticFunction("Room::get_Width",                          Sc_Room_GetWidth);
+    ccAddExternalTypedFunction("Room::get_MusicOnLoad",                     API_TYPED_FUNC(Room_GetMusicOnLoad));
+    ccAddExternalTypedFunction("Room::get_ObjectCount",                     API_TYPED_FUNC(Room_GetObjectCount));
+    ccAddExternalTypedFunction("Room::get_RightEdge",                       API_TYPED_FUNC(Room_GetRightEdge));
+    ccAddExternalTypedFunction("Room::get_TopEdge",                         API_TYPED_FUNC(Room_GetTopEdge));
+    ccAddExternalTypedFunction("Room::get_Width",                           API_TYPED_FUNC(Room_GetWidth));
     ccAddExternalStaticFunction("Room::get_Camera",                         Sc_Room_GetCamera);
 
     /* ----------------------- Registering unsafe exports for plugins -----------------------*/
@@ -1083,6 +1061,7 @@ void RegisterRoomAPI()
     ccAddExternalFunctionForPlugin("Room::GetDrawingSurfaceForBackground^1",   (void*)Room_GetDrawingSurfaceForBackground);
     ccAddExternalFunctionForPlugin("Room::GetProperty^1",                      (void*)Room_GetProperty);
     ccAddExternalFunctionForPlugin("Room::GetTextProperty^1",                  (void*)Room_GetTextProperty);
+    ccAddExternalFunctionForPlugin("Room::Preload^1",                          (void*)Room_Preload);
     ccAddExternalFunctionForPlugin("Room::get_BottomEdge",                     (void*)Room_GetBottomEdge);
     ccAddExternalFunctionForPlugin("Room::get_ColorDepth",                     (void*)Room_GetColorDepth);
     ccAddExternalFunctionForPlugin("Room::get_Height",                         (void*)Room_GetHeight);
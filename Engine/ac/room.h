@@ -35,10 +35,13 @@ int Room_GetMusicOnLoad();
 const char* Room_GetTextProperty(const char *property);
 int Room_GetProperty(const char *property);
 const char* Room_GetMessages(int index);
+void Room_Preload(int room);
 RuntimeScriptValue Sc_Room_GetProperty(const RuntimeScriptValue *params, int32_t param_count);
 
 //=============================================================================
 
+// Gets the name of the room's file in the game package
+AGS::Common::String get_room_filename(int room_num);
 void  save_room_data_segment ();
 void  unload_old_room();
 void  load_new_room(int newnum,CharacterInfo*forchar);
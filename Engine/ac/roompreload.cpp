@@ -0,0 +1,214 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <atomic>
+#include <string.h>
+#include "ac/gamesetupstruct.h"
+#include "ac/room.h"
+#include "ac/roompreload.h"
+#include "ac/spritecache.h"
+#include "ac/walkbehind.h"
+#include "debug/out.h"
+#include "game/room_file.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/thread.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern GameSetupStruct game;
+extern SpriteCache spriteset;
+
+namespace
+{
+
+enum PreloadState
+{
+    kPreload_None,
+    kPreload_Loading,   // the worker is reading the room
+    kPreload_Loaded     // the room is ready to be entered
+};
+
+// Time the worker sleeps while it has nothing to do, in milliseconds
+const int PreloadIdleDelay = 5;
+// Number of object sprites precached by the game thread per frame
+const size_t SpritesPrecachedPerFrame = 2;
+
+Thread            PreloadThread;
+bool              PreloadThreadRunning = false;
+// Set by the game thread when the room file is opened, reset by the worker
+// when it is done with the room; while it is set, only the worker may
+// access the staging data below
+std::atomic<bool> PreloadJobPending(false);
+
+// Staging data
+RoomDataSource    Source;
+RoomStruct        Room;
+HRoomFileError    Error;
+WalkBehindTables  WalkBehinds;
+bool              WalkBehindsReady = false;
+
+// Accessed by the game thread only
+PreloadState      State = kPreload_None;
+int               RoomNumber = -1;
+size_t            NextPrecachedObject = 0;
+
+
+// Worker thread entry, called repeatedly until the thread is stopped
+void preload_worker_update()
+{
+    if (!PreloadJobPending.load(std::memory_order_acquire))
+    {
+        AGSPlatformDriver::GetDriver()->Delay(PreloadIdleDelay);
+        return;
+    }
+
+    Error = ReadRoomData(&Room, Source.InputStream.get(), Source.DataVersion);
+    Source.InputStream.reset();
+    // The backgrounds are prepared for use by the game thread, which owns
+    // the display mode and the palette, when the room is entered
+    WalkBehindsReady = Error && Room.WalkBehindMask &&
+        calc_walk_behind_tables(Room.WalkBehindMask.get(), WalkBehinds);
+    PreloadJobPending.store(false, std::memory_order_release);
+}
+
+void stop_worker()
+{
+    if (!PreloadThreadRunning)
+        return;
+    PreloadThread.Stop();
+    PreloadThreadRunning = false;
+}
+
+void wait_for_worker()
+{
+    while (PreloadJobPending.load(std::memory_order_acquire))
+        AGSPlatformDriver::GetDriver()->YieldCPU();
+}
+
+void free_staging_room()
+{
+    Room.Free();
+    Room.InitDefaults();
+    WalkBehinds.Free();
+    WalkBehindsReady = false;
+    Error = HRoomFileError::None();
+    State = kPreload_None;
+    RoomNumber = -1;
+}
+
+// Checks the results once the worker is done with the room
+void complete_loading()
+{
+    stop_worker();
+    if (!Error)
+    {
+        Debug::Printf(kDbgMsg_Warn, "Failed to preload room %d: %s", RoomNumber, Error->FullMessage().GetCStr());
+        free_staging_room();
+        return;
+    }
+    Debug::Printf("Room %d preloaded", RoomNumber);
+    State = kPreload_Loaded;
+    NextPrecachedObject = 0;
+}
+
+} // namespace
+
+
+void preload_room(int room_num)
+{
+    if (State != kPreload_None && RoomNumber == room_num)
+        return;
+    cancel_room_preload();
+
+    HRoomFileError err = OpenRoomFile(get_room_filename(room_num), Source);
+    if (!err)
+    {
+        Debug::Printf(kDbgMsg_Warn, "Unable to preload room %d: %s", room_num, err->FullMessage().GetCStr());
+        return;
+    }
+    if (!PreloadThreadRunning)
+        PreloadThreadRunning = PreloadThread.CreateAndStart(preload_worker_update, true);
+    if (!PreloadThreadRunning)
+    {
+        Source = RoomDataSource();
+        return;
+    }
+
+    Debug::Printf("Preloading room %d", room_num);
+    Room.Free();
+    Room.InitDefaults();
+    RoomNumber = room_num;
+    State = kPreload_Loading;
+    PreloadJobPending.store(true, std::memory_order_release);
+}
+
+void cancel_room_preload()
+{
+    if (State == kPreload_None)
+        return;
+    wait_for_worker();
+    stop_worker();
+    free_staging_room();
+}
+
+void update_room_preload()
+{
+    if (State == kPreload_Loading && !PreloadJobPending.load(std::memory_order_acquire))
+        complete_loading();
+    if (State != kPreload_Loaded)
+        return;
+
+    for (size_t n = 0; n < SpritesPrecachedPerFrame && NextPrecachedObject < Room.ObjectCount; ++NextPrecachedObject)
+    {
+        const int sprite = Room.Objects[NextPrecachedObject].Sprite;
+        if (sprite <= 0 || (size_t)sprite >= game.SpriteInfos.size())
+            continue;
+        spriteset.Precache(sprite);
+        n++;
+    }
+}
+
+bool take_preloaded_room(int room_num, RoomStruct &room, WalkBehindTables &wb)
+{
+    if (State == kPreload_None || RoomNumber != room_num)
+        return false;
+    if (State == kPreload_Loading)
+    {
+        wait_for_worker();
+        complete_loading();
+        if (State != kPreload_Loaded)
+            return false;
+    }
+
+    room = Room;
+    if (WalkBehindsReady)
+    {
+        // hand over the tables
+        wb.Free();
+        wb.Exists = WalkBehinds.Exists;
+        wb.StartY = WalkBehinds.StartY;
+        wb.EndY = WalkBehinds.EndY;
+        wb.NoWalkBehinds = WalkBehinds.NoWalkBehinds;
+        memcpy(wb.Left, WalkBehinds.Left, sizeof(wb.Left));
+        memcpy(wb.Top, WalkBehinds.Top, sizeof(wb.Top));
+        memcpy(wb.Right, WalkBehinds.Right, sizeof(wb.Right));
+        memcpy(wb.Bottom, WalkBehinds.Bottom, sizeof(wb.Bottom));
+        WalkBehinds.Exists = NULL;
+        WalkBehinds.StartY = NULL;
+        WalkBehinds.EndY = NULL;
+    }
+    free_staging_room();
+    return true;
+}
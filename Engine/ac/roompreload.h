@@ -0,0 +1,50 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Room preloading.
+//
+// A room that the game is likely to go to next may be loaded in advance, on
+// a worker thread, while the game goes on. The worker reads and decodes the
+// room file into a staging room and finds the walk-behind areas; the
+// backgrounds are left to be prepared for the display mode by the game
+// thread when the room is entered. Once the worker is done, the sprites
+// of the room objects are precached by the game thread a few at a time.
+// When the room is entered, load_new_room takes the preloaded data instead
+// of reading the file.
+//
+// Only one room is preloaded at a time; asking for another one discards the
+// previous one.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROOMPRELOAD_H
+#define __AGS_EE_AC__ROOMPRELOAD_H
+
+#include "game/roomstruct.h"
+
+struct WalkBehindTables;
+
+// Starts loading the room in the background
+void preload_room(int room_num);
+// Discards the preloaded room, waiting for the worker if necessary
+void cancel_room_preload();
+// Precaches the preloaded room's object sprites; should be called by the game
+// thread once a frame
+void update_room_preload();
+// If the room was preloaded, waits for the worker to finish with it and moves
+// the room data into the given structs. Returns false if the room was not
+// preloaded, or could not be loaded, in which case it should be loaded the
+// usual way.
+bool take_preloaded_room(int room_num, AGS::Common::RoomStruct &room, WalkBehindTables &wb);
+
+#endif // __AGS_EE_AC__ROOMPRELOAD_H
@@ -0,0 +1,182 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/stdtr1compat.h"
+#include TR1INCLUDE(unordered_map)
+#include "ac/spritetransformcache.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+SpriteTransformKey::SpriteTransformKey()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+bool SpriteTransformKey::operator ==(const SpriteTransformKey &other) const
+{
+    return memcmp(this, &other, sizeof(*this)) == 0;
+}
+
+namespace
+{
+
+struct SpriteTransformKeyHash
+{
+    size_t operator ()(const SpriteTransformKey &key) const
+    {
+        // FNV-1a over the key fields
+        const unsigned char *p = (const unsigned char*)&key;
+        unsigned int hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(key); ++i)
+        {
+            hash ^= p[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+};
+
+struct TransformCacheEntry
+{
+    SpriteTransformKey Key;
+    Bitmap *Image;
+    size_t  Size;       // memory taken by the image, in bytes
+    // LRU list links
+    TransformCacheEntry *Prev;
+    TransformCacheEntry *Next;
+};
+
+typedef stdtr1compat::unordered_map<SpriteTransformKey, TransformCacheEntry*, SpriteTransformKeyHash> TransformCacheMap;
+
+TransformCacheMap CacheByKey;
+// The LRU list, from the most recently used entry to the least recently used one
+TransformCacheEntry *LruHead = NULL;
+TransformCacheEntry *LruTail = NULL;
+SpriteTransformCacheStats CacheStats = { 0, 0, 0, 0, 0, DEFAULT_TRANSFORM_CACHE_SIZE };
+
+} // namespace
+
+
+static void lru_unlink(TransformCacheEntry *entry)
+{
+    if (entry->Prev)
+        entry->Prev->Next = entry->Next;
+    else
+        LruHead = entry->Next;
+    if (entry->Next)
+        entry->Next->Prev = entry->Prev;
+    else
+        LruTail = entry->Prev;
+    entry->Prev = entry->Next = NULL;
+}
+
+static void lru_push_front(TransformCacheEntry *entry)
+{
+    entry->Prev = NULL;
+    entry->Next = LruHead;
+    if (LruHead)
+        LruHead->Prev = entry;
+    else
+        LruTail = entry;
+    LruHead = entry;
+}
+
+static void remove_entry(TransformCacheEntry *entry)
+{
+    lru_unlink(entry);
+    CacheByKey.erase(entry->Key);
+    CacheStats.Used -= entry->Size;
+    delete entry->Image;
+    delete entry;
+}
+
+// Evicts the least recently used images until the given amount of memory fits in
+static void free_space(size_t size)
+{
+    while (LruTail && CacheStats.Used + size > CacheStats.Limit)
+    {
+        remove_entry(LruTail);
+        CacheStats.Evictions++;
+    }
+}
+
+Bitmap *get_transformed_sprite(const SpriteTransformKey &key)
+{
+    TransformCacheMap::const_iterator it = CacheByKey.find(key);
+    if (it == CacheByKey.end())
+    {
+        CacheStats.Misses++;
+        return NULL;
+    }
+    TransformCacheEntry *entry = it->second;
+    if (entry != LruHead)
+    {
+        lru_unlink(entry);
+        lru_push_front(entry);
+    }
+    CacheStats.Hits++;
+    return entry->Image;
+}
+
+void store_transformed_sprite(const SpriteTransformKey &key, Bitmap *image)
+{
+    const size_t size = sizeof(TransformCacheEntry) + image->GetDataSize();
+    // Images bigger than a quarter of the cache would push out too much
+    if (size > CacheStats.Limit / 4)
+        return;
+
+    TransformCacheMap::iterator it = CacheByKey.find(key);
+    if (it != CacheByKey.end())
+        remove_entry(it->second);
+    free_space(size);
+
+    TransformCacheEntry *entry = new TransformCacheEntry();
+    entry->Key = key;
+    entry->Image = BitmapHelper::CreateBitmapCopy(image);
+    entry->Size = size;
+    lru_push_front(entry);
+    CacheByKey[key] = entry;
+    CacheStats.Used += size;
+}
+
+void invalidate_transformed_sprite(int sprite)
+{
+    for (TransformCacheEntry *entry = LruHead; entry;)
+    {
+        TransformCacheEntry *next = entry->Next;
+        if (entry->Key.Sprite == sprite)
+            remove_entry(entry);
+        entry = next;
+    }
+}
+
+void clear_transformed_sprite_cache()
+{
+    while (LruHead)
+        remove_entry(LruHead);
+}
+
+void set_transformed_sprite_cache_limit(size_t limit)
+{
+    CacheStats.Limit = limit;
+    free_space(0);
+}
+
+void get_transformed_sprite_cache_stats(SpriteTransformCacheStats &stats)
+{
+    stats = CacheStats;
+    stats.Entries = CacheByKey.size();
+}
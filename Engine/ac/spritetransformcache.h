@@ -0,0 +1,77 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// A cache of the sprites scaled, flipped and tinted by the software renderer,
+// shared by all the characters and objects. Each image is addressed by the
+// source sprite and all the parameters of the transformation, so the frames
+// of a looping animation, or a frame drawn by several characters at once, are
+// only transformed once. The cache size is limited by the amount of memory the
+// images take; when the limit is exceeded, the least recently used images are
+// freed first.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__SPRITETRANSFORMCACHE_H
+#define __AGS_EE_AC__SPRITETRANSFORMCACHE_H
+
+#include <stddef.h>
+
+namespace AGS { namespace Common { class Bitmap; } }
+
+// Default limit of the transformed sprite cache, in bytes
+#define DEFAULT_TRANSFORM_CACHE_SIZE (4 * 1024 * 1024)
+
+struct SpriteTransformKey
+{
+    int Sprite;
+    int ColorDepth;
+    int Width;          // final size of the image
+    int Height;
+    int Zoom;
+    int Mirrored;
+    int TintRed;
+    int TintGreen;
+    int TintBlue;
+    int TintAmount;
+    int TintLight;
+    int LightLevel;
+    int Antialias;      // whether the scaling was antialiased
+
+    SpriteTransformKey();
+    bool operator ==(const SpriteTransformKey &other) const;
+};
+
+struct SpriteTransformCacheStats
+{
+    unsigned int Hits;      // images served from the cache
+    unsigned int Misses;    // images that had to be transformed
+    unsigned int Evictions; // images freed to make room for other images
+    size_t       Entries;   // number of cached images
+    size_t       Used;      // memory taken by the cached images, in bytes
+    size_t       Limit;     // the cache size limit, in bytes
+};
+
+// Returns the cached image for the given transformation, or NULL if there's none
+AGS::Common::Bitmap *get_transformed_sprite(const SpriteTransformKey &key);
+// Stores a copy of the transformed image in the cache
+void store_transformed_sprite(const SpriteTransformKey &key, AGS::Common::Bitmap *image);
+// Frees all the cached images made from the given sprite;
+// must be called whenever the sprite's image is changed or deleted
+void invalidate_transformed_sprite(int sprite);
+// Frees all the cached images
+void clear_transformed_sprite_cache();
+// Sets the cache size limit in bytes; 0 disables the cache
+void set_transformed_sprite_cache_limit(size_t limit);
+void get_transformed_sprite_cache_stats(SpriteTransformCacheStats &stats);
+
+#endif // __AGS_EE_AC__SPRITETRANSFORMCACHE_H
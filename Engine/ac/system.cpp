@@ -25,6 +25,7 @@
 #include "debug/debug_log.h"
 #include "main/engine.h"
 #include "main/main.h"
+#include "media/audio/audiocore.h"
 #include "media/audio/soundclip.h"
 #include "gfx/graphicsdriver.h"
 #include "ac/dynobj/cc_audiochannel.h"
@@ -203,7 +204,7 @@ void System_SetVolume(int newvol)
     {
         if ((channels[i] != NULL) && (channels[i]->done == 0)) 
         {
-            channels[i]->adjust_volume();
+            audio_core_clip_adjust_volume(channels[i]);
         }
     }
 }
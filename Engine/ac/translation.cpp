@@ -46,19 +46,34 @@ void close_translation () {
     }
 }
 
-bool parse_translation(Stream *language_file, String &parse_error);
+TranslationInfo::TranslationInfo()
+    : Tree(NULL)
+    , HasGameInfo(false)
+    , GameUid(0)
+    , NormalFont(-1)
+    , SpeechFont(-1)
+    , TextDirection(0)
+{
+}
 
-bool init_translation (const String &lang, const String &fallback_lang, bool quit_on_error) {
+TranslationInfo::~TranslationInfo()
+{
+    delete Tree;
+}
+
+bool parse_translation(Stream *language_file, TranslationInfo &info);
 
+Stream *open_translation(const String &lang)
+{
     if (lang.IsEmpty())
-        return false;
+        return NULL;
     sprintf(transFileName, "%s.tra", lang.GetCStr());
 
     Stream *language_file = find_open_asset(transFileName);
     if (language_file == NULL)
     {
         Debug::Printf(kDbgMsg_Error, "Cannot open translation: %s", transFileName);
-        return false;
+        return NULL;
     }
     // in case it's inside a library file, record the offset
     lang_offs_start = language_file->GetPosition();
@@ -68,22 +83,38 @@ bool init_translation (const String &lang, const String &fallback_lang, bool qui
     if (strcmp(transsig, "AGSTranslation") != 0) {
         Debug::Printf(kDbgMsg_Error, "Translation signature mismatch: %s", transFileName);
         delete language_file;
-        return false;
+        return NULL;
     }
+    return language_file;
+}
 
-    if (transtree != NULL)
+void read_translation(Stream *language_file, TranslationInfo &info)
+{
+    delete info.Tree;
+    info.Tree = new TreeMap();
+    if (!parse_translation(language_file, info))
     {
-        close_translation();
+        delete info.Tree;
+        info.Tree = NULL;
     }
-    transtree = new TreeMap();
-
-    String parse_error;
-    bool result = parse_translation(language_file, parse_error);
     delete language_file;
+}
+
+bool apply_translation(TranslationInfo &info, const String &fallback_lang, bool quit_on_error)
+{
+    if (info.Tree && info.HasGameInfo &&
+        ((info.GameUid != game.uniqueid) || (info.GameName.Compare(game.gamename) != 0)))
+    {
+        info.ParseError.Format("The translation file is not compatible with this game. The translation is designed for '%s'.",
+            info.GameName.GetCStr());
+        delete info.Tree;
+        info.Tree = NULL;
+    }
 
-    if (!result)
+    if (info.Tree == NULL)
     {
         close_translation();
+        String parse_error = info.ParseError;
         parse_error.Prepend(String::FromFormat("Failed to read translation file: %s:\n", transFileName));
         if (quit_on_error)
         {
@@ -101,11 +132,38 @@ bool init_translation (const String &lang, const String &fallback_lang, bool qui
             return false;
         }
     }
+
+    close_translation();
+    transtree = info.Tree;
+    info.Tree = NULL;
+    if (info.NormalFont >= 0)
+        SetNormalFont(info.NormalFont);
+    if (info.SpeechFont >= 0)
+        SetSpeechFont(info.SpeechFont);
+    if (info.TextDirection == 1) {
+        play.text_align = kHAlignLeft;
+        game.options[OPT_RIGHTLEFTWRITE] = 0;
+    }
+    else if (info.TextDirection == 2) {
+        play.text_align = kHAlignRight;
+        game.options[OPT_RIGHTLEFTWRITE] = 1;
+    }
     Debug::Printf("Translation initialized: %s", transFileName);
     return true;
 }
 
-bool parse_translation(Stream *language_file, String &parse_error)
+bool init_translation (const String &lang, const String &fallback_lang, bool quit_on_error) {
+
+    Stream *language_file = open_translation(lang);
+    if (language_file == NULL)
+        return false;
+
+    TranslationInfo info;
+    read_translation(language_file, info);
+    return apply_translation(info, fallback_lang, quit_on_error);
+}
+
+bool parse_translation(Stream *language_file, TranslationInfo &info)
 {
     while (!language_file->EOS()) {
         int blockType = language_file->ReadInt32();
@@ -123,55 +181,37 @@ bool parse_translation(Stream *language_file, String &parse_error)
                     break;
                 if (language_file->EOS())
                 {
-                    parse_error = "Translation file is corrupt";
+                    info.ParseError = "Translation file is corrupt";
                     return false;
                 }
-                transtree->addText (original, translation);
+                info.Tree->addText (original, translation);
             }
 
         }
         else if (blockType == 2) {
-            int uidfrom;
+            // the game is checked when the translation is applied
             char wasgamename[100];
-            uidfrom = language_file->ReadInt32();
+            info.GameUid = language_file->ReadInt32();
             read_string_decrypt (language_file, wasgamename, sizeof(wasgamename));
-            if ((uidfrom != game.uniqueid) || (strcmp (wasgamename, game.gamename) != 0)) {
-                parse_error.Format("The translation file is not compatible with this game. The translation is designed for '%s'.",
-                    wasgamename);
-                return false;
-            }
+            info.GameName = wasgamename;
+            info.HasGameInfo = true;
         }
         else if (blockType == 3) {
-            // game settings
-            int temp = language_file->ReadInt32();
-            // normal font
-            if (temp >= 0)
-                SetNormalFont (temp);
-            temp = language_file->ReadInt32();
-            // speech font
-            if (temp >= 0)
-                SetSpeechFont (temp);
-            temp = language_file->ReadInt32();
-            // text direction
-            if (temp == 1) {
-                play.text_align = kHAlignLeft;
-                game.options[OPT_RIGHTLEFTWRITE] = 0;
-            }
-            else if (temp == 2) {
-                play.text_align = kHAlignRight;
-                game.options[OPT_RIGHTLEFTWRITE] = 1;
-            }
+            // game settings, applied along with the translation
+            info.NormalFont = language_file->ReadInt32();
+            info.SpeechFont = language_file->ReadInt32();
+            info.TextDirection = language_file->ReadInt32();
         }
         else
         {
-            parse_error.Format("Unknown block type in translation file (%d).", blockType);
+            info.ParseError.Format("Unknown block type in translation file (%d).", blockType);
             return false;
         }
     }
 
-    if (transtree->text == NULL)
+    if (info.Tree->text == NULL)
     {
-        parse_error = "The translation file was empty.";
+        info.ParseError = "The translation file was empty.";
         return false;
     }
 
@@ -20,9 +20,43 @@
 
 #include "util/string.h"
 
+namespace AGS { namespace Common { class Stream; } }
+using AGS::Common::Stream;
 using AGS::Common::String;
+struct TreeMap;
+
+// Contents of the translation file, not yet applied to the game
+struct TranslationInfo
+{
+    TreeMap *Tree;          // NULL if the file could not be read
+    String   ParseError;
+    bool     HasGameInfo;   // if the game the translation is meant for is known
+    int      GameUid;
+    String   GameName;
+    int      NormalFont;    // -1 if the translation does not change it
+    int      SpeechFont;    // -1 if the translation does not change it
+    int      TextDirection; // 1 - left-to-right, 2 - right-to-left, otherwise unchanged
+
+    TranslationInfo();
+    ~TranslationInfo();
+
+private:
+    TranslationInfo(const TranslationInfo &); // non-copyable
+    TranslationInfo &operator=(const TranslationInfo &);
+};
 
 void close_translation ();
 bool init_translation (const String &lang, const String &fallback_lang, bool quit_on_error);
 
+// Loading the translation in steps, which lets the reading itself run on
+// another thread. Opens the translation file and checks its signature;
+// returns NULL on failure.
+Stream *open_translation(const String &lang);
+// Reads the translation and disposes the stream; does not access the game
+// state, so may be called on any thread
+void read_translation(Stream *language_file, TranslationInfo &info);
+// Checks that the translation that was read fits the game, and makes it
+// current; reports the errors just like init_translation does
+bool apply_translation(TranslationInfo &info, const String &fallback_lang, bool quit_on_error);
+
 #endif // __AGS_EE_AC__TRANSLATION_H
@@ -81,64 +81,111 @@ void update_walk_behind_images()
 }
 
 
-void recache_walk_behinds () {
-  if (walkBehindExists) {
-    free (walkBehindExists);
-    free (walkBehindStartY);
-    free (walkBehindEndY);
-  }
+WalkBehindTables::WalkBehindTables()
+    : Exists(NULL)
+    , StartY(NULL)
+    , EndY(NULL)
+    , NoWalkBehinds(true)
+{
+}
 
-  walkBehindExists = (char*)malloc (thisroom.WalkBehindMask->GetWidth());
-  walkBehindStartY = (int*)malloc (thisroom.WalkBehindMask->GetWidth() * sizeof(int));
-  walkBehindEndY = (int*)malloc (thisroom.WalkBehindMask->GetWidth() * sizeof(int));
-  noWalkBehindsAtAll = 1;
+WalkBehindTables::~WalkBehindTables()
+{
+    Free();
+}
+
+void WalkBehindTables::Free()
+{
+    free(Exists);
+    free(StartY);
+    free(EndY);
+    Exists = NULL;
+    StartY = NULL;
+    EndY = NULL;
+}
+
+bool calc_walk_behind_tables(const Bitmap *mask, WalkBehindTables &wb)
+{
+  // since this is an 8-bit memory bitmap, we can just use direct 
+  // memory access
+  if ((!mask->IsLinearBitmap()) || (mask->GetColorDepth() != 8))
+    return false;
+
+  wb.Free();
+  wb.Exists = (char*)malloc (mask->GetWidth());
+  wb.StartY = (int*)malloc (mask->GetWidth() * sizeof(int));
+  wb.EndY = (int*)malloc (mask->GetWidth() * sizeof(int));
+  wb.NoWalkBehinds = true;
 
   int ee,rr,tmm;
   const int NO_WALK_BEHIND = 100000;
   for (ee = 0; ee < MAX_WALK_BEHINDS; ee++)
   {
-    walkBehindLeft[ee] = NO_WALK_BEHIND;
-    walkBehindTop[ee] = NO_WALK_BEHIND;
-    walkBehindRight[ee] = 0;
-    walkBehindBottom[ee] = 0;
-
-    if (walkBehindBitmap[ee] != NULL)
-    {
-      gfxDriver->DestroyDDB(walkBehindBitmap[ee]);
-      walkBehindBitmap[ee] = NULL;
-    }
+    wb.Left[ee] = NO_WALK_BEHIND;
+    wb.Top[ee] = NO_WALK_BEHIND;
+    wb.Right[ee] = 0;
+    wb.Bottom[ee] = 0;
   }
 
-  update_polled_stuff_if_runtime();
-
-  // since this is an 8-bit memory bitmap, we can just use direct 
-  // memory access
-  if ((!thisroom.WalkBehindMask->IsLinearBitmap()) || (thisroom.WalkBehindMask->GetColorDepth() != 8))
-    quit("Walk behinds bitmap not linear");
-
-  for (ee=0;ee<thisroom.WalkBehindMask->GetWidth();ee++) {
-    walkBehindExists[ee] = 0;
-    for (rr=0;rr<thisroom.WalkBehindMask->GetHeight();rr++) {
-      tmm = thisroom.WalkBehindMask->GetScanLine(rr)[ee];
-      //tmm = _getpixel(thisroom.WalkBehindMask,ee,rr);
+  for (ee=0;ee<mask->GetWidth();ee++) {
+    wb.Exists[ee] = 0;
+    for (rr=0;rr<mask->GetHeight();rr++) {
+      tmm = mask->GetScanLine(rr)[ee];
       if ((tmm >= 1) && (tmm < MAX_WALK_BEHINDS)) {
-        if (!walkBehindExists[ee]) {
-          walkBehindStartY[ee] = rr;
-          walkBehindExists[ee] = tmm;
-          noWalkBehindsAtAll = 0;
+        if (!wb.Exists[ee]) {
+          wb.StartY[ee] = rr;
+          wb.Exists[ee] = tmm;
+          wb.NoWalkBehinds = false;
         }
-        walkBehindEndY[ee] = rr + 1;  // +1 to allow bottom line of screen to work
+        wb.EndY[ee] = rr + 1;  // +1 to allow bottom line of screen to work
 
-        if (ee < walkBehindLeft[tmm]) walkBehindLeft[tmm] = ee;
-        if (rr < walkBehindTop[tmm]) walkBehindTop[tmm] = rr;
-        if (ee > walkBehindRight[tmm]) walkBehindRight[tmm] = ee;
-        if (rr > walkBehindBottom[tmm]) walkBehindBottom[tmm] = rr;
+        if (ee < wb.Left[tmm]) wb.Left[tmm] = ee;
+        if (rr < wb.Top[tmm]) wb.Top[tmm] = rr;
+        if (ee > wb.Right[tmm]) wb.Right[tmm] = ee;
+        if (rr > wb.Bottom[tmm]) wb.Bottom[tmm] = rr;
       }
     }
   }
+  return true;
+}
+
+void recache_walk_behinds(WalkBehindTables &wb)
+{
+  free (walkBehindExists);
+  free (walkBehindStartY);
+  free (walkBehindEndY);
+  walkBehindExists = wb.Exists;
+  walkBehindStartY = wb.StartY;
+  walkBehindEndY = wb.EndY;
+  wb.Exists = NULL;
+  wb.StartY = NULL;
+  wb.EndY = NULL;
+  noWalkBehindsAtAll = wb.NoWalkBehinds ? 1 : 0;
+
+  for (int ee = 0; ee < MAX_WALK_BEHINDS; ee++)
+  {
+    walkBehindLeft[ee] = wb.Left[ee];
+    walkBehindTop[ee] = wb.Top[ee];
+    walkBehindRight[ee] = wb.Right[ee];
+    walkBehindBottom[ee] = wb.Bottom[ee];
+
+    if (walkBehindBitmap[ee] != NULL)
+    {
+      gfxDriver->DestroyDDB(walkBehindBitmap[ee]);
+      walkBehindBitmap[ee] = NULL;
+    }
+  }
 
   if (walkBehindMethod == DrawAsSeparateSprite)
   {
     update_walk_behind_images();
   }
 }
+
+void recache_walk_behinds () {
+  WalkBehindTables wb;
+  update_polled_stuff_if_runtime();
+  if (!calc_walk_behind_tables(thisroom.WalkBehindMask.get(), wb))
+    quit("Walk behinds bitmap not linear");
+  recache_walk_behinds(wb);
+}
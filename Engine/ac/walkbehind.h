@@ -25,7 +25,35 @@ enum WalkBehindMethodEnum
     DrawAsSeparateCharSprite
 };
 
+#include "game/roomstruct.h"
+
+// Walk-behind areas' positions, found in the room's walk-behind mask
+struct WalkBehindTables
+{
+    char   *Exists;     // walk-behind area found in each column, or 0
+    int    *StartY;     // top and bottom of the areas in each column
+    int    *EndY;
+    bool    NoWalkBehinds;
+    int     Left[MAX_WALK_BEHINDS];
+    int     Top[MAX_WALK_BEHINDS];
+    int     Right[MAX_WALK_BEHINDS];
+    int     Bottom[MAX_WALK_BEHINDS];
+
+    WalkBehindTables();
+    ~WalkBehindTables();
+    void Free();
+
+private:
+    WalkBehindTables(const WalkBehindTables &); // non-copyable
+    WalkBehindTables &operator=(const WalkBehindTables &);
+};
+
 void update_walk_behind_images();
 void recache_walk_behinds ();
+// Finds the walk-behind areas in the mask; does not touch the current room,
+// so may be called on any thread. Returns false if the mask has wrong format.
+bool calc_walk_behind_tables(const AGS::Common::Bitmap *mask, WalkBehindTables &wb);
+// Makes the tables calculated earlier current, taking over their contents
+void recache_walk_behinds(WalkBehindTables &wb);
 
 #endif // __AGS_EE_AC__WALKBEHIND_H
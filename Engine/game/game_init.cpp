@@ -344,14 +344,14 @@ void AllocScriptModules()
     moduleInst.resize(numScriptModules, NULL);
     moduleInstFork.resize(numScriptModules, NULL);
     moduleRepExecAddr.resize(numScriptModules);
-    repExecAlways.moduleHasFunction.resize(numScriptModules, true);
-    lateRepExecAlways.moduleHasFunction.resize(numScriptModules, true);
-    getDialogOptionsDimensionsFunc.moduleHasFunction.resize(numScriptModules, true);
-    renderDialogOptionsFunc.moduleHasFunction.resize(numScriptModules, true);
-    getDialogOptionUnderCursorFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionMouseClickHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionKeyPressHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionRepExecFunc.moduleHasFunction.resize(numScriptModules, true);
+    repExecAlways.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    lateRepExecAlways.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    getDialogOptionsDimensionsFunc.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    renderDialogOptionsFunc.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    getDialogOptionUnderCursorFunc.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    runDialogOptionMouseClickHandlerFunc.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    runDialogOptionKeyPressHandlerFunc.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
+    runDialogOptionRepExecFunc.moduleFunction.resize(numScriptModules, SCRIPT_FUNC_UNRESOLVED);
     for (int i = 0; i < numScriptModules; ++i)
     {
         moduleRepExecAddr[i].Invalidate();
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <atomic>
 #include "ac/character.h"
 #include "ac/common.h"
 #include "ac/draw.h"
@@ -42,6 +43,7 @@
 #include "game/savegame_internal.h"
 #include "main/main.h"
 #include "media/audio/audio.h"
+#include "media/audio/audiocore.h"
 #include "media/audio/soundclip.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin.h"
@@ -52,6 +54,7 @@
 #include "util/file.h"
 #include "util/stream.h"
 #include "util/string_utils.h"
+#include "util/thread.h"
 
 using namespace Common;
 using namespace Engine;
@@ -265,6 +268,8 @@ HSaveError ReadDescription_v321(Stream *in, SavegameVersion &svg_ver, SavegameDe
 
 HSaveError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems)
 {
+    // the savegame may be still being written; its error is only logged here
+    WaitForSavegameWrite();
     UStream in(File::OpenFileRead(filename));
     if (!in.get())
         return new SavegameError(kSvgErr_FileOpenFailed, String::FromFormat("Requested filename: %s.", filename.GetCStr()));
@@ -562,8 +567,8 @@ HSaveError DoAfterRestore(const PreservedParams &pp, const RestoredData &r_data)
         if (channels[i] != NULL)
         {
             channels[i]->set_volume_direct(chan_info.VolAsPercent, chan_info.Vol);
-            channels[i]->set_speed(chan_info.Speed);
-            channels[i]->set_panning(chan_info.Pan);
+            audio_core_clip_set_speed(channels[i], chan_info.Speed);
+            audio_core_clip_set_panning(channels[i], chan_info.Pan);
             channels[i]->panningAsPercentage = chan_info.PanAsPercent;
         }
     }
@@ -580,7 +585,7 @@ HSaveError DoAfterRestore(const PreservedParams &pp, const RestoredData &r_data)
         int pos = r_data.AudioChans[i].Pos;
         if ((pos > 0) && (channels[i] != NULL) && (channels[i]->done == 0))
         {
-            channels[i]->seek(pos);
+            audio_core_clip_seek(channels[i], pos);
         }
     }
 
@@ -733,5 +738,121 @@ void SaveGameState(PStream out)
     SavegameComponents::WriteAllCommon(out);
 }
 
+namespace
+{
+
+// Time the writer thread sleeps once the savegame is written, in
+// milliseconds; the game thread stops the writer as soon as it notices
+// that, so this bounds how long it has to wait for it
+const int SavegameWriterIdleDelay = 1;
+
+Thread            SavegameWriterThread;
+bool              SavegameWriterRunning = false;
+// Set by the game thread when the snapshot is ready, reset by the writer
+// when the savegame is complete; while it is set, only the writer may
+// access the job data below
+std::atomic<bool> SavegameWritePending(false);
+
+// The savegame being written
+PStream           SavegameOut;
+SavegameComponents::ComponentDataList SavegameSnapshot;
+std::vector<uint8_t> SavegameVistaImage;
+HSaveError        SavegameWriteError;
+
+// Writes the snapshot and the screenshot for the rich media header; only
+// uses the job data, and so may be run on any thread
+void write_savegame_job()
+{
+    SavegameWriteError = SavegameComponents::WriteSnapshot(SavegameOut, SavegameSnapshot);
+    if (SavegameWriteError && !SavegameVistaImage.empty())
+    {
+        const int image_offset = (int)(SavegameOut->GetPosition() - sizeof(RICH_GAME_MEDIA_HEADER));
+        const size_t image_size = SavegameVistaImage.size();
+        // the header is only given the image if it was written in full
+        if (SavegameOut->Write(&SavegameVistaImage.front(), image_size) == image_size)
+        {
+            // dwThumbnailOffsetLowerDword and dwThumbnailSize
+            SavegameOut->Seek(12, kSeekBegin);
+            SavegameOut->WriteInt32(image_offset);
+            SavegameOut->Seek(4);
+            SavegameOut->WriteInt32((int)image_size);
+        }
+    }
+    SavegameOut.reset();
+}
+
+// Writer thread entry, called repeatedly until the thread is stopped
+void savegame_writer_update()
+{
+    if (!SavegameWritePending.load(std::memory_order_acquire))
+    {
+        AGSPlatformDriver::GetDriver()->Delay(SavegameWriterIdleDelay);
+        return;
+    }
+    write_savegame_job();
+    SavegameWritePending.store(false, std::memory_order_release);
+}
+
+// Stops the writer thread, which has completed its job, and returns the
+// result of writing
+HSaveError stop_savegame_writer()
+{
+    SavegameWriterThread.Stop();
+    SavegameWriterRunning = false;
+    HSaveError err = SavegameWriteError;
+    if (!err)
+        Debug::Printf(kDbgMsg_Error, "ERROR: failed to write savegame: %s", err->FullMessage().GetCStr());
+    SavegameWriteError = HSaveError::None();
+    SavegameSnapshot.clear();
+    SavegameVistaImage.clear();
+    return err;
+}
+
+} // namespace
+
+HSaveError SaveGameStateAsync(PStream out, std::vector<uint8_t> &vista_image)
+{
+    WaitForSavegameWrite();
+    DoBeforeSave();
+    HSaveError err = SavegameComponents::SnapshotAllCommon(SavegameSnapshot);
+    if (!err)
+    {
+        SavegameSnapshot.clear();
+        return err;
+    }
+    SavegameOut = out;
+    SavegameVistaImage.swap(vista_image);
+    // the job is set before the thread starts, so that it never idles first
+    SavegameWritePending.store(true, std::memory_order_release);
+    SavegameWriterRunning = SavegameWriterThread.CreateAndStart(savegame_writer_update, true);
+    if (SavegameWriterRunning)
+        return HSaveError::None();
+    SavegameWritePending.store(false, std::memory_order_release);
+    // no thread, so write it now
+    write_savegame_job();
+    err = SavegameWriteError;
+    SavegameWriteError = HSaveError::None();
+    SavegameSnapshot.clear();
+    SavegameVistaImage.clear();
+    return err;
+}
+
+bool PollSavegameWrite(HSaveError &err)
+{
+    if (!SavegameWriterRunning || SavegameWritePending.load(std::memory_order_acquire))
+        return false;
+    err = stop_savegame_writer();
+    return true;
+}
+
+HSaveError WaitForSavegameWrite()
+{
+    if (!SavegameWriterRunning)
+        return HSaveError::None();
+    while (SavegameWritePending.load(std::memory_order_acquire))
+        AGSPlatformDriver::GetDriver()->YieldCPU();
+    return stop_savegame_writer();
+}
+
 } // namespace Engine
 } // namespace AGS
@@ -15,6 +15,7 @@
 #ifndef __AGS_EE_GAME__SAVEGAME_H
 #define __AGS_EE_GAME__SAVEGAME_H
 
+#include <vector>
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
 #include "ac/game_version.h"
@@ -51,7 +52,8 @@ enum SavegameVersion
     kSvgVersion_321       = 8,
     kSvgVersion_Components= 9, // temp format, not supported anymore
     kSvgVersion_Cmp_64bit = 10,
-    kSvgVersion_Current   = kSvgVersion_Cmp_64bit,
+    kSvgVersion_Cmp_Packed= 11, // components may be packed
+    kSvgVersion_Current   = kSvgVersion_Cmp_Packed,
     kSvgVersion_LowestSupported = kSvgVersion_321 // change if support dropped
 };
 
@@ -161,6 +163,17 @@ PStream        StartSavegame(const String &filename, const String &user_text, co
 
 // Prepares game for saving state and writes game data into the save stream
 void           SaveGameState(PStream out);
+// Prepares game for saving state and takes a snapshot of the game data in
+// memory; the data is then packed and written into the save stream on the
+// background thread, followed by the optional encoded screenshot, which is
+// taken from the vector and referenced in the rich media header
+HSaveError     SaveGameStateAsync(PStream out, std::vector<uint8_t> &vista_image);
+// Tells if the savegame being written in background is complete; if it is,
+// stops the writer thread and passes the result of writing
+bool           PollSavegameWrite(HSaveError &err);
+// Waits until the savegame being written in background is complete, stops
+// the writer thread and returns the result of writing
+HSaveError     WaitForSavegameWrite();
 
 } // namespace Engine
 } // namespace AGS
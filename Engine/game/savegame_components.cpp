@@ -12,7 +12,9 @@
 //
 //=============================================================================
 
+#include <limits.h>
 #include <map>
+#include <string>
 
 #include "ac/character.h"
 #include "ac/common.h"
@@ -48,7 +50,11 @@
 #include "plugin/plugin_engine.h"
 #include "script/cc_error.h"
 #include "script/script.h"
+#include "util/file.h"
 #include "util/filestream.h" // TODO: needed only because plugins expect file handle
+#include "util/lzw.h"
+#include "util/memorystream.h"
+#include "util/mutex_lock.h"
 
 using namespace Common;
 
@@ -65,6 +71,7 @@ extern RoomStruct thisroom;
 extern RoomStatus troom;
 extern Bitmap *raw_saved_screen;
 extern MoveList *mls;
+extern char saveGameDirectory[260];
 
 
 namespace AGS
@@ -77,6 +84,13 @@ namespace SavegameComponents
 
 const String ComponentListTag = "Components";
 
+// Methods of packing the component data
+enum ComponentPacking
+{
+    kCmpPack_None = 0,
+    kCmpPack_LZW  = 1
+};
+
 void WriteFormatTag(PStream out, const String &tag, bool open = true)
 {
     String full_tag = String::FromFormat(open ? "<%s>" : "</%s>", tag.GetCStr());
@@ -916,8 +930,22 @@ HSaveError ReadManagedPool(PStream in, int32_t cmp_ver, const PreservedParams &p
 
 HSaveError WritePluginData(PStream out)
 {
+    if (!pl_any_want_hook(AGSE_SAVEGAME))
+        return HSaveError::None();
     // [IKM] Plugins expect FILE pointer! // TODO something with this later...
-    pl_run_plugin_hooks(AGSE_SAVEGAME, (long)((Common::FileStream*)out.get())->GetHandle());
+    // The components are serialized into memory, so plugins write into the
+    // temporary file, which contents are then copied to the savegame.
+    String temp_name = String::FromFormat("%s""_tmpplugin.dat", saveGameDirectory);
+    Stream *temp_s = File::OpenFile(temp_name, kFile_CreateAlways, kFile_ReadWrite);
+    if (!temp_s)
+        return new SavegameError(kSvgErr_ComponentSerialization, "Unable to create temporary file for the plugin data.");
+    pl_run_plugin_hooks(AGSE_SAVEGAME, (long)((Common::FileStream*)temp_s)->GetHandle());
+    temp_s->Seek(0, kSeekBegin);
+    char buf[4096];
+    for (size_t read; (read = temp_s->Read(buf, sizeof(buf))) > 0; )
+        out->Write(buf, read);
+    delete temp_s;
+    File::DeleteFile(temp_name);
     return HSaveError::None();
 }
 
@@ -937,6 +965,7 @@ struct ComponentHandler
     int32_t            LowestVersion; // lowest supported version that the engine can read
     HSaveError       (*Serialize)  (PStream);
     HSaveError       (*Unserialize)(PStream, int32_t cmp_ver, const PreservedParams&, RestoredData&);
+    bool               RawData; // the data is read directly from the file, so may not be packed
 };
 
 // Array of supported components
@@ -947,114 +976,130 @@ ComponentHandler ComponentHandlers[] =
         0,
         0,
         WriteGameState,
-        ReadGameState
+        ReadGameState,
+        false
     },
     {
         "Audio",
         0,
         0,
         WriteAudio,
-        ReadAudio
+        ReadAudio,
+        false
     },
     {
         "Characters",
         1,
         0,
         WriteCharacters,
-        ReadCharacters
+        ReadCharacters,
+        false
     },
     {
         "Dialogs",
         0,
         0,
         WriteDialogs,
-        ReadDialogs
+        ReadDialogs,
+        false
     },
     {
         "GUI",
         kGuiSvgVersion_350,
         kGuiSvgVersion_Initial,
         WriteGUI,
-        ReadGUI
+        ReadGUI,
+        false
     },
     {
         "Inventory Items",
         0,
         0,
         WriteInventory,
-        ReadInventory
+        ReadInventory,
+        false
     },
     {
         "Mouse Cursors",
         0,
         0,
         WriteMouseCursors,
-        ReadMouseCursors
+        ReadMouseCursors,
+        false
     },
     {
         "Views",
         0,
         0,
         WriteViews,
-        ReadViews
+        ReadViews,
+        false
     },
     {
         "Dynamic Sprites",
         0,
         0,
         WriteDynamicSprites,
-        ReadDynamicSprites
+        ReadDynamicSprites,
+        false
     },
     {
         "Overlays",
         0,
         0,
         WriteOverlays,
-        ReadOverlays
+        ReadOverlays,
+        false
     },
     {
         "Dynamic Surfaces",
         0,
         0,
         WriteDynamicSurfaces,
-        ReadDynamicSurfaces
+        ReadDynamicSurfaces,
+        false
     },
     {
         "Script Modules",
         0,
         0,
         WriteScriptModules,
-        ReadScriptModules
+        ReadScriptModules,
+        false
     },
     {
         "Room States",
         0,
         0,
         WriteRoomStates,
-        ReadRoomStates
+        ReadRoomStates,
+        false
     },
     {
         "Loaded Room State",
         1,
         0,
         WriteThisRoom,
-        ReadThisRoom
+        ReadThisRoom,
+        false
     },
     {
         "Managed Pool",
         400, // ags4 starts with 400
         400,
         WriteManagedPool,
-        ReadManagedPool
+        ReadManagedPool,
+        false
     },
     {
         "Plugin Data",
         0,
         0,
         WritePluginData,
-        ReadPluginData
+        ReadPluginData,
+        true
     },
-    { NULL, 0, NULL, NULL } // end of array
+    { NULL, 0, 0, NULL, NULL, false } // end of array
 };
 
 
@@ -1096,6 +1141,37 @@ struct ComponentInfo
     ComponentInfo() : Version(-1), Offset(0), DataOffset(0), DataSize(0) {}
 };
 
+// LZW data expands at most this many times: every flag byte is followed by
+// up to 8 codes of 2 bytes, each copying up to 18 bytes
+const soff_t MaxLzwExpansion = 9;
+
+// Reads the packed component data and passes it unpacked to the handler;
+// the handler's own error is returned separately in handler_err
+HSaveError UnserializePacked(PStream in, const ComponentInfo &info, soff_t unpacked_size,
+                             const ComponentHandler &handler, SvgCmpReadHelper &hlp, HSaveError &handler_err)
+{
+    const soff_t packed_size = info.DataSize - (in->GetPosition() - info.DataOffset);
+    if (packed_size <= 0 || packed_size > in->GetLength() - in->GetPosition())
+        return new SavegameError(kSvgErr_InconsistentFormat, String::FromFormat("Invalid packed data size: %lld.", packed_size));
+    if (unpacked_size <= 0 || unpacked_size > packed_size * MaxLzwExpansion || unpacked_size > LONG_MAX)
+        return new SavegameError(kSvgErr_InconsistentFormat, String::FromFormat("Invalid unpacked data size: %lld.", unpacked_size));
+    std::vector<uint8_t> packed_data((size_t)packed_size);
+    if (in->Read(&packed_data.front(), packed_data.size()) != packed_data.size())
+        return new SavegameError(kSvgErr_InconsistentFormat, "Packed data is truncated.");
+    MemoryStream packed_s(&packed_data.front(), packed_data.size());
+    uint8_t *data = lzwexpand_to_mem(&packed_s, (long)unpacked_size);
+    if (!data)
+        return new SavegameError(kSvgErr_InconsistentFormat, "Failed to unpack the data.");
+    PStream data_s(new MemoryStream(data, (size_t)unpacked_size));
+    handler_err = handler.Unserialize(data_s, info.Version, hlp.PP, hlp.RData);
+    const soff_t data_read = data_s->GetPosition();
+    data_s.reset();
+    free(data);
+    if (handler_err && data_read != unpacked_size)
+        return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected unpacked: %lld, actual: %lld", unpacked_size, data_read));
+    return HSaveError::None();
+}
+
 HSaveError ReadComponent(PStream in, SvgCmpReadHelper &hlp, ComponentInfo &info)
 {
     info = ComponentInfo(); // reset in case of early error
@@ -1115,7 +1191,29 @@ HSaveError ReadComponent(PStream in, SvgCmpReadHelper &hlp, ComponentInfo &info)
         return new SavegameError(kSvgErr_UnsupportedComponent);
     if (info.Version > handler->Version || info.Version < handler->LowestVersion)
         return new SavegameError(kSvgErr_UnsupportedComponentVersion, String::FromFormat("Saved version: %d, supported: %d - %d", info.Version, handler->LowestVersion, handler->Version));
-    HSaveError err = handler->Unserialize(in, info.Version, hlp.PP, hlp.RData);
+
+    int32_t packing = kCmpPack_None;
+    soff_t unpacked_size = 0;
+    if (hlp.Version >= kSvgVersion_Cmp_Packed)
+    {
+        packing = in->ReadInt32();
+        unpacked_size = in->ReadInt64();
+    }
+    HSaveError err;
+    if (packing == kCmpPack_None)
+    {
+        err = handler->Unserialize(in, info.Version, hlp.PP, hlp.RData);
+    }
+    else if (packing == kCmpPack_LZW && !handler->RawData)
+    {
+        HSaveError unpack_err = UnserializePacked(in, info, unpacked_size, *handler, hlp, err);
+        if (!unpack_err)
+            return unpack_err;
+    }
+    else
+    {
+        return new SavegameError(kSvgErr_InconsistentFormat, String::FromFormat("Unknown packing method: %d", packing));
+    }
     if (!err)
         return err;
     if (in->GetPosition() - info.DataOffset != info.DataSize)
@@ -1160,28 +1258,23 @@ HSaveError ReadAll(PStream in, SavegameVersion svg_version, const PreservedParam
     return new SavegameError(kSvgErr_ComponentListClosingTagMissing);
 }
 
-HSaveError WriteComponent(PStream out, ComponentHandler &hdlr)
+HSaveError SnapshotComponent(ComponentHandler &hdlr, ComponentData &cmp)
 {
-    WriteFormatTag(out, hdlr.Name, true);
-    out->WriteInt32(hdlr.Version);
-    soff_t ref_pos = out->GetPosition();
-    out->WriteInt64(0); // placeholder for the component size
-    HSaveError err = hdlr.Serialize(out);
-    soff_t end_pos = out->GetPosition();
-    out->Seek(ref_pos, kSeekBegin);
-    out->WriteInt64(end_pos - ref_pos - sizeof(int64_t)); // size of serialized component data
-    out->Seek(end_pos, kSeekBegin);
-    if (err)
-        WriteFormatTag(out, hdlr.Name, false);
-    return err;
+    cmp.Name = hdlr.Name.GetCStr();
+    cmp.Version = hdlr.Version;
+    cmp.RawData = hdlr.RawData;
+    cmp.Data.clear();
+    PStream out(new MemoryStream(cmp.Data, kFile_Write));
+    return hdlr.Serialize(out);
 }
 
-HSaveError WriteAllCommon(PStream out)
+HSaveError SnapshotAllCommon(ComponentDataList &cmps)
 {
-    WriteFormatTag(out, ComponentListTag, true);
+    cmps.resize(0);
     for (int type = 0; !ComponentHandlers[type].Name.IsEmpty(); ++type)
     {
-        HSaveError err = WriteComponent(out, ComponentHandlers[type]);
+        cmps.push_back(ComponentData());
+        HSaveError err = SnapshotComponent(ComponentHandlers[type], cmps.back());
         if (!err)
         {
             return new SavegameError(kSvgErr_ComponentSerialization,
@@ -1190,10 +1283,104 @@ HSaveError WriteAllCommon(PStream out)
         }
         update_polled_stuff_if_runtime();
     }
+    return HSaveError::None();
+}
+
+// Packed data of the components from the previous save, which is reused
+// if the component did not change since
+struct PackedComponent
+{
+    size_t   DataSize;
+    uint64_t DataHash;
+    int32_t  Packing;
+    std::vector<uint8_t> Packed;
+};
+std::map<std::string, PackedComponent> PackCache;
+Mutex PackCacheLock;
+
+// Components smaller than this are not worth packing
+const size_t MinPackedComponentSize = 4096;
+
+uint64_t HashComponentData(const std::vector<uint8_t> &data)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Packs the component's data, or finds the result of packing the same data
+// in the previous save; returns the packed data, or NULL if it is stored as is
+const std::vector<uint8_t> *PackComponent(const ComponentData &cmp)
+{
+    if (cmp.RawData || cmp.Data.size() < MinPackedComponentSize)
+        return NULL;
+
+    const uint64_t hash = HashComponentData(cmp.Data);
+    MutexLock lock(PackCacheLock);
+    PackedComponent &packed = PackCache[cmp.Name];
+    if (packed.DataSize != cmp.Data.size() || packed.DataHash != hash)
+    {
+        packed.DataSize = cmp.Data.size();
+        packed.DataHash = hash;
+        packed.Packed.clear();
+        MemoryStream data_s(&cmp.Data.front(), cmp.Data.size());
+        MemoryStream packed_s(packed.Packed, kFile_Write);
+        lzwcompress(&data_s, &packed_s);
+        // keep the data unpacked if packing did not make it smaller
+        packed.Packing = packed.Packed.size() < cmp.Data.size() ? kCmpPack_LZW : kCmpPack_None;
+        if (packed.Packing == kCmpPack_None)
+            packed.Packed.clear();
+    }
+    return packed.Packing == kCmpPack_LZW ? &packed.Packed : NULL;
+}
+
+HSaveError WriteComponent(PStream out, const ComponentData &cmp)
+{
+    const std::vector<uint8_t> *packed = PackComponent(cmp);
+    const std::vector<uint8_t> &data = packed ? *packed : cmp.Data;
+    const String name = cmp.Name.c_str();
+    WriteFormatTag(out, name, true);
+    out->WriteInt32(cmp.Version);
+    out->WriteInt64(sizeof(int32_t) + sizeof(int64_t) + data.size()); // size of serialized component data
+    out->WriteInt32(packed ? kCmpPack_LZW : kCmpPack_None);
+    out->WriteInt64(cmp.Data.size());
+    if (!data.empty() && out->Write(&data.front(), data.size()) != data.size())
+        return new SavegameError(kSvgErr_ComponentSerialization, "Failed to write component data.");
+    WriteFormatTag(out, name, false);
+    return HSaveError::None();
+}
+
+HSaveError WriteSnapshot(PStream out, const ComponentDataList &cmps)
+{
+    WriteFormatTag(out, ComponentListTag, true);
+    for (size_t i = 0; i < cmps.size(); ++i)
+    {
+        HSaveError err = WriteComponent(out, cmps[i]);
+        if (!err)
+        {
+            return new SavegameError(kSvgErr_ComponentSerialization,
+                String::FromFormat("Component: (#%d) %s", (int)i, cmps[i].Name.c_str()),
+                err);
+        }
+    }
     WriteFormatTag(out, ComponentListTag, false);
     return HSaveError::None();
 }
 
+HSaveError WriteAllCommon(PStream out)
+{
+    ComponentDataList cmps;
+    HSaveError err = SnapshotAllCommon(cmps);
+    if (!err)
+        return err;
+    return WriteSnapshot(out, cmps);
+}
+
 } // namespace SavegameBlocks
 } // namespace Engine
 } // namespace AGS
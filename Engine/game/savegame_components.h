@@ -15,6 +15,8 @@
 #ifndef __AGS_EE_GAME__SAVEGAMECOMPONENTS_H
 #define __AGS_EE_GAME__SAVEGAMECOMPONENTS_H
 
+#include <string>
+#include <vector>
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
 #include "game/savegame.h"
@@ -36,10 +38,25 @@ typedef stdtr1compat::shared_ptr<Stream> PStream;
 
 namespace SavegameComponents
 {
+    // Serialized component, kept in memory until written to the savegame
+    struct ComponentData
+    {
+        std::string Name;       // own copy, not shared with the game thread
+        int32_t     Version;
+        bool        RawData;    // must be written as is, without packing
+        std::vector<uint8_t> Data;
+    };
+    typedef std::vector<ComponentData> ComponentDataList;
+
     // Reads all available components from the stream
     HSaveError    ReadAll(PStream in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data);
     // Writes a full list of common components to the stream
     HSaveError    WriteAllCommon(PStream out);
+    // Serializes a full list of common components into memory
+    HSaveError    SnapshotAllCommon(ComponentDataList &cmps);
+    // Packs serialized components and writes them to the stream; does not
+    // access the game state, and so may be run on any thread
+    HSaveError    WriteSnapshot(PStream out, const ComponentDataList &cmps);
 }
 
 } // namespace Engine
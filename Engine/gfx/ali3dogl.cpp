@@ -1559,6 +1559,33 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
   free(origPtr);
 }
 
+void OGLGraphicsDriver::UpdateTexturePart(OGLTextureTile *tile, const TextureTile &part, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha)
+{
+  int textureHeight = tile->height;
+  int textureWidth = tile->width;
+  AdjustSizeToNearestSupportedByCard(&textureWidth, &textureHeight);
+  // The line below the tile repeats its last line, see UpdateTextureRegion
+  const bool copyLastLine = (textureHeight > tile->height) && (part.y + part.height == tile->y + tile->height);
+  const int partHeight = copyLastLine ? part.height + 1 : part.height;
+
+  char *origPtr = (char*)malloc(sizeof(int) * part.width * partHeight);
+  const int pitch = part.width * sizeof(int);
+  BitmapToVideoMem(bitmap, hasAlpha, &part, target, origPtr, pitch, _filter->UseLinearFiltering());
+
+  if (copyLastLine)
+  {
+    unsigned int* memPtrLong = (unsigned int*)(origPtr + pitch * part.height);
+    unsigned int* memPtrLong_previous = (unsigned int*)(origPtr + pitch * (part.height - 1));
+    for (int x = 0; x < part.width; x++)
+      memPtrLong[x] = memPtrLong_previous[x] & 0x00FFFFFF;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, tile->texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, part.x - tile->x, part.y - tile->y, part.width, partHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+
+  free(origPtr);
+}
+
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
 {
   OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
@@ -1581,6 +1608,30 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
       unselect_palette();
 }
 
+void OGLGraphicsDriver::UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, const Rect &region, bool hasAlpha)
+{
+  OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
+  if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
+    throw Ali3DException("UpdateDDBFromBitmapRegion: mismatched bitmap size");
+  const int color_depth = bitmap->GetColorDepth();
+  if (color_depth != target->_colDepth)
+    throw Ali3DException("UpdateDDBFromBitmapRegion: mismatched colour depths");
+
+  target->_hasAlpha = hasAlpha;
+  if (color_depth == 8)
+      select_palette(palette);
+
+  TextureTile part;
+  for (int i = 0; i < target->_numTiles; i++)
+  {
+    if (GetTilePartInRegion(target->_tiles[i], region, part))
+      UpdateTexturePart(&target->_tiles[i], part, bitmap, target, hasAlpha);
+  }
+
+  if (color_depth == 8)
+      unselect_palette();
+}
+
 int OGLGraphicsDriver::GetCompatibleBitmapFormat(int color_depth)
 {
   if (color_depth == 8)
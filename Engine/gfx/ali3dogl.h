@@ -184,6 +184,7 @@ public:
     virtual int  GetCompatibleBitmapFormat(int color_depth);
     virtual IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque);
     virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha);
+    virtual void UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, const Rect &region, bool hasAlpha);
     virtual void DestroyDDB(IDriverDependantBitmap* bitmap);
     virtual void DrawSprite(int x, int y, IDriverDependantBitmap* bitmap);
     virtual void RenderToBackBuffer();
@@ -319,6 +320,8 @@ private:
     void ReleaseDisplayMode();
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
     void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha);
+    // Updates the part of the tile's texture; the part is in bitmap coordinates
+    void UpdateTexturePart(OGLTextureTile *tile, const TextureTile &part, Bitmap *bitmap, OGLBitmap *target, bool hasAlpha);
     void CreateVirtualScreen();
     void do_fade(bool fadingOut, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     void create_screen_tint_bitmap();
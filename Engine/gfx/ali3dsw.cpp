@@ -383,6 +383,12 @@ void ALSoftwareGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitma
   alSwBmp->_hasAlpha = hasAlpha;
 }
 
+void ALSoftwareGraphicsDriver::UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, const Rect &region, bool hasAlpha)
+{
+  // Software DDB draws straight from the bitmap, so nothing has to be copied
+  UpdateDDBFromBitmap(bitmapToUpdate, bitmap, hasAlpha);
+}
+
 void ALSoftwareGraphicsDriver::DestroyDDB(IDriverDependantBitmap* bitmap)
 {
   delete bitmap;
@@ -153,6 +153,7 @@ public:
     virtual int  GetCompatibleBitmapFormat(int color_depth);
     virtual IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque);
     virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha);
+    virtual void UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, const Rect &region, bool hasAlpha);
     virtual void DestroyDDB(IDriverDependantBitmap* bitmap);
 
     virtual void DrawSprite(int x, int y, IDriverDependantBitmap* bitmap);
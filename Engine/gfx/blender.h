@@ -37,6 +37,8 @@ unsigned long _myblender_color32(unsigned long x, unsigned long y, unsigned long
 unsigned long _myblender_color15_light(unsigned long x, unsigned long y, unsigned long n);
 unsigned long _myblender_color16_light(unsigned long x, unsigned long y, unsigned long n);
 unsigned long _myblender_color32_light(unsigned long x, unsigned long y, unsigned long n);
+// Allegro's 24-bit translucency blender which keeps the alpha of the image
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n);
 // Customizable alpha blender that uses the supplied alpha value as src alpha,
 // and preserves destination's alpha channel (if there was one);
 void set_my_trans_blender(int r, int g, int b, int a);
@@ -18,6 +18,7 @@
 #include "gfx/gfxfilter.h"
 #include "gfx/gfxdriverbase.h"
 #include "gfx/gfx_util.h"
+#include "util/math.h"
 
 using namespace AGS::Common;
 
@@ -278,6 +279,21 @@ __inline void get_pixel_if_not_transparent32(unsigned int *pixel, unsigned int *
     ( (((a) & 0xFF) << _vmem_a_shift_32) | (((r) & 0xFF) << _vmem_r_shift_32) | (((g) & 0xFF) << _vmem_g_shift_32) | (((b) & 0xFF) << _vmem_b_shift_32) )
 
 
+bool VideoMemoryGraphicsDriver::GetTilePartInRegion(const TextureTile &tile, const Rect &region, TextureTile &part)
+{
+  const int left = Math::Max(tile.x, region.Left);
+  const int top = Math::Max(tile.y, region.Top);
+  const int right = Math::Min(tile.x + tile.width, region.Right + 1);
+  const int bottom = Math::Min(tile.y + tile.height, region.Bottom + 1);
+  if (left >= right || top >= bottom)
+    return false;
+  part.x = left;
+  part.y = top;
+  part.width = right - left;
+  part.height = bottom - top;
+  return true;
+}
+
 void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const bool has_alpha, const TextureTile *tile, const VideoMemDDB *target,
                                                  char *dst_ptr, const int dst_pitch, const bool usingLinearFiltering)
 {
@@ -195,6 +195,9 @@ protected:
     // Prepares bitmap to be applied to the texture, copies pixels to the provided buffer
     void BitmapToVideoMem(const Bitmap *bitmap, const bool has_alpha, const TextureTile *tile, const VideoMemDDB *target,
                             char *dst_ptr, const int dst_pitch, const bool usingLinearFiltering);
+    // Gets the part of the tile which is inside the bitmap region;
+    // returns false if there is none
+    static bool GetTilePartInRegion(const TextureTile &tile, const Rect &region, TextureTile &part);
 
     // Stage virtual screen is used to let plugins draw custom graphics
     // in between render stages (between room and GUI, after GUI, and so on)
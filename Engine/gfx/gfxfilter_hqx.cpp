@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <string.h>
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/hq2x3x.h"
@@ -27,14 +28,27 @@ using namespace Common;
 
 const GfxFilterInfo HqxGfxFilter::FilterInfo = GfxFilterInfo("Hqx", "Hqx (High Quality)", 2, 3);
 
+// Upper limit of the worker threads helping the main thread
+const int MaxHqxWorkers = 7;
+// Least number of source rows worth giving to a separate job
+const int MinHqxBandHeight = 8;
+
 HqxGfxFilter::HqxGfxFilter()
     : _pfnHqx(NULL)
     , _hqxScalingBuffer(NULL)
+    , _nextJob(0)
+    , _jobSource(NULL)
+#if defined(AGS_HQX_WORKER_THREADS)
+    , _frameIndex(0)
+    , _busyWorkers(0)
+    , _stopWorkers(false)
+#endif
 {
 }
 
 HqxGfxFilter::~HqxGfxFilter()
 {
+    StopWorkers();
     delete _hqxScalingBuffer;
 }
 
@@ -61,17 +75,22 @@ Bitmap* HqxGfxFilter::InitVirtualScreen(Bitmap *screen, const Size src_size, con
     int min_scaling = Math::Min(dst_rect.GetWidth() / src_size.Width, dst_rect.GetHeight() / src_size.Height);
     min_scaling = Math::Clamp(min_scaling, 2, 3);
     if (min_scaling == 2)
-        _pfnHqx = hq2x_32;
+        _pfnHqx = hq2x_32_region;
     else
-        _pfnHqx = hq3x_32;
+        _pfnHqx = hq3x_32_region;
     _hqxScalingBuffer = BitmapHelper::CreateBitmap(src_size.Width * min_scaling, src_size.Height * min_scaling);
+    // the new buffer has to be scaled whole
+    _lastFrame.clear();
+    _lastFrameSize = Size();
 
     InitLUTs();
+    StartWorkers();
     return virtual_screen;
 }
 
 Bitmap *HqxGfxFilter::ShutdownAndReturnRealScreen()
 {
+    StopWorkers();
     Bitmap *real_screen = AllegroGfxFilter::ShutdownAndReturnRealScreen();
     delete _hqxScalingBuffer;
     _hqxScalingBuffer = NULL;
@@ -80,13 +99,192 @@ Bitmap *HqxGfxFilter::ShutdownAndReturnRealScreen()
 
 Bitmap *HqxGfxFilter::PreRenderPass(Bitmap *toRender)
 {
+    MakeJobs(toRender);
+    if (_jobs.empty())
+        return _hqxScalingBuffer;
+
     _hqxScalingBuffer->Acquire();
-    _pfnHqx(toRender->GetDataForWriting(), _hqxScalingBuffer->GetDataForWriting(),
-        toRender->GetWidth(), toRender->GetHeight(), _hqxScalingBuffer->GetLineLength());
+    _jobSource = toRender->GetDataForWriting();
+    _nextJob = 0;
+#if defined(AGS_HQX_WORKER_THREADS)
+    if (_jobs.size() > 1 && !_workers.empty())
+    {
+        std::unique_lock<std::mutex> lock(_workMutex);
+        _busyWorkers = (int)_workers.size();
+        _frameIndex++;
+        lock.unlock();
+        _workCond.notify_all();
+        RunJobs();
+        lock.lock();
+        while (_busyWorkers > 0)
+            _doneCond.wait(lock);
+    }
+    else
+#endif
+    {
+        RunJobs();
+    }
     _hqxScalingBuffer->Release();
     return _hqxScalingBuffer;
 }
 
+void HqxGfxFilter::MakeJobs(Bitmap *toRender)
+{
+    const int width = toRender->GetWidth();
+    const int height = toRender->GetHeight();
+    _jobs.clear();
+    _changedSpans.resize(height);
+    if (_lastFrameSize.Width != width || _lastFrameSize.Height != height)
+    {
+        _lastFrame.resize(width * height);
+        _lastFrameSize = Size(width, height);
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(&_lastFrame[y * width], toRender->GetScanLine(y), width * sizeof(uint32_t));
+            _changedSpans[y] = std::make_pair(0, width - 1);
+        }
+    }
+    else
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            const uint32_t *now = (const uint32_t*)toRender->GetScanLine(y);
+            uint32_t *was = &_lastFrame[y * width];
+            if (memcmp(now, was, width * sizeof(uint32_t)) == 0)
+            {
+                _changedSpans[y] = std::make_pair(0, -1);
+                continue;
+            }
+            int first = 0;
+            int last = width - 1;
+            for (; now[first] == was[first]; ++first);
+            for (; now[last] == was[last]; --last);
+            memcpy(was + first, now + first, (last - first + 1) * sizeof(uint32_t));
+            _changedSpans[y] = std::make_pair(first, last);
+        }
+    }
+
+    // Every scaled pixel depends on the source pixel and its 8 neighbours,
+    // so the changed spans are widened by a pixel on each side, and
+    // consecutive lines that have to be scaled are joined into one region
+    std::vector<Rect> regions;
+    int total_rows = 0;
+    for (int y = 0; y < height; ++y)
+    {
+        int first = width;
+        int last = -1;
+        for (int line = Math::Max(y - 1, 0); line <= Math::Min(y + 1, height - 1); ++line)
+        {
+            if (_changedSpans[line].first > _changedSpans[line].second)
+                continue;
+            first = Math::Min(first, _changedSpans[line].first - 1);
+            last = Math::Max(last, _changedSpans[line].second + 1);
+        }
+        if (last < 0)
+            continue;
+        first = Math::Max(first, 0);
+        last = Math::Min(last, width - 1);
+        if (!regions.empty() && regions.back().Bottom == y - 1)
+        {
+            Rect &rc = regions.back();
+            rc.Left = Math::Min(rc.Left, first);
+            rc.Right = Math::Max(rc.Right, last);
+            rc.Bottom = y;
+        }
+        else
+        {
+            regions.push_back(Rect(first, y, last, y));
+        }
+        total_rows++;
+    }
+
+    // Split the regions into bands, about two per thread, so that a thread
+    // which gets done early may take another one
+#if defined(AGS_HQX_WORKER_THREADS)
+    const int thread_count = (int)_workers.size() + 1;
+#else
+    const int thread_count = 1;
+#endif
+    const int band_height = Math::Max(MinHqxBandHeight, (total_rows + thread_count * 2 - 1) / (thread_count * 2));
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        const Rect &rc = regions[i];
+        for (int y = rc.Top; y <= rc.Bottom; y += band_height)
+            _jobs.push_back(Rect(rc.Left, y, rc.Right, Math::Min(y + band_height - 1, rc.Bottom)));
+    }
+}
+
+void HqxGfxFilter::RunJobs()
+{
+    const int src_w = _lastFrameSize.Width;
+    const int src_h = _lastFrameSize.Height;
+    unsigned char *dst = _hqxScalingBuffer->GetDataForWriting();
+    const int bpl = _hqxScalingBuffer->GetLineLength();
+    for (int job = _nextJob++; job < (int)_jobs.size(); job = _nextJob++)
+    {
+        const Rect &rc = _jobs[job];
+        _pfnHqx(_jobSource, dst, src_w, src_h, bpl, rc.Left, rc.Top, rc.GetWidth(), rc.GetHeight());
+    }
+}
+
+#if defined(AGS_HQX_WORKER_THREADS)
+
+void HqxGfxFilter::StartWorkers()
+{
+    StopWorkers();
+    const int worker_count = Math::Min<int>(std::thread::hardware_concurrency(), MaxHqxWorkers + 1) - 1;
+    _stopWorkers = false;
+    for (int i = 0; i < worker_count; ++i)
+        _workers.push_back(std::thread(&HqxGfxFilter::WorkerLoop, this, _frameIndex));
+}
+
+void HqxGfxFilter::StopWorkers()
+{
+    if (_workers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(_workMutex);
+        _stopWorkers = true;
+    }
+    _workCond.notify_all();
+    for (size_t i = 0; i < _workers.size(); ++i)
+        _workers[i].join();
+    _workers.clear();
+}
+
+void HqxGfxFilter::WorkerLoop(unsigned last_frame)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_workMutex);
+            while (!_stopWorkers && _frameIndex == last_frame)
+                _workCond.wait(lock);
+            if (_stopWorkers)
+                return;
+            last_frame = _frameIndex;
+        }
+        RunJobs();
+        {
+            std::lock_guard<std::mutex> lock(_workMutex);
+            _busyWorkers--;
+        }
+        _doneCond.notify_one();
+    }
+}
+
+#else // !AGS_HQX_WORKER_THREADS
+
+void HqxGfxFilter::StartWorkers()
+{
+}
+
+void HqxGfxFilter::StopWorkers()
+{
+}
+
+#endif // !AGS_HQX_WORKER_THREADS
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
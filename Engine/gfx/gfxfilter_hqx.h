@@ -12,15 +12,31 @@
 //
 //=============================================================================
 //
-// High quality x2 scaling filter
+// High quality x2 and x3 scaling filter. The frame is scaled in horizontal
+// bands on several threads, and only the parts of it which have changed
+// since the last frame are scaled again.
 //
 //=============================================================================
 
 #ifndef __AGS_EE_GFX__HQ2XGFXFILTER_H
 #define __AGS_EE_GFX__HQ2XGFXFILTER_H
 
+#include <atomic>
+#include <vector>
 #include "gfx/gfxfilter_allegro.h"
 
+// The frame is only scaled on several threads where the standard library
+// provides them; elsewhere the main thread scales it all
+#if !defined(PSP_VERSION) && !defined(WII_VERSION)
+#define AGS_HQX_WORKER_THREADS
+#endif
+
+#if defined(AGS_HQX_WORKER_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
 namespace AGS
 {
 namespace Engine
@@ -45,10 +61,46 @@ public:
 protected:
     virtual Bitmap *PreRenderPass(Bitmap *toRender);
 
-    typedef void (*PfnHqx)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl);
+    typedef void (*PfnHqx)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl,
+        int x, int y, int width, int height);
 
     PfnHqx  _pfnHqx;
     Bitmap *_hqxScalingBuffer;
+
+private:
+    // Compares the frame with the last one and makes the scaling jobs for
+    // the parts of it that have changed
+    void MakeJobs(Bitmap *toRender);
+    // Scales the frame regions from the job list until there are none left
+    void RunJobs();
+    void StartWorkers();
+    void StopWorkers();
+#if defined(AGS_HQX_WORKER_THREADS)
+    // Waits for the frames after the given one and helps scaling them
+    void WorkerLoop(unsigned last_frame);
+#endif
+
+    // Copy of the last scaled frame; only the regions that differ from it
+    // are scaled again, the rest of the scaling buffer is kept
+    std::vector<uint32_t> _lastFrame;
+    Size                  _lastFrameSize;
+    // First and last changed pixel of every source line, or [0, -1] when
+    // the line did not change since the last frame
+    std::vector<std::pair<int, int> > _changedSpans;
+    // Horizontal bands of the frame that have to be scaled
+    std::vector<Rect>     _jobs;
+    std::atomic<int>      _nextJob;
+    unsigned char        *_jobSource;
+
+#if defined(AGS_HQX_WORKER_THREADS)
+    std::vector<std::thread> _workers;
+    std::mutex               _workMutex;
+    std::condition_variable  _workCond;
+    std::condition_variable  _doneCond;
+    unsigned                 _frameIndex;
+    int                      _busyWorkers;
+    bool                     _stopWorkers;
+#endif
 };
 
 } // namespace ALSW
@@ -119,6 +119,10 @@ public:
   virtual int  GetCompatibleBitmapFormat(int color_depth) = 0;
   virtual IDriverDependantBitmap* CreateDDBFromBitmap(Common::Bitmap *bitmap, bool hasAlpha, bool opaque = false) = 0;
   virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha) = 0;
+  // Updates only the given part of the DDB from the same part of the bitmap. Meant for
+  // the opaque DDBs: for the others, the transparent pixels outside of the region keep
+  // the colours they were given for linear filtering from their old neighbours.
+  virtual void UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, const Rect &region, bool hasAlpha) = 0;
   virtual void DestroyDDB(IDriverDependantBitmap* bitmap) = 0;
 
   // Prepares next sprite batch, a list of sprites with defined viewport and optional
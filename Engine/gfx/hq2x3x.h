@@ -19,10 +19,21 @@
 void InitLUTs(){}
 void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
 void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
+void hq2x_32_region( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL,
+                     int x, int y, int width, int height ){}
+void hq3x_32_region( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL,
+                     int x, int y, int width, int height ){}
 #else
 void InitLUTs();
 void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL );
 void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL );
+// Scale only the given source region; the source pixels around it are still
+// read, and the destination outside of the scaled region is left untouched.
+// Different regions of one image may be scaled on several threads at once.
+void hq2x_32_region( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL,
+                     int x, int y, int width, int height );
+void hq3x_32_region( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL,
+                     int x, int y, int width, int height );
 #endif
 
 #endif // __AC_HQ2X3X_H
\ No newline at end of file
@@ -0,0 +1,280 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <allegro.h>
+#include "gfx/tint.h"
+#include "util/math.h"
+#include "util/simd.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace Tint
+{
+
+// Number of tint tables kept; a room rarely has more distinct tints at once
+const int TableCacheSize = 8;
+// Pixels of a 32-bit line are tinted in parts of this size
+const int TintChunk = 256;
+
+Table TableCache[TableCacheSize];
+int   TableCacheUsed = 0;
+int   TableCacheNext = 0;
+
+
+inline int expand5(int v) { return (v << 3) | (v >> 2); }
+inline int expand6(int v) { return (v << 2) | (v >> 4); }
+
+// Gets the brightness of a 15- or 16-bit pixel, as 8-bit value
+inline int brightness16(uint32_t c, const PixelFormat &format)
+{
+    const int r = expand5((c >> format.RShift) & 0x1F);
+    const int b = expand5((c >> format.BShift) & 0x1F);
+    const int g = format.ColorDepth == 16 ? expand6((c >> format.GShift) & 0x3F) : expand5((c >> format.GShift) & 0x1F);
+    return Math::Max(r, Math::Max(g, b));
+}
+
+// Same as Allegro's _blender_trans15 and _blender_trans16
+inline uint32_t blend16(uint32_t x, uint32_t y, int n, int color_depth)
+{
+    const uint32_t mask = color_depth == 16 ? 0x7E0F81F : 0x3E07C1F;
+    x = ((x & 0xFFFF) | (x << 16)) & mask;
+    y = ((y & 0xFFFF) | (y << 16)) & mask;
+    const uint32_t result = ((x - y) * n / 32 + y) & mask;
+    return (result & 0xFFFF) | (result >> 16);
+}
+
+// Blends the 15- or 16-bit pixels with their colors from the table, or the
+// single color if there is no table given
+static void blend_line16(const uint32_t *table, uint32_t color, const uint16_t *src, uint16_t *dst,
+    int width, const PixelFormat &format, int amount)
+{
+    const int n = amount ? (Math::Min(amount, FullAmount) + 1) / 8 : 0;
+    for (int i = 0; i < width; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c == format.MaskColor)
+            dst[i] = (uint16_t)c;
+        else
+            dst[i] = (uint16_t)blend16(table ? table[brightness16(c, format)] : color, c, n, format.ColorDepth);
+    }
+}
+
+// Blends every byte of the pixels with those of the colors, or the single
+// color if there are no colors given; n is the weight of the color, 0 - 256.
+// The alpha of the source pixels is kept. The result is the same as of the
+// 32-bit translucency blender (_myblender_alpha_trans24), whose packed
+// arithmetic rounds the third byte with the second byte of the pixel.
+static void blend_line32(const uint32_t *colors, uint32_t color, const uint32_t *src, uint32_t *dst,
+    int width, const PixelFormat &format, int n)
+{
+    const uint32_t alpha_mask = 0xFFu << format.AShift;
+    int i = 0;
+#if defined(AGS_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i third_byte = _mm_set_epi16(0, -1, 0, 0, 0, -1, 0, 0);
+    const __m128i weight = _mm_set1_epi16((short)n);
+    const __m128i inv_weight = _mm_set1_epi16((short)(256 - n));
+    const __m128i amask = _mm_set1_epi32((int)alpha_mask);
+    const __m128i mask_color = _mm_set1_epi32((int)format.MaskColor);
+    const __m128i single = _mm_set1_epi32((int)color);
+    for (; i + 4 <= width; i += 4)
+    {
+        const __m128i y = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128i x = colors ? _mm_loadu_si128((const __m128i*)(colors + i)) : single;
+        const __m128i y_lo = _mm_unpacklo_epi8(y, zero);
+        const __m128i y_hi = _mm_unpackhi_epi8(y, zero);
+        // x * n + y * (256 - n), plus the rounding, never exceeds 16 bits
+        const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), weight),
+            _mm_mullo_epi16(y_lo, inv_weight)),
+            _mm_and_si128(_mm_slli_epi64(y_lo, 16), third_byte)), 8);
+        const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), weight),
+            _mm_mullo_epi16(y_hi, inv_weight)),
+            _mm_and_si128(_mm_slli_epi64(y_hi, 16), third_byte)), 8);
+        __m128i res = _mm_or_si128(_mm_andnot_si128(amask, _mm_packus_epi16(lo, hi)), _mm_and_si128(amask, y));
+        const __m128i is_mask = _mm_cmpeq_epi32(y, mask_color);
+        res = _mm_or_si128(_mm_and_si128(is_mask, y), _mm_andnot_si128(is_mask, res));
+        _mm_storeu_si128((__m128i*)(dst + i), res);
+    }
+#elif defined(AGS_SIMD_NEON)
+    const uint16_t third_byte_lanes[8] = { 0, 0, 0xFFFF, 0, 0, 0, 0xFFFF, 0 };
+    const uint16x8_t third_byte = vld1q_u16(third_byte_lanes);
+    const uint16x8_t inv_weight = vdupq_n_u16((uint16_t)(256 - n));
+    const uint32x4_t amask = vdupq_n_u32(alpha_mask);
+    const uint32x4_t mask_color = vdupq_n_u32(format.MaskColor);
+    const uint32x4_t single = vdupq_n_u32(color);
+    for (; i + 4 <= width; i += 4)
+    {
+        const uint32x4_t y = vld1q_u32(src + i);
+        const uint32x4_t x = colors ? vld1q_u32(colors + i) : single;
+        const uint8x16_t y8 = vreinterpretq_u8_u32(y);
+        const uint8x16_t x8 = vreinterpretq_u8_u32(x);
+        const uint16x8_t y_lo = vmovl_u8(vget_low_u8(y8));
+        const uint16x8_t y_hi = vmovl_u8(vget_high_u8(y8));
+        const uint16x8_t round_lo = vandq_u16(vreinterpretq_u16_u64(vshlq_n_u64(vreinterpretq_u64_u16(y_lo), 16)), third_byte);
+        const uint16x8_t round_hi = vandq_u16(vreinterpretq_u16_u64(vshlq_n_u64(vreinterpretq_u64_u16(y_hi), 16)), third_byte);
+        const uint16x8_t lo = vaddq_u16(vmlaq_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(x8)), (uint16_t)n), y_lo, inv_weight), round_lo);
+        const uint16x8_t hi = vaddq_u16(vmlaq_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(x8)), (uint16_t)n), y_hi, inv_weight), round_hi);
+        const uint32x4_t blend = vreinterpretq_u32_u8(vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+        const uint32x4_t res = vbslq_u32(amask, y, blend);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(y, mask_color), y, res));
+    }
+#endif
+    for (; i < width; ++i)
+    {
+        const uint32_t y = src[i];
+        if (y == format.MaskColor)
+        {
+            dst[i] = y;
+            continue;
+        }
+        const uint32_t x = colors ? colors[i] : color;
+        const uint32_t rb = (((x & 0xFF00FF) - (y & 0xFF00FF)) * (uint32_t)n / 256 + (y & 0xFFFFFF)) & 0xFF00FF;
+        const uint32_t g = (((x & 0xFF00) - (y & 0xFF00)) * (uint32_t)n / 256 + (y & 0xFF00)) & 0xFF00;
+        dst[i] = ((rb | g) & ~alpha_mask) | (y & alpha_mask);
+    }
+}
+
+// Gets the weight of the color in a 32-bit blend, the same as Allegro's
+// translucency blender uses
+inline int weight32(int amount)
+{
+    return amount ? Math::Min(amount + 1, 256) : 0;
+}
+
+bool IsSupported(int color_depth)
+{
+    return color_depth == 15 || color_depth == 16 || color_depth == 32;
+}
+
+PixelFormat GetPixelFormat(int color_depth)
+{
+    PixelFormat format = {};
+    format.ColorDepth = color_depth;
+    switch (color_depth)
+    {
+    case 15:
+        format.RShift = _rgb_r_shift_15; format.GShift = _rgb_g_shift_15; format.BShift = _rgb_b_shift_15;
+        format.MaskColor = MASK_COLOR_15;
+        break;
+    case 16:
+        format.RShift = _rgb_r_shift_16; format.GShift = _rgb_g_shift_16; format.BShift = _rgb_b_shift_16;
+        format.MaskColor = MASK_COLOR_16;
+        break;
+    case 32:
+        format.RShift = _rgb_r_shift_32; format.GShift = _rgb_g_shift_32; format.BShift = _rgb_b_shift_32;
+        format.AShift = _rgb_a_shift_32;
+        format.MaskColor = MASK_COLOR_32;
+        break;
+    }
+    return format;
+}
+
+void MakeTable(Table &table, const PixelFormat &format, int red, int green, int blue, int luminance)
+{
+    table.Format = format;
+    table.Red = red;
+    table.Green = green;
+    table.Blue = blue;
+    table.Luminance = luminance;
+
+    // The tint color is taken in the image format, as the blenders did
+    const int depth = format.ColorDepth;
+    const int tint = makecol_depth(depth, red, green, blue);
+    float th, ts, tv;
+    rgb_to_hsv(getr_depth(depth, tint), getg_depth(depth, tint), getb_depth(depth, tint), &th, &ts, &tv);
+    for (int i = 0; i < 256; ++i)
+    {
+        float h, s, v;
+        rgb_to_hsv(i, i, i, &h, &s, &v);
+        if (luminance < 250)
+        {
+            v -= (1.0 - ((float)luminance / 250.0));
+            if (v < 0.0) v = 0.0;
+        }
+        int r, g, b;
+        hsv_to_rgb(th, ts, v, &r, &g, &b);
+        if (depth == 32)
+            table.Colors[i] = (r << format.RShift) | (g << format.GShift) | (b << format.BShift);
+        else
+            table.Colors[i] = makecol_depth(depth, r, g, b);
+    }
+}
+
+const Table &GetTable(int color_depth, int red, int green, int blue, int luminance)
+{
+    // Any luminance from 250 up leaves the brightness as it is
+    luminance = Math::Min(luminance, 250);
+    const PixelFormat format = GetPixelFormat(color_depth);
+    for (int i = 0; i < TableCacheUsed; ++i)
+    {
+        const Table &t = TableCache[i];
+        if (t.Red == red && t.Green == green && t.Blue == blue && t.Luminance == luminance &&
+            t.Format.ColorDepth == format.ColorDepth && t.Format.RShift == format.RShift &&
+            t.Format.GShift == format.GShift && t.Format.BShift == format.BShift)
+            return t;
+    }
+
+    Table &table = TableCache[TableCacheNext];
+    TableCacheNext = (TableCacheNext + 1) % TableCacheSize;
+    TableCacheUsed = Math::Min(TableCacheUsed + 1, TableCacheSize);
+    MakeTable(table, format, red, green, blue, luminance);
+    return table;
+}
+
+void TintLine(const uint8_t *src, uint8_t *dst, int width, const Table &table, int amount)
+{
+    const PixelFormat &format = table.Format;
+    if (format.ColorDepth != 32)
+    {
+        blend_line16(table.Colors, 0, (const uint16_t*)src, (uint16_t*)dst, width, format, amount);
+        return;
+    }
+
+    const uint32_t *src32 = (const uint32_t*)src;
+    uint32_t *dst32 = (uint32_t*)dst;
+    uint32_t colors[TintChunk];
+    for (int x = 0; x < width; x += TintChunk)
+    {
+        const int count = Math::Min(width - x, TintChunk);
+        for (int i = 0; i < count; ++i)
+        {
+            const uint32_t c = src32[x + i];
+            const int r = (c >> format.RShift) & 0xFF;
+            const int g = (c >> format.GShift) & 0xFF;
+            const int b = (c >> format.BShift) & 0xFF;
+            colors[i] = table.Colors[Math::Max(r, Math::Max(g, b))];
+        }
+        blend_line32(colors, 0, src32 + x, dst32 + x, count, format, weight32(amount));
+    }
+}
+
+void LightLine(const uint8_t *src, uint8_t *dst, int width, const PixelFormat &format, uint32_t color, int amount)
+{
+    if (format.ColorDepth == 32)
+        blend_line32(NULL, color, (const uint32_t*)src, (uint32_t*)dst, width, format, weight32(amount));
+    else
+        blend_line16(NULL, color, (const uint16_t*)src, (uint16_t*)dst, width, format, amount);
+}
+
+} // namespace Tint
+
+} // namespace Engine
+} // namespace AGS
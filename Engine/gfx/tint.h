@@ -0,0 +1,82 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Software tinting and lighting of hi-color images.
+//
+// A tinted pixel takes the hue and saturation of the tint color, and keeps
+// its own brightness, which is the highest of its components. The result
+// thus depends only on the brightness, and every tint is made into a table
+// of 256 colors once, instead of converting each pixel to HSV and back.
+// Light levels and partial tints blend the pixels with another color, the
+// same way as Allegro's translucency blenders do; for 32-bit images this is
+// done with SSE2 or NEON when available. Pixels of mask color are kept.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__TINT_H
+#define __AGS_EE_GFX__TINT_H
+
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace Tint
+{
+    // Blend amount which replaces the pixels with the tinted ones
+    const int FullAmount = 256;
+
+    struct PixelFormat
+    {
+        int      ColorDepth;
+        int      RShift;
+        int      GShift;
+        int      BShift;
+        int      AShift;
+        uint32_t MaskColor;
+    };
+
+    // Tinted color for every pixel brightness
+    struct Table
+    {
+        PixelFormat Format;
+        int         Red;
+        int         Green;
+        int         Blue;
+        int         Luminance;
+        uint32_t    Colors[256]; // in the image format, alpha not set
+    };
+
+    // Tells if the images of the given color depth may be tinted
+    bool IsSupported(int color_depth);
+    // Gets the pixel format Allegro uses for the color depth
+    PixelFormat GetPixelFormat(int color_depth);
+    // Makes the table for the tint color; the tinted pixels are darkened if
+    // the luminance is below 250
+    void MakeTable(Table &table, const PixelFormat &format, int red, int green, int blue, int luminance);
+    // Gets the table from the few most recently used ones, or makes it
+    const Table &GetTable(int color_depth, int red, int green, int blue, int luminance);
+
+    // Blends the line with its tinted pixels; amount is the translucency of
+    // the tint, in the same range as Allegro's blenders use, or FullAmount
+    void TintLine(const uint8_t *src, uint8_t *dst, int width, const Table &table, int amount);
+    // Blends the line with the color, given in the image format
+    void LightLine(const uint8_t *src, uint8_t *dst, int width, const PixelFormat &format, uint32_t color, int amount);
+} // namespace Tint
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__TINT_H
@@ -27,6 +27,7 @@ struct ALOGG_OGG {
   void *data;                      /* ogg data */
   char *data_cursor;               /* pointer to data being read */
   int data_len;                    /* size of the data */
+  ALOGG_OGG_SOURCE source;         /* custom data source, if not buffered */
   /* decoder info */
   OggVorbis_File vf;
   int current_section;
@@ -150,6 +151,36 @@ ov_callbacks _alogg_ogg_callbacks = {
 };
 
 
+/* callbacks used to read from a custom data source */
+
+size_t _alogg_ogg_source_read(void *ptr, size_t size, size_t nmemb, void *datasource) {
+  ALOGG_OGG *ogg = (ALOGG_OGG *)datasource;
+  return ogg->source.read(ptr, size, nmemb, ogg->source.source);
+}
+
+int _alogg_ogg_source_seek(void *datasource, ogg_int64_t offset, int whence) {
+  ALOGG_OGG *ogg = (ALOGG_OGG *)datasource;
+  return ogg->source.seek(ogg->source.source, (long)offset, whence);
+}
+
+int _alogg_ogg_source_close(void *datasource) {
+  ALOGG_OGG *ogg = (ALOGG_OGG *)datasource;
+  return ogg->source.close(ogg->source.source);
+}
+
+long _alogg_ogg_source_tell(void *datasource) {
+  ALOGG_OGG *ogg = (ALOGG_OGG *)datasource;
+  return ogg->source.tell(ogg->source.source);
+}
+
+ov_callbacks _alogg_ogg_source_callbacks = {
+  &_alogg_ogg_source_read,
+  &_alogg_ogg_source_seek,
+  &_alogg_ogg_source_close,
+  &_alogg_ogg_source_tell
+};
+
+
 /* function called in an interrupt */
 
 static void alogg_autopoll_ogg(void *ogg) {
@@ -247,6 +278,51 @@ ALOGG_OGG *alogg_create_ogg_from_file(FILE *f) {
 }
 
 
+/* the data is read through the source while the ogg is being decoded, so
+   it does not have to be in memory at once; on failure the source is not
+   closed, this is left to the caller */
+ALOGG_OGG *alogg_create_ogg_from_source(const ALOGG_OGG_SOURCE *source, int data_len) {
+  ALOGG_OGG *ogg;
+  vorbis_info *vi;
+  int ret;
+
+  /* create a new ogg struct */
+  ogg = (ALOGG_OGG *)malloc(sizeof(ALOGG_OGG));
+  if (ogg == NULL)
+    return NULL;
+
+  /* fill in the ogg struct */
+  ogg->data = NULL;
+  ogg->data_cursor = NULL;
+  ogg->data_len = data_len;
+  ogg->source = *source;
+  memset((void *)&ogg->vf, 0, sizeof(ogg->vf));
+  ogg->audiostream = NULL;
+  ogg->loop = FALSE;
+  ogg->auto_polling = FALSE;
+  ogg->current_section = -1;
+
+  /* use vorbisfile to open it */
+  ret = ov_open_callbacks((void *)ogg, &(ogg->vf), NULL, 0, _alogg_ogg_source_callbacks);
+
+  /* if error */
+  if (ret < 0) {
+    free((void *)ogg);
+    return NULL;
+  }
+
+  /* get audio info */
+  vi = ov_info(&(ogg->vf), -1);
+  if (vi->channels > 1)
+    ogg->stereo = TRUE;
+  else
+    ogg->stereo = FALSE;
+  ogg->freq = vi->rate;
+ 
+  return ogg;
+}
+
+
 void alogg_destroy_ogg(ALOGG_OGG *ogg) {
   if (ogg == NULL)
     return;
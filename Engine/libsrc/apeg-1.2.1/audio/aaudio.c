@@ -30,6 +30,37 @@ int _apeg_audio_get_position(APEG_LAYER *layer)
 	return np;
 }
 
+/* Returns the time of the audio sample being played, in seconds, or a
+ * negative value if the stream has no audio */
+double apeg_get_audio_time(APEG_STREAM *stream)
+{
+	APEG_LAYER *layer = (APEG_LAYER*)stream;
+	int played, hs, pos;
+
+	if(!(layer->stream.flags&APEG_HAS_AUDIO) || layer->stream.audio.freq <= 0)
+		return -1.0;
+
+	played = layer->audio.pos;
+	if(!layer->audio.callback && layer->audio.stream)
+	{
+		/* audio.pos is where the half of the voice buffer that is waiting to
+		 * be refilled begins; once the voice gets to the other half, that
+		 * half is being played instead */
+		hs = layer->audio.stream->len/2;
+		pos = voice_get_position(layer->audio.voice);
+		if(pos >= 0)
+		{
+			if((pos >= hs) != (layer->audio.buf_segment != 0))
+				played += hs;
+			played += pos % hs;
+		}
+	}
+
+	if(played < 0)
+		played = 0;
+	return (double)played / (double)layer->stream.audio.freq;
+}
+
 void _apeg_audio_set_speed_multiple(APEG_LAYER *layer, float multiple)
 {
 	if(layer->audio.stream)
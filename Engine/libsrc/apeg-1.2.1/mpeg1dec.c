@@ -441,6 +441,61 @@ int apeg_advance_stream(APEG_STREAM *stream, int loop)
 	return ret;
 }
 
+int apeg_poll_audio(APEG_STREAM *stream)
+{
+	APEG_LAYER *layer = (APEG_LAYER*)stream;
+	int ret;
+
+	if((ret = setjmp(jmp_buffer)) != 0)
+		return ret;
+
+	if(!(layer->stream.flags&APEG_HAS_AUDIO) || layer->multiple <= 0.0)
+		return APEG_EOF;
+
+	layer->stream.audio.flushed = FALSE;
+	return _apeg_audio_poll(layer);
+}
+
+int apeg_decode_video_frame(APEG_STREAM *stream)
+{
+	APEG_LAYER *layer = (APEG_LAYER*)stream;
+	unsigned char **picture = NULL;
+	int ret;
+
+	if((ret = setjmp(jmp_buffer)) != 0)
+		return ret;
+
+	if(!(layer->stream.flags&APEG_HAS_VIDEO))
+		return APEG_EOF;
+
+	while(!picture)
+	{
+		if((layer->stream.flags&APEG_MPG_VIDEO))
+		{
+			if(apeg_get_header(layer) == 1)
+				picture = apeg_get_frame(layer);
+			// If end of stream, display the last frame
+			else if(!layer->got_last)
+			{
+				layer->got_last = TRUE;
+				picture = layer->backward_frame;
+			}
+			else
+				return APEG_EOF;
+		}
+		else
+		{
+			picture = altheora_get_frame(layer);
+			if(!picture)
+				return APEG_EOF;
+		}
+	}
+
+	++(layer->stream.frame);
+	apeg_display_frame(layer, picture);
+	return APEG_OK;
+}
+
 int apeg_reset_stream(APEG_STREAM *stream)
 {
 	APEG_LAYER *layer = (APEG_LAYER*)stream;
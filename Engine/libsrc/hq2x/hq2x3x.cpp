@@ -17,11 +17,12 @@
 //Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <stdlib.h>
+#include <vector>
 #include "core/types.h"
+#include "util/simd.h"
 
 static int   LUT16to32[65536];
 static int   RGBtoYUV[65536];
-static int   YUV1, YUV2;
 const  int   Ymask = 0x00FF0000;
 const  int   Umask = 0x0000FF00;
 const  int   Vmask = 0x000000FF;
@@ -144,24 +145,177 @@ inline void Interp10(unsigned char * pc, int c1, int c2, int c3)
 
 
 
+inline bool DiffYUV(int yuv1, int yuv2)
+{
+  return ( ( abs((yuv1 & Ymask) - (yuv2 & Ymask)) > trY ) ||
+           ( abs((yuv1 & Umask) - (yuv2 & Umask)) > trU ) ||
+           ( abs((yuv1 & Vmask) - (yuv2 & Vmask)) > trV ) );
+}
+
 inline bool Diff(unsigned int w1, unsigned int w2)
 {
-  YUV1 = RGBtoYUV[w1];
-  YUV2 = RGBtoYUV[w2];
-  return ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-           ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-           ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) );
+  return DiffYUV(RGBtoYUV[w1], RGBtoYUV[w2]);
 }
 
-#define INPUT_IMAGE_PIXEL_SIZE uint32_t
-#define INPUT_IMAGE_PIXEL_SIZE_IN_BYTES sizeof(INPUT_IMAGE_PIXEL_SIZE)
+// One source line converted down to 16-bit, with the YUV and the 32-bit
+// value of every pixel looked up once. Indexes -1 and Xres repeat the edge
+// pixels, so that the neighbours of the border pixels need no special case.
+struct HqxLine
+{
+  int *W;
+  int *YUV;
+  int *C;
+};
 
-void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+// The previous, current and next source lines of the row being processed,
+// and the classified pattern of every pixel of the current line. The line
+// buffers are rotated when moving to the next row, so every source line is
+// converted only once per region.
+struct HqxLines
+{
+  std::vector<int> Buffer;
+  HqxLine Line[3];
+  int *Pattern;
+  int Prev, Cur, Next;
+
+  HqxLines(int xres)
+    : Buffer((xres + 2) * 10)
+    , Prev(0), Cur(1), Next(2)
+  {
+    int *buf = &Buffer[0] + 1;
+    for (int k = 0; k < 3; k++)
+    {
+      Line[k].W   = buf; buf += xres + 2;
+      Line[k].YUV = buf; buf += xres + 2;
+      Line[k].C   = buf; buf += xres + 2;
+    }
+    Pattern = buf;
+  }
+};
+
+static void HqxLoadLine(HqxLine &line, const unsigned char *pIn, int Xres, int row, int from, int to)
+{
+  const uint32_t *src = (const uint32_t*)pIn + row * Xres;
+  for (int i = from; i <= to; i++)
+  {
+    uint32_t p = src[i < 0 ? 0 : (i < Xres ? i : Xres - 1)];
+    int w16 = ((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F);
+    line.W[i]   = w16;
+    line.YUV[i] = RGBtoYUV[w16];
+    line.C[i]   = LUT16to32[w16];
+  }
+}
+
+// Y, U and V take a byte each in the YUV value, so the thresholds may be
+// tested on the byte-wise absolute difference, which equals the masked
+// difference used by DiffYUV.
+#if defined (AGS_SIMD_SSE2)
+inline __m128i DiffYUV4(__m128i yuv1, __m128i yuv2, __m128i thresholds)
+{
+  __m128i d = _mm_or_si128(_mm_subs_epu8(yuv1, yuv2), _mm_subs_epu8(yuv2, yuv1));
+  return _mm_cmpeq_epi32(_mm_subs_epu8(d, thresholds), _mm_setzero_si128());
+}
+
+#define HQX_FLAG4(yuv, flag) \
+  pattern = _mm_or_si128(pattern, _mm_andnot_si128(DiffYUV4(center, _mm_loadu_si128((const __m128i*)(yuv)), thresholds), _mm_set1_epi32(flag)));
+#elif defined (AGS_SIMD_NEON)
+inline uint32x4_t DiffYUV4(uint32x4_t yuv1, uint32x4_t yuv2, uint8x16_t thresholds)
+{
+  uint8x16_t over = vcgtq_u8(vabdq_u8(vreinterpretq_u8_u32(yuv1), vreinterpretq_u8_u32(yuv2)), thresholds);
+  return vtstq_u32(vreinterpretq_u32_u8(over), vreinterpretq_u32_u8(over));
+}
+
+#define HQX_FLAG4(yuv, flag) \
+  pattern = vorrq_u32(pattern, vandq_u32(DiffYUV4(center, vld1q_u32((const uint32_t*)(yuv)), thresholds), vdupq_n_u32(flag)));
+#endif
+
+// Sets a bit of the pixel's pattern for every neighbour that differs from it,
+// in the order w1, w2, w3, w4, w6, w7, w8, w9
+static void HqxClassifyLine(HqxLines &lines, int from, int to)
+{
+  const int *prev = lines.Line[lines.Prev].YUV;
+  const int *cur  = lines.Line[lines.Cur].YUV;
+  const int *next = lines.Line[lines.Next].YUV;
+  int *out = lines.Pattern;
+  int i = from;
+#if defined (AGS_SIMD_SSE2)
+  const __m128i thresholds = _mm_set1_epi32(trY | trU | trV);
+  for (; i + 4 <= to; i += 4)
+  {
+    const __m128i center = _mm_loadu_si128((const __m128i*)(cur + i));
+    __m128i pattern = _mm_setzero_si128();
+    HQX_FLAG4(prev + i - 1, 1)
+    HQX_FLAG4(prev + i, 2)
+    HQX_FLAG4(prev + i + 1, 4)
+    HQX_FLAG4(cur + i - 1, 8)
+    HQX_FLAG4(cur + i + 1, 16)
+    HQX_FLAG4(next + i - 1, 32)
+    HQX_FLAG4(next + i, 64)
+    HQX_FLAG4(next + i + 1, 128)
+    _mm_storeu_si128((__m128i*)(out + i), pattern);
+  }
+#elif defined (AGS_SIMD_NEON)
+  const uint8x16_t thresholds = vreinterpretq_u8_u32(vdupq_n_u32(trY | trU | trV));
+  for (; i + 4 <= to; i += 4)
+  {
+    const uint32x4_t center = vld1q_u32((const uint32_t*)(cur + i));
+    uint32x4_t pattern = vdupq_n_u32(0);
+    HQX_FLAG4(prev + i - 1, 1)
+    HQX_FLAG4(prev + i, 2)
+    HQX_FLAG4(prev + i + 1, 4)
+    HQX_FLAG4(cur + i - 1, 8)
+    HQX_FLAG4(cur + i + 1, 16)
+    HQX_FLAG4(next + i - 1, 32)
+    HQX_FLAG4(next + i, 64)
+    HQX_FLAG4(next + i + 1, 128)
+    vst1q_u32((uint32_t*)(out + i), pattern);
+  }
+#endif
+  for (; i < to; i++)
+  {
+    const int yuv = cur[i];
+    out[i] = (DiffYUV(yuv, prev[i - 1]) ? 1 : 0) |
+             (DiffYUV(yuv, prev[i])     ? 2 : 0) |
+             (DiffYUV(yuv, prev[i + 1]) ? 4 : 0) |
+             (DiffYUV(yuv, cur[i - 1])  ? 8 : 0) |
+             (DiffYUV(yuv, cur[i + 1])  ? 16 : 0) |
+             (DiffYUV(yuv, next[i - 1]) ? 32 : 0) |
+             (DiffYUV(yuv, next[i])     ? 64 : 0) |
+             (DiffYUV(yuv, next[i + 1]) ? 128 : 0);
+  }
+}
+
+// Makes the lines around row j ready for the pixels x..x+width-1. The rows
+// above the first and below the last one repeat the edge rows.
+static void HqxPrepareRow(HqxLines &lines, const unsigned char *pIn, int Xres, int Yres, int j, bool first, int x, int width)
 {
-  int  i, j, k;
-  int  prevline, nextline;
+  const int from = x - 1;
+  const int to = x + width;
+  const int next_row = j < Yres - 1 ? j + 1 : j;
+  if (first)
+  {
+    HqxLoadLine(lines.Line[lines.Prev], pIn, Xres, j > 0 ? j - 1 : j, from, to);
+    HqxLoadLine(lines.Line[lines.Cur], pIn, Xres, j, from, to);
+  }
+  else
+  {
+    const int old_prev = lines.Prev;
+    lines.Prev = lines.Cur;
+    lines.Cur = lines.Next;
+    lines.Next = old_prev;
+  }
+  HqxLoadLine(lines.Line[lines.Next], pIn, Xres, next_row, from, to);
+  HqxClassifyLine(lines, x, x + width);
+}
+
+
+void hq2x_32_region( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL,
+                    int x, int y, int width, int height )
+{
+  int  i, j;
   int  w[10];
   int  c[10];
+  HqxLines lines(Xres);
 
   //   +----+----+----+
   //   |    |    |    |
@@ -174,72 +328,25 @@ void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j=0; j<Yres; j++)
+  pOut += y * BpL * 2 + x * 8;
+  for (j=y; j<y+height; j++)
   {
-    if (j>0)      prevline = -Xres*4; else prevline = 0;
-    if (j<Yres-1) nextline =  Xres*4; else nextline = 0;
+    HqxPrepareRow(lines, pIn, Xres, Yres, j, j == y, x, width);
+    const HqxLine &prev = lines.Line[lines.Prev];
+    const HqxLine &cur  = lines.Line[lines.Cur];
+    const HqxLine &next = lines.Line[lines.Next];
 
-    for (i=0; i<Xres; i++)
+    for (i=x; i<x+width; i++)
     {
-      w[2] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline));
-      w[5] = *((INPUT_IMAGE_PIXEL_SIZE*)pIn);
-      w[8] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline));
-
-      if (i>0)
-      {
-        w[1] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[4] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[7] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[1] = w[2];
-        w[4] = w[5];
-        w[7] = w[8];
-      }
-
-      if (i<Xres-1)
-      {
-        w[3] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[6] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[9] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[3] = w[2];
-        w[6] = w[5];
-        w[9] = w[8];
-      }
-
-      // convert down to 16-bit
-      for (k = 1; k <= 9; k++) {
-        w[k] = (((((w[k] >> 16) & 0x00ff) / 8) << 11) +
-          ((((w[k] >> 8) & 0x00ff) / 4) << 5) +
-          ((w[k]  & 0x00ff) / 8)) & 0x000ffff;
-      }
-
-      int pattern = 0;
-      int flag = 1;
-
-      YUV1 = RGBtoYUV[w[5]];
+      w[1] = prev.W[i-1]; w[2] = prev.W[i]; w[3] = prev.W[i+1];
+      w[4] = cur.W[i-1];  w[5] = cur.W[i];  w[6] = cur.W[i+1];
+      w[7] = next.W[i-1]; w[8] = next.W[i]; w[9] = next.W[i+1];
 
-      for (k=1; k<=9; k++)
-      {
-        if (k==5) continue;
-
-        if ( w[k] != w[5] )
-        {
-          YUV2 = RGBtoYUV[w[k]];
-          if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-               ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-               ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
-            pattern |= flag;
-        }
-        flag <<= 1;
-      }
+      c[1] = prev.C[i-1]; c[2] = prev.C[i]; c[3] = prev.C[i+1];
+      c[4] = cur.C[i-1];  c[5] = cur.C[i];  c[6] = cur.C[i+1];
+      c[7] = next.C[i-1]; c[8] = next.C[i]; c[9] = next.C[i+1];
 
-      for (k=1; k<=9; k++)
-        c[k] = LUT16to32[w[k]];
+      int pattern = lines.Pattern[i];
 
       switch (pattern)
       {
@@ -2883,13 +2990,17 @@ void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
           break;
         }
       }
-      pIn += INPUT_IMAGE_PIXEL_SIZE_IN_BYTES;
       pOut+=8;
     }
-    pOut+=BpL + (BpL - Xres * 8);
+    pOut+=BpL + (BpL - width * 8);
   }
 }
 
+void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+{
+  hq2x_32_region(pIn, pOut, Xres, Yres, BpL, 0, 0, Xres, Yres);
+}
+
 void InitLUTs(void)
 {
   int i, j, k, r, g, b, Y, u, v;
@@ -2972,12 +3083,13 @@ void InitLUTs(void)
 
 
 
-void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+void hq3x_32_region( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL,
+                    int x, int y, int width, int height )
 {
-  int  i, j, k;
-  int  prevline, nextline;
+  int  i, j;
   int  w[10];
   int  c[10];
+  HqxLines lines(Xres);
 
   //   +----+----+----+
   //   |    |    |    |
@@ -2990,72 +3102,25 @@ void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j=0; j<Yres; j++)
+  pOut += y * BpL * 3 + x * 12;
+  for (j=y; j<y+height; j++)
   {
-    if (j>0)      prevline = -Xres*4; else prevline = 0;
-    if (j<Yres-1) nextline =  Xres*4; else nextline = 0;
+    HqxPrepareRow(lines, pIn, Xres, Yres, j, j == y, x, width);
+    const HqxLine &prev = lines.Line[lines.Prev];
+    const HqxLine &cur  = lines.Line[lines.Cur];
+    const HqxLine &next = lines.Line[lines.Next];
 
-    for (i=0; i<Xres; i++)
+    for (i=x; i<x+width; i++)
     {
-      w[2] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline));
-      w[5] = *((INPUT_IMAGE_PIXEL_SIZE*)pIn);
-      w[8] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline));
-
-      if (i>0)
-      {
-        w[1] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[4] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[7] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline - INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[1] = w[2];
-        w[4] = w[5];
-        w[7] = w[8];
-      }
-
-      if (i<Xres-1)
-      {
-        w[3] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + prevline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[6] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-        w[9] = *((INPUT_IMAGE_PIXEL_SIZE*)(pIn + nextline + INPUT_IMAGE_PIXEL_SIZE_IN_BYTES));
-      }
-      else
-      {
-        w[3] = w[2];
-        w[6] = w[5];
-        w[9] = w[8];
-      }
-
-      // convert down to 16-bit
-      for (k = 1; k <= 9; k++) {
-        w[k] = (((((w[k] >> 16) & 0x00ff) / 8) << 11) +
-          ((((w[k] >> 8) & 0x00ff) / 4) << 5) +
-          ((w[k]  & 0x00ff) / 8)) & 0x000ffff;
-      }
+      w[1] = prev.W[i-1]; w[2] = prev.W[i]; w[3] = prev.W[i+1];
+      w[4] = cur.W[i-1];  w[5] = cur.W[i];  w[6] = cur.W[i+1];
+      w[7] = next.W[i-1]; w[8] = next.W[i]; w[9] = next.W[i+1];
 
-      int pattern = 0;
-      int flag = 1;
+      c[1] = prev.C[i-1]; c[2] = prev.C[i]; c[3] = prev.C[i+1];
+      c[4] = cur.C[i-1];  c[5] = cur.C[i];  c[6] = cur.C[i+1];
+      c[7] = next.C[i-1]; c[8] = next.C[i]; c[9] = next.C[i+1];
 
-      YUV1 = RGBtoYUV[w[5]];
-
-      for (k=1; k<=9; k++)
-      {
-        if (k==5) continue;
-
-        if ( w[k] != w[5] )
-        {
-          YUV2 = RGBtoYUV[w[k]];
-          if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-               ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-               ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
-            pattern |= flag;
-        }
-        flag <<= 1;
-      }
-
-      for (k=1; k<=9; k++)
-        c[k] = LUT16to32[w[k]];
+      int pattern = lines.Pattern[i];
 
       switch (pattern)
       {
@@ -6672,10 +6737,14 @@ void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
           break;
         }
       }
-      pIn += INPUT_IMAGE_PIXEL_SIZE_IN_BYTES;
       pOut+=12;
     }
-    pOut+=BpL + (BpL - Xres * 12);
+    pOut+=BpL + (BpL - width * 12);
     pOut+=BpL;
   }
 }
+
+void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+{
+  hq3x_32_region(pIn, pOut, Xres, Yres, BpL, 0, 0, Xres, Yres);
+}
@@ -22,10 +22,12 @@
 #include "ac/global_translation.h"
 #include "ac/path_helper.h"
 #include "ac/spritecache.h"
+#include "ac/spritetransformcache.h"
 #include "ac/system.h"
 #include "debug/debug_log.h"
 #include "main/mainheader.h"
 #include "main/config.h"
+#include "media/audio/sound.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/override_defines.h" //_getcwd()
 #include "util/directory.h"
@@ -415,9 +417,11 @@ void apply_config(const ConfigTree &cfg)
             idx = MIDI_AUTODETECT;
         usetup.midicard = idx;
 #endif
-#if !defined (LINUX_VERSION)
         psp_audio_multithreaded = INIreadint(cfg, "sound", "threaded", psp_audio_multithreaded);
-#endif
+        psp_audio_cachesize = INIreadint(cfg, "sound", "cache_size", psp_audio_cachesize);
+        psp_audio_cache_mb = INIreadint(cfg, "sound", "cache_size_mb", psp_audio_cache_mb);
+        stream_ogg_min_size = INIreadint(cfg, "sound", "stream_min_size", stream_ogg_min_size);
+        stream_preroll_ms = INIreadint(cfg, "sound", "stream_preroll", stream_preroll_ms);
 
         // Filter can also be set by command line
         // TODO: apply command line arguments to ConfigTree instead to override options read from config file
@@ -465,6 +469,7 @@ void apply_config(const ConfigTree &cfg)
 
         // This option is backwards (usevox is 0 if no_speech_pack)
         usetup.no_speech_pack = INIreadint(cfg, "sound", "usespeech", 1) == 0;
+        usetup.profile_scripts = INIreadint(cfg, "misc", "script_profile") > 0;
 
         usetup.user_data_dir = INIreadstring(cfg, "misc", "user_data_dir");
         usetup.shared_data_dir = INIreadstring(cfg, "misc", "shared_data_dir");
@@ -477,6 +482,8 @@ void apply_config(const ConfigTree &cfg)
         // the config file specifies cache size in KB, here we convert it to bytes
         spriteset.SetMaxCacheSize(INIreadint (cfg, "misc", "cachemax", DEFAULTCACHESIZE / 1024) * 1024);
 #endif
+        // the transformed sprite cache size is in KB as well
+        set_transformed_sprite_cache_limit(INIreadint (cfg, "misc", "transformcachemax", DEFAULT_TRANSFORM_CACHE_SIZE / 1024) * 1024);
 
         String repfile = INIreadstring(cfg, "misc", "replay");
         if (repfile != NULL) {
@@ -51,14 +51,19 @@
 #include "main/graphics_mode.h"
 #include "main/main.h"
 #include "main/main_allegro.h"
+#include "main/startup_tasks.h"
+#include "media/audio/audiocore.h"
 #include "media/audio/sound.h"
+#include "script/script_profiler.h"
 #include "ac/spritecache.h"
 #include "gfx/graphicsdriver.h"
+#include "core/asset.h"
 #include "core/assetmanager.h"
 #include "util/misc.h"
 #include "platform/util/pe.h"
 #include "util/directory.h"
 #include "util/path.h"
+#include "util/thread.h"
 #include "main/game_file.h"
 #include "debug/out.h"
 
@@ -96,7 +101,32 @@ extern IDriverDependantBitmap **guibgbmp;
 String music_file;
 String speech_file;
 
+// Voice and audio packs, which are read by the startup tasks; the results are
+// applied to the game by the main thread
+struct VoxPackInit
+{
+    String      FilePath;   // empty if the pack was not found
+    AssetError  Error;
+    int         Task;
+};
+
+static VoxPackInit speech_pack;
+static VoxPackInit music_pack;
+static int speech_pack_lipsync_fmt = -1; // -1 if there is no lip sync data
+static SpeechLipSyncLine *speech_pack_lipsync = NULL;
+static int speech_pack_lipsync_lines = 0;
+// Sprite file is initialized by a startup task
+static Stream *sprite_file = NULL;
+static Stream *sprite_index_file = NULL;
+static int sprite_init_result = 0;
+static int sprite_task = -1;
+// Translation is read by a startup task
+static Stream *translation_file = NULL;
+static TranslationInfo translation_info;
+static int translation_task = -1;
+
 t_engine_pre_init_callback engine_pre_init_callback = 0;
+Thread::Id game_thread_id;
 
 #define ALLEGRO_KEYBOARD_HANDLER
 // KEYBOARD HANDLER
@@ -443,48 +473,110 @@ void engine_init_rooms()
     // Obsolete now since room statuses are allocated only when needed
 }
 
-void engine_init_speech()
+// Reads the voice pack's table of contents and lip sync data; startup task
+void engine_read_speech_pack()
 {
-    play.want_speech=-2;
+    AssetLibInfo lib;
+    speech_pack.Error = AssetManager::ReadDataFileTOC(speech_pack.FilePath, lib);
+    if (speech_pack.Error != Common::kAssetNoError)
+        return;
+
+    const AssetInfo *sync_asset = NULL;
+    for (size_t i = 0; i < lib.AssetInfos.size() && !sync_asset; ++i)
+    {
+        if (lib.AssetInfos[i].FileName.CompareNoCase("syncdata.dat") == 0)
+            sync_asset = &lib.AssetInfos[i];
+    }
+    if (!sync_asset || sync_asset->LibUid < 0 || (size_t)sync_asset->LibUid >= lib.LibFileNames.size())
+        return;
+    // the first part is the pack itself, the others are located next to it
+    String lib_file = speech_pack.FilePath;
+    if (sync_asset->LibUid > 0)
+    {
+        size_t slash_at = lib_file.FindCharReverse('/');
+        lib_file = slash_at == -1 ? lib.LibFileNames[sync_asset->LibUid] :
+            String::FromFormat("%s/%s", lib_file.Left(slash_at).GetCStr(), lib.LibFileNames[sync_asset->LibUid].GetCStr());
+    }
+
+    Stream *speechsync = ci_fopen(lib_file, Common::kFile_Open, Common::kFile_Read);
+    if (speechsync == NULL)
+        return;
+    speechsync->Seek(sync_asset->Offset, kSeekBegin);
+    // this game has voice lip sync
+    speech_pack_lipsync_fmt = speechsync->ReadInt32();
+    if (speech_pack_lipsync_fmt == 4)
+    {
+        speech_pack_lipsync_lines = speechsync->ReadInt32();
+        speech_pack_lipsync = (SpeechLipSyncLine*)malloc (sizeof(SpeechLipSyncLine) * speech_pack_lipsync_lines);
+        for (int ee = 0; ee < speech_pack_lipsync_lines; ee++)
+        {
+            SpeechLipSyncLine &line = speech_pack_lipsync[ee];
+            line.numPhonemes = speechsync->ReadInt16();
+            speechsync->Read(line.filename, 14);
+            line.endtimeoffs = (int*)malloc(line.numPhonemes * sizeof(int));
+            speechsync->ReadArrayOfInt32(line.endtimeoffs, line.numPhonemes);
+            line.frame = (short*)malloc(line.numPhonemes * sizeof(short));
+            speechsync->ReadArrayOfInt16(line.frame, line.numPhonemes);
+        }
+    }
+    delete speechsync;
+}
 
+// Checks the audio pack's table of contents; startup task
+void engine_read_music_pack()
+{
+    AssetLibInfo lib;
+    music_pack.Error = AssetManager::ReadDataFileTOC(music_pack.FilePath, lib);
+}
+
+// Looks for the voice and audio packs and starts reading them
+void engine_start_vox_packs()
+{
+    speech_pack.FilePath = "";
+    speech_pack.Task = -1;
     if (!usetup.no_speech_pack) {
         speech_file = "speech.vox";
-        String speech_filepath = find_assetlib(speech_file);
-        if (!speech_filepath.IsEmpty()) {
+        speech_pack.FilePath = find_assetlib(speech_file);
+        if (!speech_pack.FilePath.IsEmpty()) {
             Debug::Printf("Initializing speech vox");
-            if (AssetManager::SetDataFile(speech_filepath)!=Common::kAssetNoError) {
+            speech_pack.Task = startup_task_add("speech.vox", engine_read_speech_pack);
+        }
+    }
+
+    music_file = "audio.vox";
+    music_pack.FilePath = find_assetlib(music_file);
+    music_pack.Task = -1;
+    if (!music_pack.FilePath.IsEmpty()) {
+        Debug::Printf("Initializing audio vox");
+        music_pack.Task = startup_task_add("audio.vox", engine_read_music_pack);
+    }
+}
+
+void engine_init_speech()
+{
+    play.want_speech=-2;
+
+    if (!usetup.no_speech_pack) {
+        if (!speech_pack.FilePath.IsEmpty()) {
+            startup_task_wait(speech_pack.Task);
+            if (speech_pack.Error != Common::kAssetNoError) {
                 platform->DisplayAlert("Unable to read voice pack, file could be corrupted or of unknown format.\nSpeech voice-over will be disabled.");
-                AssetManager::SetDataFile(game_file_name); // switch back to the main data pack
                 return;
             }
-            Stream *speechsync = AssetManager::OpenAsset("syncdata.dat");
-            if (speechsync != NULL) {
-                // this game has voice lip sync
-                int lipsync_fmt = speechsync->ReadInt32();
-                if (lipsync_fmt != 4)
-                {
-                    Debug::Printf(kDbgMsg_Init, "Unknown speech lip sync format (%d).\nLip sync disabled.", lipsync_fmt);
-                }
-                else {
-                    numLipLines = speechsync->ReadInt32();
-                    splipsync = (SpeechLipSyncLine*)malloc (sizeof(SpeechLipSyncLine) * numLipLines);
-                    for (int ee = 0; ee < numLipLines; ee++)
-                    {
-                        splipsync[ee].numPhonemes = speechsync->ReadInt16();
-                        speechsync->Read(splipsync[ee].filename, 14);
-                        splipsync[ee].endtimeoffs = (int*)malloc(splipsync[ee].numPhonemes * sizeof(int));
-                        speechsync->ReadArrayOfInt32(splipsync[ee].endtimeoffs, splipsync[ee].numPhonemes);
-                        splipsync[ee].frame = (short*)malloc(splipsync[ee].numPhonemes * sizeof(short));
-                        speechsync->ReadArrayOfInt16(splipsync[ee].frame, splipsync[ee].numPhonemes);
-                    }
-                }
-                delete speechsync;
+            if (speech_pack_lipsync_fmt == 4) {
+                splipsync = speech_pack_lipsync;
+                numLipLines = speech_pack_lipsync_lines;
+                speech_pack_lipsync = NULL;
+            }
+            else if (speech_pack_lipsync_fmt >= 0) {
+                Debug::Printf(kDbgMsg_Init, "Unknown speech lip sync format (%d).\nLip sync disabled.", speech_pack_lipsync_fmt);
             }
-            AssetManager::SetDataFile(game_file_name); // switch back to the main data pack
             Debug::Printf(kDbgMsg_Init, "Voice pack found and initialized.");
-            play.want_speech=1;
+            // no voice-over without digital sound
+            if (usetup.digicard != DIGI_NONE)
+                play.want_speech=1;
         }
-        else if (Path::ComparePaths(usetup.data_files_dir, get_voice_install_dir()) != 0)
+        else if (Path::ComparePaths(usetup.data_files_dir, get_voice_install_dir()) != 0 && usetup.digicard != DIGI_NONE)
         {
             // If we have custom voice directory set, we will enable voice-over even if speech.vox does not exist
             Debug::Printf(kDbgMsg_Init, "Voice pack was not found, but voice installation directory is defined: enabling voice-over.");
@@ -497,20 +589,16 @@ int engine_init_music()
 {
     play.separate_music_lib = 0;
 
-    music_file = "audio.vox";
-    String music_filepath = find_assetlib(music_file);
-    if (!music_filepath.IsEmpty()) {
-
-        Debug::Printf("Initializing audio vox");
-
-        //if (Common::AssetManager::SetDataFile(useloc,"")!=0) {
-        if (Common::AssetManager::SetDataFile(music_filepath)!=Common::kAssetNoError) {
+    if (!music_pack.FilePath.IsEmpty()) {
+        startup_task_wait(music_pack.Task);
+        if (music_pack.Error != Common::kAssetNoError) {
             platform->DisplayAlert("Unable to initialize music library - check for corruption and that\nit belongs to this game.\n");
             return EXIT_NORMAL;
         }
-        Common::AssetManager::SetDataFile(game_file_name);
         Debug::Printf(kDbgMsg_Init, "Audio vox found and initialized.");
-        play.separate_music_lib = 1;
+        // no separate music library without digital sound
+        if (usetup.digicard != DIGI_NONE)
+            play.separate_music_lib = 1;
     }
 
     return RETURN_CONTINUE;
@@ -931,11 +1019,43 @@ void engine_show_preload()
     show_preload ();
 }
 
-int engine_init_sprites()
+// Reads the sprite file's index; startup task
+void engine_read_sprite_index()
+{
+    sprite_init_result = spriteset.InitFile(sprite_file, sprite_index_file);
+    sprite_file = NULL;
+    sprite_index_file = NULL;
+}
+
+// Reads the translation; startup task
+void engine_read_translation()
+{
+    read_translation(translation_file, translation_info);
+    translation_file = NULL;
+}
+
+// Starts the tasks that need the game data
+void engine_start_game_data_tasks()
 {
     Debug::Printf(kDbgMsg_Init, "Initialize sprites");
+    // the assets are opened here, the tasks do not use the asset manager
+    sprite_file = AssetManager::OpenAsset("acsprset.spr");
+    sprite_index_file = AssetManager::OpenAsset("sprindex.dat");
+    sprite_task = startup_task_add("sprite index", engine_read_sprite_index);
+
+    translation_task = -1;
+    if (!usetup.translation.IsEmpty())
+    {
+        translation_file = open_translation(usetup.translation);
+        if (translation_file)
+            translation_task = startup_task_add("translation", engine_read_translation);
+    }
+}
 
-    if (spriteset.InitFile("acsprset.spr")) 
+int engine_init_sprites()
+{
+    startup_task_wait(sprite_task);
+    if (sprite_init_result) 
     {
         platform->FinishedUsingGraphicsMode();
         allegro_exit();
@@ -1197,7 +1317,14 @@ void engine_init_game_settings()
     for (ee = 0; ee < MAX_SOUND_CHANNELS; ee++)
         last_sound_played[ee] = -1;
 
-    if (!usetup.translation.IsEmpty())
+    if (translation_task >= 0)
+    {
+        // translation read while the engine was starting
+        startup_task_wait(translation_task);
+        translation_task = -1;
+        apply_translation(translation_info, "", true);
+    }
+    else if (!usetup.translation.IsEmpty())
         init_translation (usetup.translation, "", true);
 
     update_invorder();
@@ -1226,21 +1353,15 @@ void engine_setup_scsystem_auxiliary()
     }
 }
 
-void engine_update_mp3_thread()
-{
-  update_mp3_thread();
-  platform->Delay(50);
-}
-
 void engine_start_multithreaded_audio()
 {
   // PSP: Initialize the sound cache.
   clear_sound_cache();
 
-  // Create sound update thread. This is a workaround for sound stuttering.
+  // Create the audio thread, which polls all the playing clips from now on
   if (psp_audio_multithreaded)
   {
-    if (!audioThread.CreateAndStart(engine_update_mp3_thread, true))
+    if (!audio_core_init())
     {
       Debug::Printf(kDbgMsg_Init, "Failed to start audio thread, audio will be processed on the main thread");
       psp_audio_multithreaded = 0;
@@ -1262,6 +1383,8 @@ void engine_prepare_to_start_game()
 
     engine_setup_scsystem_auxiliary();
     engine_start_multithreaded_audio();
+    if (usetup.profile_scripts)
+        script_profiler_start();
 
 #if defined(ANDROID_VERSION)
     if (psp_load_latest_savegame)
@@ -1358,12 +1481,23 @@ bool engine_do_config(const String &exe_path)
     return engine_check_run_setup(exe_path, cfg);
 }
 
+// Stops the startup tasks when the initialization ends early; shutting them
+// down a second time does nothing
+struct StartupTasksGuard
+{
+    ~StartupTasksGuard() { startup_tasks_shutdown(); }
+};
+
 int initialize_engine(int argc,char*argv[])
 {
+    game_thread_id = Thread::GetCurrentId();
     if (engine_pre_init_callback) {
         engine_pre_init_callback();
     }
     
+    startup_tasks_init("setup");
+    StartupTasksGuard startup_tasks_guard;
+
     int res;
     if (!engine_init_allegro())
         return EXIT_NORMAL;
@@ -1408,14 +1542,10 @@ int initialize_engine(int argc,char*argv[])
 
     our_eip = -186;
     
-    engine_init_speech();
+    // Voice and audio packs are read while the engine continues initializing
+    engine_start_vox_packs();
 
-    our_eip = -185;
-    
-    res = engine_init_music();
-    if (res != RETURN_CONTINUE) {
-        return res;
-    }
+    startup_phase("system");
 
     our_eip = -184;
 
@@ -1454,10 +1584,28 @@ int initialize_engine(int argc,char*argv[])
     //thisroom.allocall();
     our_eip=-19;
 
+    startup_phase("game data");
+
     res = engine_load_game_data();
     if (res != RETURN_CONTINUE) {
         return res;
     }
+
+    // Sprite index and translation are read while the graphics are initialized
+    engine_start_game_data_tasks();
+
+    startup_phase("vox packs");
+
+    engine_init_speech();
+
+    our_eip = -185;
+
+    res = engine_init_music();
+    if (res != RETURN_CONTINUE) {
+        return res;
+    }
+
+    startup_phase("graphics");
     
     res = engine_check_register_game();
     if (res != RETURN_CONTINUE) {
@@ -1497,17 +1645,25 @@ int initialize_engine(int argc,char*argv[])
     // Hide the system cursor via allegro
     show_os_cursor(MOUSE_CURSOR_NONE);
 
+    startup_phase("preload");
+
     engine_show_preload();
 
+    startup_phase("sprites");
+
     res = engine_init_sprites();
     if (res != RETURN_CONTINUE) {
         return res;
     }
 
+    startup_phase("game settings");
+
     engine_init_game_settings();
 
     engine_prepare_to_start_game();
 
+    startup_tasks_shutdown();
+
 	allegro_bitmap_test_init();
 
     initialize_start_and_play_game(override_start_room, loadSaveGameOnStartup);
@@ -1641,3 +1797,8 @@ const char *get_engine_version() {
 void engine_set_pre_init_callback(t_engine_pre_init_callback callback) {
     engine_pre_init_callback = callback;
 }
+
+bool engine_is_game_thread()
+{
+    return Thread::IsCurrent(game_thread_id);
+}
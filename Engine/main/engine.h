@@ -34,6 +34,8 @@ bool        engine_try_set_gfxmode_any(const ScreenSetup &setup);
 bool        engine_try_switch_windowed_gfxmode();
 // Shutdown graphics mode (used before shutting down tha application)
 void        engine_shutdown_gfxmode();
+// Tells whether the calling thread is the one running the game
+bool        engine_is_game_thread();
 
 // Names of the data files containing music and speech, respectively
 extern String music_file;
@@ -37,6 +37,7 @@
 #include "ac/record.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
@@ -47,10 +48,12 @@
 #include "main/engine.h"
 #include "main/game_run.h"
 #include "main/update.h"
+#include "media/audio/audiocore.h"
 #include "media/audio/soundclip.h"
 #include "plugin/agsplugin.h"
 #include "plugin/plugin_engine.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "ac/spritecache.h"
 
 using namespace AGS::Common;
@@ -411,6 +414,10 @@ void check_keyboard_controls()
             play.wait_counter = -1;
             debug_script_log("Keypress code %d ignored - in Wait", kgn);
         }
+        else if ((kgn == 16) && (play.debug_mode > 0) && script_profiler_is_active()) {
+            // ctrl+P - write script profile collected so far
+            script_profiler_write_report();
+        }
         else if ((kgn == 5) && (display_fps == 2)) {
             // if --fps paramter is used, Ctrl+E will max out frame rate
             SetGameSpeed(1000);
@@ -770,6 +777,9 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     game_loop_update_events();
 
+    update_room_preload();
+    update_savegame_write();
+
     our_eip=7;
 
     //    if (mgetbutton()>NONE) break;
@@ -959,6 +969,10 @@ void RunGameUntilAborted()
 
 void update_polled_stuff_if_runtime()
 {
+    // the room data may also be read by the preloading thread
+    if (!engine_is_game_thread())
+        return;
+
     if (want_exit) {
         want_exit = 0;
         quit("||exit!");
@@ -966,6 +980,8 @@ void update_polled_stuff_if_runtime()
 
     if (!psp_audio_multithreaded)
         update_polled_mp3();
+    else
+        audio_core_update();
 
     if (editor_debugging_initialized)
         check_for_messages_from_editor();
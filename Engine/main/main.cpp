@@ -84,6 +84,9 @@ int datafile_argv=0, change_to_game_dir = 0, force_window = 0;
 int override_start_room = 0;
 bool justDisplayHelp = false;
 bool justDisplayVersion = false;
+#ifdef _DEBUG
+bool justRunBenchmarks = false;
+#endif
 bool justRunSetup = false;
 bool justRegisterGame = false;
 bool justUnRegisterGame = false;
@@ -98,6 +101,7 @@ int psp_clear_cache_on_room_change = 0;
 
 int psp_midi_preload_patches = 0;
 int psp_audio_cachesize = 10;
+int psp_audio_cache_mb = 64;
 char psp_game_file_name[] = "ac2game.dat";
 char psp_translation[] = "default";
 
@@ -252,6 +256,8 @@ int main_process_cmdline(int argc,char*argv[])
             override_start_room = atoi(argv[ee+1]);
             ee++;
         }
+        else if (stricmp(argv[ee],"--benchmark") == 0)
+            justRunBenchmarks = true;
 #endif
         else if ((stricmp(argv[ee],"--testre") == 0) && (ee < argc-2)) {
             strcpy(return_to_roomedit, argv[ee+1]);
@@ -493,6 +499,14 @@ int main(int argc,char*argv[]) {
         return 0;
     }
 
+#ifdef _DEBUG
+    if (justRunBenchmarks)
+    {
+        Test_DoAllBenchmarks();
+        return 0;
+    }
+#endif
+
     init_debug();
     Debug::Printf(kDbgMsg_Init, get_engine_string());
 
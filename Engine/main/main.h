@@ -60,6 +60,7 @@ extern int psp_clear_cache_on_room_change;
 
 extern int psp_midi_preload_patches;
 extern int psp_audio_cachesize;
+extern int psp_audio_cache_mb;
 extern char psp_game_file_name[];
 extern char psp_translation[];
 
@@ -19,6 +19,7 @@
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/record.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/translation.h"
 #include "debug/agseditordebugger.h"
@@ -26,16 +27,21 @@
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "font/fonts.h"
+#include "game/savegame.h"
 #include "main/config.h"
 #include "main/engine.h"
 #include "main/main.h"
 #include "main/mainheader.h"
 #include "main/quit.h"
 #include "ac/spritecache.h"
+#include "ac/spritetransformcache.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
 #include "core/assetmanager.h"
+#include "media/audio/audiocore.h"
+#include "media/audio/soundcache.h"
 #include "plugin/plugin_engine.h"
+#include "script/script_profiler.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -68,6 +74,7 @@ void quit_tell_editor_debugger(const String &qmsg, QuitReason qreason)
 
 void quit_shutdown_scripts()
 {
+    script_profiler_stop();
     ccUnregisterAllObjects();
 }
 
@@ -110,7 +117,13 @@ void quit_shutdown_audio()
 #endif
 
     // Quit the sound thread.
-    audioThread.Stop();
+    audio_core_shutdown();
+
+    SoundCacheStats cache_stats;
+    get_sound_cache_stats(cache_stats);
+    Debug::Printf(kDbgMsg_Init, "Sound cache: %u hits, %u misses, %u evictions; %u of %u sounds, %u of %u KB used",
+        cache_stats.Hits, cache_stats.Misses, cache_stats.Evictions, (unsigned)cache_stats.Entries, (unsigned)cache_stats.MaxEntries,
+        (unsigned)(cache_stats.Used / 1024), (unsigned)(cache_stats.Limit / 1024));
 
     remove_sound();
 }
@@ -186,6 +199,8 @@ void quit_message_on_exit(const char *qmsg, String &alertis, QuitReason qreason)
 
 void quit_release_data()
 {
+    cancel_room_preload();
+    WaitForSavegameWrite();
     resetRoomStatuses();
     thisroom.Free();
 
@@ -273,6 +288,12 @@ void quit(const char *quitmsg)
     shutdown_font_renderer();
     our_eip = 9902;
 
+    SpriteTransformCacheStats transform_stats;
+    get_transformed_sprite_cache_stats(transform_stats);
+    Debug::Printf(kDbgMsg_Init, "Transformed sprite cache: %u hits, %u misses, %u evictions; %u images, %u of %u KB used",
+        transform_stats.Hits, transform_stats.Misses, transform_stats.Evictions, (unsigned)transform_stats.Entries,
+        (unsigned)(transform_stats.Used / 1024), (unsigned)(transform_stats.Limit / 1024));
+    clear_transformed_sprite_cache();
     spriteset.Reset();
 
     our_eip = 9907;
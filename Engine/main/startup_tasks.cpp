@@ -0,0 +1,230 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <chrono>
+#include <vector>
+#include "debug/out.h"
+#include "main/startup_tasks.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
+#include "util/thread.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+namespace
+{
+
+typedef std::chrono::high_resolution_clock StartupClock;
+
+enum StartupTaskState
+{
+    kTask_Pending,
+    kTask_Running,
+    kTask_Done
+};
+
+struct StartupTask
+{
+    const char      *Name;
+    StartupTaskFunc  Func;
+    int              Dependencies[2];
+    StartupTaskState State;
+    bool             OnWorker;
+    uint64_t         StartTime; // in microseconds since the startup began
+    uint64_t         EndTime;
+};
+
+struct StartupPhase
+{
+    const char      *Name;
+    uint64_t         StartTime; // in microseconds since the startup began
+    uint64_t         EndTime;
+    uint64_t         WaitTime;  // time spent waiting for the tasks
+};
+
+const int StartupWorkerCount = 3;
+// Time an idle worker sleeps before looking for a ready task, in milliseconds
+const int WorkerIdleDelay = 1;
+
+Mutex                     TaskMutex;
+// Tasks may only be accessed with the mutex locked
+std::vector<StartupTask>  Tasks;
+// Phases are only accessed by the main thread
+std::vector<StartupPhase> Phases;
+Thread                    Workers[StartupWorkerCount];
+int                       WorkerCount = 0;
+StartupClock::time_point  StartupBegin;
+
+
+uint64_t get_startup_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(StartupClock::now() - StartupBegin).count();
+}
+
+bool is_task_ready(const StartupTask &task)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        if (task.Dependencies[i] >= 0 && Tasks[task.Dependencies[i]].State != kTask_Done)
+            return false;
+    }
+    return true;
+}
+
+// Marks the task as running; the mutex must be locked
+StartupTaskFunc claim_task(int task, bool on_worker)
+{
+    Tasks[task].State = kTask_Running;
+    Tasks[task].OnWorker = on_worker;
+    Tasks[task].StartTime = get_startup_time();
+    return Tasks[task].Func;
+}
+
+void run_task(int task, StartupTaskFunc func)
+{
+    func();
+    MutexLock _lock(TaskMutex);
+    Tasks[task].State = kTask_Done;
+    Tasks[task].EndTime = get_startup_time();
+}
+
+// Worker thread entry, called repeatedly until the thread is stopped
+void startup_worker_update()
+{
+    MutexLock _lock(TaskMutex);
+    for (size_t i = 0; i < Tasks.size(); ++i)
+    {
+        if (Tasks[i].State != kTask_Pending || !is_task_ready(Tasks[i]))
+            continue;
+        StartupTaskFunc func = claim_task(i, true);
+        _lock.Release();
+        run_task(i, func);
+        return;
+    }
+    _lock.Release();
+    AGSPlatformDriver::GetDriver()->Delay(WorkerIdleDelay);
+}
+
+void wait_for_task(int task)
+{
+    for (;;)
+    {
+        MutexLock _lock(TaskMutex);
+        StartupTask &t = Tasks[task];
+        if (t.State == kTask_Done)
+            return;
+        if (t.State == kTask_Pending)
+        {
+            if (is_task_ready(t))
+            {
+                StartupTaskFunc func = claim_task(task, false);
+                _lock.Release();
+                run_task(task, func);
+                return;
+            }
+            const int dep = Tasks[t.Dependencies[0]].State != kTask_Done ? t.Dependencies[0] : t.Dependencies[1];
+            _lock.Release();
+            wait_for_task(dep);
+            continue;
+        }
+        _lock.Release();
+        AGSPlatformDriver::GetDriver()->YieldCPU();
+    }
+}
+
+void log_timing()
+{
+    Debug::Printf(kDbgMsg_Init, "Startup timing, total %.1f ms:", Phases.back().EndTime / 1000.0);
+    for (size_t i = 0; i < Phases.size(); ++i)
+    {
+        const StartupPhase &p = Phases[i];
+        Debug::Printf(kDbgMsg_Init, "  phase %-20s %8.1f ms (waiting for tasks %.1f ms)",
+            p.Name, (p.EndTime - p.StartTime) / 1000.0, p.WaitTime / 1000.0);
+    }
+    for (size_t i = 0; i < Tasks.size(); ++i)
+    {
+        const StartupTask &t = Tasks[i];
+        Debug::Printf(kDbgMsg_Init, "  task  %-20s %8.1f ms (started at %.1f ms, on %s thread)",
+            t.Name, (t.EndTime - t.StartTime) / 1000.0, t.StartTime / 1000.0, t.OnWorker ? "worker" : "main");
+    }
+}
+
+} // namespace
+
+
+void startup_tasks_init(const char *first_phase)
+{
+    StartupBegin = StartupClock::now();
+    Phases.clear();
+    startup_phase(first_phase);
+    for (WorkerCount = 0; WorkerCount < StartupWorkerCount; ++WorkerCount)
+    {
+        if (!Workers[WorkerCount].CreateAndStart(startup_worker_update, true))
+            break;
+    }
+    if (WorkerCount == 0)
+        Debug::Printf(kDbgMsg_Warn, "Failed to start the worker threads, startup tasks will run on the main thread");
+}
+
+void startup_tasks_shutdown()
+{
+    if (Phases.empty())
+        return;
+    const uint64_t wait_start = get_startup_time();
+    for (size_t i = 0; i < Tasks.size(); ++i)
+        wait_for_task(i);
+    Phases.back().WaitTime += get_startup_time() - wait_start;
+    for (int i = 0; i < WorkerCount; ++i)
+        Workers[i].Stop();
+    WorkerCount = 0;
+    Phases.back().EndTime = get_startup_time();
+
+    log_timing();
+    Tasks.clear();
+    Phases.clear();
+}
+
+int startup_task_add(const char *name, StartupTaskFunc func, int dependency1, int dependency2)
+{
+    StartupTask task;
+    task.Name = name;
+    task.Func = func;
+    task.Dependencies[0] = dependency1;
+    task.Dependencies[1] = dependency2;
+    task.State = kTask_Pending;
+    task.OnWorker = false;
+    task.StartTime = task.EndTime = 0;
+    MutexLock _lock(TaskMutex);
+    Tasks.push_back(task);
+    return Tasks.size() - 1;
+}
+
+void startup_task_wait(int task)
+{
+    const uint64_t wait_start = get_startup_time();
+    wait_for_task(task);
+    if (!Phases.empty())
+        Phases.back().WaitTime += get_startup_time() - wait_start;
+}
+
+void startup_phase(const char *name)
+{
+    const uint64_t now = get_startup_time();
+    if (!Phases.empty())
+        Phases.back().EndTime = now;
+    StartupPhase phase = { name, now, now, 0 };
+    Phases.push_back(phase);
+}
@@ -0,0 +1,50 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Startup tasks: lets the engine run independent initialization steps, that
+// mostly wait for the disk, on the worker threads while the main thread
+// carries on with the rest of the initialization.
+//
+// A task may depend on other tasks, and is not started before all of them are
+// complete. Tasks must not touch anything the main thread may use while they
+// run, nor display any messages: they should store their results, which are
+// applied by the main thread after it waited for the task.
+// If the worker threads could not be started, the tasks are run on the main
+// thread when it waits for them.
+//
+// The main thread's initialization is split into named phases; the time taken
+// by every phase and every task is written to the log at the end.
+//
+//=============================================================================
+#ifndef __AGS_EE_MAIN__STARTUPTASKS_H
+#define __AGS_EE_MAIN__STARTUPTASKS_H
+
+typedef void (*StartupTaskFunc)();
+
+// Starts the worker threads and the timing of the first phase
+void startup_tasks_init(const char *first_phase);
+// Waits for all the remaining tasks, stops the worker threads and logs the timing
+void startup_tasks_shutdown();
+
+// Adds a task, which may start as soon as the listed tasks are complete;
+// returns the task's handle
+int  startup_task_add(const char *name, StartupTaskFunc func, int dependency1 = -1, int dependency2 = -1);
+// Waits until the task is complete; runs the task on the calling thread if
+// no worker has picked it up yet
+void startup_task_wait(int task);
+
+// Marks the beginning of the next phase of the main thread
+void startup_phase(const char *name);
+
+#endif // __AGS_EE_MAIN__STARTUPTASKS_H
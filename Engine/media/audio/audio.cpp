@@ -14,6 +14,7 @@
 
 #include "util/wgt2allg.h"
 #include "media/audio/audio.h"
+#include "media/audio/audiocore.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/dynobj/cc_audioclip.h"
 #include "ac/dynobj/cc_audiochannel.h"
@@ -35,9 +36,6 @@
 
 using namespace AGS::Common;
 
-AGS::Engine::Mutex _audio_mutex;
-volatile bool _audio_doing_crossfade;
-
 extern GameSetupStruct game;
 extern GameSetup usetup;
 extern GameState play;
@@ -47,15 +45,13 @@ extern CharacterInfo*playerchar;
 extern volatile int switching_away_from_game;
 
 #if !defined(IOS_VERSION) && !defined(PSP_VERSION) && !defined(ANDROID_VERSION)
-volatile int psp_audio_multithreaded = 0;
+volatile int psp_audio_multithreaded = 1;
 #endif
 
 ScriptAudioChannel scrAudioChannel[MAX_SOUND_CHANNELS + 1];
 char acaudio_buffer[256];
 int reserved_channel_count = 0;
 
-AGS::Engine::Thread audioThread;
-
 void calculate_reserved_channel_count()
 {
     int reservedChannels = 0;
@@ -432,8 +428,7 @@ void stop_and_destroy_channel_ex(int chid, bool resetLegacyMusicSettings) {
         quit("!StopChannel: invalid channel ID");
 
     if (channels[chid] != NULL) {
-        channels[chid]->destroy();
-        delete channels[chid];
+        audio_core_destroy_clip(channels[chid]);
         channels[chid] = NULL;
     }
 
@@ -578,7 +573,7 @@ void update_ambient_sound_vol () {
         if (channels[thisSound->channel] == NULL)
             quit("Internal error: the ambient sound channel is enabled, but it has been destroyed");
 
-        channels[thisSound->channel]->set_volume(wantvol);
+        audio_core_clip_set_volume(channels[thisSound->channel], wantvol);
     }
 }
 
@@ -792,7 +787,6 @@ extern int frames_per_second;
 void update_mp3_thread()
 {
 	while (switching_away_from_game) { }
-	AGS::Engine::MutexLock _lock(_audio_mutex);
 	for (musicPollIterator = 0; musicPollIterator <= MAX_SOUND_CHANNELS; ++musicPollIterator)
 	{
 		if ((channels[musicPollIterator] != NULL) && (channels[musicPollIterator]->done == 0))
@@ -803,6 +797,7 @@ void update_mp3_thread()
 void update_mp3()
 {
 	if (!psp_audio_multithreaded) update_mp3_thread();
+	else audio_core_update();
 }
 
 void update_polled_mp3() {
@@ -823,10 +818,6 @@ void update_polled_audio_and_crossfade ()
 {
 	update_polled_stuff_if_runtime ();
 
-	AGS::Engine::MutexLock _lock(_audio_mutex);
-
-    _audio_doing_crossfade = true;
-
     audio_update_polled_stuff();
 
     if (crossFading) {
@@ -856,9 +847,6 @@ void update_polled_audio_and_crossfade ()
                 }
         }
     }
-
-    _audio_doing_crossfade = false;
-
 }
 
 
@@ -931,7 +919,7 @@ void update_music_volume() {
             }
             else {
                 if (crossFading > 0)
-                    channels[crossFading]->set_volume((curvol > targetVol) ? targetVol : curvol);
+                    audio_core_clip_set_volume(channels[crossFading], (curvol > targetVol) ? targetVol : curvol);
 
                 newvol -= curvol;
                 if (newvol < 0)
@@ -19,9 +19,6 @@
 #include "ac/dynobj/scriptaudioclip.h"
 #include "ac/dynobj/scriptaudiochannel.h"
 #include "media/audio/ambientsound.h"
-#include "util/mutex.h"
-#include "util/mutex_lock.h"
-#include "util/thread.h"
 
 struct SOUNDCLIP;
 
@@ -90,13 +87,12 @@ SOUNDCLIP * load_music_from_disk(int mnum, bool doRepeat);
 void        play_new_music(int mnum, SOUNDCLIP *music);
 void        newmusic(int mnum);
 
-extern AGS::Engine::Thread audioThread;
-extern AGS::Engine::Mutex _audio_mutex;
-extern volatile bool _audio_doing_crossfade;
 extern SOUNDCLIP *channels[MAX_SOUND_CHANNELS+1]; // needed for update_mp3_thread
 extern volatile int psp_audio_multithreaded;
 
+// Polls playing clips, or lets the audio thread know about new ones if it's running
 void update_mp3();
+// Polls playing clips on the calling thread
 void update_mp3_thread();
 
 extern volatile int mvolcounter;
@@ -0,0 +1,314 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <vector>
+#include "media/audio/audiocore.h"
+#include "media/audio/audiodefines.h"
+#include "media/audio/soundclip.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/lockfree_ring.h"
+#include "util/thread.h"
+
+using namespace AGS::Engine;
+
+extern SOUNDCLIP *channels[MAX_SOUND_CHANNELS+1];
+extern volatile int switching_away_from_game;
+
+namespace
+{
+
+enum AudioCommandType
+{
+    kAudioCmd_Attach,       // start polling the clip
+    kAudioCmd_Destroy,      // stop polling, destroy and delete the clip
+    kAudioCmd_SetVolume,
+    kAudioCmd_AdjustVolume,
+    kAudioCmd_SetPanning,
+    kAudioCmd_SetSpeed,
+    kAudioCmd_Seek
+};
+
+// Clip handed over to the audio thread; the id tells apart the clips that
+// were allocated at the same address one after another
+struct PolledClip
+{
+    SOUNDCLIP *Clip;
+    uint32_t   Id;
+};
+
+struct AudioCommand
+{
+    AudioCommandType Type;
+    PolledClip       Clip;
+    int              Param;
+};
+
+enum AudioEventType
+{
+    kAudioEvent_ClipFinished
+};
+
+// Events only refer to the clips by id, as the game thread may have
+// destroyed the clip by the time it receives the event
+struct AudioEvent
+{
+    AudioEventType   Type;
+    uint32_t         ClipId;
+};
+
+typedef std::vector<PolledClip> PolledClips;
+
+// Time the audio thread sleeps between polling clips, in milliseconds;
+// must be well below the duration of a stream buffer
+const int AudioThreadPollInterval = 10;
+// Only the clips on the channels are handed over, and every clip is taken
+// back before it is replaced on its channel; the lists are reserved to this
+// size, so that the audio thread does not allocate memory normally
+const size_t MaxPolledClips = MAX_SOUND_CHANNELS + 1;
+
+Thread AudioThread;
+bool   AudioThreadRunning = false;
+
+// Game thread -> audio thread
+LockFreeRing<AudioCommand, 256> CommandRing;
+// Audio thread -> game thread
+LockFreeRing<AudioEvent, 64>    EventRing;
+
+// Clips polled by the audio thread; only accessed by the audio thread
+PolledClips PollList;
+// Clips handed over to the audio thread; only accessed by the game thread
+PolledClips AttachedList;
+uint32_t    NextClipId = 1;
+
+
+PolledClips::iterator find_clip(PolledClips &clips, SOUNDCLIP *clip)
+{
+    for (PolledClips::iterator it = clips.begin(); it != clips.end(); ++it)
+    {
+        if (it->Clip == clip)
+            return it;
+    }
+    return clips.end();
+}
+
+void remove_clip_at(PolledClips &clips, PolledClips::iterator it)
+{
+    if (it == clips.end())
+        return;
+    *it = clips.back();
+    clips.pop_back();
+}
+
+void execute_command(const AudioCommand &cmd)
+{
+    switch (cmd.Type)
+    {
+    case kAudioCmd_Attach:
+        if (find_clip(PollList, cmd.Clip.Clip) == PollList.end())
+            PollList.push_back(cmd.Clip);
+        break;
+    case kAudioCmd_Destroy:
+        remove_clip_at(PollList, find_clip(PollList, cmd.Clip.Clip));
+        cmd.Clip.Clip->destroy();
+        delete cmd.Clip.Clip;
+        break;
+    case kAudioCmd_SetVolume:
+        cmd.Clip.Clip->set_volume(cmd.Param);
+        break;
+    case kAudioCmd_AdjustVolume:
+        cmd.Clip.Clip->adjust_volume();
+        break;
+    case kAudioCmd_SetPanning:
+        cmd.Clip.Clip->set_panning(cmd.Param);
+        break;
+    case kAudioCmd_SetSpeed:
+        cmd.Clip.Clip->set_speed(cmd.Param);
+        break;
+    case kAudioCmd_Seek:
+        cmd.Clip.Clip->seek(cmd.Param);
+        break;
+    }
+}
+
+// Audio thread entry, called repeatedly until the thread is stopped
+void audio_thread_update()
+{
+    AudioCommand cmd;
+    while (CommandRing.Pop(cmd))
+        execute_command(cmd);
+
+    if (!switching_away_from_game)
+    {
+        for (size_t i = 0; i < PollList.size();)
+        {
+            const PolledClip &polled = PollList[i];
+            if (polled.Clip->poll() == 0)
+            {
+                ++i;
+                continue;
+            }
+            // Clip is finished: stop polling it once the game has been told;
+            // if the event ring is full, try again on next update
+            AudioEvent evt = { kAudioEvent_ClipFinished, polled.Id };
+            if (EventRing.Push(evt))
+                remove_clip_at(PollList, PollList.begin() + i);
+            else
+                ++i;
+        }
+    }
+
+    AGSPlatformDriver::GetDriver()->Delay(AudioThreadPollInterval);
+}
+
+void post_command(AudioCommandType type, const PolledClip &clip, int param = 0)
+{
+    AudioCommand cmd = { type, clip, param };
+    if (!AudioThreadRunning)
+    {
+        execute_command(cmd);
+        return;
+    }
+    // The audio thread empties the ring on every update, so it cannot stay full for long
+    while (!CommandRing.Push(cmd))
+        AGSPlatformDriver::GetDriver()->YieldCPU();
+}
+
+// Posts the change to the audio thread if it polls the clip, so that it is
+// applied in order with the other commands; otherwise applies it right away
+void change_clip(AudioCommandType type, SOUNDCLIP *clip, int param)
+{
+    PolledClips::iterator it = find_clip(AttachedList, clip);
+    if (it != AttachedList.end())
+    {
+        post_command(type, *it, param);
+        return;
+    }
+    PolledClip polled = { clip, 0 };
+    AudioCommand cmd = { type, polled, param };
+    execute_command(cmd);
+}
+
+} // namespace
+
+
+bool audio_core_init()
+{
+    if (!AudioThreadRunning)
+    {
+        PollList.reserve(MaxPolledClips);
+        AttachedList.reserve(MaxPolledClips);
+        AudioThreadRunning = AudioThread.CreateAndStart(audio_thread_update, true);
+    }
+    return AudioThreadRunning;
+}
+
+void audio_core_shutdown()
+{
+    if (!AudioThreadRunning)
+        return;
+    AudioThread.Stop();
+    AudioThreadRunning = false;
+
+    // The audio thread is gone, complete whatever it did not get to
+    AudioCommand cmd;
+    while (CommandRing.Pop(cmd))
+        execute_command(cmd);
+    AudioEvent evt;
+    while (EventRing.Pop(evt));
+    PollList.clear();
+    AttachedList.clear();
+}
+
+bool audio_core_is_threaded()
+{
+    return AudioThreadRunning;
+}
+
+void audio_core_update()
+{
+    if (!AudioThreadRunning)
+        return;
+
+    AudioEvent evt;
+    while (EventRing.Pop(evt))
+    {
+        switch (evt.Type)
+        {
+        case kAudioEvent_ClipFinished:
+            // Forget the clip, so that it is handed over again if restarted;
+            // if it was destroyed meanwhile, it is not in the list anymore
+            for (PolledClips::iterator it = AttachedList.begin(); it != AttachedList.end(); ++it)
+            {
+                if (it->Id == evt.ClipId)
+                {
+                    remove_clip_at(AttachedList, it);
+                    break;
+                }
+            }
+            break;
+        }
+    }
+
+    for (int i = 0; i <= MAX_SOUND_CHANNELS; ++i)
+    {
+        SOUNDCLIP *clip = channels[i];
+        if ((clip == NULL) || (clip->done != 0) || find_clip(AttachedList, clip) != AttachedList.end())
+            continue;
+        PolledClip polled = { clip, NextClipId++ };
+        AttachedList.push_back(polled);
+        post_command(kAudioCmd_Attach, polled);
+    }
+}
+
+void audio_core_destroy_clip(SOUNDCLIP *clip)
+{
+    if (clip == NULL)
+        return;
+    remove_clip_at(AttachedList, find_clip(AttachedList, clip));
+    PolledClip polled = { clip, 0 };
+    post_command(kAudioCmd_Destroy, polled);
+}
+
+void audio_core_clip_set_volume(SOUNDCLIP *clip, int volume)
+{
+    change_clip(kAudioCmd_SetVolume, clip, volume);
+}
+
+void audio_core_clip_adjust_volume(SOUNDCLIP *clip)
+{
+    change_clip(kAudioCmd_AdjustVolume, clip, 0);
+}
+
+void audio_core_clip_set_panning(SOUNDCLIP *clip, int panning)
+{
+    change_clip(kAudioCmd_SetPanning, clip, panning);
+}
+
+void audio_core_clip_set_speed(SOUNDCLIP *clip, int speed)
+{
+    change_clip(kAudioCmd_SetSpeed, clip, speed);
+}
+
+void audio_core_clip_seek(SOUNDCLIP *clip, int pos)
+{
+    // Clips that report no position may be streams, which cannot seek and
+    // quit with the script error; that must happen on the game thread, so
+    // they are seeked right away, under the clip's own lock
+    if (clip->get_pos() == 0)
+    {
+        clip->seek(pos);
+        return;
+    }
+    change_clip(kAudioCmd_Seek, clip, pos);
+}
@@ -0,0 +1,60 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Audio core: the dedicated audio thread.
+//
+// When running, the audio thread owns the polling (decoding) of every sound
+// clip that is playing on a channel. The game thread talks to it through a
+// lock-free command ring: it hands started clips over, changes their volume,
+// panning, speed and position, and stops them; the audio thread applies the
+// commands in order, and reports back clips that finished playing through
+// another ring. Changes to a clip which the audio thread does not poll are
+// applied immediately.
+//
+// Each clip still has its own lock, which the audio thread holds while
+// polling the clip. The game thread takes it when reading the playback
+// position, and the display switch callbacks, which may run on a system
+// thread of their own, take it to pause and resume the clips.
+//
+// When the thread is not running all the functions below perform their
+// action immediately on the calling thread.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__AUDIOCORE_H
+#define __AGS_EE_MEDIA__AUDIOCORE_H
+
+struct SOUNDCLIP;
+
+// Starts the audio thread; returns false if it could not be started
+bool audio_core_init();
+// Stops the audio thread, and executes any commands left pending
+void audio_core_shutdown();
+// Tells if the clips are currently polled by the audio thread
+bool audio_core_is_threaded();
+// Hands clips that started playing on the channels over to the audio thread,
+// and processes notifications received from it. Should be called by the game
+// thread regularly; does nothing if the audio thread is not running.
+void audio_core_update();
+
+// Stops the clip, releases its resources and deletes the object
+void audio_core_destroy_clip(SOUNDCLIP *clip);
+// Applies absolute volume (0 - 255) to the clip's playback
+void audio_core_clip_set_volume(SOUNDCLIP *clip, int volume);
+// Applies the clip's volume together with its volume modifiers
+void audio_core_clip_adjust_volume(SOUNDCLIP *clip);
+void audio_core_clip_set_panning(SOUNDCLIP *clip, int panning);
+void audio_core_clip_set_speed(SOUNDCLIP *clip, int speed);
+void audio_core_clip_seek(SOUNDCLIP *clip, int pos);
+
+#endif // __AGS_EE_MEDIA__AUDIOCORE_H
@@ -18,6 +18,7 @@
 
 #include "media/audio/clip_mydumbmod.h"
 #include "media/audio/audiointernaldefs.h"
+#include "util/mutex_lock.h"
 
 void al_duh_set_loop(AL_DUH_PLAYER *dp, int loop) {
     DUH_SIGRENDERER *sr = al_duh_get_sigrenderer(dp);
@@ -33,6 +34,8 @@ void al_duh_set_loop(AL_DUH_PLAYER *dp, int loop) {
 
 int MYMOD::poll()
 {
+    AGS::Engine::MutexLock _lock(_mutex);
+
     if (done)
         return done;
 
@@ -49,6 +52,8 @@ int MYMOD::poll()
 
 void MYMOD::adjust_volume()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (duhPlayer)
         al_duh_set_volume(duhPlayer, VOLUME_TO_DUMB_VOL(get_final_volume()));
 }
@@ -61,6 +66,7 @@ void MYMOD::set_volume(int newvol)
 
 void MYMOD::destroy()
 {
+    AGS::Engine::MutexLock _lock(_mutex);
     if (duhPlayer) {
         al_stop_duh(duhPlayer);
         duhPlayer = NULL;
@@ -73,6 +79,8 @@ void MYMOD::destroy()
 
 void MYMOD::seek(int patnum)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if ((!done) && (duhPlayer)) {
         al_stop_duh(duhPlayer);
         done = 0;
@@ -122,6 +130,8 @@ int MYMOD::get_length_ms()
 
 void MYMOD::restart()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (tune != NULL) {
         al_stop_duh(duhPlayer);
         done = 0;
@@ -136,12 +146,16 @@ int MYMOD::get_voice()
 }
 
 void MYMOD::pause() {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (tune != NULL) {
         al_pause_duh(duhPlayer);
     }
 }
 
 void MYMOD::resume() {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (tune != NULL) {
         al_resume_duh(duhPlayer);
     }
@@ -21,19 +21,11 @@
 #include "ac/common.h"               // quit()
 #include "util/mutex_lock.h"
 
-#include "platform/base/agsplatformdriver.h"
-
 
 int MYMP3::poll()
 {
 	AGS::Engine::MutexLock _lock(_mutex);
 
-    if (!done && _destroyThis)
-    {
-      internal_destroy();
-      _destroyThis = false;
-    }
-
     if (done)
     {
         return done;
@@ -70,8 +62,6 @@ int MYMP3::poll()
     if (result == ALMP3_POLL_PLAYJUSTFINISHED)
     {
         done = 1;
-        if (psp_audio_multithreaded)
-            internal_destroy();
     }
 
     return done;
@@ -85,11 +75,15 @@ void MYMP3::adjust_stream()
 
 void MYMP3::adjust_volume()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     adjust_stream();
 }
 
 void MYMP3::set_volume(int newvol)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     // boost MP3 volume
     newvol += 20;
     if (newvol > 255)
@@ -101,6 +95,8 @@ void MYMP3::set_volume(int newvol)
 
 void MYMP3::set_speed(int new_speed)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     speed = new_speed;
     adjust_stream();
 }
@@ -124,23 +120,13 @@ void MYMP3::internal_destroy()
     buffer = NULL;
     pack_fclose(in);
 
-    _destroyThis = false;
     done = 1;
 }
 
 void MYMP3::destroy()
 {
-	AGS::Engine::MutexLock _lock(_mutex);
-
-    if (psp_audio_multithreaded && _playing && !_audio_doing_crossfade)
-      _destroyThis = true;
-    else
-      internal_destroy();
-
-	_lock.Release();
-
-    while (!done)
-      AGSPlatformDriver::GetDriver()->YieldCPU();
+    AGS::Engine::MutexLock _lock(_mutex);
+    internal_destroy();
 }
 
 void MYMP3::seek(int pos)
@@ -168,6 +154,8 @@ int MYMP3::get_length_ms()
 
 void MYMP3::restart()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (stream != NULL) {
         // need to reset file pointer for this to work
 		AGS::Engine::MutexLock _lockMp3(_mp3_mutex);
@@ -200,8 +188,6 @@ int MYMP3::play() {
     if (!psp_audio_multithreaded)
       poll();
 
-    _playing = true;
-
     return 1;
 }
 
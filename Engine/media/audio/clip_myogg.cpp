@@ -18,8 +18,6 @@
 #include "ac/common.h"               // quit()
 #include "util/mutex_lock.h"
 
-#include "platform/base/agsplatformdriver.h"
-
 
 extern "C" {
     extern int alogg_is_end_of_oggstream(ALOGG_OGGSTREAM *ogg);
@@ -32,12 +30,6 @@ int MYOGG::poll()
 {
     AGS::Engine::MutexLock _lock(_mutex);
 
-    if (!done && _destroyThis)
-    {
-      internal_destroy();
-      _destroyThis = false;
-    }
-
     if (done)
     {
         return done;
@@ -66,12 +58,10 @@ int MYOGG::poll()
 
     int ret = alogg_poll_oggstream(stream);
     if (ret == ALOGG_OK || ret == ALOGG_POLL_BUFFERUNDERRUN)
-        get_pos_ms();  // call this to keep the last_but_one stuff up to date
+        internal_get_pos_ms();  // call this to keep the last_but_one stuff up to date
     else {
         // finished playing or error
         done = 1;
-        if (psp_audio_multithreaded)
-            internal_destroy();
     }
     return done;
 }
@@ -83,11 +73,15 @@ void MYOGG::adjust_stream()
 
 void MYOGG::adjust_volume()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     adjust_stream();
 }
 
 void MYOGG::set_volume(int newvol)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     // boost MP3 volume
     newvol += 20;
     if (newvol > 255)
@@ -98,6 +92,8 @@ void MYOGG::set_volume(int newvol)
 
 void MYOGG::set_speed(int new_speed)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     speed = new_speed;
     adjust_stream();
 }
@@ -114,23 +110,13 @@ void MYOGG::internal_destroy()
     buffer = NULL;
     pack_fclose(in);
 
-    _destroyThis = false;
     done = 1;
 }
 
 void MYOGG::destroy()
 {
-	AGS::Engine::MutexLock _lock(_mutex);
-
-    if (psp_audio_multithreaded && _playing && !_audio_doing_crossfade)
-      _destroyThis = true;
-    else
-      internal_destroy();
-
-	_lock.Release();
-
-    while (!done)
-      AGSPlatformDriver::GetDriver()->YieldCPU();
+    AGS::Engine::MutexLock _lock(_mutex);
+    internal_destroy();
 }
 
 void MYOGG::seek(int pos)
@@ -144,6 +130,13 @@ int MYOGG::get_pos()
 }
 
 int MYOGG::get_pos_ms()
+{
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
+    return internal_get_pos_ms();
+}
+
+int MYOGG::internal_get_pos_ms()
 {
     // Unfortunately the alogg_get_pos_msecs_oggstream function
     // returns the ms offset that was last decoded, so it's always
@@ -194,6 +187,8 @@ int MYOGG::get_length_ms()
 
 void MYOGG::restart()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (stream != NULL) {
         // need to reset file pointer for this to work
         quit("Attempted to restart OGG not currently supported");
@@ -224,8 +219,6 @@ int MYOGG::play() {
     if (!psp_audio_multithreaded)
       poll();
 
-    _playing = true;
-
     return 1;
 }
 
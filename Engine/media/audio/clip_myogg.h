@@ -60,6 +60,7 @@ protected:
     virtual void adjust_volume();
 private:
     void adjust_stream();
+    int internal_get_pos_ms();
 };
 
 #endif // __AC_MYOGG_H
\ No newline at end of file
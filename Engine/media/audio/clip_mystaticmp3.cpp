@@ -21,7 +21,6 @@
 #include "media/audio/soundcache.h"
 #include "util/mutex_lock.h"
 
-#include "platform/base/agsplatformdriver.h"
 
 extern int our_eip;
 
@@ -33,12 +32,6 @@ int MYSTATICMP3::poll()
 {
     AGS::Engine::MutexLock _lock(_mutex);
 
-    if (tune && !done && _destroyThis)
-    {
-      internal_destroy();
-      _destroyThis = false;
-    }
-
     int oldeip = our_eip;
     our_eip = 5997;
     
@@ -55,8 +48,6 @@ int MYSTATICMP3::poll()
         if (!repeat)
         {
             done = 1;
-            if (psp_audio_multithreaded)
-                internal_destroy();
         }
       }
     }
@@ -76,17 +67,23 @@ void MYSTATICMP3::adjust_stream()
 
 void MYSTATICMP3::adjust_volume()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     adjust_stream();
 }
 
 void MYSTATICMP3::set_volume(int newvol)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     vol = newvol;
     adjust_stream();
 }
 
 void MYSTATICMP3::set_speed(int new_speed)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     speed = new_speed;
     adjust_stream();
 }
@@ -105,30 +102,19 @@ void MYSTATICMP3::internal_destroy()
       mp3buffer = NULL;
   }
 
-  _destroyThis = false;
   done = 1;
 }
 
 void MYSTATICMP3::destroy()
 {
-	AGS::Engine::MutexLock _lock(_mutex);
-
-    if (psp_audio_multithreaded && _playing && !_audio_doing_crossfade)
-      _destroyThis = true;
-    else
-      internal_destroy();
-
-	_lock.Release();
-
-    while (!done)
-      AGSPlatformDriver::GetDriver()->YieldCPU();
-
-    // Allow the last poll cycle to finish.
-	_lock.Acquire(_mutex);
+    AGS::Engine::MutexLock _lock(_mutex);
+    internal_destroy();
 }
 
 void MYSTATICMP3::seek(int pos)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     AGS::Engine::MutexLock _lockMp3(_mp3_mutex);
     almp3_seek_abs_msecs_mp3(tune, pos);
 }
@@ -153,6 +139,8 @@ int MYSTATICMP3::get_length_ms()
 
 void MYSTATICMP3::restart()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (tune != NULL) {
         AGS::Engine::MutexLock _lockMp3(_mp3_mutex);
         almp3_stop_mp3(tune);
@@ -190,8 +178,6 @@ int MYSTATICMP3::play() {
 
     if (!psp_audio_multithreaded)
       poll();
-
-    _playing = true;
     return 1;
 }
 
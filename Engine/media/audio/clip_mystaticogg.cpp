@@ -18,7 +18,6 @@
 #include "media/audio/soundcache.h"
 #include "util/mutex_lock.h"
 
-#include "platform/base/agsplatformdriver.h"
 
 extern "C" {
     extern int alogg_is_end_of_oggstream(ALOGG_OGGSTREAM *ogg);
@@ -28,28 +27,30 @@ extern "C" {
 }
 
 extern int use_extra_sound_offset;  // defined in ac.cpp
+extern int stream_preroll_ms;
+
+// Size of the audio stream buffer, which is filled with decoded sound in
+// advance; streamed clips read from disk when refilling it
+static int get_stream_buffer_len(ALOGG_OGG *tune)
+{
+    int bytes_per_sec = alogg_get_wave_freq_ogg(tune) * (alogg_get_wave_is_stereo_ogg(tune) ? 2 : 1) * 2;
+    int len = (int)((long long)bytes_per_sec * stream_preroll_ms / 1000) & ~3;
+    return len < 4096 ? 4096 : len;
+}
 
 int MYSTATICOGG::poll()
 {
 	AGS::Engine::MutexLock _lock(_mutex);
 
-    if (tune && !done && _destroyThis)
-    {
-      internal_destroy();
-      _destroyThis = false;
-    }
-
     if ((tune == NULL) || (!ready))
         ; // Do nothing
     else if (alogg_poll_ogg(tune) == ALOGG_POLL_PLAYJUSTFINISHED) {
         if (!repeat)
         {
             done = 1;
-            if (psp_audio_multithreaded)
-                internal_destroy();
         }
     }
-    else get_pos();  // call this to keep the last_but_one stuff up to date
+    else internal_get_pos_ms();  // call this to keep the last_but_one stuff up to date
 
     return done;
 }
@@ -62,17 +63,23 @@ void MYSTATICOGG::adjust_stream()
 
 void MYSTATICOGG::adjust_volume()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     adjust_stream();
 }
 
 void MYSTATICOGG::set_volume(int newvol)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     vol = newvol;
     adjust_stream();
 }
 
 void MYSTATICOGG::set_speed(int new_speed)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     speed = new_speed;
     adjust_stream();
 }
@@ -90,37 +97,31 @@ void MYSTATICOGG::internal_destroy()
         mp3buffer = NULL;
     }
 
-    _destroyThis = false;
     done = 1;
 }
 
 void MYSTATICOGG::destroy()
 {
-	AGS::Engine::MutexLock _lock(_mutex);
-
-    if (psp_audio_multithreaded && _playing && !_audio_doing_crossfade)
-      _destroyThis = true;
-    else
-      internal_destroy();
-
-	_lock.Release();
-
-    while (!done)
-      AGSPlatformDriver::GetDriver()->YieldCPU();
-
-    // Allow the last poll cycle to finish.
-	_lock.Acquire(_mutex);
+    AGS::Engine::MutexLock _lock(_mutex);
+    internal_destroy();
 }
 
 void MYSTATICOGG::seek(int pos)
 {
-	AGS::Engine::MutexLock _lock;
-    if (psp_audio_multithreaded)
-		_lock.Acquire(_mutex);
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     // we stop and restart it because otherwise the buffer finishes
     // playing first and the seek isn't quite accurate
     alogg_stop_ogg(tune);
-    play_from(pos);
+    if (!start_playback(pos))
+    {
+        // the clip is still owned by its channel, which will release it
+        internal_destroy();
+        return;
+    }
+
+    if (!psp_audio_multithreaded)
+      poll();
 }
 
 int MYSTATICOGG::get_pos()
@@ -129,6 +130,13 @@ int MYSTATICOGG::get_pos()
 }
 
 int MYSTATICOGG::get_pos_ms()
+{
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
+    return internal_get_pos_ms();
+}
+
+int MYSTATICOGG::internal_get_pos_ms()
 {
     // Unfortunately the alogg_get_pos_msecs function
     // returns the ms offset that was last decoded, so it's always
@@ -179,10 +187,12 @@ int MYSTATICOGG::get_length_ms()
 
 void MYSTATICOGG::restart()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (tune != NULL) {
         alogg_stop_ogg(tune);
         alogg_rewind_ogg(tune);
-        alogg_play_ogg(tune, 16384, vol, panning);
+        alogg_play_ogg(tune, get_stream_buffer_len(tune), vol, panning);
         last_ms_offs = 0;
         last_but_one = 0;
         last_but_one_but_one = 0;
@@ -207,32 +217,39 @@ int MYSTATICOGG::get_sound_type() {
 
 int MYSTATICOGG::play_from(int position)
 {
-    if (use_extra_sound_offset) 
-        extraOffset = ((16384 / (alogg_get_wave_is_stereo_ogg(tune) ? 2 : 1)) * 1000) / alogg_get_wave_freq_ogg(tune);
-    else
-        extraOffset = 0;
-
-    if (alogg_play_ex_ogg(tune, 16384, vol, panning, 1000, repeat) != ALOGG_OK) {
+    if (!start_playback(position)) {
         destroy();
         delete this;
         return 0;
     }
 
+    if (!psp_audio_multithreaded)
+      poll();
+
+    return 1;
+}
+
+bool MYSTATICOGG::start_playback(int position)
+{
+    const int buffer_len = get_stream_buffer_len(tune);
+    if (use_extra_sound_offset) 
+        extraOffset = ((buffer_len / (alogg_get_wave_is_stereo_ogg(tune) ? 2 : 1)) * 1000) / alogg_get_wave_freq_ogg(tune);
+    else
+        extraOffset = 0;
+
+    if (alogg_play_ex_ogg(tune, buffer_len, vol, panning, 1000, repeat) != ALOGG_OK)
+        return false;
+
     last_ms_offs = position;
     last_but_one = position;
     last_but_one_but_one = position;
 
     if (position > 0)
         alogg_seek_abs_msecs_ogg(tune, position);
-
-    if (!psp_audio_multithreaded)
-      poll();
-
-    return 1;
+    return true;
 }
 
 int MYSTATICOGG::play() {
-    _playing = true;
     return play_from(0);
 }
 
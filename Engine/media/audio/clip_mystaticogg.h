@@ -18,11 +18,11 @@
 #include "alogg.h"
 #include "media/audio/soundclip.h"
 
-// pre-loaded (non-streaming) OGG file
+// OGG file, either pre-loaded or decoded from the asset file while playing
 struct MYSTATICOGG:public SOUNDCLIP
 {
     ALOGG_OGG *tune;
-    char *mp3buffer;
+    char *mp3buffer; // NULL if the clip is streamed
     int mp3buffersize;
     int extraOffset;
 
@@ -63,6 +63,9 @@ protected:
     virtual void adjust_volume();
 private:
     void adjust_stream();
+    // starts playing from the position, without polling; tells if succeeded
+    bool start_playback(int position);
+    int internal_get_pos_ms();
 };
 
 #endif // __AC_MYSTATICOGG_H
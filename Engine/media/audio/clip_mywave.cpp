@@ -19,19 +19,11 @@
 #include "media/audio/soundcache.h"
 #include "util/mutex_lock.h"
 
-#include "platform/base/agsplatformdriver.h"
-
 
 int MYWAVE::poll()
 {
     AGS::Engine::MutexLock _lock(_mutex);
 
-    if (!done && _destroyThis)
-    {
-      internal_destroy();
-      _destroyThis = false;
-    }
-
     if (wave == NULL)
     {
         return 1;
@@ -50,8 +42,6 @@ int MYWAVE::poll()
     if (voice_get_position(voice) < 0)
     {
         done = 1;
-        if (psp_audio_multithreaded)
-            internal_destroy();
     }
 
     return done;
@@ -59,6 +49,8 @@ int MYWAVE::poll()
 
 void MYWAVE::adjust_volume()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (voice >= 0)
         voice_set_volume(voice, get_final_volume());
 }
@@ -76,27 +68,19 @@ void MYWAVE::internal_destroy()
     sound_cache_free((char*)wave, true);
     wave = NULL;
 
-    _destroyThis = false;
     done = 1;
 }
 
 void MYWAVE::destroy()
 {
     AGS::Engine::MutexLock _lock(_mutex);
-
-    if (psp_audio_multithreaded && _playing && !_audio_doing_crossfade)
-      _destroyThis = true;
-    else
-      internal_destroy();
-
-	_lock.Release();
-
-    while (!done)
-      AGSPlatformDriver::GetDriver()->YieldCPU();
+    internal_destroy();
 }
 
 void MYWAVE::seek(int pos)
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     voice_set_position(voice, pos);
 }
 
@@ -125,6 +109,8 @@ int MYWAVE::get_length_ms()
 
 void MYWAVE::restart()
 {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     if (wave != NULL) {
         done = 0;
         paused = 0;
@@ -145,8 +131,6 @@ int MYWAVE::get_sound_type() {
 int MYWAVE::play() {
     voice = play_sample(wave, vol, panning, 1000, repeat);
 
-    _playing = true;
-
     return 1;
 }
 
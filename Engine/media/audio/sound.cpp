@@ -18,6 +18,7 @@
 
 #include "util/wgt2allg.h"
 #include "ac/file.h"
+#include "core/assetmanager.h"
 #include "media/audio/audiodefines.h"
 #include "media/audio/sound.h"
 #include "media/audio/audiointernaldefs.h"
@@ -36,7 +37,11 @@
 #include "media/audio/clip_mydumbmod.h"
 #endif
 #include "media/audio/soundcache.h"
+#include "util/file.h"
 #include "util/mutex_lock.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
 
 #if defined JGMOD_MOD_PLAYER && defined DUMB_MOD_PLAYER
 #error JGMOD_MOD_PLAYER and DUMB_MOD_PLAYER macros cannot be defined at the same time.
@@ -62,6 +67,11 @@ int numSoundChannels = 8;
 
 
 int use_extra_sound_offset = 0;
+// OGG clips of at least this size (in KB) are decoded straight from the asset
+// file while playing instead of being loaded whole; 0 to never stream them
+int stream_ogg_min_size = 512;
+// Amount of sound decoded ahead of playback by streamed clips, in milliseconds
+int stream_preroll_ms = 100;
 
 
 
@@ -182,10 +192,103 @@ SOUNDCLIP *my_load_static_mp3(const AssetPath &asset_name, int voll, bool loop)
 
 
 
+// OGG data read from the asset file on demand, used by the streamed clips
+struct OggAssetSource
+{
+    Stream *In;
+    soff_t  Offset; // asset's offset in the file
+    soff_t  Size;   // asset's size
+    soff_t  Pos;    // read position, relative to the asset's beginning
+};
+
+static size_t ogg_asset_read(void *ptr, size_t size, size_t nmemb, void *source)
+{
+    OggAssetSource *src = (OggAssetSource*)source;
+    if (size == 0)
+        return 0;
+    size_t items = nmemb;
+    if ((soff_t)(items * size) > src->Size - src->Pos)
+        items = (size_t)((src->Size - src->Pos) / size);
+    size_t bytes = src->In->Read(ptr, items * size);
+    src->Pos += bytes;
+    return bytes / size;
+}
+
+static int ogg_asset_seek(void *source, long offset, int whence)
+{
+    OggAssetSource *src = (OggAssetSource*)source;
+    soff_t pos;
+    switch (whence)
+    {
+    case SEEK_SET: pos = offset; break;
+    case SEEK_CUR: pos = src->Pos + offset; break;
+    case SEEK_END: pos = src->Size + offset; break;
+    default: return -1;
+    }
+    if (pos < 0 || pos > src->Size)
+        return -1;
+    if (pos != src->Pos)
+        src->In->Seek(src->Offset + pos, kSeekBegin);
+    src->Pos = pos;
+    return 0;
+}
+
+static long ogg_asset_tell(void *source)
+{
+    return (long)((OggAssetSource*)source)->Pos;
+}
+
+static int ogg_asset_close(void *source)
+{
+    OggAssetSource *src = (OggAssetSource*)source;
+    delete src->In;
+    delete src;
+    return 0;
+}
+
+// Opens the OGG for decoding directly from the asset file, without loading
+// it into memory; returns NULL if the asset is too small to be worth it
+static ALOGG_OGG *open_streamed_ogg(const AssetPath &asset_name)
+{
+    AssetLocation loc;
+    if (stream_ogg_min_size <= 0 || !LocateAsset(asset_name, loc) ||
+        loc.Size < (soff_t)stream_ogg_min_size * 1024)
+        return NULL;
+    Stream *in = File::OpenFileRead(loc.FileName);
+    if (!in)
+        return NULL;
+    in->Seek(loc.Offset, kSeekBegin);
+
+    OggAssetSource *src = new OggAssetSource();
+    src->In = in;
+    src->Offset = loc.Offset;
+    src->Size = loc.Size;
+    src->Pos = 0;
+    ALOGG_OGG_SOURCE source = { src, ogg_asset_read, ogg_asset_seek, ogg_asset_tell, ogg_asset_close };
+    ALOGG_OGG *ogg = alogg_create_ogg_from_source(&source, (int)loc.Size);
+    if (!ogg)
+        ogg_asset_close(src);
+    return ogg;
+}
+
 MYSTATICOGG *thissogg;
 SOUNDCLIP *my_load_static_ogg(const AssetPath &asset_name, int voll, bool loop)
 {
-    // Load via soundcache.
+    // Long tracks are streamed, the rest is loaded whole via soundcache
+    ALOGG_OGG *streamed = open_streamed_ogg(asset_name);
+    if (streamed != NULL)
+    {
+        thissogg = new MYSTATICOGG();
+        thissogg->vol = voll;
+        thissogg->repeat = loop;
+        thissogg->done = 0;
+        thissogg->mp3buffer = NULL;
+        thissogg->mp3buffersize = 0;
+        thissogg->tune = streamed;
+        thissogg->ready = true;
+        return thissogg;
+    }
+
     long muslen = 0;
     char* mp3buffer = get_cached_sound(asset_name, false, &muslen);
     if (mp3buffer == NULL)
@@ -32,5 +32,7 @@ SOUNDCLIP *my_load_mod(const AssetPath &asset_name, int repet);
 
 extern int numSoundChannels;
 extern int use_extra_sound_offset;
+extern int stream_ogg_min_size;
+extern int stream_preroll_ms;
 
 #endif // __AC_SOUND_H
@@ -21,39 +21,110 @@
 #include "util/mutex.h"
 #include "util/mutex_lock.h"
 #include "util/string.h"
+#include "util/string_types.h"
 
 using namespace Common;
 
-sound_cache_entry_t* sound_cache_entries = NULL;
-unsigned int sound_cache_counter = 0;
+namespace
+{
+
+struct SoundCacheEntry
+{
+    String  FileName;
+    char   *Data;
+    size_t  Size;       // memory taken by the data, in bytes
+    int     Reference;  // number of clips using the data
+    bool    IsWave;
+    // Entries that are not referenced are kept in the LRU list
+    SoundCacheEntry *Prev;
+    SoundCacheEntry *Next;
+};
+
+typedef stdtr1compat::unordered_map<String, SoundCacheEntry*> SoundCacheByName;
+typedef stdtr1compat::unordered_map<const char*, SoundCacheEntry*> SoundCacheByData;
+
+SoundCacheByName CacheByName;
+SoundCacheByData CacheByData;
+// The LRU list, from the most recently used entry to the least recently used one
+SoundCacheEntry *LruHead = NULL;
+SoundCacheEntry *LruTail = NULL;
+SoundCacheStats  CacheStats;
+
+} // namespace
 
 AGS::Engine::Mutex _sound_cache_mutex;
 
 
-void clear_sound_cache()
+static size_t get_cache_limit()
 {
-    AGS::Engine::MutexLock _lock(_sound_cache_mutex);
+    return psp_audio_cache_mb > 0 ? (size_t)psp_audio_cache_mb * 1024 * 1024 : 0;
+}
 
-    if (sound_cache_entries)
-    {
-        int i;
-        for (i = 0; i < psp_audio_cachesize; i++)
-        {
-            if (sound_cache_entries[i].data)
-            {
-                free(sound_cache_entries[i].data);
-                sound_cache_entries[i].data = NULL;
-                free(sound_cache_entries[i].file_name);
-                sound_cache_entries[i].file_name = NULL;
-                sound_cache_entries[i].reference = 0;
-            }
-        }
-    }
+static size_t get_cache_entry_limit()
+{
+    return psp_audio_cachesize > 0 ? (size_t)psp_audio_cachesize : 0;
+}
+
+static size_t get_sample_size(SAMPLE *wave)
+{
+    return sizeof(SAMPLE) + wave->len * (wave->bits / 8) * (wave->stereo ? 2 : 1);
+}
+
+static void free_sound_data(char *data, bool is_wave)
+{
+    if (is_wave)
+        destroy_sample((SAMPLE*)data);
     else
+        free(data);
+}
+
+static void lru_unlink(SoundCacheEntry *entry)
+{
+    if (entry->Prev)
+        entry->Prev->Next = entry->Next;
+    else
+        LruHead = entry->Next;
+    if (entry->Next)
+        entry->Next->Prev = entry->Prev;
+    else
+        LruTail = entry->Prev;
+    entry->Prev = entry->Next = NULL;
+}
+
+static void lru_push_front(SoundCacheEntry *entry)
+{
+    entry->Prev = NULL;
+    entry->Next = LruHead;
+    if (LruHead)
+        LruHead->Prev = entry;
+    else
+        LruTail = entry;
+    LruHead = entry;
+}
+
+// Removes entry from the cache; the data is freed unless it's still referenced,
+// in which case it will be freed as uncached data when the last clip lets it go
+static void remove_entry(SoundCacheEntry *entry)
+{
+    if (entry->Reference == 0)
     {
-        sound_cache_entries = (sound_cache_entry_t*)malloc(psp_audio_cachesize * sizeof(sound_cache_entry_t));
-        memset(sound_cache_entries, 0, psp_audio_cachesize * sizeof(sound_cache_entry_t));
+        lru_unlink(entry);
+        free_sound_data(entry->Data, entry->IsWave);
     }
+    CacheByName.erase(entry->FileName);
+    CacheByData.erase(entry->Data);
+    CacheStats.Used -= entry->Size;
+    delete entry;
+}
+
+void clear_sound_cache()
+{
+    AGS::Engine::MutexLock _lock(_sound_cache_mutex);
+
+    while (!CacheByName.empty())
+        remove_entry(CacheByName.begin()->second);
+    CacheStats.Limit = get_cache_limit();
+    CacheStats.MaxEntries = get_cache_entry_limit();
 }
 
 void sound_cache_free(char* buffer, bool is_wave)
@@ -61,21 +132,20 @@ void sound_cache_free(char* buffer, bool is_wave)
     AGS::Engine::MutexLock _lock(_sound_cache_mutex);
 
 #ifdef SOUND_CACHE_DEBUG
-    Debug::Printf("sound_cache_free(%d %d)\n", (unsigned int)buffer, (unsigned int)is_wave);
+    Debug::Printf("sound_cache_free(%p %d)\n", buffer, (unsigned int)is_wave);
 #endif
-    int i;
-    for (i = 0; i < psp_audio_cachesize; i++)
+    SoundCacheByData::const_iterator it = CacheByData.find(buffer);
+    if (it != CacheByData.end())
     {
-        if (sound_cache_entries[i].data == buffer)
-        {
-            if (sound_cache_entries[i].reference > 0)
-                sound_cache_entries[i].reference--;
+        SoundCacheEntry *entry = it->second;
+        // Last clip using the data has stopped, it may be evicted from now on
+        if (entry->Reference > 0 && --entry->Reference == 0)
+            lru_push_front(entry);
 
 #ifdef SOUND_CACHE_DEBUG
-            Debug::Printf("..decreased reference count of slot %d to %d\n", i, sound_cache_entries[i].reference);
+        Debug::Printf("..decreased reference count of %s to %d\n", entry->FileName.GetCStr(), entry->Reference);
 #endif
-            return;
-        }
+        return;
     }
 
 #ifdef SOUND_CACHE_DEBUG
@@ -83,13 +153,7 @@ void sound_cache_free(char* buffer, bool is_wave)
 #endif
 
     // Sound is uncached
-    if (i == psp_audio_cachesize)
-    {
-        if (is_wave)
-            destroy_sample((SAMPLE*)buffer);
-        else
-            free(buffer);
-    }
+    free_sound_data(buffer, is_wave);
 }
 
 
@@ -98,31 +162,31 @@ char* get_cached_sound(const AssetPath &asset_name, bool is_wave, long* size)
 	AGS::Engine::MutexLock _lock(_sound_cache_mutex);
 
 #ifdef SOUND_CACHE_DEBUG
-    Debug::Printf("get_cached_sound(%s %d)\n", filename, (unsigned int)is_wave);
+    Debug::Printf("get_cached_sound(%s %d)\n", asset_name.second.GetCStr(), (unsigned int)is_wave);
 #endif
 
     *size = 0;
 
-    int i;
-    for (i = 0; i < psp_audio_cachesize; i++)
+    SoundCacheByName::const_iterator it = CacheByName.find(asset_name.second);
+    if (it != CacheByName.end())
     {
-        if (sound_cache_entries[i].data == NULL)
-            continue;
-
-        if (strcmp(asset_name.second, sound_cache_entries[i].file_name) == 0)
-        {
+        SoundCacheEntry *entry = it->second;
 #ifdef SOUND_CACHE_DEBUG
-            Debug::Printf("..found in slot %d\n", i);
+        Debug::Printf("..found in cache\n");
 #endif
-            sound_cache_entries[i].reference++;
-            sound_cache_entries[i].last_used = sound_cache_counter++;
-            *size = sound_cache_entries[i].size;
-
-            return sound_cache_entries[i].data;
-        }
+        // Pin the data while it's being played
+        if (entry->Reference++ == 0)
+            lru_unlink(entry);
+        CacheStats.Hits++;
+        if (!entry->IsWave)
+            *size = entry->Size;
+        return entry->Data;
     }
+    CacheStats.Misses++;
+
+    // Not found; let other threads release their sounds meanwhile
+    _lock.Release();
 
-    // Not found
     PACKFILE *mp3in = NULL;
     SAMPLE* wave = NULL;
 
@@ -134,7 +198,7 @@ char* get_cached_sound(const AssetPath &asset_name, bool is_wave, long* size)
             wave = load_wav_pf(wavin);
             pack_fclose(wavin);
         }
-    }  
+    }
     else
     {
         mp3in = PackfileFromAsset(asset_name);
@@ -144,41 +208,17 @@ char* get_cached_sound(const AssetPath &asset_name, bool is_wave, long* size)
         }
     }
 
-    // Find free slot
-    for (i = 0; i < psp_audio_cachesize; i++)
-    {
-        if (sound_cache_entries[i].data == NULL)
-            break;
-    }
-
-    // No free slot?
-    if (i == psp_audio_cachesize)
-    {
-        unsigned int oldest = sound_cache_counter;
-        int index = -1;
-
-        for (i = 0; i < psp_audio_cachesize; i++)
-        {
-            if (sound_cache_entries[i].reference == 0)
-            {
-                if (sound_cache_entries[i].last_used < oldest)
-                {
-                    oldest = sound_cache_entries[i].last_used;
-                    index = i;
-                }
-            }
-        }
-
-        i = index;
-    }
-
     // Load new file
     char* newdata;
+    size_t data_size;
 
     if (is_wave)
     {
+        if (wave == NULL)
+            return NULL;
         *size = 0;
         newdata = (char*)wave;
+        data_size = get_sample_size(wave);
     }
     else
     {
@@ -193,42 +233,61 @@ char* get_cached_sound(const AssetPath &asset_name, bool is_wave, long* size)
 
         pack_fread(newdata, *size, mp3in);
         pack_fclose(mp3in);
+        data_size = *size;
     }
 
-    if (i == -1)
+    _lock.Acquire(_sound_cache_mutex);
+
+    // Same sound could have been cached by another thread meanwhile
+    if (CacheByName.find(asset_name.second) != CacheByName.end())
+        return newdata;
+
+    // Make room for the new data, starting with the least recently used
+    const size_t limit = get_cache_limit();
+    const size_t max_entries = get_cache_entry_limit();
+    CacheStats.Limit = limit;
+    CacheStats.MaxEntries = max_entries;
+    if (data_size <= limit && max_entries > 0)
     {
-        // No cache slot empty, return uncached data
+        while (LruTail && (CacheStats.Used + data_size > limit || CacheByName.size() >= max_entries))
+        {
 #ifdef SOUND_CACHE_DEBUG
-        Debug::Printf("..loading uncached\n");
+            Debug::Printf("..evicting %s\n", LruTail->FileName.GetCStr());
 #endif
-        return newdata;  
+            remove_entry(LruTail);
+            CacheStats.Evictions++;
+        }
     }
-    else
+
+    if (data_size > limit || CacheStats.Used + data_size > limit || CacheByName.size() >= max_entries)
     {
-        // Add to cache, free old sound first
+        // Not enough memory can be freed, return uncached data
 #ifdef SOUND_CACHE_DEBUG
-        Debug::Printf("..loading cached in slot %d\n", i);
-#endif	
-
-        if (sound_cache_entries[i].data) {
-            if (sound_cache_entries[i].is_wave)
-                destroy_sample((SAMPLE*)sound_cache_entries[i].data);
-            else
-                free(sound_cache_entries[i].data);
-	}
-	
-        sound_cache_entries[i].size = *size;
-        sound_cache_entries[i].data = newdata;
-
-        if (sound_cache_entries[i].file_name)
-            free(sound_cache_entries[i].file_name);
-        sound_cache_entries[i].file_name = (char*)malloc(strlen(asset_name.second) + 1);
-        strcpy(sound_cache_entries[i].file_name, asset_name.second);
-        sound_cache_entries[i].reference = 1;
-        sound_cache_entries[i].last_used = sound_cache_counter++;
-        sound_cache_entries[i].is_wave = is_wave;
-
-        return sound_cache_entries[i].data;	
+        Debug::Printf("..loading uncached\n");
+#endif
+        return newdata;
     }
 
+    // Add to cache
+#ifdef SOUND_CACHE_DEBUG
+    Debug::Printf("..loading cached\n");
+#endif
+    SoundCacheEntry *entry = new SoundCacheEntry();
+    entry->FileName = asset_name.second;
+    entry->Data = newdata;
+    entry->Size = data_size;
+    entry->Reference = 1;
+    entry->IsWave = is_wave;
+    entry->Prev = entry->Next = NULL;
+    CacheByName[entry->FileName] = entry;
+    CacheByData[entry->Data] = entry;
+    CacheStats.Used += data_size;
+    return newdata;
+}
+
+void get_sound_cache_stats(SoundCacheStats &stats)
+{
+    AGS::Engine::MutexLock _lock(_sound_cache_mutex);
+    stats = CacheStats;
+    stats.Entries = CacheByName.size();
 }
@@ -17,9 +17,13 @@
 
 #include "ac/asset_helper.h"
 
-// PSP: A simple sound cache. The size can be configured in the config file.
-// The data rate while reading from disk on the PSP is usually between 500 to 900 kiB/s,
-// caching the last used sound files therefore improves game performance.
+// A cache of the loaded sound data, indexed by asset name. Its size is limited
+// by the amount of memory the cached data takes, and by the number of cached
+// sounds; both are set in the config file. Data used by the playing clips is
+// never evicted; when a limit is exceeded, the least recently used data is
+// freed first.
+// Originally made for the PSP, where the data rate while reading from disk is
+// usually between 500 to 900 kiB/s.
 
 //#define SOUND_CACHE_DEBUG
 
@@ -29,26 +33,28 @@
 #include <psprtc.h>
 #endif
 
-typedef struct
+struct SoundCacheStats
 {
-    char* file_name;
-    int number;
-    int free;
-    unsigned int last_used;
-    unsigned int size;
-    char* data;
-    int reference;
-    bool is_wave;
-} sound_cache_entry_t;
+    unsigned int Hits;       // requests served from the cache
+    unsigned int Misses;     // requests that had to load data from disk
+    unsigned int Evictions;  // cached data freed to make room for other data
+    size_t       Entries;    // number of cached sounds
+    size_t       MaxEntries; // the limit of cached sounds
+    size_t       Used;       // memory taken by the cached data, in bytes
+    size_t       Limit;      // the cache size limit, in bytes
+};
 
 extern int psp_use_sound_cache;
 extern int psp_sound_cache_max_size;
+// Sound cache limits: the number of sounds, and the memory in megabytes
 extern int psp_audio_cachesize;
+extern int psp_audio_cache_mb;
 extern int psp_midi_preload_patches;
 
 void clear_sound_cache();
 void sound_cache_free(char* buffer, bool is_wave);
 char* get_cached_sound(const AssetPath &asset_name, bool is_wave, long* size);
+void get_sound_cache_stats(SoundCacheStats &stats);
 
 
 #endif // __AC_SOUNDCACHE_H
@@ -30,6 +30,8 @@ int SOUNDCLIP::play_from(int position)
 }
 
 void SOUNDCLIP::set_panning(int newPanning) {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     int voice = get_voice();
     if (voice >= 0) {
         voice_set_pan(voice, newPanning);
@@ -38,6 +40,8 @@ void SOUNDCLIP::set_panning(int newPanning) {
 }
 
 void SOUNDCLIP::pause() {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     int voice = get_voice();
     if (voice >= 0) {
         voice_stop(voice);
@@ -45,6 +49,8 @@ void SOUNDCLIP::pause() {
     }
 }
 void SOUNDCLIP::resume() {
+    AGS::Engine::MutexLock _lock;
+    lock_for_update(_lock);
     int voice = get_voice();
     if (voice >= 0)
         voice_start(voice);
@@ -70,8 +76,6 @@ SOUNDCLIP::SOUNDCLIP() {
     ySource = -1;
     maximumPossibleDistanceAway = 0;
     directionalVolModifier = 0;
-    _destroyThis = false;
-    _playing = false;
 }
 
 SOUNDCLIP::~SOUNDCLIP()
@@ -20,11 +20,11 @@
 #define __AC_SOUNDCLIP_H
 
 #undef BITMAP
-#include "util/mutex.h"
+#include "media/audio/audiocore.h"
+#include "util/mutex_lock.h"
 
 // JJS: This is needed for the derieved classes
 extern volatile int psp_audio_multithreaded;
-extern volatile bool _audio_doing_crossfade;
 
 // TODO: one of the biggest problems with sound clips currently is that it
 // provides several methods of applying volume, which may ignore or override
@@ -34,9 +34,6 @@ extern volatile bool _audio_doing_crossfade;
 
 struct SOUNDCLIP
 {
-    bool _destroyThis;
-    bool _playing;
-
     int done;
     int priority;
     int soundType;
@@ -103,7 +100,7 @@ struct SOUNDCLIP
     {
         volAsPercentage = volume;
         if (!muted)
-            set_volume((volume * 255) / 100);
+            audio_core_clip_set_volume(this, (volume * 255) / 100);
     }
 
     // Explicitly defines both percentage and absolute volume value,
@@ -113,7 +110,7 @@ struct SOUNDCLIP
     {
         muted = false;
         volAsPercentage = vol_percent;
-        set_volume(vol_absolute);
+        audio_core_clip_set_volume(this, vol_absolute);
     }
 
     // Mutes sound clip, while preserving current volume property
@@ -123,9 +120,9 @@ struct SOUNDCLIP
     {
         muted = enable;
         if (enable)
-            set_volume(0);
+            audio_core_clip_set_volume(this, 0);
         else
-            set_volume((volAsPercentage * 255) / 100);
+            audio_core_clip_set_volume(this, (volAsPercentage * 255) / 100);
     }
 
     // Apply arbitrary permanent volume modifier, in absolute units (0 - 255);
@@ -134,7 +131,7 @@ struct SOUNDCLIP
     inline void apply_volume_modifier(int mod)
     {
         volModifier = mod;
-        adjust_volume();
+        audio_core_clip_adjust_volume(this);
     }
 
     // Apply permanent directional volume modifier, in absolute units (0 - 255)
@@ -143,7 +140,7 @@ struct SOUNDCLIP
     inline void apply_directional_modifier(int mod)
     {
         directionalVolModifier = mod;
-        adjust_volume();
+        audio_core_clip_adjust_volume(this);
     }
 
     virtual void adjust_volume() = 0;
@@ -152,6 +149,14 @@ struct SOUNDCLIP
     virtual ~SOUNDCLIP();
 
 protected:
+    // Locks the clip against the audio thread, if there is one; used by the
+    // operations which the game thread runs while the audio thread polls
+    inline void lock_for_update(AGS::Engine::MutexLock &lock)
+    {
+        if (psp_audio_multithreaded)
+            lock.Acquire(_mutex);
+    }
+
     // mute mode overrides the volume; if set, any volume assigned is stored
     // in properties, but not applied to playback itself
     bool muted;
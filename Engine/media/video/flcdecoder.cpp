@@ -0,0 +1,497 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "media/video/flcdecoder.h"
+#include "util/math.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+enum FlcFileType
+{
+    kFlcType_FLI        = 0xAF11,
+    kFlcType_FLC        = 0xAF12
+};
+
+enum FlcChunkType
+{
+    kFlcChunk_Color256  = 4,
+    kFlcChunk_DeltaFLC  = 7,
+    kFlcChunk_Color64   = 11,
+    kFlcChunk_DeltaFLI  = 12,
+    kFlcChunk_Black     = 13,
+    kFlcChunk_ByteRun   = 15,
+    kFlcChunk_Copy      = 16,
+    kFlcChunk_Frame     = 0xF1FA
+};
+
+const size_t FlcHeaderSize      = 128;
+const size_t FlcFrameHeaderSize = 16;
+const size_t FlcChunkHeaderSize = 6;
+
+inline uint16_t read16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t read32(const uint8_t *p)
+{
+    return (uint32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
+}
+
+// Reads the chunk data, keeping within its bounds; once an attempt was made
+// to read past the end, the reader stays failed
+struct FlcDecoder::ChunkReader
+{
+    const uint8_t *Pos;
+    const uint8_t *End;
+    bool           Ok;
+
+    ChunkReader(const uint8_t *data, size_t size)
+        : Pos(data), End(data + size), Ok(true) {}
+
+    const uint8_t *Bytes(size_t count)
+    {
+        if (!Ok || (size_t)(End - Pos) < count)
+        {
+            Ok = false;
+            return NULL;
+        }
+        const uint8_t *p = Pos;
+        Pos += count;
+        return p;
+    }
+
+    uint8_t U8()
+    {
+        const uint8_t *p = Bytes(1);
+        return p ? p[0] : 0;
+    }
+
+    uint16_t U16()
+    {
+        const uint8_t *p = Bytes(2);
+        return p ? read16(p) : 0;
+    }
+};
+
+
+FlcDecoder::FlcDecoder()
+    : _in(NULL)
+    , _data(NULL)
+    , _dataSize(0)
+    , _firstFrame(0)
+    , _nextFrame(0)
+    , _width(0)
+    , _height(0)
+    , _frameCount(0)
+    , _frameDelay(0)
+    , _frameIndex(0)
+    , _failed(false)
+    , _dirtyFrom(0)
+    , _dirtyTo(0)
+    , _palDirtyFrom(0)
+    , _palDirtyTo(0)
+{
+    memset(_palette, 0, sizeof(_palette));
+}
+
+FlcDecoder::~FlcDecoder()
+{
+    Close();
+}
+
+bool FlcDecoder::Open(Stream *in)
+{
+    Close();
+    if (!in)
+        return false;
+    _in = in;
+    _data = in->GetDataView();
+    if (_data)
+    {
+        _dataSize = (size_t)in->GetLength();
+    }
+    else
+    {
+        _ownData.resize((size_t)(in->GetLength() - in->GetPosition()));
+        if (!_ownData.empty())
+            _ownData.resize(in->Read(&_ownData.front(), _ownData.size()));
+        _data = _ownData.empty() ? NULL : &_ownData.front();
+        _dataSize = _ownData.size();
+    }
+    if (_dataSize < FlcHeaderSize)
+    {
+        Close();
+        return false;
+    }
+
+    const uint16_t type = read16(_data + 4);
+    if (type != kFlcType_FLI && type != kFlcType_FLC)
+    {
+        Close();
+        return false;
+    }
+    _frameCount = read16(_data + 6);
+    _width = read16(_data + 8);
+    _height = read16(_data + 10);
+    if (type == kFlcType_FLI)
+    {
+        // FLI speed is in 1/70ths of a second, and the size is always 320x200
+        _frameDelay = read16(_data + 16) * 1000 / 70;
+        if (_width == 0 || _height == 0)
+        {
+            _width = 320;
+            _height = 200;
+        }
+        _firstFrame = FlcHeaderSize;
+    }
+    else
+    {
+        _frameDelay = (int)read32(_data + 16);
+        const uint32_t oframe1 = read32(_data + 80);
+        _firstFrame = oframe1 != 0 ? oframe1 : FlcHeaderSize;
+    }
+    if (_width == 0 || _height == 0 || _firstFrame >= _dataSize)
+    {
+        Close();
+        return false;
+    }
+
+    _nextFrame = _firstFrame;
+    _frameIndex = 0;
+    _failed = false;
+    _image.assign(_width * _height, 0);
+    memset(_palette, 0, sizeof(_palette));
+    _dirtyX1.assign(_height, 0);
+    _dirtyX2.assign(_height, _width);
+    _dirtyFrom = 0;
+    _dirtyTo = _height;
+    _palDirtyFrom = 0;
+    _palDirtyTo = 256;
+    return true;
+}
+
+void FlcDecoder::Close()
+{
+    delete _in;
+    _in = NULL;
+    _ownData.clear();
+    _data = NULL;
+    _dataSize = 0;
+    _width = 0;
+    _height = 0;
+    _frameCount = 0;
+    _frameIndex = 0;
+    _image.clear();
+    _dirtyX1.clear();
+    _dirtyX2.clear();
+    _dirtyFrom = _dirtyTo = 0;
+    _palDirtyFrom = _palDirtyTo = 0;
+}
+
+bool FlcDecoder::NextFrame()
+{
+    if (!_data || _failed || _frameIndex >= _frameCount)
+        return false;
+
+    // Skip any chunks that are not frames, such as the FLC prefix chunk
+    for (;;)
+    {
+        if (_dataSize - _nextFrame < FlcFrameHeaderSize)
+        {
+            _failed = true;
+            return false;
+        }
+        const uint8_t *frame = _data + _nextFrame;
+        const uint32_t size = read32(frame);
+        if (size < FlcChunkHeaderSize || size > _dataSize - _nextFrame)
+        {
+            _failed = true;
+            return false;
+        }
+        _nextFrame += size;
+        if (read16(frame + 4) != kFlcChunk_Frame)
+            continue;
+        if (size < FlcFrameHeaderSize || !DecodeFrame(frame, size))
+        {
+            _failed = true;
+            return false;
+        }
+        _frameIndex++;
+        return true;
+    }
+}
+
+bool FlcDecoder::GetDirtySpan(int y, int &x1, int &x2) const
+{
+    x1 = _dirtyX1[y];
+    x2 = _dirtyX2[y];
+    return x1 < x2;
+}
+
+void FlcDecoder::ClearDirty()
+{
+    for (int y = _dirtyFrom; y < _dirtyTo; ++y)
+    {
+        _dirtyX1[y] = _width;
+        _dirtyX2[y] = 0;
+    }
+    _dirtyFrom = _height;
+    _dirtyTo = 0;
+    _palDirtyFrom = 256;
+    _palDirtyTo = 0;
+}
+
+bool FlcDecoder::DecodeFrame(const uint8_t *data, size_t size)
+{
+    const int chunk_count = read16(data + 6);
+    size_t pos = FlcFrameHeaderSize;
+    for (int i = 0; i < chunk_count; ++i)
+    {
+        if (size - pos < FlcChunkHeaderSize)
+            return false;
+        const uint32_t chunk_size = read32(data + pos);
+        const uint16_t chunk_type = read16(data + pos + 4);
+        if (chunk_size < FlcChunkHeaderSize || chunk_size > size - pos)
+            return false;
+        ChunkReader chunk(data + pos + FlcChunkHeaderSize, chunk_size - FlcChunkHeaderSize);
+        bool ok = true;
+        switch (chunk_type)
+        {
+        case kFlcChunk_Color256: ok = DecodeColor(chunk, false); break;
+        case kFlcChunk_Color64:  ok = DecodeColor(chunk, true); break;
+        case kFlcChunk_DeltaFLC: ok = DecodeDeltaFLC(chunk); break;
+        case kFlcChunk_DeltaFLI: ok = DecodeDeltaFLI(chunk); break;
+        case kFlcChunk_ByteRun:  ok = DecodeByteRun(chunk); break;
+        case kFlcChunk_Copy:     ok = DecodeCopy(chunk); break;
+        case kFlcChunk_Black:    DecodeBlack(); break;
+        default: break; // postage stamps and unknown chunks
+        }
+        if (!ok)
+            return false;
+        pos += chunk_size;
+    }
+    return true;
+}
+
+bool FlcDecoder::DecodeColor(ChunkReader &chunk, bool six_bit)
+{
+    const int packets = chunk.U16();
+    int index = 0;
+    for (int p = 0; p < packets && chunk.Ok; ++p)
+    {
+        index += chunk.U8();
+        int count = chunk.U8();
+        if (count == 0)
+            count = 256;
+        count = Math::Min(count, 256 - index);
+        if (count <= 0)
+            break;
+        const uint8_t *rgb = chunk.Bytes(count * 3);
+        if (!rgb)
+            break;
+        MarkPaletteDirty(index, index + count);
+        for (int i = 0; i < count; ++i, ++index, rgb += 3)
+        {
+            if (six_bit)
+            {
+                _palette[index].R = (uint8_t)((rgb[0] << 2) | ((rgb[0] >> 4) & 3));
+                _palette[index].G = (uint8_t)((rgb[1] << 2) | ((rgb[1] >> 4) & 3));
+                _palette[index].B = (uint8_t)((rgb[2] << 2) | ((rgb[2] >> 4) & 3));
+            }
+            else
+            {
+                _palette[index].R = rgb[0];
+                _palette[index].G = rgb[1];
+                _palette[index].B = rgb[2];
+            }
+        }
+    }
+    return chunk.Ok;
+}
+
+bool FlcDecoder::DecodeDeltaFLC(ChunkReader &chunk)
+{
+    int lines = chunk.U16();
+    int y = 0;
+    while (lines > 0 && chunk.Ok)
+    {
+        uint16_t opcode = chunk.U16();
+        // Line skips and the last pixel of an odd-width line come before
+        // the packet count
+        while (chunk.Ok && (opcode & 0xC000) != 0)
+        {
+            if ((opcode & 0xC000) == 0xC000)
+            {
+                y += 0x10000 - opcode;
+            }
+            else if ((opcode & 0xC000) == 0x8000)
+            {
+                if (y >= _height)
+                    return false;
+                _image[y * _width + _width - 1] = (uint8_t)(opcode & 0xFF);
+                MarkDirty(y, _width - 1, _width);
+            }
+            else
+            {
+                return false;
+            }
+            opcode = chunk.U16();
+        }
+        if (y >= _height)
+            return false;
+
+        uint8_t *line = &_image[y * _width];
+        int x = 0;
+        for (int p = 0; p < opcode && chunk.Ok; ++p)
+        {
+            x += chunk.U8();
+            const int count = (int8_t)chunk.U8();
+            const int bytes = (count >= 0 ? count : -count) * 2;
+            if (x + bytes > _width)
+                return false;
+            if (count >= 0)
+            {
+                const uint8_t *src = chunk.Bytes(bytes);
+                if (!src)
+                    return false;
+                memcpy(line + x, src, bytes);
+            }
+            else
+            {
+                const uint8_t *pair = chunk.Bytes(2);
+                if (!pair)
+                    return false;
+                for (int i = 0; i < bytes; i += 2)
+                {
+                    line[x + i] = pair[0];
+                    line[x + i + 1] = pair[1];
+                }
+            }
+            if (bytes > 0)
+                MarkDirty(y, x, x + bytes);
+            x += bytes;
+        }
+        y++;
+        lines--;
+    }
+    return chunk.Ok;
+}
+
+bool FlcDecoder::DecodeDeltaFLI(ChunkReader &chunk)
+{
+    int y = chunk.U16();
+    const int lines = chunk.U16();
+    if (y + lines > _height)
+        return false;
+    for (int l = 0; l < lines && chunk.Ok; ++l, ++y)
+    {
+        uint8_t *line = &_image[y * _width];
+        const int packets = chunk.U8();
+        int x = 0;
+        for (int p = 0; p < packets && chunk.Ok; ++p)
+        {
+            x += chunk.U8();
+            const int count = (int8_t)chunk.U8();
+            const int bytes = count >= 0 ? count : -count;
+            if (x + bytes > _width)
+                return false;
+            if (count >= 0)
+            {
+                const uint8_t *src = chunk.Bytes(bytes);
+                if (!src)
+                    return false;
+                memcpy(line + x, src, bytes);
+            }
+            else
+            {
+                memset(line + x, chunk.U8(), bytes);
+            }
+            if (bytes > 0)
+                MarkDirty(y, x, x + bytes);
+            x += bytes;
+        }
+    }
+    return chunk.Ok;
+}
+
+bool FlcDecoder::DecodeByteRun(ChunkReader &chunk)
+{
+    for (int y = 0; y < _height && chunk.Ok; ++y)
+    {
+        uint8_t *line = &_image[y * _width];
+        chunk.U8(); // packet count, unreliable for wide images
+        for (int x = 0; x < _width && chunk.Ok;)
+        {
+            const int count = (int8_t)chunk.U8();
+            const int bytes = Math::Min(count >= 0 ? count : -count, _width - x);
+            if (count < 0)
+            {
+                const uint8_t *src = chunk.Bytes(-count);
+                if (!src)
+                    return false;
+                memcpy(line + x, src, bytes);
+            }
+            else
+            {
+                memset(line + x, chunk.U8(), bytes);
+            }
+            x += bytes;
+        }
+        MarkDirty(y, 0, _width);
+    }
+    return chunk.Ok;
+}
+
+bool FlcDecoder::DecodeCopy(ChunkReader &chunk)
+{
+    const uint8_t *src = chunk.Bytes(_image.size());
+    if (!src)
+        return false;
+    memcpy(&_image.front(), src, _image.size());
+    for (int y = 0; y < _height; ++y)
+        MarkDirty(y, 0, _width);
+    return true;
+}
+
+void FlcDecoder::DecodeBlack()
+{
+    memset(&_image.front(), 0, _image.size());
+    for (int y = 0; y < _height; ++y)
+        MarkDirty(y, 0, _width);
+}
+
+void FlcDecoder::MarkDirty(int y, int x1, int x2)
+{
+    _dirtyX1[y] = Math::Min(_dirtyX1[y], x1);
+    _dirtyX2[y] = Math::Max(_dirtyX2[y], x2);
+    _dirtyFrom = Math::Min(_dirtyFrom, y);
+    _dirtyTo = Math::Max(_dirtyTo, y + 1);
+}
+
+void FlcDecoder::MarkPaletteDirty(int from, int to)
+{
+    _palDirtyFrom = Math::Min(_palDirtyFrom, from);
+    _palDirtyTo = Math::Max(_palDirtyTo, to);
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,124 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// FlcDecoder reads FLI and FLC animations frame by frame.
+//
+// The frames are decoded into an 8-bit image which is kept between frames,
+// so that delta chunks only touch the pixels they change. The decoder
+// remembers which span of every line and which palette entries were changed
+// since the caller last cleared the marks, which lets the player convert
+// and upload only these parts of the frame.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__FLCDECODER_H
+#define __AGS_EE_MEDIA__FLCDECODER_H
+
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+
+namespace Common { class Stream; }
+
+namespace Engine
+{
+
+struct FlcColor
+{
+    uint8_t R, G, B; // 0 - 255
+};
+
+class FlcDecoder
+{
+public:
+    FlcDecoder();
+    ~FlcDecoder();
+
+    // Reads the animation header; the decoder takes over the stream, which
+    // should keep its data in memory, or else it is read whole
+    bool Open(Common::Stream *in);
+    void Close();
+
+    int  GetWidth() const { return _width; }
+    int  GetHeight() const { return _height; }
+    int  GetFrameCount() const { return _frameCount; }
+    // Delay between frames, in milliseconds
+    int  GetFrameDelay() const { return _frameDelay; }
+    // Number of the last decoded frame, starting with 1
+    int  GetFrameIndex() const { return _frameIndex; }
+
+    // Decodes the next frame; returns false after the last frame, or if the
+    // animation data is broken
+    bool NextFrame();
+    bool HasFailed() const { return _failed; }
+
+    // Gets a line of the current image, one palette index per pixel
+    const uint8_t  *GetLine(int y) const { return &_image[y * _width]; }
+    const FlcColor *GetPalette() const { return _palette; }
+
+    // Tells the range of lines which have changed, the end excluded; the
+    // range is empty if nothing did
+    int  GetDirtyFrom() const { return _dirtyFrom; }
+    int  GetDirtyTo() const { return _dirtyTo; }
+    // Gets the changed part of the line, the end excluded; returns false
+    // if it did not change
+    bool GetDirtySpan(int y, int &x1, int &x2) const;
+    // Tells the range of changed palette entries, the end excluded
+    int  GetPaletteDirtyFrom() const { return _palDirtyFrom; }
+    int  GetPaletteDirtyTo() const { return _palDirtyTo; }
+    // Forgets about the changes
+    void ClearDirty();
+
+private:
+    struct ChunkReader;
+
+    bool DecodeFrame(const uint8_t *data, size_t size);
+    bool DecodeColor(ChunkReader &chunk, bool six_bit);
+    bool DecodeDeltaFLC(ChunkReader &chunk);
+    bool DecodeDeltaFLI(ChunkReader &chunk);
+    bool DecodeByteRun(ChunkReader &chunk);
+    bool DecodeCopy(ChunkReader &chunk);
+    void DecodeBlack();
+    void MarkDirty(int y, int x1, int x2);
+    void MarkPaletteDirty(int from, int to);
+
+    Common::Stream      *_in;
+    std::vector<uint8_t> _ownData;
+    const uint8_t       *_data;
+    size_t               _dataSize;
+    size_t               _firstFrame;
+    size_t               _nextFrame;
+
+    int  _width;
+    int  _height;
+    int  _frameCount;
+    int  _frameDelay;
+    int  _frameIndex;
+    bool _failed;
+
+    std::vector<uint8_t> _image;
+    FlcColor             _palette[256];
+    std::vector<int>     _dirtyX1;
+    std::vector<int>     _dirtyX2;
+    int  _dirtyFrom;
+    int  _dirtyTo;
+    int  _palDirtyFrom;
+    int  _palDirtyTo;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MEDIA__FLCDECODER_H
@@ -12,6 +12,9 @@
 //
 //=============================================================================
 
+#include <chrono>
+#include <string.h>
+#include <vector>
 #include "video.h"
 #include "apeg.h"
 #include "debug/debug_log.h"
@@ -33,6 +36,10 @@
 #include "gfx/graphicsdriver.h"
 #include "main/game_run.h"
 #include "media/audio/audio.h"
+#include "media/video/flcdecoder.h"
+#include "media/video/videodecoder.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/math.h"
 #include "util/stream.h"
 
 using namespace AGS::Common;
@@ -54,13 +61,20 @@ enum VideoPlaybackType
 VideoPlaybackType video_type = kVideoNone;
 
 // FLIC player start
-Bitmap *fli_buffer = NULL;
 short fliwidth,fliheight;
 int canabort=0, stretch_flc = 1;
 Bitmap *hicol_buf=NULL;
 IDriverDependantBitmap *fli_ddb = NULL;
 Bitmap *fli_target = NULL;
 int fliTargetWidth, fliTargetHeight;
+// Current FLIC palette, in 6-bit components, and its colours in the game's format
+PALETTE flc_palette;
+int flc_colors[256];
+// Source column for every column of the stretched FLIC frame
+std::vector<int> flc_stretch_xmap;
+// Longest sleep between the audio updates while waiting for the next frame, in milliseconds
+const int FlcMaxWaitDelay = 5;
+
 int check_if_user_input_should_cancel_video()
 {
     NEXT_ITERATION();
@@ -77,29 +91,122 @@ int check_if_user_input_should_cancel_video()
     return 0;
 }
 
-#if defined(WINDOWS_VERSION)
-int __cdecl fli_callback() {
-#else
-extern "C" int fli_callback() {
-#endif
-    Bitmap *usebuf = fli_buffer;
+// Converts the palette indexes to the pixels of the frame bitmap
+void convert_flc_span(const uint8_t *src, uint8_t *dst, int count, int bpp)
+{
+    switch (bpp)
+    {
+    case 1:
+        memcpy(dst, src, count);
+        break;
+    case 2:
+        for (int i = 0; i < count; ++i)
+            ((uint16_t*)dst)[i] = (uint16_t)flc_colors[src[i]];
+        break;
+    case 3:
+        for (int i = 0; i < count; ++i, dst += 3)
+        {
+            const int c = flc_colors[src[i]];
+            dst[0] = (uint8_t)c;
+            dst[1] = (uint8_t)(c >> 8);
+            dst[2] = (uint8_t)(c >> 16);
+        }
+        break;
+    case 4:
+        for (int i = 0; i < count; ++i)
+            ((uint32_t*)dst)[i] = (uint32_t)flc_colors[src[i]];
+        break;
+    }
+}
 
-    update_polled_audio_and_crossfade ();
+// Copies the part of the frame line to all the lines of the stretched frame
+// it is shown on, and returns the part of the stretched frame that was changed
+Rect stretch_flc_span(int y, int x1, int x2)
+{
+    const int bpp = hicol_buf->GetBPP();
+    const int dst_w = fli_target->GetWidth();
+    const int dst_h = fli_target->GetHeight();
+    const int dx1 = (x1 * dst_w + fliwidth - 1) / fliwidth;
+    const int dx2 = (x2 * dst_w + fliwidth - 1) / fliwidth;
+    const int dy1 = (y * dst_h + fliheight - 1) / fliheight;
+    const int dy2 = ((y + 1) * dst_h + fliheight - 1) / fliheight;
+    if (dx1 >= dx2 || dy1 >= dy2)
+        return Rect();
+
+    const uint8_t *src = hicol_buf->GetScanLine(y);
+    uint8_t *dst = fli_target->GetScanLineForWriting(dy1);
+    const int *xmap = &flc_stretch_xmap.front();
+    for (int dx = dx1; dx < dx2; ++dx)
+        memcpy(dst + dx * bpp, src + xmap[dx] * bpp, bpp);
+    for (int dy = dy1 + 1; dy < dy2; ++dy)
+        memcpy(fli_target->GetScanLineForWriting(dy) + dx1 * bpp, dst + dx1 * bpp, (dx2 - dx1) * bpp);
+    return Rect(dx1, dy1, dx2 - 1, dy2 - 1);
+}
 
-    if (game.color_depth > 1) {
-        hicol_buf->Blit(fli_buffer,0,0,0,0,fliwidth,fliheight);
-        usebuf=hicol_buf;
+// Converts the parts of the frame that changed since the previous one, and
+// updates them on the texture
+void update_flc_frame(FlcDecoder &flc)
+{
+    const int pal_from = flc.GetPaletteDirtyFrom();
+    const int pal_to = flc.GetPaletteDirtyTo();
+    const bool palette_changed = pal_from < pal_to;
+    if (palette_changed)
+    {
+        const FlcColor *pal = flc.GetPalette();
+        for (int i = pal_from; i < pal_to; ++i)
+        {
+            flc_palette[i].r = pal[i].R >> 2;
+            flc_palette[i].g = pal[i].G >> 2;
+            flc_palette[i].b = pal[i].B >> 2;
+            flc_colors[i] = makecol_depth(hicol_buf->GetColorDepth(), pal[i].R, pal[i].G, pal[i].B);
+        }
+        if (game.color_depth == 1)
+            set_palette_range(flc_palette, pal_from, pal_to - 1, 0);
     }
 
+    // A palette change alters any pixel; the 8-bit frames are converted by
+    // the graphics driver, but their texture must be updated all the same
+    const bool convert_all = palette_changed && game.color_depth > 1;
+    const bool update_all = palette_changed;
+    const int bpp = hicol_buf->GetBPP();
+    Rect changed;
+    const int from = convert_all ? 0 : flc.GetDirtyFrom();
+    const int to = convert_all ? fliheight : flc.GetDirtyTo();
+    for (int y = from; y < to; ++y)
+    {
+        int x1 = 0, x2 = fliwidth;
+        if (!convert_all && !flc.GetDirtySpan(y, x1, x2))
+            continue;
+        convert_flc_span(flc.GetLine(y) + x1, hicol_buf->GetScanLineForWriting(y) + x1 * bpp, x2 - x1, bpp);
+        const Rect span = fli_target ? stretch_flc_span(y, x1, x2) : Rect(x1, y, x2 - 1, y);
+        if (span.IsEmpty())
+            continue;
+        if (changed.IsEmpty())
+            changed = span;
+        else
+            changed = Rect(Math::Min(changed.Left, span.Left), Math::Min(changed.Top, span.Top),
+                Math::Max(changed.Right, span.Right), Math::Max(changed.Bottom, span.Bottom));
+    }
+    flc.ClearDirty();
+
+    Bitmap *ddb_source = fli_target ? fli_target : hicol_buf;
+    if (update_all)
+        gfxDriver->UpdateDDBFromBitmap(fli_ddb, ddb_source, false);
+    else if (!changed.IsEmpty())
+        gfxDriver->UpdateDDBFromBitmapRegion(fli_ddb, ddb_source, changed, false);
+}
+
+int fli_callback(FlcDecoder &flc) {
+    update_polled_audio_and_crossfade ();
+
+    update_flc_frame(flc);
+
     const Rect &view = play.GetMainViewport();
     if (stretch_flc == 0)
-        fli_target->Blit(usebuf, 0,0, view.GetWidth()/2-fliwidth/2, view.GetHeight()/2-fliheight/2, view.GetWidth(), view.GetHeight());
-    else 
-        fli_target->StretchBlt(usebuf, RectWH(0,0,fliwidth,fliheight), RectWH(0,0, view.GetWidth(), view.GetHeight()));
-
-    gfxDriver->UpdateDDBFromBitmap(fli_ddb, fli_target, false);
-    gfxDriver->DrawSprite(0, 0, fli_ddb);
-    render_to_screen(fli_target, 0, 0);
+        gfxDriver->DrawSprite(view.GetWidth()/2-fliwidth/2, view.GetHeight()/2-fliheight/2, fli_ddb);
+    else
+        gfxDriver->DrawSprite(0, 0, fli_ddb);
+    render_to_screen(virtual_screen, 0, 0);
 
     return check_if_user_input_should_cancel_video();
 }
@@ -128,11 +235,11 @@ void play_flc_file(int numb,int playflags) {
         clearScreenAtStart = 0;
 
     String flicname = String::FromFormat("flic%d.flc", numb);
-    Stream *in = AssetManager::OpenAsset(flicname);
+    Stream *in = AssetManager::OpenAssetMapped(flicname);
     if (!in)
     {
         flicname.Format("flic%d.fli", numb);
-        in = AssetManager::OpenAsset(flicname);
+        in = AssetManager::OpenAssetMapped(flicname);
     }
     if (!in)
     {
@@ -140,24 +247,36 @@ void play_flc_file(int numb,int playflags) {
         return;
     }
 
-    in->Seek(8);
-    fliwidth = in->ReadInt16();
-    fliheight = in->ReadInt16();
-    delete in;
-
-    if (game.color_depth > 1) {
-        hicol_buf=BitmapHelper::CreateBitmap(fliwidth,fliheight,game.GetColorDepth());
-        hicol_buf->Clear();
+    FlcDecoder flc;
+    if (!flc.Open(in))
+    {
+        Debug::Printf("FLI/FLC animation %s could not be opened", flicname.GetCStr());
+        return;
     }
+    fliwidth = flc.GetWidth();
+    fliheight = flc.GetHeight();
+
     // override the stretch option if necessary
     const Rect &view = play.GetMainViewport();
     if ((fliwidth == view.GetWidth()) && (fliheight == view.GetHeight()))
         stretch_flc = 0;
     else if ((fliwidth > view.GetWidth()) || (fliheight >view.GetHeight()))
         stretch_flc = 1;
-    fli_buffer=BitmapHelper::CreateBitmap(fliwidth,fliheight,8);
-    if (fli_buffer==NULL) quit("Not enough memory to play animation");
-    fli_buffer->Clear();
+
+    // Frames are converted to the game's color depth at their own size;
+    // unless the graphics driver can stretch them, the changed lines are
+    // then also stretched into the screen-sized bitmap
+    hicol_buf=BitmapHelper::CreateBitmap(fliwidth,fliheight,game.GetColorDepth());
+    if (hicol_buf==NULL) quit("Not enough memory to play animation");
+    hicol_buf->Clear();
+    if (stretch_flc && !gfxDriver->HasAcceleratedTransform())
+    {
+        fli_target = BitmapHelper::CreateBitmap(view.GetWidth(), view.GetHeight(), game.GetColorDepth());
+        fli_target->Clear();
+        flc_stretch_xmap.resize(fli_target->GetWidth());
+        for (int x = 0; x < fli_target->GetWidth(); ++x)
+            flc_stretch_xmap[x] = x * fliwidth / fli_target->GetWidth();
+    }
 
     Bitmap *screen_bmp = BitmapHelper::GetScreenBitmap();
 
@@ -167,30 +286,37 @@ void play_flc_file(int numb,int playflags) {
     }
 
     video_type = kVideoFlic;
-    fli_target = BitmapHelper::CreateBitmap(screen_bmp->GetWidth(), screen_bmp->GetHeight(), game.GetColorDepth());
-    fli_ddb = gfxDriver->CreateDDBFromBitmap(fli_target, false, true);
-
-    // TODO: find a better solution.
-    // Make only certain versions of the engineuse play_fli_pf from the patched version of Allegro for now.
-    // Add more versions as their Allegro lib becomes patched too, or they use newer version of Allegro 4.
-    // Ports can still play FLI if separate file is put into game's directory.
-#if defined (WINDOWS_VERSION) || defined (ANDROID_VERSION)
-    PACKFILE *pf = PackfileFromAsset(AssetPath("", flicname));
-    if (play_fli_pf(pf, (BITMAP*)fli_buffer->GetAllegroBitmap(), fli_callback)==FLI_ERROR)
-#else
-    if (play_fli(flicname, (BITMAP*)fli_buffer->GetAllegroBitmap(), 0, fli_callback)==FLI_ERROR)
-#endif
+    fli_ddb = gfxDriver->CreateDDBFromBitmap(fli_target ? fli_target : hicol_buf, false, true);
+    if (stretch_flc && !fli_target)
+        fli_ddb->SetStretch(view.GetWidth(), view.GetHeight(), false);
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration frame_delay = std::chrono::milliseconds(flc.GetFrameDelay());
+    Clock::time_point next_frame_time = Clock::now();
+    while (flc.NextFrame())
+    {
+        if (fli_callback(flc))
+            break;
+        // Wait for the next frame, unless already late for it, keeping the
+        // audio going meanwhile
+        next_frame_time += frame_delay;
+        if (next_frame_time < Clock::now())
+            next_frame_time = Clock::now();
+        for (Clock::time_point now = Clock::now(); now < next_frame_time; now = Clock::now())
+        {
+            const int wait_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(next_frame_time - now).count();
+            AGSPlatformDriver::GetDriver()->Delay(Math::Clamp(wait_ms, 1, FlcMaxWaitDelay));
+            update_polled_audio_and_crossfade();
+        }
+    }
+    if (flc.HasFailed())
     {
         // This is not a fatal error that should prevent the game from continuing
         Debug::Printf("FLI/FLC animation play error");
     }
-#if defined WINDOWS_VERSION
-    pack_fclose(pf);
-#endif
+    flc.Close();
 
     video_type = kVideoNone;
-    delete fli_buffer;
-    fli_buffer = NULL;
     // NOTE: the screen bitmap could change in the meanwhile, if the display mode has changed
     screen_bmp = BitmapHelper::GetScreenBitmap();
     screen_bmp->Clear();
@@ -367,11 +493,89 @@ void calculate_destination_size_maintain_aspect_ratio(int vidWidth, int vidHeigh
 
 }
 
+// Longest time the video player sleeps waiting for a frame, in milliseconds
+const int TheoraMaxFrameWait = 10;
+
+// Presents the frames decoded ahead by the decoder thread when their time
+// comes; with framedrop enabled only the latest of the due frames is shown
+bool play_theora_decoded(APEG_STREAM *oggVid, int color_depth)
+{
+    const bool hw_stretch = stretch_flc && gfxDriver->HasAcceleratedTransform();
+    const int draw_width = stretch_flc ? fliTargetWidth : oggVid->w;
+    const int draw_height = stretch_flc ? fliTargetHeight : oggVid->h;
+    const int frame_width = hw_stretch ? oggVid->w : draw_width;
+    const int frame_height = hw_stretch ? oggVid->h : draw_height;
+    if (!video_decoder_start(oggVid, frame_width, frame_height, color_depth, psp_video_framedrop != 0))
+        return false;
+
+    const Rect &viewport = play.GetMainViewport();
+    const int draw_x = viewport.GetWidth() / 2 - draw_width / 2;
+    const int draw_y = viewport.GetHeight() / 2 - draw_height / 2;
+    VideoFrame next;
+    bool has_next = false;
+    for (;;)
+    {
+        const double clock = video_decoder_get_clock();
+        VideoFrame shown;
+        bool has_shown = false;
+        while (has_next || (has_next = video_decoder_next_frame(next)))
+        {
+            if (next.Time > clock)
+                break;
+            if (has_shown)
+                video_decoder_release_frame(shown);
+            shown = next;
+            has_shown = true;
+            has_next = false;
+            if (!psp_video_framedrop)
+                break;
+        }
+
+        if (has_shown)
+        {
+            // the same texture is refilled with every frame
+            if (fli_ddb == NULL)
+                fli_ddb = gfxDriver->CreateDDBFromBitmap(shown.Image, false, true);
+            else
+                gfxDriver->UpdateDDBFromBitmap(fli_ddb, shown.Image, false);
+            video_decoder_release_frame(shown);
+            if (hw_stretch)
+                fli_ddb->SetStretch(draw_width, draw_height, false);
+            gfxDriver->DrawSprite(draw_x, draw_y, fli_ddb);
+            render_to_screen(virtual_screen, 0, 0);
+        }
+        update_polled_audio_and_crossfade();
+
+        if (check_if_user_input_should_cancel_video())
+            break;
+        if (!has_next && video_decoder_is_finished())
+            break;
+        if (!has_shown)
+        {
+            int wait = has_next ? (int)((next.Time - clock) * 1000.0) : TheoraMaxFrameWait;
+            wait = Math::Clamp(wait, 1, TheoraMaxFrameWait);
+            AGSPlatformDriver::GetDriver()->Delay(wait);
+        }
+    }
+
+    const bool failed = video_decoder_has_failed();
+    video_decoder_stop();
+    return !failed;
+}
+
 void play_theora_video(const char *name, int skip, int flags)
 {
     ApegStreamReader reader(AssetPath("", name));
     apeg_set_stream_reader(apeg_stream_init, apeg_stream_read, apeg_stream_skip);
-    apeg_set_display_depth(BitmapHelper::GetScreenBitmap()->GetColorDepth());
+    const int color_depth = BitmapHelper::GetScreenBitmap()->GetColorDepth();
+    apeg_set_display_depth(color_depth);
+    // Frames are decoded ahead on a separate thread, unless they cannot be
+    // converted to the screen format; then APEG renders them as it plays
+    const bool decode_ahead = video_decoder_supports_depth(color_depth);
+    if (decode_ahead)
+        video_decoder_set_display_callbacks();
+    else
+        apeg_set_display_callbacks(NULL, NULL, NULL);
     // we must disable length detection, otherwise it takes ages to start
     // playing if the file is large because it seeks through the whole thing
     apeg_disable_length_detection(TRUE);
@@ -406,7 +610,7 @@ void play_theora_video(const char *name, int skip, int flags)
         stretch_flc = 0;
     }
 
-    if ((stretch_flc) && (!gfxDriver->HasAcceleratedTransform()))
+    if ((stretch_flc) && (!gfxDriver->HasAcceleratedTransform()) && !decode_ahead)
     {
         fli_target = BitmapHelper::CreateBitmap(play.GetMainViewport().GetWidth(), play.GetMainViewport().GetHeight(), game.GetColorDepth());
         fli_target->Clear();
@@ -422,11 +626,17 @@ void play_theora_video(const char *name, int skip, int flags)
     virtual_screen->Clear();
 
     video_type = kVideoTheora;
-    if (apeg_play_apeg_stream(oggVid, NULL, 0, theora_playing_callback) == APEG_ERROR)
+    bool played;
+    if (decode_ahead)
+        played = play_theora_decoded(oggVid, color_depth);
+    else
+        played = apeg_play_apeg_stream(oggVid, NULL, 0, theora_playing_callback) != APEG_ERROR;
+    if (!played)
     {
         Display("Error playing theora video '%s'", name);
     }
     apeg_close_stream(oggVid);
+    apeg_set_display_callbacks(NULL, NULL, NULL);
     video_type = kVideoNone;
 
     //destroy_bitmap(fli_buffer);
@@ -443,6 +653,6 @@ void video_on_gfxmode_changed()
     if (video_type == kVideoFlic)
     {
         // If the FLIC video is playing, restore its palette
-        set_palette_range(fli_palette, 0, 255, 0);
+        set_palette_range(flc_palette, 0, 255, 0);
     }
 }
@@ -0,0 +1,365 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <atomic>
+#include <chrono>
+#include <string.h>
+#include <vector>
+#include "media/video/videodecoder.h"
+#include "media/video/yuvconvert.h"
+#include "gfx/bitmap.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/lockfree_ring.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
+#include "util/thread.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+// Number of frames which may be decoded ahead, including the one being
+// presented; must be a power of two
+const int VideoFrameSlots = 4;
+// Time the decoder sleeps when there is no frame to decode, in milliseconds;
+// must be well below the duration of an audio buffer
+const int DecoderIdleDelay = 2;
+// How far the clock may run ahead of the last audio time reported, in
+// seconds; keeps the video from running away when the audio stalls
+const double MaxAudioClockLead = 0.1;
+// Even when late, show at least every few frames
+const int MaxConsecutiveDrops = 4;
+
+Thread DecoderThread;
+bool   DecoderRunning = false;
+
+APEG_STREAM *VideoStream = NULL;
+bool         Framedrop = false;
+Bitmap      *FrameSlots[VideoFrameSlots];
+// Decoder thread -> game thread
+LockFreeRing<VideoFrame, VideoFrameSlots> ReadyFrames;
+// Game thread -> decoder thread
+LockFreeRing<int, VideoFrameSlots>        FreeSlots;
+std::atomic<bool> DecoderFinished(false);
+std::atomic<bool> DecoderFailed(false);
+
+// Playback clock, updated by the decoder thread
+Mutex             ClockLock;
+double            ClockBase = 0.0;
+Clock::time_point ClockStamp;
+bool              ClockFollowsAudio = false;
+// Last time told to the game thread; only accessed by the game thread
+double            LastClock = 0.0;
+
+// Stream state, only accessed by the decoder thread once it started
+int    CodedWidth = 0;
+YUVConvert::PixelFormat Format;
+std::vector<int>     StretchXMap;
+std::vector<uint8_t> StretchLine;
+int    PendingSlot = -1;
+bool   FrameConverted = false;
+bool   FrameDropped = false;
+int    ConsecutiveDrops = 0;
+bool   VideoEnded = false;
+bool   AudioEnded = false;
+
+
+double calc_clock()
+{
+    MutexLock lock(ClockLock);
+    double elapsed = std::chrono::duration<double>(Clock::now() - ClockStamp).count();
+    if (ClockFollowsAudio && elapsed > MaxAudioClockLead)
+        elapsed = MaxAudioClockLead;
+    return ClockBase + elapsed;
+}
+
+void set_clock(double time, bool follows_audio)
+{
+    MutexLock lock(ClockLock);
+    ClockBase = time;
+    ClockStamp = Clock::now();
+    ClockFollowsAudio = follows_audio;
+}
+
+double get_frame_period()
+{
+    return VideoStream->frame_rate > 0.0 ? 1.0 / VideoStream->frame_rate : 1.0 / 25.0;
+}
+
+// Accepts the pictures of the usual 4:2:0 layout; APEG renders any other
+// into its own bitmap, which is then copied
+int display_init(APEG_STREAM *stream, int coded_w, int /*coded_h*/, void * /*arg*/)
+{
+    if (stream->pixel_format != APEG_STREAM::APEG_420)
+        return 1;
+    CodedWidth = coded_w;
+    return 0;
+}
+
+void stretch_line(const uint8_t *src, uint8_t *dst, int width, int bpp)
+{
+    const int *xmap = &StretchXMap.front();
+    if (bpp == 4)
+    {
+        for (int x = 0; x < width; ++x)
+            ((uint32_t*)dst)[x] = ((const uint32_t*)src)[xmap[x]];
+    }
+    else
+    {
+        for (int x = 0; x < width; ++x)
+            ((uint16_t*)dst)[x] = ((const uint16_t*)src)[xmap[x]];
+    }
+}
+
+void display_frame(APEG_STREAM *stream, unsigned char **src, void * /*arg*/)
+{
+    const double frame_time = (stream->frame - 1) * get_frame_period();
+    if (Framedrop && ConsecutiveDrops < MaxConsecutiveDrops &&
+        frame_time + get_frame_period() < calc_clock())
+    {
+        FrameDropped = true;
+        return;
+    }
+
+    Bitmap *dst = FrameSlots[PendingSlot];
+    const int src_w = stream->w;
+    const int src_h = stream->h;
+    const int dst_w = dst->GetWidth();
+    const int dst_h = dst->GetHeight();
+    const bool stretch = src_w != dst_w || src_h != dst_h;
+    const int chroma_width = CodedWidth / 2;
+    int last_sy = -1;
+    for (int dy = 0; dy < dst_h; ++dy)
+    {
+        const int sy = stretch ? dy * src_h / dst_h : dy;
+        uint8_t *line = dst->GetScanLineForWriting(dy);
+        // a source line stretched over several lines is only converted once
+        if (sy == last_sy)
+        {
+            memcpy(line, dst->GetScanLine(dy - 1), dst->GetLineLength());
+            continue;
+        }
+        const uint8_t *y = src[0] + sy * CodedWidth;
+        const uint8_t *u = src[1] + (sy / 2) * chroma_width;
+        const uint8_t *v = src[2] + (sy / 2) * chroma_width;
+        if (stretch)
+        {
+            YUVConvert::ConvertLine420(y, u, v, &StretchLine.front(), src_w, Format);
+            stretch_line(&StretchLine.front(), line, dst_w, dst->GetBPP());
+        }
+        else
+        {
+            YUVConvert::ConvertLine420(y, u, v, line, src_w, Format);
+        }
+        last_sy = sy;
+    }
+    FrameConverted = true;
+}
+
+void copy_apeg_bitmap()
+{
+    Bitmap *dst = FrameSlots[PendingSlot];
+    Bitmap apeg_bmp;
+    apeg_bmp.WrapAllegroBitmap(VideoStream->bitmap, true);
+    if (VideoStream->w == dst->GetWidth() && VideoStream->h == dst->GetHeight())
+        dst->Blit(&apeg_bmp, 0, 0, 0, 0, VideoStream->w, VideoStream->h);
+    else
+        dst->StretchBlt(&apeg_bmp, RectWH(0, 0, VideoStream->w, VideoStream->h), RectWH(0, 0, dst->GetWidth(), dst->GetHeight()));
+}
+
+void decode_failed()
+{
+    DecoderFailed = true;
+    DecoderFinished = true;
+}
+
+void poll_audio()
+{
+    const int ret = apeg_poll_audio(VideoStream);
+    if (ret == APEG_OK)
+    {
+        const double time = apeg_get_audio_time(VideoStream);
+        if (time >= 0.0)
+            set_clock(time, true);
+        return;
+    }
+    // Audio is over, so let the clock run on its own from where it stopped
+    AudioEnded = true;
+    set_clock(calc_clock(), false);
+    if (ret == APEG_ERROR)
+        decode_failed();
+}
+
+// Returns true if a picture was decoded, whether it was kept or dropped
+bool decode_frame()
+{
+    if (PendingSlot < 0 && !FreeSlots.Pop(PendingSlot))
+        return false;
+
+    FrameConverted = false;
+    FrameDropped = false;
+    const int ret = apeg_decode_video_frame(VideoStream);
+    if (ret != APEG_OK)
+    {
+        VideoEnded = true;
+        if (ret == APEG_ERROR)
+            decode_failed();
+        return false;
+    }
+    if (FrameDropped)
+    {
+        ConsecutiveDrops++;
+        return true;
+    }
+    ConsecutiveDrops = 0;
+    if (!FrameConverted)
+        copy_apeg_bitmap();
+
+    VideoFrame frame = { FrameSlots[PendingSlot], (VideoStream->frame - 1) * get_frame_period(), PendingSlot };
+    // cannot fail: there are as many places in the ring as there are slots
+    ReadyFrames.Push(frame);
+    PendingSlot = -1;
+    return true;
+}
+
+// Decoder thread entry, called repeatedly until the thread is stopped
+void video_decoder_update()
+{
+    if (DecoderFinished)
+    {
+        AGSPlatformDriver::GetDriver()->Delay(DecoderIdleDelay);
+        return;
+    }
+
+    if (!AudioEnded)
+        poll_audio();
+    bool decoded = false;
+    if (!VideoEnded && !DecoderFailed)
+        decoded = decode_frame();
+    if (VideoEnded && AudioEnded)
+        DecoderFinished = true;
+
+    if (!decoded)
+        AGSPlatformDriver::GetDriver()->Delay(DecoderIdleDelay);
+}
+
+} // namespace
+
+
+bool video_decoder_supports_depth(int color_depth)
+{
+    return YUVConvert::IsSupported(color_depth);
+}
+
+void video_decoder_set_display_callbacks()
+{
+    apeg_set_display_callbacks(display_init, display_frame, NULL);
+}
+
+bool video_decoder_start(APEG_STREAM *stream, int frame_width, int frame_height,
+                         int color_depth, bool framedrop)
+{
+    if (DecoderRunning || !YUVConvert::IsSupported(color_depth))
+        return false;
+
+    VideoStream = stream;
+    Framedrop = framedrop;
+    Format.ColorDepth = color_depth;
+    switch (color_depth)
+    {
+    case 15:
+        Format.RShift = _rgb_r_shift_15; Format.GShift = _rgb_g_shift_15; Format.BShift = _rgb_b_shift_15; Format.AShift = 0;
+        break;
+    case 16:
+        Format.RShift = _rgb_r_shift_16; Format.GShift = _rgb_g_shift_16; Format.BShift = _rgb_b_shift_16; Format.AShift = 0;
+        break;
+    case 32:
+        Format.RShift = _rgb_r_shift_32; Format.GShift = _rgb_g_shift_32; Format.BShift = _rgb_b_shift_32; Format.AShift = _rgb_a_shift_32;
+        break;
+    }
+    StretchXMap.resize(frame_width);
+    for (int x = 0; x < frame_width; ++x)
+        StretchXMap[x] = x * stream->w / frame_width;
+    StretchLine.resize(stream->w * 4);
+
+    for (int i = 0; i < VideoFrameSlots; ++i)
+    {
+        FrameSlots[i] = BitmapHelper::CreateBitmap(frame_width, frame_height, color_depth);
+        FrameSlots[i]->Clear();
+        FreeSlots.Push(i);
+    }
+    PendingSlot = -1;
+    ConsecutiveDrops = 0;
+    VideoEnded = (stream->flags & APEG_HAS_VIDEO) == 0;
+    AudioEnded = (stream->flags & APEG_HAS_AUDIO) == 0;
+    DecoderFinished = false;
+    DecoderFailed = false;
+    set_clock(0.0, !AudioEnded);
+    LastClock = 0.0;
+
+    DecoderRunning = DecoderThread.CreateAndStart(video_decoder_update, true);
+    if (!DecoderRunning)
+        video_decoder_stop();
+    return DecoderRunning;
+}
+
+void video_decoder_stop()
+{
+    if (DecoderRunning)
+        DecoderThread.Stop();
+    DecoderRunning = false;
+
+    VideoFrame frame;
+    while (ReadyFrames.Pop(frame));
+    int slot;
+    while (FreeSlots.Pop(slot));
+    for (int i = 0; i < VideoFrameSlots; ++i)
+    {
+        delete FrameSlots[i];
+        FrameSlots[i] = NULL;
+    }
+    VideoStream = NULL;
+}
+
+double video_decoder_get_clock()
+{
+    const double time = calc_clock();
+    if (time > LastClock)
+        LastClock = time;
+    return LastClock;
+}
+
+bool video_decoder_next_frame(VideoFrame &frame)
+{
+    return ReadyFrames.Pop(frame);
+}
+
+void video_decoder_release_frame(const VideoFrame &frame)
+{
+    FreeSlots.Push(frame.Slot);
+}
+
+bool video_decoder_is_finished()
+{
+    return DecoderFinished && ReadyFrames.IsEmpty();
+}
+
+bool video_decoder_has_failed()
+{
+    return DecoderFailed;
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Video decoder: the thread decoding an APEG stream ahead of the playback.
+//
+// While running, the decoder thread owns the stream: it polls its audio and
+// converts the decoded pictures into a small set of bitmaps of the output
+// size, which are passed to the game thread through a lock-free ring, and
+// given back through another one once presented. The playback clock follows
+// the audio of the stream, or the system time when there is no audio.
+//
+// The display callbacks must be set before the stream is opened.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__VIDEODECODER_H
+#define __AGS_EE_MEDIA__VIDEODECODER_H
+
+#include "apeg.h"
+
+namespace AGS { namespace Common { class Bitmap; } }
+
+struct VideoFrame
+{
+    AGS::Common::Bitmap *Image;
+    double               Time;  // presentation time, in seconds
+    int                  Slot;
+};
+
+// Tells if the frames may be converted for the given color depth
+bool video_decoder_supports_depth(int color_depth);
+// Makes APEG pass decoded pictures to the decoder; the callbacks stay set
+// until reset by the caller
+void video_decoder_set_display_callbacks();
+// Starts decoding the stream on a new thread; frames are made of the given
+// size, with the picture stretched if necessary. If framedrop is enabled
+// the frames which are already late are not converted.
+bool video_decoder_start(APEG_STREAM *stream, int frame_width, int frame_height,
+                         int color_depth, bool framedrop);
+// Stops the thread and releases the frames; the stream is not closed
+void video_decoder_stop();
+// Gets the current playback time, in seconds; never goes backwards
+double video_decoder_get_clock();
+// Takes the earliest of the decoded frames; returns false if none is ready
+bool video_decoder_next_frame(VideoFrame &frame);
+// Gives the frame back to the decoder, which may then overwrite it
+void video_decoder_release_frame(const VideoFrame &frame);
+// Tells if the decoder reached the end of stream, and every frame was taken
+bool video_decoder_is_finished();
+// Tells if decoding has stopped because of an error
+bool video_decoder_has_failed();
+
+#endif // __AGS_EE_MEDIA__VIDEODECODER_H
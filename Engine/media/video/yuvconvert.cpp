@@ -0,0 +1,215 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "media/video/yuvconvert.h"
+#include "util/simd.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace YUVConvert
+{
+
+// Color components are computed with 6 fractional bits. Coefficients are
+// split into a whole part, applied with a shift, and a fraction, applied
+// as a multiplication by (fraction * 32768) of the value shifted left by 7,
+// of which only the high 16 bits are kept:
+//   R = 1.164 * (Y - 16)                 + 1.596 * (V - 128)
+//   G = 1.164 * (Y - 16) - 0.391 * (U - 128) - 0.813 * (V - 128)
+//   B = 1.164 * (Y - 16) + 2.018 * (U - 128)
+const int16_t FracY  = 5386;  // 0.164
+const int16_t FracRV = 19530; // 0.596
+const int16_t FracGU = 12812; // 0.391
+const int16_t FracGV = 26640; // 0.813
+const int16_t FracBU = 590;   // 0.018
+const int     FracBits = 6;
+
+inline int mulhi(int a, int b)
+{
+    return (a * b) >> 16;
+}
+
+inline int adds(int a, int b)
+{
+    const int sum = a + b;
+    return sum < -32768 ? -32768 : (sum > 32767 ? 32767 : sum);
+}
+
+inline int to_byte(int c)
+{
+    c >>= FracBits;
+    return c < 0 ? 0 : (c > 255 ? 255 : c);
+}
+
+inline void convert_pixel(int y, int u, int v, int &r, int &g, int &b)
+{
+    y -= 16;
+    u -= 128;
+    v -= 128;
+    const int yc = (y << FracBits) + mulhi(y << 7, FracY) + (1 << (FracBits - 1));
+    r = to_byte(adds(yc, (v << FracBits) + mulhi(v << 7, FracRV)));
+    g = to_byte(adds(yc, -(mulhi(u << 7, FracGU) + mulhi(v << 7, FracGV))));
+    b = to_byte(adds(yc, (u << (FracBits + 1)) + mulhi(u << 7, FracBU)));
+}
+
+static void convert_pixels(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+    uint8_t *dst, int from, int to, const PixelFormat &format)
+{
+    int r, g, b;
+    for (int i = from; i < to; ++i)
+    {
+        convert_pixel(y[i], u[i / 2], v[i / 2], r, g, b);
+        switch (format.ColorDepth)
+        {
+        case 15:
+            ((uint16_t*)dst)[i] = (uint16_t)(((r >> 3) << format.RShift) | ((g >> 3) << format.GShift) | ((b >> 3) << format.BShift));
+            break;
+        case 16:
+            ((uint16_t*)dst)[i] = (uint16_t)(((r >> 3) << format.RShift) | ((g >> 2) << format.GShift) | ((b >> 3) << format.BShift));
+            break;
+        case 32:
+            ((uint32_t*)dst)[i] = (r << format.RShift) | (g << format.GShift) | (b << format.BShift) | (0xFFu << format.AShift);
+            break;
+        }
+    }
+}
+
+#if defined(AGS_SIMD_SSE2)
+static int convert_pixels8(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+    uint8_t *dst, int width, bool dst32)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i y_off = _mm_set1_epi16(16);
+    const __m128i uv_off = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi16(1 << (FracBits - 1));
+    int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        int32_t u4, v4;
+        memcpy(&u4, u + i / 2, sizeof(u4));
+        memcpy(&v4, v + i / 2, sizeof(v4));
+        __m128i uu = _mm_cvtsi32_si128(u4);
+        __m128i vv = _mm_cvtsi32_si128(v4);
+        uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(uu, uu), zero), uv_off);
+        vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(vv, vv), zero), uv_off);
+        __m128i yy = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(y + i)), zero), y_off);
+
+        const __m128i yc = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(yy, FracBits),
+            _mm_mulhi_epi16(_mm_slli_epi16(yy, 7), _mm_set1_epi16(FracY))), round);
+        const __m128i u7 = _mm_slli_epi16(uu, 7);
+        const __m128i v7 = _mm_slli_epi16(vv, 7);
+        const __m128i rc = _mm_add_epi16(_mm_slli_epi16(vv, FracBits), _mm_mulhi_epi16(v7, _mm_set1_epi16(FracRV)));
+        const __m128i gc = _mm_add_epi16(_mm_mulhi_epi16(u7, _mm_set1_epi16(FracGU)), _mm_mulhi_epi16(v7, _mm_set1_epi16(FracGV)));
+        const __m128i bc = _mm_add_epi16(_mm_slli_epi16(uu, FracBits + 1), _mm_mulhi_epi16(u7, _mm_set1_epi16(FracBU)));
+        // packing to bytes saturates the components to 0..255
+        const __m128i r = _mm_packus_epi16(_mm_srai_epi16(_mm_adds_epi16(yc, rc), FracBits), zero);
+        const __m128i g = _mm_packus_epi16(_mm_srai_epi16(_mm_subs_epi16(yc, gc), FracBits), zero);
+        const __m128i b = _mm_packus_epi16(_mm_srai_epi16(_mm_adds_epi16(yc, bc), FracBits), zero);
+
+        if (dst32)
+        {
+            const __m128i bg = _mm_unpacklo_epi8(b, g);
+            const __m128i ra = _mm_unpacklo_epi8(r, _mm_set1_epi8((char)0xFF));
+            _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_unpacklo_epi16(bg, ra));
+            _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(bg, ra));
+        }
+        else
+        {
+            const __m128i r16 = _mm_slli_epi16(_mm_srli_epi16(_mm_unpacklo_epi8(r, zero), 3), 11);
+            const __m128i g16 = _mm_slli_epi16(_mm_srli_epi16(_mm_unpacklo_epi8(g, zero), 2), 5);
+            const __m128i b16 = _mm_srli_epi16(_mm_unpacklo_epi8(b, zero), 3);
+            _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_or_si128(_mm_or_si128(r16, g16), b16));
+        }
+    }
+    return i;
+}
+#elif defined(AGS_SIMD_NEON)
+static int convert_pixels8(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+    uint8_t *dst, int width, bool dst32)
+{
+    const int16x8_t y_off = vdupq_n_s16(16);
+    const int16x8_t uv_off = vdupq_n_s16(128);
+    const int16x8_t round = vdupq_n_s16(1 << (FracBits - 1));
+    int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        uint8_t u8[8], v8[8];
+        for (int k = 0; k < 4; ++k)
+        {
+            u8[k * 2] = u8[k * 2 + 1] = u[i / 2 + k];
+            v8[k * 2] = v8[k * 2 + 1] = v[i / 2 + k];
+        }
+        const int16x8_t uu = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u8))), uv_off);
+        const int16x8_t vv = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v8))), uv_off);
+        const int16x8_t yy = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), y_off);
+
+        // vqdmulh doubles the product, so the values are shifted by 6 instead of 7
+        const int16x8_t yc = vaddq_s16(vaddq_s16(vshlq_n_s16(yy, FracBits),
+            vqdmulhq_n_s16(vshlq_n_s16(yy, 6), FracY)), round);
+        const int16x8_t u6 = vshlq_n_s16(uu, 6);
+        const int16x8_t v6 = vshlq_n_s16(vv, 6);
+        const int16x8_t rc = vaddq_s16(vshlq_n_s16(vv, FracBits), vqdmulhq_n_s16(v6, FracRV));
+        const int16x8_t gc = vaddq_s16(vqdmulhq_n_s16(u6, FracGU), vqdmulhq_n_s16(v6, FracGV));
+        const int16x8_t bc = vaddq_s16(vshlq_n_s16(uu, FracBits + 1), vqdmulhq_n_s16(u6, FracBU));
+        const uint8x8_t r = vqmovun_s16(vshrq_n_s16(vqaddq_s16(yc, rc), FracBits));
+        const uint8x8_t g = vqmovun_s16(vshrq_n_s16(vqsubq_s16(yc, gc), FracBits));
+        const uint8x8_t b = vqmovun_s16(vshrq_n_s16(vqaddq_s16(yc, bc), FracBits));
+
+        if (dst32)
+        {
+            uint8x8x4_t bgra;
+            bgra.val[0] = b;
+            bgra.val[1] = g;
+            bgra.val[2] = r;
+            bgra.val[3] = vdup_n_u8(0xFF);
+            vst4_u8(dst + i * 4, bgra);
+        }
+        else
+        {
+            const uint16x8_t r16 = vshlq_n_u16(vshrq_n_u16(vmovl_u8(r), 3), 11);
+            const uint16x8_t g16 = vshlq_n_u16(vshrq_n_u16(vmovl_u8(g), 2), 5);
+            const uint16x8_t b16 = vshrq_n_u16(vmovl_u8(b), 3);
+            vst1q_u16((uint16_t*)(dst + i * 2), vorrq_u16(vorrq_u16(r16, g16), b16));
+        }
+    }
+    return i;
+}
+#endif
+
+bool IsSupported(int color_depth)
+{
+    return color_depth == 15 || color_depth == 16 || color_depth == 32;
+}
+
+void ConvertLine420(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+    uint8_t *dst, int width, const PixelFormat &format)
+{
+    int done = 0;
+#if defined(AGS_SIMD_SSE2) || defined(AGS_SIMD_NEON)
+    // the vector code writes only the usual pixel layouts
+    if (format.ColorDepth == 32 && format.RShift == 16 && format.GShift == 8 && format.BShift == 0 && format.AShift == 24)
+        done = convert_pixels8(y, u, v, dst, width, true);
+    else if (format.ColorDepth == 16 && format.RShift == 11 && format.GShift == 5 && format.BShift == 0)
+        done = convert_pixels8(y, u, v, dst, width, false);
+#endif
+    convert_pixels(y, u, v, dst, done, width, format);
+}
+
+} // namespace YUVConvert
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,55 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Conversion of decoded YUV video frames to 15-, 16- and 32-bit pixels.
+//
+// Uses the same BT.601 coefficients as the apeg renderer, in 16-bit fixed
+// point, and results differ from apeg's by 1 at most. The common pixel
+// layouts are converted 8 pixels at a time with SSE2 or NEON when available.
+//
+//=============================================================================
+#ifndef __AGS_EE_MEDIA__YUVCONVERT_H
+#define __AGS_EE_MEDIA__YUVCONVERT_H
+
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace YUVConvert
+{
+    // Position of the color components in the destination pixels
+    struct PixelFormat
+    {
+        int ColorDepth;
+        int RShift;
+        int GShift;
+        int BShift;
+        int AShift; // 32-bit pixels are made opaque
+    };
+
+    // Tells if the pixels of the given color depth may be produced
+    bool IsSupported(int color_depth);
+    // Converts a line of a 4:2:0 image; the u and v lines hold one sample
+    // for every two pixels
+    void ConvertLine420(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+        uint8_t *dst, int width, const PixelFormat &format);
+} // namespace YUVConvert
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MEDIA__YUVCONVERT_H
@@ -1547,6 +1547,27 @@ void D3DGraphicsDriver::UpdateTextureRegion(D3DTextureTile *tile, Bitmap *bitmap
   newTexture->UnlockRect(0);
 }
 
+void D3DGraphicsDriver::UpdateTexturePart(D3DTextureTile *tile, const TextureTile &part, Bitmap *bitmap, D3DBitmap *target, bool hasAlpha)
+{
+  RECT lockRect;
+  lockRect.left = part.x - tile->x;
+  lockRect.top = part.y - tile->y;
+  lockRect.right = lockRect.left + part.width;
+  lockRect.bottom = lockRect.top + part.height;
+
+  D3DLOCKED_RECT lockedRegion;
+  HRESULT hr = tile->texture->LockRect(0, &lockedRegion, &lockRect, D3DLOCK_NOSYSLOCK);
+  if (hr != D3D_OK)
+  {
+    throw Ali3DException("Unable to lock texture");
+  }
+
+  bool usingLinearFiltering = _filter->NeedToColourEdgeLines();
+  BitmapToVideoMem(bitmap, hasAlpha, &part, target, (char*)lockedRegion.pBits, lockedRegion.Pitch, usingLinearFiltering);
+
+  tile->texture->UnlockRect(0);
+}
+
 void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
 {
   D3DBitmap *target = (D3DBitmap*)bitmapToUpdate;
@@ -1569,6 +1590,30 @@ void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
       unselect_palette();
 }
 
+void D3DGraphicsDriver::UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, const Rect &region, bool hasAlpha)
+{
+  D3DBitmap *target = (D3DBitmap*)bitmapToUpdate;
+  if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
+    throw Ali3DException("UpdateDDBFromBitmapRegion: mismatched bitmap size");
+  const int color_depth = bitmap->GetColorDepth();
+  if (color_depth != target->_colDepth)
+    throw Ali3DException("UpdateDDBFromBitmapRegion: mismatched colour depths");
+
+  target->_hasAlpha = hasAlpha;
+  if (color_depth == 8)
+      select_palette(palette);
+
+  TextureTile part;
+  for (int i = 0; i < target->_numTiles; i++)
+  {
+    if (GetTilePartInRegion(target->_tiles[i], region, part))
+      UpdateTexturePart(&target->_tiles[i], part, bitmap, target, hasAlpha);
+  }
+
+  if (color_depth == 8)
+      unselect_palette();
+}
+
 int D3DGraphicsDriver::GetCompatibleBitmapFormat(int color_depth)
 {
   if (color_depth == 8)
@@ -181,6 +181,7 @@ public:
     virtual int  GetCompatibleBitmapFormat(int color_depth);
     virtual IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque);
     virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha);
+    virtual void UpdateDDBFromBitmapRegion(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, const Rect &region, bool hasAlpha);
     virtual void DestroyDDB(IDriverDependantBitmap* bitmap);
     virtual void DrawSprite(int x, int y, IDriverDependantBitmap* bitmap);
     virtual void RenderToBackBuffer();
@@ -262,6 +263,8 @@ private:
     void set_up_default_vertices();
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
     void UpdateTextureRegion(D3DTextureTile *tile, Bitmap *bitmap, D3DBitmap *target, bool hasAlpha);
+    // Updates the part of the tile's texture; the part is in bitmap coordinates
+    void UpdateTexturePart(D3DTextureTile *tile, const TextureTile &part, Bitmap *bitmap, D3DBitmap *target, bool hasAlpha);
     void CreateVirtualScreen();
     void do_fade(bool fadingOut, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     bool IsTextureFormatOk( D3DFORMAT TextureFormat, D3DFORMAT AdapterFormat );
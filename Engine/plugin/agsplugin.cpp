@@ -52,6 +52,7 @@
 #include "script/script.h"
 #include "script/script_runtime.h"
 #include "ac/spritecache.h"
+#include "ac/spritetransformcache.h"
 #include "util/stream.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
@@ -616,6 +617,7 @@ int IAGSEngine::CallGameScriptFunction(const char *name, int32 globalScript, int
 
 void IAGSEngine::NotifySpriteUpdated(int32 slot) {
     int ff;
+    invalidate_transformed_sprite(slot);
     // wipe the character cache when we change rooms
     for (ff = 0; ff < game.numcharacters; ff++) {
         if ((charcache[ff].inUse) && (charcache[ff].sppic == slot)) {
@@ -807,6 +809,14 @@ int pl_run_plugin_hooks (int event, long data) {
     return 0;
 }
 
+bool pl_any_want_hook(int event) {
+    for (int i = 0; i < numPlugins; i++) {
+        if (plugins[i].wantHook & event)
+            return true;
+    }
+    return false;
+}
+
 int pl_run_plugin_debug_hooks (const char *scriptfile, int linenum) {
     int i, retval = 0;
     for (i = 0; i < numPlugins; i++) {
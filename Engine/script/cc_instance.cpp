@@ -26,9 +26,11 @@
 #include "script/cc_options.h"
 #include "script/executingscript.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "script/systemimports.h"
 #include "util/bbop.h"
+#include "util/memory.h"
 #include "util/stream.h"
 #include "util/misc.h"
 #include "util/textstreamwriter.h"
@@ -280,11 +282,32 @@ void ccInstance::AbortAndDestroy()
         return -1; \
     }
 
+int32_t ccInstance::FindScriptFunction(const char *funcname) const
+{
+    if (!exportindex)
+        return SCRIPT_FUNC_NOTFOUND;
+    ScExportMap::const_iterator it = exportindex->find(funcname);
+    return it != exportindex->end() ? it->second : SCRIPT_FUNC_NOTFOUND;
+}
+
 int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const RuntimeScriptValue *params)
 {
     ccError = 0;
     currentline = 0;
 
+    int32_t func_index = FindScriptFunction(funcname);
+    if (func_index < 0) {
+        cc_error("function '%s' not found", funcname);
+        return -2;
+    }
+    return CallScriptFunction(func_index, numargs, params);
+}
+
+int ccInstance::CallScriptFunction(int32_t func_index, int32_t numargs, const RuntimeScriptValue *params)
+{
+    ccError = 0;
+    currentline = 0;
+
     if (numargs > 0 && !params)
     {
         cc_error("internal error in ccInstance::CallScriptFunction");
@@ -301,42 +324,26 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
         return -4;
     }
 
-    int32_t startat = -1;
-    int k;
-    char mangledName[200];
-    sprintf(mangledName, "%s$", funcname);
-
-    for (k = 0; k < instanceof->numexports; k++) {
-        char *thisExportName = instanceof->exports[k];
-        int match = 0;
-
-        // check for a mangled name match
-        if (strncmp(thisExportName, mangledName, strlen(mangledName)) == 0) {
-            // found, compare the number of parameters
-            char *numParams = thisExportName + strlen(mangledName);
-            if (atoi(numParams) != numargs) {
-                cc_error("wrong number of parameters to exported function '%s' (expected %d, supplied %d)", funcname, atoi(numParams), numargs);
-                return -1;
-            }
-            match = 1;
-        }
-        // check for an exact match (if the script was compiled with
-        // an older version)
-        if ((match == 1) || (strcmp(thisExportName, funcname) == 0)) {
-            int32_t etype = (instanceof->export_addr[k] >> 24L) & 0x000ff;
-            if (etype != EXPORT_FUNCTION) {
-                cc_error("symbol is not a function");
-                return -1;
-            }
-            startat = (instanceof->export_addr[k] & 0x00ffffff);
-            break;
-        }
+    if (func_index < 0 || func_index >= instanceof->numexports) {
+        cc_error("function not found");
+        return -2;
     }
 
-    if (startat < 0) {
-        cc_error("function '%s' not found", funcname);
-        return -2;
+    const char *exportName = instanceof->exports[func_index];
+    // mangled name has the number of parameters; exact name means
+    // that the script was compiled with an older version
+    const char *numParams = strchr(exportName, '$');
+    if (numParams && atoi(numParams + 1) != numargs) {
+        cc_error("wrong number of parameters to exported function '%.*s' (expected %d, supplied %d)",
+            (int)(numParams - exportName), exportName, atoi(numParams + 1), numargs);
+        return -1;
+    }
+    int32_t etype = (instanceof->export_addr[func_index] >> 24L) & 0x000ff;
+    if (etype != EXPORT_FUNCTION) {
+        cc_error("symbol is not a function");
+        return -1;
     }
+    int32_t startat = (instanceof->export_addr[func_index] & 0x00ffffff);
 
     //numargs++;                    // account for return address
     flags &= ~INSTF_ABORTED;
@@ -393,23 +400,25 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
     return ccError;
 }
 
-bool ccInstance::DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, bool hasTheFunc) {
-    if (!hasTheFunc)
-        return(false);
+int32_t ccInstance::DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, int32_t func_index) {
+    if (func_index == SCRIPT_FUNC_UNRESOLVED)
+        func_index = FindScriptFunction(funcToRun->functionName);
+    // the function doesn't exist, so don't try and run it again
+    if (func_index == SCRIPT_FUNC_NOTFOUND)
+        return func_index;
 
     no_blocking_functions++;
     int result = 0;
 
     if (funcToRun->numParameters < 3)
     {
-        result = CallScriptFunction((char*)funcToRun->functionName, funcToRun->numParameters, funcToRun->params);
+        result = CallScriptFunction(func_index, funcToRun->numParameters, funcToRun->params);
     }
     else
         quit("DoRunScriptFuncCantBlock called with too many parameters");
 
     if (result == -2) {
-        // the function doens't exist, so don't try and run it again
-        hasTheFunc = false;
+        func_index = SCRIPT_FUNC_NOTFOUND;
     }
     else if ((result != 0) && (result != 100)) {
         quit_with_script_error(funcToRun->functionName);
@@ -422,7 +431,7 @@ bool ccInstance::DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun,
     ccErrorString[0] = 0;
     ccError = 0;
     no_blocking_functions--;
-    return(hasTheFunc);
+    return func_index;
 }
 
 char scfunctionname[MAX_FUNCTION_NAME_LEN+1];
@@ -479,6 +488,26 @@ int ccInstance::PrepareTextScript(const char**tsname) {
     line_number = callStackLineNumber[callStackSize];\
     currentline = line_number
 
+// Makes the profiler leave the script functions entered by Run, whichever
+// way it returns
+struct ScriptProfilerScope
+{
+    const bool   Active;
+    const size_t Depth;
+
+    ScriptProfilerScope(bool active, ccInstance *inst, int32_t pc)
+        : Active(active)
+        , Depth(active ? script_profiler_enter_function(inst, pc) : 0)
+    {
+    }
+
+    ~ScriptProfilerScope()
+    {
+        if (Active)
+            script_profiler_unwind(Depth);
+    }
+};
+
 #define MAXNEST 50  // number of recursive function calls allowed
 int ccInstance::Run(int32_t curpc)
 {
@@ -502,6 +531,8 @@ int ccInstance::Run(int32_t curpc)
     current_instance = this;
     ccInstance *codeInst = runningInst;
     int write_debug_dump = ccGetOption(SCOPT_DEBUGRUN);
+    const bool profile = script_profiler_is_active();
+    ScriptProfilerScope profiler_scope(profile, codeInst, pc);
 	ScriptOperation codeOp;
 
     FunctionCallStack func_callstack;
@@ -556,6 +587,9 @@ int ccInstance::Run(int32_t curpc)
                         codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
                     }
                     break;
+                case FIXUP_GLOBALDATA_PLAIN:
+                    codeOp.Args[i].SetGlobalData(codeInst->globaldata + codeInst->code[pc_at]);
+                    break;
                 case FIXUP_FUNCTION:
                     // originally commented -- CHECKME: could this be used in very old versions of AGS?
                     //      code[fixup] += (long)&code[0];
@@ -615,12 +649,19 @@ int ccInstance::Run(int32_t curpc)
             DumpInstruction(codeOp);
         }
 
+        if (profile)
+        {
+            script_profiler_instruction();
+        }
+
         switch (codeOp.Instruction.Code) {
       case SCMD_LINENUM:
           line_number = arg1.IValue;
           currentline = arg1.IValue;
           if (new_line_hook)
               new_line_hook(this, currentline);
+          if (profile)
+              script_profiler_line(line_number);
           break;
       case SCMD_ADD:
           // If the the register is SREG_SP, we are allocating new variable on the stack
@@ -718,6 +759,8 @@ int ccInstance::Run(int32_t curpc)
           }
           current_instance = this;
           POP_CALL_STACK;
+          if (profile)
+              script_profiler_leave();
           continue; // continue so that the PC doesn't get overwritten
           }
       case SCMD_LITTOREG:
@@ -725,11 +768,17 @@ int ccInstance::Run(int32_t curpc)
           break;
       case SCMD_MEMREAD:
           // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
-          reg1 = registers[SREG_MAR].ReadValue();
+          if (registers[SREG_MAR].Type == kScValGlobalData)
+              reg1.SetInt32(Memory::ReadInt32LE(registers[SREG_MAR].GetPtrWithOffset()));
+          else
+              reg1 = registers[SREG_MAR].ReadValue();
           break;
       case SCMD_MEMWRITE:
           // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
-          registers[SREG_MAR].WriteValue(reg1);
+          if (registers[SREG_MAR].Type == kScValGlobalData)
+              Memory::WriteInt32LE(registers[SREG_MAR].GetPtrWithOffset(), reg1.IValue);
+          else
+              registers[SREG_MAR].WriteValue(reg1);
           break;
       case SCMD_LOADSPOFFS:
           registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
@@ -833,22 +882,36 @@ int ccInstance::Run(int32_t curpc)
           curnest++;
           thisbase[curnest] = 0;
           funcstart[curnest] = pc;
+          if (profile)
+              script_profiler_enter_function(codeInst, pc);
           continue; // continue so that the PC doesn't get overwritten
       case SCMD_MEMREADB:
           // Take the data address from reg[MAR] and copy byte to reg[arg1]
-          reg1.SetUInt8(registers[SREG_MAR].ReadByte());
+          if (registers[SREG_MAR].Type == kScValGlobalData)
+              reg1.SetUInt8(*(uint8_t*)registers[SREG_MAR].GetPtrWithOffset());
+          else
+              reg1.SetUInt8(registers[SREG_MAR].ReadByte());
           break;
       case SCMD_MEMREADW:
           // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
-          reg1.SetInt16(registers[SREG_MAR].ReadInt16());
+          if (registers[SREG_MAR].Type == kScValGlobalData)
+              reg1.SetInt16(Memory::ReadInt16LE(registers[SREG_MAR].GetPtrWithOffset()));
+          else
+              reg1.SetInt16(registers[SREG_MAR].ReadInt16());
           break;
       case SCMD_MEMWRITEB:
           // Take the data address from reg[MAR] and copy there byte from reg[arg1]
-          registers[SREG_MAR].WriteByte(reg1.IValue);
+          if (registers[SREG_MAR].Type == kScValGlobalData)
+              *(uint8_t*)registers[SREG_MAR].GetPtrWithOffset() = (uint8_t)reg1.IValue;
+          else
+              registers[SREG_MAR].WriteByte(reg1.IValue);
           break;
       case SCMD_MEMWRITEW:
           // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
-          registers[SREG_MAR].WriteInt16(reg1.IValue);
+          if (registers[SREG_MAR].Type == kScValGlobalData)
+              Memory::WriteInt16LE(registers[SREG_MAR].GetPtrWithOffset(), (int16_t)reg1.IValue);
+          else
+              registers[SREG_MAR].WriteInt16(reg1.IValue);
           break;
       case SCMD_JZ:
           if (registers[SREG_AX].IsNull())
@@ -952,9 +1015,9 @@ int ccInstance::Run(int32_t curpc)
           int32_t handle = registers[SREG_MAR].ReadInt32();
           char *address = NULL;
 
-          if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager())
+          if (reg1.Type == kScValStaticArray && reg1.GetStaticArray()->GetDynamicManager())
           {
-              address = (char*)reg1.StcArr->GetElementPtr(reg1.Ptr, reg1.IValue);
+              address = (char*)reg1.GetStaticArray()->GetElementPtr(reg1.Ptr, reg1.IValue);
           }
           else if (reg1.Type == kScValDynamicObject ||
               reg1.Type == kScValPluginObject)
@@ -986,9 +1049,9 @@ int ccInstance::Run(int32_t curpc)
       case SCMD_MEMINITPTR: { 
           char *address = NULL;
 
-          if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager())
+          if (reg1.Type == kScValStaticArray && reg1.GetStaticArray()->GetDynamicManager())
           {
-              address = (char*)reg1.StcArr->GetElementPtr(reg1.Ptr, reg1.IValue);
+              address = (char*)reg1.GetStaticArray()->GetElementPtr(reg1.Ptr, reg1.IValue);
           }
           else if (reg1.Type == kScValDynamicObject ||
               reg1.Type == kScValPluginObject)
@@ -1119,6 +1182,31 @@ int ccInstance::Run(int32_t curpc)
             num_args_to_func = func_callstack.Count;
           }
 
+          if (reg1.Type == kScValTypedFunction)
+          {
+              // Typed function reads the arguments as they are, and sets the return value itself
+              if (num_args_to_func < reg1.IValue)
+              {
+                  cc_error("not enough parameters in call to typed API function: expected %d, got %d", reg1.IValue, num_args_to_func);
+                  return -1;
+              }
+              void *self = next_call_needs_object ? (void*)registers[SREG_OP].GetDirectPtr() : NULL;
+              ScriptAPITypedFunction *pfn = reg1.TPfn;
+              if (profile)
+                  script_profiler_enter_api(reg1);
+              pfn(self, func_callstack.GetHead() + 1, registers[SREG_AX]);
+              if (profile)
+                  script_profiler_leave();
+              if (ccError)
+              {
+                  return -1;
+              }
+              current_instance = this;
+              next_call_needs_object = 0;
+              num_args_to_func = -1;
+              break;
+          }
+
           // Convert pointer arguments to simple types
           for (RuntimeScriptValue *prval = func_callstack.GetHead() + num_args_to_func;
               prval > func_callstack.GetHead(); --prval)
@@ -1128,6 +1216,9 @@ int ccInstance::Run(int32_t curpc)
 
           RuntimeScriptValue return_value;
 
+          if (profile)
+              script_profiler_enter_api(reg1);
+
           if (reg1.Type == kScValPluginFunction)
           {
               GlobalReturnValue.Invalidate();
@@ -1179,6 +1270,9 @@ int ccInstance::Run(int32_t curpc)
             cc_error("invalid pointer type for function call: %d", reg1.Type);
           }
 
+          if (profile)
+              script_profiler_leave();
+
           if (ccError)
           {
             return -1;
@@ -1219,15 +1313,16 @@ int ccInstance::Run(int32_t curpc)
           // Note, that this is the only case known when such object is written into reg[SREG_OP];
           // in any other case that would count as error. 
           case kScValGlobalVar:
+          case kScValGlobalData:
           case kScValStackPtr:
               registers[SREG_OP] = reg1;
               break;
           case kScValStaticArray:
-              if (reg1.StcArr->GetDynamicManager())
+              if (reg1.GetStaticArray()->GetDynamicManager())
               {
                   registers[SREG_OP].SetDynamicObject(
-                      (char*)reg1.StcArr->GetElementPtr(reg1.Ptr, reg1.IValue),
-                      reg1.StcArr->GetDynamicManager());
+                      (char*)reg1.GetStaticArray()->GetElementPtr(reg1.Ptr, reg1.IValue),
+                      reg1.GetStaticArray()->GetDynamicManager());
                   break;
               }
               // fall-through intended
@@ -1266,8 +1361,7 @@ int ccInstance::Run(int32_t curpc)
                   cc_error("Invalid size for user object; requested: %u (or %d), range: 0..%d", (uint32_t)size, size, INT_MAX);
                   return -1;
               }
-              std::pair<char*, ScriptUserObject*> suo = ScriptUserObject::CreateManaged(size);
-              reg1.SetDynamicObject(suo.first, suo.second);
+              reg1.SetDynamicObject(globalScriptUserObject.CreateManaged(size), &globalScriptUserObject);
               break;
           }
       case SCMD_FADD:
@@ -1530,19 +1624,13 @@ void ccInstance::GetScriptPosition(ScriptPosition &script_pos)
 // get a pointer to a variable or function exported by the script
 RuntimeScriptValue ccInstance::GetSymbolAddress(const char *symname)
 {
-    int k;
-    char altName[200];
-    sprintf(altName, "%s$", symname);
     RuntimeScriptValue rval_null;
 
-    for (k = 0; k < instanceof->numexports; k++) {
-        if (strcmp(instanceof->exports[k], symname) == 0)
-            return exports[k];
-        // mangled function name
-        if (strncmp(instanceof->exports[k], altName, strlen(altName)) == 0)
-            return exports[k];
-    }
-    return rval_null;
+    // NOTE: the index has mangled function names stripped of the parameter count
+    int32_t export_index = FindScriptFunction(symname);
+    if (export_index < 0)
+        return rval_null;
+    return exports[export_index];
 }
 
 void ccInstance::DumpInstruction(const ScriptOperation &op)
@@ -1704,6 +1792,11 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
             return false;
         }
     }
+    if (joined)
+        exportindex = joined->exportindex;
+    else
+        CreateExportIndex(scri);
+
     instanceof = scri;
     pc = 0;
     flags = 0;
@@ -1743,6 +1836,7 @@ void ccInstance::Free()
         nullfree(code);
     }
     globalvars.reset();
+    exportindex.reset();
     globaldata = NULL;
     code = NULL;
     strings = NULL;
@@ -1892,6 +1986,21 @@ ScriptVariable *ccInstance::FindGlobalVar(int32_t var_addr)
     return it != globalvars->end() ? &it->second : NULL;
 }
 
+void ccInstance::CreateExportIndex(PScript scri)
+{
+    exportindex.reset(new ScExportMap());
+    for (int i = 0; i < scri->numexports; ++i)
+    {
+        // mangled function names are stored as "name$N", where N is the
+        // number of parameters; older scripts have plain function names
+        const char *name = scri->exports[i];
+        const char *name_end = strchr(name, '$');
+        String key = name_end ? String(name, name_end - name) : String(name);
+        // the first symbol of the same name takes precedence
+        exportindex->insert(std::make_pair(key, i));
+    }
+}
+
 bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
 {
     code_fixups = new char[scri->codesize];
@@ -1916,7 +2025,12 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
                     cc_error("cannot resolve global variable, key = %d", (int32_t)code[fixup]);
                     return false;
                 }
-                code[fixup] = (intptr_t)gl_var;
+                // Plain data is accessed directly, only the variables which need
+                // special treatment are referenced through their ScriptVariable
+                if (gl_var->RValue.Type == kScValData)
+                    code_fixups[fixup] = FIXUP_GLOBALDATA_PLAIN;
+                else
+                    code[fixup] = (intptr_t)gl_var;
             }
             break;
         case FIXUP_FUNCTION:
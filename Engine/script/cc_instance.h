@@ -27,6 +27,7 @@
 #include "script/cc_script.h"  // ccScript
 #include "script/nonblockingscriptfunction.h"
 #include "util/string.h"
+#include "util/string_types.h"
 
 using namespace AGS;
 
@@ -45,6 +46,10 @@ using namespace AGS;
 #define INSTANCE_ID_MASK  0x00000000000000ffLL
 #define INSTANCE_ID_REMOVEMASK 0x0000000000ffffffLL
 
+// Runtime fixup type which replaces FIXUP_GLOBALDATA for the global variables
+// of plain data: these are addressed directly at their offset in globaldata
+#define FIXUP_GLOBALDATA_PLAIN 0x7f
+
 struct ccInstance;
 struct ScriptImport;
 
@@ -110,9 +115,14 @@ public:
     // TODO: change to std:: if moved to C++11
     typedef stdtr1compat::unordered_map<int32_t, ScriptVariable> ScVarMap;
     typedef stdtr1compat::shared_ptr<ScVarMap>                   PScVarMap;
+    // Maps exported symbol's name, without the "$N" parameter count suffix,
+    // to its index in the script's export table
+    typedef stdtr1compat::unordered_map<Common::String, int32_t> ScExportMap;
+    typedef stdtr1compat::shared_ptr<ScExportMap>                PScExportMap;
 public:
     int32_t flags;
     PScVarMap globalvars;
+    PScExportMap exportindex;
     char *globaldata;
     int32_t globaldatasize;
     intptr_t *code;
@@ -163,9 +173,16 @@ public:
     // aborts instance, then frees the memory later when it is done with
     void    AbortAndDestroy();
     
+    // find an exported function in the script; returns its export index, which
+    // stays valid for every instance of the same script, or SCRIPT_FUNC_NOTFOUND
+    int32_t FindScriptFunction(const char *funcname) const;
     // call an exported function in the script (2nd arg is number of params)
     int     CallScriptFunction(const char *funcname, int32_t num_params, const RuntimeScriptValue *params);
-    bool    DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, bool hasTheFunc);
+    // call an exported function found by FindScriptFunction
+    int     CallScriptFunction(int32_t func_index, int32_t num_params, const RuntimeScriptValue *params);
+    // runs the function if the script has it; func_index is the function's
+    // export index found on previous call, the updated one is returned
+    int32_t DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, int32_t func_index);
     int     PrepareTextScript(const char **tsname);
     int     Run(int32_t curpc);
     int     RunScriptFunctionIfExists(const char *tsname, int numParam, const RuntimeScriptValue *params);
@@ -187,6 +204,7 @@ protected:
 
     bool    ResolveScriptImports(PScript scri);
     bool    CreateGlobalVars(PScript scri);
+    void    CreateExportIndex(PScript scri);
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(PScript scri);
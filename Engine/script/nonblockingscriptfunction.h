@@ -23,6 +23,10 @@
 
 #include <vector>
 
+// Special values of the script function's export index
+#define SCRIPT_FUNC_NOTFOUND    -1  // there's no such function in the script
+#define SCRIPT_FUNC_UNRESOLVED  -2  // the script was not searched for it yet
+
 struct NonBlockingScriptFunction
 {
     const char* functionName;
@@ -30,9 +34,11 @@ struct NonBlockingScriptFunction
     //void* param1;
     //void* param2;
     RuntimeScriptValue params[2];
-    bool roomHasFunction;
-    bool globalScriptHasFunction;
-    std::vector<bool> moduleHasFunction;
+    // Function's export index in each script, found on the first call;
+    // must be reset to SCRIPT_FUNC_UNRESOLVED when the script is replaced
+    int32_t roomFunction;
+    int32_t globalScriptFunction;
+    std::vector<int32_t> moduleFunction;
     bool atLeastOneImplementationExists;
 
     NonBlockingScriptFunction(const char*funcName, int numParams)
@@ -40,8 +46,8 @@ struct NonBlockingScriptFunction
         this->functionName = funcName;
         this->numParameters = numParams;
         atLeastOneImplementationExists = false;
-        roomHasFunction = true;
-        globalScriptHasFunction = true;
+        roomFunction = SCRIPT_FUNC_UNRESOLVED;
+        globalScriptFunction = SCRIPT_FUNC_UNRESOLVED;
     }
 };
 
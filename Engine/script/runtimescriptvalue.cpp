@@ -4,7 +4,10 @@
 #include "ac/dynobj/cc_dynamicobject.h"
 #include "ac/statobj/staticobject.h"
 #include "util/memory.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
 
+#include <atomic>
 #include <string.h> // for memcpy()
 
 using namespace AGS::Common;
@@ -18,6 +21,50 @@ using namespace AGS::Common;
 
 // TODO: use endian-agnostic method to access global vars
 
+extern void quit(const char *);
+
+static_assert(sizeof(RuntimeScriptValue) <= 16, "RuntimeScriptValue is expected to fit in 16 bytes");
+
+void *RuntimeScriptValue::Managers[SCVAL_MAX_MANAGERS];
+
+namespace
+{
+// Managers are never removed from the table, and the count is only increased
+// after the new entry is written, so the table may be searched without locking
+std::atomic<int>    ManagerCount(1);
+AGS::Engine::Mutex  ManagerLock;
+}
+
+uint8_t RuntimeScriptValue::GetManagerIndex(void *manager)
+{
+    if (!manager)
+        return 0;
+    int count = ManagerCount.load(std::memory_order_acquire);
+    for (int i = 1; i < count; ++i)
+    {
+        if (Managers[i] == manager)
+            return (uint8_t)i;
+    }
+
+    AGS::Engine::MutexLock lock(ManagerLock);
+    // Another thread could have added the manager meanwhile
+    const int new_count = ManagerCount.load(std::memory_order_relaxed);
+    for (int i = count; i < new_count; ++i)
+    {
+        if (Managers[i] == manager)
+            return (uint8_t)i;
+    }
+    count = new_count;
+    if (count == SCVAL_MAX_MANAGERS)
+    {
+        quit("Too many kinds of script objects: runtime value manager table is full");
+        return 0;
+    }
+    Managers[count] = manager;
+    ManagerCount.store(count + 1, std::memory_order_release);
+    return (uint8_t)count;
+}
+
 uint8_t RuntimeScriptValue::ReadByte()
 {
     if (this->Type == kScValStackPtr || this->Type == kScValGlobalVar)
@@ -33,11 +80,11 @@ uint8_t RuntimeScriptValue::ReadByte()
     }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        return this->StcMgr->ReadInt8(this->Ptr, this->IValue);
+        return this->GetStaticManager()->ReadInt8(this->Ptr, this->IValue);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        return this->DynMgr->ReadInt8(this->Ptr, this->IValue);
+        return this->GetDynamicManager()->ReadInt8(this->Ptr, this->IValue);
     }
     return *((uint8_t*)this->GetPtrWithOffset());
 }
@@ -66,13 +113,17 @@ int16_t RuntimeScriptValue::ReadInt16()
             return RValue->IValue; // get RValue as int
         }
     }
+    else if (this->Type == kScValGlobalData)
+    {
+        return Memory::ReadInt16LE(this->GetPtrWithOffset());
+    }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        return this->StcMgr->ReadInt16(this->Ptr, this->IValue);
+        return this->GetStaticManager()->ReadInt16(this->Ptr, this->IValue);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        return this->DynMgr->ReadInt16(this->Ptr, this->IValue);
+        return this->GetDynamicManager()->ReadInt16(this->Ptr, this->IValue);
     }
     return *((int16_t*)this->GetPtrWithOffset());
 }
@@ -101,13 +152,17 @@ int32_t RuntimeScriptValue::ReadInt32()
             return RValue->IValue; // get RValue as int
         }
     }
+    else if (this->Type == kScValGlobalData)
+    {
+        return Memory::ReadInt32LE(this->GetPtrWithOffset());
+    }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        return this->StcMgr->ReadInt32(this->Ptr, this->IValue);
+        return this->GetStaticManager()->ReadInt32(this->Ptr, this->IValue);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        return this->DynMgr->ReadInt32(this->Ptr, this->IValue);
+        return this->GetDynamicManager()->ReadInt32(this->Ptr, this->IValue);
     }
     return *((int32_t*)this->GetPtrWithOffset());
 }
@@ -140,13 +195,17 @@ RuntimeScriptValue RuntimeScriptValue::ReadValue()
             rval = *RValue;
         }
     }
+    else if (this->Type == kScValGlobalData)
+    {
+        rval.SetInt32(Memory::ReadInt32LE(this->GetPtrWithOffset()));
+    }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        rval.SetInt32(this->StcMgr->ReadInt32(this->Ptr, this->IValue));
+        rval.SetInt32(this->GetStaticManager()->ReadInt32(this->Ptr, this->IValue));
     }
     else if (this->Type == kScValDynamicObject)
     {
-        rval.SetInt32(this->DynMgr->ReadInt32(this->Ptr, this->IValue));
+        rval.SetInt32(this->GetDynamicManager()->ReadInt32(this->Ptr, this->IValue));
     }
     else
     {
@@ -171,11 +230,11 @@ bool RuntimeScriptValue::WriteByte(uint8_t val)
     }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        this->StcMgr->WriteInt8(this->Ptr, this->IValue, val);
+        this->GetStaticManager()->WriteInt8(this->Ptr, this->IValue, val);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        this->DynMgr->WriteInt8(this->Ptr, this->IValue, val);
+        this->GetDynamicManager()->WriteInt8(this->Ptr, this->IValue, val);
     }
     else
     {
@@ -208,13 +267,17 @@ bool RuntimeScriptValue::WriteInt16(int16_t val)
             RValue->SetInt16(val); // set RValue as int
         }
     }
+    else if (this->Type == kScValGlobalData)
+    {
+        Memory::WriteInt16LE(this->GetPtrWithOffset(), val);
+    }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        this->StcMgr->WriteInt16(this->Ptr, this->IValue, val);
+        this->GetStaticManager()->WriteInt16(this->Ptr, this->IValue, val);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        this->DynMgr->WriteInt16(this->Ptr, this->IValue, val);
+        this->GetDynamicManager()->WriteInt16(this->Ptr, this->IValue, val);
     }
     else
     {
@@ -247,13 +310,17 @@ bool RuntimeScriptValue::WriteInt32(int32_t val)
             RValue->SetInt32(val); // set RValue as int
         }
     }
+    else if (this->Type == kScValGlobalData)
+    {
+        Memory::WriteInt32LE(this->GetPtrWithOffset(), val);
+    }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        this->StcMgr->WriteInt32(this->Ptr, this->IValue, val);
+        this->GetStaticManager()->WriteInt32(this->Ptr, this->IValue, val);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        this->DynMgr->WriteInt32(this->Ptr, this->IValue, val);
+        this->GetDynamicManager()->WriteInt32(this->Ptr, this->IValue, val);
     }
     else
     {
@@ -303,13 +370,17 @@ bool RuntimeScriptValue::WriteValue(const RuntimeScriptValue &rval)
             *RValue = rval;
         }
     }
+    else if (this->Type == kScValGlobalData)
+    {
+        Memory::WriteInt32LE(this->GetPtrWithOffset(), rval.IValue);
+    }
     else if (this->Type == kScValStaticObject || this->Type == kScValStaticArray)
     {
-        this->StcMgr->WriteInt32(this->Ptr, this->IValue, rval.IValue);
+        this->GetStaticManager()->WriteInt32(this->Ptr, this->IValue, rval.IValue);
     }
     else if (this->Type == kScValDynamicObject)
     {
-        this->DynMgr->WriteInt32(this->Ptr, this->IValue, rval.IValue);
+        this->GetDynamicManager()->WriteInt32(this->Ptr, this->IValue, rval.IValue);
     }
     else
     {
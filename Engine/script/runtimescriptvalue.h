@@ -18,13 +18,21 @@
 #ifndef __AGS_EE_SCRIPT__RUNTIMESCRIPTVALUE_H
 #define __AGS_EE_SCRIPT__RUNTIMESCRIPTVALUE_H
 
-#include "script/script_api.h"
+#include "core/types.h"
+
+struct RuntimeScriptValue;
+
+// TODO: replace void* with base object class when possible; also put array class for parameters
+typedef RuntimeScriptValue ScriptAPIFunction(const RuntimeScriptValue *params, int32_t param_count);
+typedef RuntimeScriptValue ScriptAPIObjectFunction(void *self, const RuntimeScriptValue *params, int32_t param_count);
+// Function of the typed calling convention (see script_api.h); self is NULL for static functions
+typedef void ScriptAPITypedFunction(void *self, const RuntimeScriptValue *params, RuntimeScriptValue &result);
 
 struct ICCStaticObject;
 struct StaticArray;
 struct ICCDynamicObject;
 
-enum ScriptValueType
+enum ScriptValueType : uint8_t
 {
     kScValUndefined,    // to detect errors
     kScValInteger,      // as strictly 32-bit integer (for integer math)
@@ -47,21 +55,47 @@ enum ScriptValueType
     kScValObjectFunction,// as a pointer to object member function, gets object pointer as
                         // first parameter
     kScValCodePtr,      // as a pointer to element in byte-code array
+    kScValTypedFunction,// as a pointer to static or object function of the typed calling
+                        // convention; the number of parameters is kept in IValue
+    kScValGlobalData,   // as a pointer to plain data in script's global memory; used
+                        // instead of kScValGlobalVar for the variables of simple types
 };
 
+// Index of the object manager which is the object itself
+#define SCVAL_MGR_SELF      0xFF
+// Max number of distinct object managers referenced by values
+#define SCVAL_MAX_MANAGERS  0xFF
+
+// Runtime values are copied around a lot by the interpreter, so they are kept
+// compact: on 64-bit systems the value takes 16 bytes. Instead of the object
+// manager pointer the value stores the manager's index in the Managers table;
+// the dynamic objects that are their own managers need no table entry.
 struct RuntimeScriptValue
 {
 public:
     RuntimeScriptValue()
     {
         Type        = kScValUndefined;
-        IValue		= 0;
-        Ptr         = NULL;
-        MgrPtr      = NULL;
+        MgrIndex    = 0;
         Size        = 0;
+        IValue      = 0;
+        Ptr         = NULL;
     }
 
     ScriptValueType Type;
+    // Index of the object manager in the Managers table, or SCVAL_MGR_SELF;
+    // 0 means there's no manager.
+    // TODO: separation to Ptr and manager is only needed so far as there's
+    // a separation between Script*, Dynamic* and game entity classes.
+    // Once those classes are merged, it will no longer be needed.
+    uint8_t         MgrIndex;
+    // The "real" size of data, either one stored in I/FValue,
+    // or the one referenced by Ptr. Used for calculating stack
+    // offsets.
+    // Original AGS scripts always assumed pointer is 32-bit.
+    // Therefore for stored pointers Size is always 4 both for x32
+    // and x64 builds, so that the script is interpreted correctly.
+    uint16_t        Size;
     // The 32-bit value used for integer/float math and for storing
     // variable/element offset relative to object (and array) address
     union
@@ -77,24 +111,30 @@ public:
         RuntimeScriptValue  *RValue;// access ptr as a pointer to Runtime Value
         ScriptAPIFunction   *SPfn;  // access ptr as a pointer to Script API Static Function
         ScriptAPIObjectFunction *ObjPfn; // access ptr as a pointer to Script API Object Function
+        ScriptAPITypedFunction  *TPfn;   // access ptr as a pointer to Script API Typed Function
     };
-    // TODO: separation to Ptr and MgrPtr is only needed so far as there's
-    // a separation between Script*, Dynamic* and game entity classes.
-    // Once those classes are merged, it will no longer be needed.
-    union
+
+    // Object managers referenced by the values, indexed by MgrIndex
+    static void *Managers[SCVAL_MAX_MANAGERS];
+    // Returns the index of the manager in the table, adds the manager if it's not there yet
+    static uint8_t GetManagerIndex(void *manager);
+
+    // Static object manager
+    inline ICCStaticObject *GetStaticManager() const
     {
-        void                *MgrPtr;// generic object manager pointer
-        ICCStaticObject     *StcMgr;// static object manager
-        StaticArray         *StcArr;// static array manager
-        ICCDynamicObject    *DynMgr;// dynamic object manager
-    };
-    // The "real" size of data, either one stored in I/FValue,
-    // or the one referenced by Ptr. Used for calculating stack
-    // offsets.
-    // Original AGS scripts always assumed pointer is 32-bit.
-    // Therefore for stored pointers Size is always 4 both for x32
-    // and x64 builds, so that the script is interpreted correctly.
-    int             Size;
+        return (ICCStaticObject*)Managers[MgrIndex];
+    }
+    // Static array manager
+    inline StaticArray *GetStaticArray() const
+    {
+        return (StaticArray*)Managers[MgrIndex];
+    }
+    // Dynamic object manager; only valid while the object's address was not
+    // shifted by DirectPtr()
+    inline ICCDynamicObject *GetDynamicManager() const
+    {
+        return MgrIndex == SCVAL_MGR_SELF ? (ICCDynamicObject*)Ptr : (ICCDynamicObject*)Managers[MgrIndex];
+    }
 
     inline bool IsValid() const
     {
@@ -117,9 +157,9 @@ public:
     inline RuntimeScriptValue &Invalidate()
     {
         Type    = kScValUndefined;
-        IValue   = 0;
+        IValue  = 0;
         Ptr     = NULL;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 0;
         return *this;
     }
@@ -128,7 +168,7 @@ public:
         Type    = kScValInteger;
         IValue  = val;
         Ptr     = NULL;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 1;
         return *this;
     }
@@ -137,7 +177,7 @@ public:
         Type    = kScValInteger;
         IValue  = val;
         Ptr     = NULL;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 2;
         return *this;
     }
@@ -146,7 +186,7 @@ public:
         Type    = kScValInteger;
         IValue  = val;
         Ptr     = NULL;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -155,7 +195,7 @@ public:
         Type    = kScValFloat;
         FValue  = val;
         Ptr     = NULL;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -172,7 +212,7 @@ public:
         Type    = kScValPluginArg;
         IValue  = val;
         Ptr     = NULL;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -181,7 +221,7 @@ public:
         Type    = kScValStackPtr;
         IValue  = 0;
         RValue  = stack_entry;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -190,8 +230,8 @@ public:
         Type    = kScValData;
         IValue  = 0;
         Ptr     = data;
-        MgrPtr  = NULL;
-        Size    = size;
+        MgrIndex = 0;
+        Size    = (uint16_t)size;
         return *this;
     }
     inline RuntimeScriptValue &SetGlobalVar(RuntimeScriptValue *glvar_value)
@@ -199,7 +239,16 @@ public:
         Type    = kScValGlobalVar;
         IValue  = 0;
         RValue  = glvar_value;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
+        Size    = 4;
+        return *this;
+    }
+    inline RuntimeScriptValue &SetGlobalData(char *data)
+    {
+        Type    = kScValGlobalData;
+        IValue  = 0;
+        Ptr     = data;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -209,7 +258,7 @@ public:
         Type    = kScValStringLiteral;
         IValue  = 0;
         Ptr     = str;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -218,7 +267,7 @@ public:
         Type    = kScValStaticObject;
         IValue  = 0;
         Ptr     = (char*)object;
-        StcMgr  = manager;
+        MgrIndex = GetManagerIndex(manager);
         Size    = 4;
         return *this;
     }
@@ -227,7 +276,7 @@ public:
         Type    = kScValStaticArray;
         IValue  = 0;
         Ptr     = (char*)object;
-        StcArr  = manager;
+        MgrIndex = GetManagerIndex(manager);
         Size    = 4;
         return *this;
     }
@@ -236,7 +285,7 @@ public:
         Type    = kScValDynamicObject;
         IValue  = 0;
         Ptr     = (char*)object;
-        DynMgr  = manager;
+        MgrIndex = (manager && (void*)manager == object) ? SCVAL_MGR_SELF : GetManagerIndex(manager);
         Size    = 4;
         return *this;
     }
@@ -245,7 +294,7 @@ public:
         Type    = kScValPluginObject;
         IValue  = 0;
         Ptr     = (char*)object;
-        DynMgr  = manager;
+        MgrIndex = (manager && (void*)manager == object) ? SCVAL_MGR_SELF : GetManagerIndex(manager);
         Size    = 4;
         return *this;
     }
@@ -254,7 +303,7 @@ public:
         Type    = kScValStaticFunction;
         IValue  = 0;
         SPfn    = pfn;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -263,7 +312,7 @@ public:
         Type    = kScValPluginFunction;
         IValue  = 0;
         Ptr     = (char*)pfn;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -272,7 +321,16 @@ public:
         Type    = kScValObjectFunction;
         IValue  = 0;
         ObjPfn  = pfn;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
+        Size    = 4;
+        return *this;
+    }
+    inline RuntimeScriptValue &SetTypedFunction(ScriptAPITypedFunction *pfn, int32_t param_count)
+    {
+        Type    = kScValTypedFunction;
+        IValue  = param_count;
+        TPfn    = pfn;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
@@ -281,7 +339,7 @@ public:
         Type    = kScValCodePtr;
         IValue  = 0;
         Ptr     = ptr;
-        MgrPtr  = NULL;
+        MgrIndex = 0;
         Size    = 4;
         return *this;
     }
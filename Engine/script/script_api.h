@@ -24,12 +24,7 @@
 #include "ac/runtime_defines.h"
 #include "ac/statobj/agsstaticobject.h"
 #include "debug/out.h"
-
-struct RuntimeScriptValue;
-
-// TODO: replace void* with base object class when possible; also put array class for parameters
-typedef RuntimeScriptValue ScriptAPIFunction(const RuntimeScriptValue *params, int32_t param_count);
-typedef RuntimeScriptValue ScriptAPIObjectFunction(void *self, const RuntimeScriptValue *params, int32_t param_count);
+#include "script/runtimescriptvalue.h"
 
 // Sprintf that takes either script values or common argument list from plugin.
 // Uses EITHER sc_args/sc_argc or varg_ptr as parameter list, whichever is not
@@ -516,4 +511,155 @@ inline const char *ScriptVSprintf(char *buffer, size_t buf_length, const char *f
     RET_CLASS* ret_obj = METHOD((CLASS*)self, (P1CLASS*)params[0].Ptr); \
     return RuntimeScriptValue().SetDynamicObject(ret_obj, ret_obj)
 
+//-----------------------------------------------------------------------------
+// Typed calling convention
+//
+// Thunks generated from the signature of the engine function, registered with
+// ccAddExternalTypedFunction(name, API_TYPED_FUNC(FUNCTION)), or with
+// API_TYPED_OBJFUNC for the functions which get the object as the first
+// parameter. The interpreter calls the thunk with the arguments left as they
+// were pushed by the script: the thunk reads int, bool, float and pointer
+// values directly from them, and writes the result to the return register,
+// so neither the pointer resolution pass over the arguments nor the temporary
+// return value are needed. Supported return types are void, int, bool and float.
+
+// Value accessors for the thunks
+inline const RuntimeScriptValue &ScriptAPIParam(const RuntimeScriptValue *params, size_t index)
+{
+    return params[index];
+}
+inline int32_t ScriptAPIParamInt(const RuntimeScriptValue &value)
+{
+    return value.IValue;
+}
+inline bool ScriptAPIParamBool(const RuntimeScriptValue &value)
+{
+    return value.GetAsBool();
+}
+inline float ScriptAPIParamFloat(const RuntimeScriptValue &value)
+{
+    return value.FValue;
+}
+inline void *ScriptAPIParamPtr(const RuntimeScriptValue &value)
+{
+    return (void*)value.GetDirectPtr();
+}
+inline void ScriptAPISetVoid(RuntimeScriptValue &result)
+{
+    result.Invalidate();
+}
+inline void ScriptAPISetInt(RuntimeScriptValue &result, int32_t value)
+{
+    result.SetInt32(value);
+}
+inline void ScriptAPISetBool(RuntimeScriptValue &result, bool value)
+{
+    result.SetInt32AsBool(value);
+}
+inline void ScriptAPISetFloat(RuntimeScriptValue &result, float value)
+{
+    result.SetFloat(value);
+}
+
+template <typename T> struct ScriptAPIArg;
+template <> struct ScriptAPIArg<int>
+{
+    static int Get(const RuntimeScriptValue &value) { return ScriptAPIParamInt(value); }
+};
+template <> struct ScriptAPIArg<bool>
+{
+    static bool Get(const RuntimeScriptValue &value) { return ScriptAPIParamBool(value); }
+};
+template <> struct ScriptAPIArg<float>
+{
+    static float Get(const RuntimeScriptValue &value) { return ScriptAPIParamFloat(value); }
+};
+template <typename T> struct ScriptAPIArg<T*>
+{
+    static T *Get(const RuntimeScriptValue &value) { return (T*)ScriptAPIParamPtr(value); }
+};
+
+template <typename T> struct ScriptAPIResult;
+template <> struct ScriptAPIResult<int>
+{
+    static void Set(RuntimeScriptValue &result, int value) { ScriptAPISetInt(result, value); }
+};
+template <> struct ScriptAPIResult<bool>
+{
+    static void Set(RuntimeScriptValue &result, bool value) { ScriptAPISetBool(result, value); }
+};
+template <> struct ScriptAPIResult<float>
+{
+    static void Set(RuntimeScriptValue &result, float value) { ScriptAPISetFloat(result, value); }
+};
+
+// Compile-time sequence of parameter indexes
+template <size_t... I> struct ScriptAPIIndexes {};
+template <size_t N, size_t... I> struct ScriptAPIMakeIndexes : ScriptAPIMakeIndexes<N - 1, N - 1, I...> {};
+template <size_t... I> struct ScriptAPIMakeIndexes<0, I...> { typedef ScriptAPIIndexes<I...> Type; };
+
+template <typename R> struct ScriptAPIInvoker
+{
+    template <typename F, typename... Args>
+    static void Invoke(RuntimeScriptValue &result, F fn, Args... args) { ScriptAPIResult<R>::Set(result, fn(args...)); }
+};
+template <> struct ScriptAPIInvoker<void>
+{
+    template <typename F, typename... Args>
+    static void Invoke(RuntimeScriptValue &result, F fn, Args... args) { fn(args...); ScriptAPISetVoid(result); }
+};
+
+template <typename F, F Fn> struct ScriptAPIStaticThunk;
+template <typename R, typename... Args, R (*Fn)(Args...)>
+struct ScriptAPIStaticThunk<R (*)(Args...), Fn>
+{
+    static const int32_t ParamCount = sizeof...(Args);
+
+    static void Call(void * /*self*/, const RuntimeScriptValue *params, RuntimeScriptValue &result)
+    {
+        Call(params, result, typename ScriptAPIMakeIndexes<sizeof...(Args)>::Type());
+    }
+
+private:
+    template <size_t... I>
+    static void Call(const RuntimeScriptValue *params, RuntimeScriptValue &result, ScriptAPIIndexes<I...>)
+    {
+        (void)params; // not used by functions without parameters
+        ScriptAPIInvoker<R>::Invoke(result, Fn, ScriptAPIArg<Args>::Get(ScriptAPIParam(params, I))...);
+    }
+};
+
+template <typename F, F Fn> struct ScriptAPIObjectThunk;
+template <typename R, typename T, typename... Args, R (*Fn)(T*, Args...)>
+struct ScriptAPIObjectThunk<R (*)(T*, Args...), Fn>
+{
+    static const int32_t ParamCount = sizeof...(Args);
+
+    static void Call(void *self, const RuntimeScriptValue *params, RuntimeScriptValue &result)
+    {
+        if (!self)
+        {
+            AGS::Common::Debug::Printf(AGS::Common::kDbgMsg_Error, "ERROR: Object pointer is null in call to typed API function");
+            ScriptAPISetVoid(result);
+            return;
+        }
+        Call((T*)self, params, result, typename ScriptAPIMakeIndexes<sizeof...(Args)>::Type());
+    }
+
+private:
+    template <size_t... I>
+    static void Call(T *self, const RuntimeScriptValue *params, RuntimeScriptValue &result, ScriptAPIIndexes<I...>)
+    {
+        (void)params; // not used by functions without parameters
+        ScriptAPIInvoker<R>::Invoke(result, Fn, self, ScriptAPIArg<Args>::Get(ScriptAPIParam(params, I))...);
+    }
+};
+
+// Expand to the thunk and parameter count arguments of ccAddExternalTypedFunction
+#define API_TYPED_FUNC(FUNCTION) \
+    ScriptAPIStaticThunk<decltype(&FUNCTION), &FUNCTION>::Call, ScriptAPIStaticThunk<decltype(&FUNCTION), &FUNCTION>::ParamCount
+
+#define API_TYPED_OBJFUNC(FUNCTION) \
+    ScriptAPIObjectThunk<decltype(&FUNCTION), &FUNCTION>::Call, ScriptAPIObjectThunk<decltype(&FUNCTION), &FUNCTION>::ParamCount
+
 #endif // __AGS_EE_SCRIPT__SCRIPTAPI_H
@@ -0,0 +1,383 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string.h>
+#include <vector>
+#include "debug/out.h"
+#include "platform/base/agsplatformdriver.h"
+#include "script/cc_instance.h"
+#include "script/script_profiler.h"
+#include "script/systemimports.h"
+#include "util/file.h"
+#include "util/textstreamwriter.h"
+
+using namespace AGS::Common;
+
+namespace
+{
+
+typedef std::chrono::high_resolution_clock ProfClock;
+
+struct LineStats
+{
+    uint64_t Instructions;
+    uint64_t Time;          // in nanoseconds
+    LineStats() : Instructions(0), Time(0) {}
+};
+
+typedef std::map<int32_t, LineStats> LineStatsMap;
+
+// Script function or engine API function
+struct FunctionStats
+{
+    String   Name;          // script functions are prefixed with the section name
+    String   Section;
+    bool     IsEngineAPI;
+    uint64_t Calls;
+    uint64_t Instructions;
+    uint64_t Time;          // self time, in nanoseconds
+    LineStatsMap Lines;
+
+    FunctionStats() : IsEngineAPI(false), Calls(0), Instructions(0), Time(0) {}
+};
+
+// Node of the call tree, one for each unique call stack
+struct CallNode
+{
+    FunctionStats *Func;
+    CallNode      *Parent;
+    std::map<FunctionStats*, CallNode*> Children;
+    uint64_t       Time;    // self time, in nanoseconds
+
+    CallNode(FunctionStats *func, CallNode *parent) : Func(func), Parent(parent), Time(0) {}
+    ~CallNode()
+    {
+        for (std::map<FunctionStats*, CallNode*>::iterator it = Children.begin(); it != Children.end(); ++it)
+            delete it->second;
+    }
+};
+
+struct Frame
+{
+    CallNode  *Node;
+    LineStats *Line;        // engine API frames keep the caller's line
+};
+
+// Script functions are kept by their names, so that a script which is loaded
+// again, such as the script of a room entered anew, adds to the same entries
+typedef std::map<String, FunctionStats*> ScriptFuncMap;
+typedef std::map<const void*, FunctionStats*> APIFuncMap;
+
+// Quick lookup of the script functions by code position; the weak reference
+// tells if the script at that address is still the one the entry was made for
+struct ScriptFuncRef
+{
+    stdtr1compat::weak_ptr<ccScript> Script;
+    FunctionStats                   *Func;
+    ScriptFuncRef() : Func(NULL) {}
+};
+typedef std::map<std::pair<const ccScript*, int32_t>, ScriptFuncRef> ScriptFuncCache;
+
+bool                  ProfilerActive = false;
+ScriptFuncMap         ScriptFuncs;
+ScriptFuncCache       ScriptFuncLookup;
+APIFuncMap            APIFuncs;
+CallNode             *CallRoot = NULL;
+std::vector<Frame>    Stack;
+ProfClock::time_point LastTick;
+
+
+// Attributes the time passed since the last call to the current frame
+void account_time()
+{
+    ProfClock::time_point now = ProfClock::now();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - LastTick).count();
+    LastTick = now;
+    if (Stack.empty())
+        return;
+    Frame &frame = Stack.back();
+    frame.Node->Time += ns;
+    frame.Node->Func->Time += ns;
+    if (frame.Line)
+        frame.Line->Time += ns;
+}
+
+void push_frame(FunctionStats *func, LineStats *line)
+{
+    account_time();
+    CallNode *parent = Stack.empty() ? CallRoot : Stack.back().Node;
+    CallNode *&node = parent->Children[func];
+    if (!node)
+        node = new CallNode(func, parent);
+    func->Calls++;
+    Frame frame = { node, line };
+    Stack.push_back(frame);
+}
+
+String make_script_function_name(const ccScript *script, int32_t pc)
+{
+    String section = const_cast<ccScript*>(script)->GetSectionName(pc);
+    for (int i = 0; i < script->numexports; ++i)
+    {
+        if (((script->export_addr[i] >> 24L) & 0x000ff) != EXPORT_FUNCTION ||
+            (script->export_addr[i] & 0x00ffffff) != pc)
+            continue;
+        const char *name = script->exports[i];
+        const char *name_end = strchr(name, '$');
+        return String::FromFormat("%s:%s", section.GetCStr(),
+            (name_end ? String(name, name_end - name) : String(name)).GetCStr());
+    }
+    return String::FromFormat("%s:func@%d", section.GetCStr(), pc);
+}
+
+String make_api_function_name(const RuntimeScriptValue &fn)
+{
+    for (int i = 0;; ++i)
+    {
+        const ScriptImport *import = simp.getByIndex(i);
+        if (!import)
+            break;
+        if (import->Value.Ptr == fn.Ptr && !import->Name.IsEmpty())
+            return import->Name;
+    }
+    return String::FromFormat("api@%p", fn.Ptr);
+}
+
+void reset_counters(CallNode *node)
+{
+    node->Time = 0;
+    for (std::map<FunctionStats*, CallNode*>::iterator it = node->Children.begin(); it != node->Children.end(); ++it)
+        reset_counters(it->second);
+}
+
+void free_stats()
+{
+    Stack.clear();
+    delete CallRoot;
+    CallRoot = NULL;
+    for (ScriptFuncMap::iterator it = ScriptFuncs.begin(); it != ScriptFuncs.end(); ++it)
+        delete it->second;
+    ScriptFuncs.clear();
+    ScriptFuncLookup.clear();
+    for (APIFuncMap::iterator it = APIFuncs.begin(); it != APIFuncs.end(); ++it)
+        delete it->second;
+    APIFuncs.clear();
+}
+
+void write_folded_stacks(TextStreamWriter &out, CallNode *node, const String &stack)
+{
+    for (std::map<FunctionStats*, CallNode*>::iterator it = node->Children.begin(); it != node->Children.end(); ++it)
+    {
+        CallNode *child = it->second;
+        String child_stack = stack.IsEmpty() ? child->Func->Name : String::FromFormat("%s;%s", stack.GetCStr(), child->Func->Name.GetCStr());
+        uint64_t usec = child->Time / 1000;
+        if (usec > 0)
+            out.WriteFormat("%s %llu\n", child_stack.GetCStr(), (unsigned long long)usec);
+        write_folded_stacks(out, child, child_stack);
+    }
+}
+
+bool compare_func_time(const FunctionStats *a, const FunctionStats *b)
+{
+    return a->Time > b->Time;
+}
+
+struct LineEntry
+{
+    const FunctionStats *Func;
+    int32_t              Line;
+    const LineStats     *Stats;
+};
+
+bool compare_line_time(const LineEntry &a, const LineEntry &b)
+{
+    return a.Stats->Time > b.Stats->Time;
+}
+
+void write_report()
+{
+    account_time();
+    const String out_dir = platform->GetAppOutputDirectory();
+
+    std::vector<FunctionStats*> funcs;
+    std::vector<LineEntry> lines;
+    for (ScriptFuncMap::const_iterator it = ScriptFuncs.begin(); it != ScriptFuncs.end(); ++it)
+    {
+        funcs.push_back(it->second);
+        for (LineStatsMap::const_iterator lit = it->second->Lines.begin(); lit != it->second->Lines.end(); ++lit)
+        {
+            LineEntry entry = { it->second, lit->first, &lit->second };
+            lines.push_back(entry);
+        }
+    }
+    for (APIFuncMap::const_iterator it = APIFuncs.begin(); it != APIFuncs.end(); ++it)
+        funcs.push_back(it->second);
+    std::sort(funcs.begin(), funcs.end(), compare_func_time);
+    std::sort(lines.begin(), lines.end(), compare_line_time);
+
+    String filename = String::FromFormat("%s/script_profile.txt", out_dir.GetCStr());
+    Stream *report_s = File::CreateFile(filename);
+    if (report_s)
+    {
+        TextStreamWriter out(report_s);
+        out.WriteLine("Functions, by self time");
+        out.WriteFormat("%12s %14s %12s  %s\n", "time (us)", "instructions", "calls", "function");
+        for (size_t i = 0; i < funcs.size(); ++i)
+        {
+            const FunctionStats *f = funcs[i];
+            out.WriteFormat("%12llu %14llu %12llu  %s%s\n", (unsigned long long)(f->Time / 1000),
+                (unsigned long long)f->Instructions, (unsigned long long)f->Calls,
+                f->IsEngineAPI ? "[engine] " : "", f->Name.GetCStr());
+        }
+        out.WriteLineBreak();
+        out.WriteLine("Lines, by time (including engine API calls made on the line)");
+        out.WriteFormat("%12s %14s  %s\n", "time (us)", "instructions", "line");
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            const LineEntry &l = lines[i];
+            out.WriteFormat("%12llu %14llu  %s:%d (%s)\n", (unsigned long long)(l.Stats->Time / 1000),
+                (unsigned long long)l.Stats->Instructions, l.Func->Section.GetCStr(), l.Line, l.Func->Name.GetCStr());
+        }
+    }
+
+    String folded_filename = String::FromFormat("%s/script_profile.folded", out_dir.GetCStr());
+    Stream *folded_s = File::CreateFile(folded_filename);
+    if (folded_s)
+    {
+        TextStreamWriter out(folded_s);
+        write_folded_stacks(out, CallRoot, "");
+    }
+    Debug::Printf(kDbgMsg_Init, "Script profile written to %s", filename.GetCStr());
+}
+
+} // namespace
+
+
+void script_profiler_start()
+{
+    if (ProfilerActive)
+        return;
+    CallRoot = new CallNode(NULL, NULL);
+    LastTick = ProfClock::now();
+    ProfilerActive = true;
+    Debug::Printf(kDbgMsg_Init, "Script profiler started");
+}
+
+void script_profiler_stop()
+{
+    if (!ProfilerActive)
+        return;
+    write_report();
+    free_stats();
+    ProfilerActive = false;
+}
+
+bool script_profiler_is_active()
+{
+    return ProfilerActive;
+}
+
+void script_profiler_write_report()
+{
+    if (!ProfilerActive)
+        return;
+    write_report();
+    // Functions currently on the stack are kept, only the counters are reset
+    reset_counters(CallRoot);
+    for (ScriptFuncMap::iterator it = ScriptFuncs.begin(); it != ScriptFuncs.end(); ++it)
+    {
+        FunctionStats *f = it->second;
+        f->Calls = f->Instructions = f->Time = 0;
+        for (LineStatsMap::iterator lit = f->Lines.begin(); lit != f->Lines.end(); ++lit)
+            lit->second = LineStats();
+    }
+    for (APIFuncMap::iterator it = APIFuncs.begin(); it != APIFuncs.end(); ++it)
+        it->second->Calls = it->second->Instructions = it->second->Time = 0;
+}
+
+size_t script_profiler_enter_function(ccInstance *inst, int32_t pc)
+{
+    const size_t depth = Stack.size();
+    if (!ProfilerActive)
+        return depth;
+    const ccScript *script = inst->instanceof.get();
+    ScriptFuncRef &ref = ScriptFuncLookup[std::make_pair(script, pc)];
+    if (!ref.Func || ref.Script.expired())
+    {
+        const String name = make_script_function_name(script, pc);
+        FunctionStats *&func = ScriptFuncs[name];
+        if (!func)
+        {
+            func = new FunctionStats();
+            func->Name = name;
+            func->Section = const_cast<ccScript*>(script)->GetSectionName(pc);
+        }
+        ref.Script = inst->instanceof;
+        ref.Func = func;
+    }
+    push_frame(ref.Func, NULL);
+    return depth;
+}
+
+void script_profiler_enter_api(const RuntimeScriptValue &fn)
+{
+    if (!ProfilerActive)
+        return;
+    FunctionStats *&func = APIFuncs[fn.Ptr];
+    if (!func)
+    {
+        func = new FunctionStats();
+        func->Name = make_api_function_name(fn);
+        func->IsEngineAPI = true;
+    }
+    push_frame(func, Stack.empty() ? NULL : Stack.back().Line);
+}
+
+void script_profiler_leave()
+{
+    if (!ProfilerActive || Stack.empty())
+        return;
+    account_time();
+    Stack.pop_back();
+}
+
+void script_profiler_unwind(size_t depth)
+{
+    if (!ProfilerActive || Stack.size() <= depth)
+        return;
+    account_time();
+    Stack.resize(depth);
+}
+
+void script_profiler_line(int32_t line)
+{
+    if (!ProfilerActive || Stack.empty())
+        return;
+    account_time();
+    Frame &frame = Stack.back();
+    frame.Line = &frame.Node->Func->Lines[line];
+}
+
+void script_profiler_instruction()
+{
+    if (Stack.empty())
+        return;
+    Frame &frame = Stack.back();
+    frame.Node->Func->Instructions++;
+    if (frame.Line)
+        frame.Line->Instructions++;
+}
@@ -0,0 +1,58 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Script profiler.
+//
+// While active, counts the instructions executed and measures the wall time
+// spent in every script function and on every script line. Time spent inside
+// the engine API functions called by scripts is attributed to the API names.
+// The report is written to the output directory as two files:
+// script_profile.txt lists the costs per function and per line, and
+// script_profile.folded has the call stacks in the "folded" format read by
+// the flame graph tools, weighted by the wall time in microseconds.
+//
+//=============================================================================
+#ifndef __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+#define __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+
+#include <stddef.h>
+#include "core/types.h"
+
+struct ccInstance;
+struct RuntimeScriptValue;
+
+// Starts collecting the statistics
+void script_profiler_start();
+// Writes the report and stops collecting
+void script_profiler_stop();
+bool script_profiler_is_active();
+// Writes the report of what was collected so far and starts counting anew
+void script_profiler_write_report();
+
+// Notifications from the script interpreter; only called when profiling.
+// Script function starting at the given code position is called;
+// returns the call depth prior to the call.
+size_t script_profiler_enter_function(ccInstance *inst, int32_t pc);
+// Engine API function is called by the script
+void   script_profiler_enter_api(const RuntimeScriptValue &fn);
+// Last entered script or API function returns
+void   script_profiler_leave();
+// Leaves all the functions entered after the call depth was at given value
+void   script_profiler_unwind(size_t depth);
+// Script reached the new line
+void   script_profiler_line(int32_t line);
+// Script instruction is about to be executed
+void   script_profiler_instruction();
+
+#endif // __AGS_EE_SCRIPT__SCRIPTPROFILER_H
@@ -68,6 +68,11 @@ bool ccAddExternalObjectFunction(const String &name, ScriptAPIObjectFunction *pf
     return simp.add(name, RuntimeScriptValue().SetObjectFunction(pfn), NULL) == 0;
 }
 
+bool ccAddExternalTypedFunction(const String &name, ScriptAPITypedFunction *pfn, int32_t param_count)
+{
+    return simp.add(name, RuntimeScriptValue().SetTypedFunction(pfn, param_count), NULL) == 0;
+}
+
 bool ccAddExternalScriptSymbol(const String &name, const RuntimeScriptValue &prval, ccInstance *inst)
 {
     return simp.add(name, prval, inst) == 0;
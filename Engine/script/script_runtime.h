@@ -47,6 +47,8 @@ extern bool ccAddExternalStaticObject(const String &name, void *ptr, ICCStaticOb
 extern bool ccAddExternalStaticArray(const String &name, void *ptr, StaticArray *array_mgr);
 extern bool ccAddExternalDynamicObject(const String &name, void *ptr, ICCDynamicObject *manager);
 extern bool ccAddExternalObjectFunction(const String &name, ScriptAPIObjectFunction *pfn);
+// function of the typed calling convention, see API_TYPED_FUNC and API_TYPED_OBJFUNC
+extern bool ccAddExternalTypedFunction(const String &name, ScriptAPITypedFunction *pfn, int32_t param_count);
 extern bool ccAddExternalScriptSymbol(const String &name, const RuntimeScriptValue &prval, ccInstance *inst);
 // remove the script access to a variable or function in your program
 extern void ccRemoveExternalSymbol(const String &name);
@@ -20,6 +20,7 @@ void Test_DoAllTests()
 {
     Test_Math();
     Test_Memory();
+    Test_RuntimeScriptValue();
     Test_Path();
     Test_ScriptSprintf();
     Test_String();
@@ -28,6 +29,12 @@ void Test_DoAllTests()
     Test_IniFile();
 
     Test_Gfx();
+    Test_Video();
+}
+
+void Test_DoAllBenchmarks()
+{
+    Test_FlcConvertSpeed();
 }
 
 #endif // _DEBUG
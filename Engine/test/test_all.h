@@ -15,6 +15,8 @@
 #ifdef _DEBUG
 
 void Test_DoAllTests();
+// Runs the speed tests, which are too slow to do on every start
+void Test_DoAllBenchmarks();
 // Math tests
 void Test_Math();
 // File tests
@@ -24,10 +26,15 @@ void Test_IniFile();
 void Test_Gfx();
 // Memory / bit-byte operations
 void Test_Memory();
+// Script runtime tests
+void Test_RuntimeScriptValue();
 // String tests
 void Test_ScriptSprintf();
 void Test_String();
 void Test_Path();
 void Test_Version();
+// Video tests
+void Test_Video();
+void Test_FlcConvertSpeed();
 
 #endif // _DEBUG
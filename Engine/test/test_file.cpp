@@ -17,7 +17,10 @@
 #include <string.h>
 #include "debug/assert.h"
 #include "util/alignedstream.h"
+#include "util/binaryreader.h"
 #include "util/file.h"
+#include "util/memorystream.h"
+#include "util/mmapstream.h"
 
 using namespace AGS::Common;
 
@@ -48,6 +51,76 @@ struct TTrickyAlignedData
     char    final;
 };
 
+// Hides that the stream can seek, which makes BinaryReader read through
+// the stream's own methods
+class UnseekableStream : public ProxyStream
+{
+public:
+    UnseekableStream(Stream *stream) : ProxyStream(stream, kDisposeAfterUse) {}
+    virtual bool CanSeek() const { return false; }
+};
+
+static void read_tricky_data(LEBinaryReader &rd, TTrickyAlignedData &data)
+{
+    data.a = rd.ReadInt8();
+    data.b = rd.ReadInt32();
+    data.c = rd.ReadInt32();
+    rd.ReadArrayOfInt16(data.d, 3);
+    data.e = rd.ReadInt32();
+    rd.Read(data.f, 17);
+    rd.ReadArrayOfInt32(data.g, 4);
+    rd.ReadArrayOfInt16(data.h, 13);
+    rd.Read(data.i, 3);
+    data.j = rd.ReadInt16();
+    data.k = rd.ReadInt32();
+    data.l = rd.ReadInt16();
+    data.m = rd.ReadInt16();
+    data.n = rd.ReadInt32();
+    data.i64a = rd.ReadInt64();
+    data.o = rd.ReadInt8();
+    data.i64b = rd.ReadInt64();
+    data.p = rd.ReadInt16();
+    data.i64c = rd.ReadInt64();
+    data.q = rd.ReadInt16();
+    data.r = rd.ReadInt16();
+    data.i64d = rd.ReadInt64();
+    data.final = rd.ReadInt8();
+}
+
+// Reads the data written in Test_File with BinaryReader, in the plain and
+// aligned modes, giving the stream back to its owner in between
+static void test_binary_reader(Stream *in, size_t buffer_size, const std::vector<uint8_t> &block,
+    soff_t tricky_data_at, const TTrickyAlignedData &tricky_data_out)
+{
+    {
+        LEBinaryReader rd(in, false, buffer_size);
+        assert(rd.ReadInt16() == 10);
+        assert(rd.ReadInt64() == -20202);
+        assert(strcmp(String::FromStream(rd.GetStream()), "test.tmp") == 0);
+        assert(rd.ReadInt32() == 20);
+        int32_t arr_in[3];
+        assert(rd.ReadArrayOfInt32(arr_in, 3) == 3);
+        assert(arr_in[0] == 3 && arr_in[1] == -4 && arr_in[2] == 5);
+        rd.Skip(5);
+        assert(rd.ReadBool());
+        std::vector<uint8_t> block_in(block.size());
+        assert(rd.Read(&block_in.front(), block_in.size()) == block.size());
+        assert(block_in == block);
+    }
+    // the reader has given the unread data back
+    assert(in->GetPosition() == tricky_data_at);
+
+    TTrickyAlignedData tricky_data_in;
+    memset(&tricky_data_in, 0xAA, sizeof(tricky_data_in));
+    {
+        LEBinaryReader rd(in, true, buffer_size);
+        read_tricky_data(rd, tricky_data_in);
+    }
+    assert(memcmp(&tricky_data_in, &tricky_data_out, sizeof(TTrickyAlignedData)) == 0);
+    assert(in->ReadInt32() == 0x7FEEDBEE);
+    assert(in->ReadByte() == -1);
+}
+
 void Test_File()
 {
     //-----------------------------------------------------
@@ -202,6 +275,100 @@ void Test_File()
     assert(ptr32_array_in[3] == 0xBEEFFEED);
 
     assert(!File::TestReadFile("test.tmp"));
+
+    //-----------------------------------------------------
+    // Memory streams
+    std::vector<uint8_t> membuf;
+    {
+        MemoryStream mem_out(membuf, AGS::Common::kFile_Write);
+        mem_out.WriteInt8(1);
+        mem_out.WriteInt16(-2);
+        mem_out.WriteInt32(0x12345678);
+        const int32_t arr_out[3] = { 3, -4, 5 };
+        mem_out.WriteArrayOfInt32(arr_out, 3);
+        mem_out.WriteInt64(-20202);
+        assert(mem_out.GetPosition() == 27);
+    }
+    assert(membuf.size() == 27);
+
+    MemoryStream mem_in(&membuf.front(), membuf.size());
+    assert(mem_in.GetDataView() == &membuf.front());
+    assert(mem_in.ReadInt8() == 1);
+    assert(mem_in.ReadInt16() == -2);
+    assert(mem_in.ReadInt32() == 0x12345678);
+    int32_t arr_in[3];
+    assert(mem_in.ReadArrayOfInt32(arr_in, 3) == 3);
+    assert(arr_in[0] == 3 && arr_in[1] == -4 && arr_in[2] == 5);
+    assert(mem_in.ReadInt64() == -20202);
+    assert(mem_in.EOS());
+    assert(mem_in.ReadByte() == -1);
+    assert(mem_in.Seek(-8, AGS::Common::kSeekEnd) == 19);
+    assert(mem_in.ReadInt64() == -20202);
+    assert(mem_in.Seek(100, AGS::Common::kSeekBegin) == 27);
+
+    // Mapped file region
+    out = File::CreateFile("test.tmp");
+    out->Write(&membuf.front(), membuf.size());
+    delete out;
+    {
+        MMapStream map_in("test.tmp", 3, 16);
+        if (map_in.IsValid())
+        {
+            assert(map_in.GetLength() == 16);
+            assert(map_in.ReadInt32() == 0x12345678);
+            assert(map_in.ReadInt32() == 3);
+            assert(map_in.Seek(0, AGS::Common::kSeekEnd) == 16);
+        }
+    }
+    File::DeleteFile("test.tmp");
+
+    //-----------------------------------------------------
+    // Binary reader
+    std::vector<uint8_t> block(3000);
+    for (size_t i = 0; i < block.size(); ++i)
+        block[i] = (uint8_t)(i * 7);
+    membuf.clear();
+    soff_t tricky_data_at;
+    {
+        MemoryStream mem_out(membuf, AGS::Common::kFile_Write);
+        mem_out.WriteInt16(10);
+        mem_out.WriteInt64(-20202);
+        String::WriteString("test.tmp", &mem_out);
+        mem_out.WriteInt32(20);
+        const int32_t arr_out[3] = { 3, -4, 5 };
+        mem_out.WriteArrayOfInt32(arr_out, 3);
+        for (int i = 0; i < 5; ++i)
+            mem_out.WriteInt8(0);
+        mem_out.WriteInt8(1);
+        mem_out.Write(&block.front(), block.size());
+        tricky_data_at = mem_out.GetPosition();
+        mem_out.Write(&tricky_data_out, sizeof(TTrickyAlignedData));
+        mem_out.WriteInt32(0x7FEEDBEE);
+    }
+    out = File::CreateFile("test.tmp");
+    out->Write(&membuf.front(), membuf.size());
+    delete out;
+
+    // straight from the stream's memory
+    {
+        MemoryStream view_in(&membuf.front(), membuf.size());
+        test_binary_reader(&view_in, LEBinaryReader::DefaultBufferSize, block, tricky_data_at, tricky_data_out);
+    }
+    // through the buffer, including refills in the middle of the values,
+    // and the reads larger than the buffer
+    const size_t buffer_sizes[] = { LEBinaryReader::DefaultBufferSize, 16, 5 };
+    for (size_t i = 0; i < sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i)
+    {
+        in = File::OpenFileRead("test.tmp");
+        assert(in->GetDataView() == NULL);
+        test_binary_reader(in, buffer_sizes[i], block, tricky_data_at, tricky_data_out);
+        delete in;
+    }
+    // without buffering, when the stream cannot seek
+    in = new UnseekableStream(File::OpenFileRead("test.tmp"));
+    test_binary_reader(in, LEBinaryReader::DefaultBufferSize, block, tricky_data_at, tricky_data_out);
+    delete in;
+    File::DeleteFile("test.tmp");
 }
 
 #endif // _DEBUG
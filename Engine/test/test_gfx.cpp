@@ -14,10 +14,179 @@
 
 #ifdef _DEBUG
 
+#include <allegro.h>
+#include "gfx/aastretch.h"
 #include "gfx/gfx_def.h"
 #include "debug/assert.h"
+#include "gfx/blender.h"
+#include "gfx/tint.h"
+#include "media/video/yuvconvert.h"
 
+extern "C" unsigned long _blender_trans16(unsigned long x, unsigned long y, unsigned long n);
+
+namespace AAStretch = AGS::Common::AAStretch;
 namespace GfxDef = AGS::Common::GfxDef;
+namespace Tint = AGS::Engine::Tint;
+namespace YUVConvert = AGS::Engine::YUVConvert;
+
+// Shrinks a 4x2 32-bit image to 2x1 and returns the pixels
+static void stretch_4x2(const uint32_t src[2][4], uint32_t dst[2], AAStretch::StretchMode mode)
+{
+    unsigned char *src_lines[2] = { (unsigned char*)src[0], (unsigned char*)src[1] };
+    unsigned char *dst_lines[1] = { (unsigned char*)dst };
+    AAStretch::Surface src_surf = { src_lines, 4, 2, 32, Rect(0, 0, 3, 1) };
+    AAStretch::Surface dst_surf = { dst_lines, 2, 1, 32, Rect(0, 0, 1, 0) };
+    AAStretch::Blit(src_surf, Rect(0, 0, 3, 1), dst_surf, Rect(0, 0, 1, 0), mode);
+}
+
+void Test_AAStretch()
+{
+    // Each destination pixel is the average of a 2x2 box
+    const uint32_t opaque[2][4] = {
+        { 0x000000, 0x101010, 0xFF0000, 0xFF0000 },
+        { 0x202020, 0x303030, 0x00FF00, 0x00FF00 } };
+    uint32_t dst[2] = { 0, 0 };
+    stretch_4x2(opaque, dst, AAStretch::kStretch_Opaque);
+    assert(dst[0] == 0x181818);
+    assert(dst[1] == 0x808000);
+
+    // The mask color is skipped; the pixel with more than a half of mask
+    // is left untouched, and the other one does not get darker
+    const uint32_t masked[2][4] = {
+        { MASK_COLOR_32, 0x404040, MASK_COLOR_32, 0x123456 },
+        { 0x404040,      0x404040, MASK_COLOR_32, MASK_COLOR_32 } };
+    dst[0] = dst[1] = 0xABCDEF;
+    stretch_4x2(masked, dst, AAStretch::kStretch_Masked);
+    assert(dst[0] == 0x404040);
+    assert(dst[1] == 0xABCDEF);
+
+    // The transparent pixels do not bleed into the colors
+    const uint32_t alpha[2][4] = {
+        { 0xFF204080, 0x00FFFFFF, 0x80FF0000, 0x80FF0000 },
+        { 0xFF204080, 0x00FFFFFF, 0x80FF0000, 0x80FF0000 } };
+    stretch_4x2(alpha, dst, AAStretch::kStretch_Alpha);
+    assert(dst[0] == 0x80204080);
+    assert(dst[1] == 0x80FF0000);
+}
+
+void Test_YUVConvert()
+{
+    const YUVConvert::PixelFormat fmt32 = { 32, 16, 8, 0, 24 };
+    const YUVConvert::PixelFormat fmt16 = { 16, 11, 5, 0, 0 };
+    uint8_t y[24], u[12], v[12];
+    for (int i = 0; i < 24; ++i)
+        y[i] = (uint8_t)(i * 11);
+    for (int i = 0; i < 12; ++i)
+    {
+        u[i] = (uint8_t)(i * 23);
+        v[i] = (uint8_t)(255 - i * 19);
+    }
+
+    // Every pixel is within 1 of the exact formula, and opaque
+    uint32_t dst32[24];
+    YUVConvert::ConvertLine420(y, u, v, (uint8_t*)dst32, 24, fmt32);
+    for (int i = 0; i < 24; ++i)
+    {
+        const double luma = (y[i] - 16) * 1.164;
+        const double exact[3] = {
+            luma + 1.596 * (v[i / 2] - 128),
+            luma - 0.391 * (u[i / 2] - 128) - 0.813 * (v[i / 2] - 128),
+            luma + 2.018 * (u[i / 2] - 128) };
+        for (int c = 0; c < 3; ++c)
+        {
+            const int expect = exact[c] < 0.0 ? 0 : (exact[c] > 255.0 ? 255 : (int)(exact[c] + 0.5));
+            const int got = (dst32[i] >> (16 - c * 8)) & 0xFF;
+            assert(got >= expect - 1 && got <= expect + 1);
+        }
+        assert((dst32[i] >> 24) == 0xFF);
+    }
+
+    // Black and white are exact
+    const uint8_t black_white_y[2] = { 16, 235 };
+    const uint8_t grey_uv[1] = { 128 };
+    uint32_t bw[2];
+    YUVConvert::ConvertLine420(black_white_y, grey_uv, grey_uv, (uint8_t*)bw, 2, fmt32);
+    assert(bw[0] == 0xFF000000);
+    assert(bw[1] == 0xFFFFFFFF);
+
+    // A line too short for the vector code gives the same pixels
+    uint32_t short32[7];
+    YUVConvert::ConvertLine420(y, u, v, (uint8_t*)short32, 7, fmt32);
+    uint16_t dst16[24], short16[7];
+    YUVConvert::ConvertLine420(y, u, v, (uint8_t*)dst16, 24, fmt16);
+    YUVConvert::ConvertLine420(y, u, v, (uint8_t*)short16, 7, fmt16);
+    for (int i = 0; i < 7; ++i)
+    {
+        assert(short32[i] == dst32[i]);
+        assert(short16[i] == dst16[i]);
+    }
+}
+
+void Test_Tint()
+{
+    // 32-bit: tinted pixels are the same as the HSV blenders give
+    const Tint::PixelFormat fmt32 = Tint::GetPixelFormat(32);
+    uint32_t src32[24], dst32[24], short32[3];
+    for (int i = 0; i < 24; ++i)
+        src32[i] = makeacol32((i * 37) & 0xFF, (i * 91) & 0xFF, (255 - i * 11) & 0xFF, i * 10);
+    src32[5] = MASK_COLOR_32;
+    const uint32_t tint32 = makecol32(200, 100, 50);
+    Tint::Table table;
+    Tint::MakeTable(table, fmt32, 200, 100, 50, 250);
+    Tint::TintLine((uint8_t*)src32, (uint8_t*)dst32, 24, table, Tint::FullAmount);
+    for (int i = 0; i < 24; ++i)
+        assert(dst32[i] == (i == 5 ? MASK_COLOR_32 : _myblender_color32(tint32, src32[i], 0)));
+    Tint::MakeTable(table, fmt32, 200, 100, 50, 150);
+    Tint::TintLine((uint8_t*)src32, (uint8_t*)dst32, 24, table, Tint::FullAmount);
+    for (int i = 0; i < 24; ++i)
+        assert(dst32[i] == (i == 5 ? MASK_COLOR_32 : _myblender_color32_light(tint32, src32[i], 150)));
+
+    // 32-bit partial tint and light are the same as the translucency blender
+    const int amounts[] = { 1, 60, 127, 200, 254, 255 };
+    for (size_t a = 0; a < sizeof(amounts) / sizeof(amounts[0]); ++a)
+    {
+        const int amount = amounts[a];
+        Tint::TintLine((uint8_t*)src32, (uint8_t*)dst32, 24, table, amount);
+        Tint::TintLine((uint8_t*)src32, (uint8_t*)short32, 3, table, amount);
+        for (int i = 0; i < 24; ++i)
+        {
+            const uint32_t tinted = _myblender_color32_light(tint32, src32[i], 150);
+            assert(dst32[i] == (i == 5 ? MASK_COLOR_32 : _myblender_alpha_trans24(tinted, src32[i], amount)));
+        }
+        for (int i = 0; i < 3; ++i)
+            assert(short32[i] == dst32[i]);
+        const uint32_t dark = makecol32(8, 8, 8), light = makecol32(248, 248, 248);
+        Tint::LightLine((uint8_t*)src32, (uint8_t*)dst32, 23, fmt32, dark, amount);
+        for (int i = 0; i < 23; ++i)
+            assert(dst32[i] == (i == 5 ? MASK_COLOR_32 : _myblender_alpha_trans24(dark, src32[i], amount)));
+        Tint::LightLine((uint8_t*)src32, (uint8_t*)dst32, 23, fmt32, light, amount);
+        for (int i = 0; i < 23; ++i)
+            assert(dst32[i] == (i == 5 ? MASK_COLOR_32 : _myblender_alpha_trans24(light, src32[i], amount)));
+    }
+
+    // 16-bit: same as the HSV and translucency blenders
+    const Tint::PixelFormat fmt16 = Tint::GetPixelFormat(16);
+    uint16_t src16[24], dst16[24];
+    for (int i = 0; i < 24; ++i)
+        src16[i] = (uint16_t)makecol16((i * 37) & 0xFF, (i * 91) & 0xFF, (255 - i * 11) & 0xFF);
+    src16[7] = MASK_COLOR_16;
+    const uint32_t tint16 = makecol16(200, 100, 50);
+    Tint::MakeTable(table, fmt16, 200, 100, 50, 250);
+    Tint::TintLine((uint8_t*)src16, (uint8_t*)dst16, 24, table, Tint::FullAmount);
+    for (int i = 0; i < 24; ++i)
+        assert(dst16[i] == (i == 7 ? MASK_COLOR_16 : _myblender_color16(tint16, src16[i], 0)));
+    Tint::TintLine((uint8_t*)src16, (uint8_t*)dst16, 24, table, 100);
+    for (int i = 0; i < 24; ++i)
+        assert(dst16[i] == (i == 7 ? MASK_COLOR_16 : _blender_trans16(_myblender_color16(tint16, src16[i], 0), src16[i], 100)));
+    Tint::LightLine((uint8_t*)src16, (uint8_t*)dst16, 24, fmt16, makecol16(8, 8, 8), 60);
+    for (int i = 0; i < 24; ++i)
+        assert(dst16[i] == (i == 7 ? MASK_COLOR_16 : _blender_trans16(makecol16(8, 8, 8), src16[i], 60)));
+
+    // Tables are shared between the same tints
+    const Tint::Table &shared = Tint::GetTable(32, 10, 20, 30, 255);
+    assert(&Tint::GetTable(32, 10, 20, 30, 250) == &shared);
+    assert(&Tint::GetTable(32, 10, 20, 31, 250) != &shared);
+}
 
 void Test_Gfx()
 {
@@ -34,6 +203,10 @@ void Test_Gfx()
         trans100_back[i] = GfxDef::LegacyTrans255ToTrans100(trans255[i]);
         assert(trans100[i] == trans100_back[i]);
     }
+
+    Test_AAStretch();
+    Test_YUVConvert();
+    Test_Tint();
 }
 
 #endif // _DEBUG
@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include "ac/dynobj/cc_dynamicobject.h"
+#include "ac/dynobj/scriptdatetime.h"
+#include "ac/dynobj/scriptuserobject.h"
+#include "ac/statobj/agsstaticobject.h"
+#include "ac/statobj/staticarray.h"
+#include "debug/assert.h"
+#include "script/runtimescriptvalue.h"
+
+void Test_RuntimeScriptValue()
+{
+    RuntimeScriptValue rval;
+    assert(sizeof(rval) <= 16);
+
+    rval.SetInt16(-5);
+    assert(rval.Type == kScValInteger && rval.IValue == -5 && rval.Size == 2 && rval.MgrIndex == 0);
+    char data[3000];
+    rval.SetData(data, sizeof(data));
+    assert(rval.Size == sizeof(data));
+
+    // Plain global data is little-endian
+    char gldata[8] = { 0 };
+    rval.SetGlobalData(gldata);
+    rval.IValue = 4;
+    rval.WriteInt32(0x01020304);
+    assert(gldata[4] == 0x04 && gldata[7] == 0x01 && rval.ReadInt32() == 0x01020304);
+    rval.IValue = 2;
+    rval.WriteInt16(-2);
+    assert(rval.ReadInt16() == -2 && rval.ReadValue().IValue == 0x0304FFFE);
+
+    // Managers are found again by their index
+    int32_t obj[4] = { 1, 2, 3, 4 };
+    rval.SetStaticObject(obj, &GlobalStaticManager);
+    assert(rval.MgrIndex != 0 && rval.GetStaticManager() == &GlobalStaticManager);
+    RuntimeScriptValue rval2;
+    rval2.SetStaticObject(obj + 1, &GlobalStaticManager);
+    assert(rval2.MgrIndex == rval.MgrIndex);
+    rval.IValue = 8;
+    assert(rval.ReadInt32() == 3);
+
+    // Managers stay registered for the rest of the program, must not go out of scope
+    static StaticArray arr;
+    arr.Create(&GlobalStaticManager, sizeof(int32_t), sizeof(int32_t));
+    rval.SetStaticArray(obj, &arr);
+    assert(rval.MgrIndex != rval2.MgrIndex && rval.GetStaticArray() == &arr);
+
+    // Object which is its own manager
+    ScriptDateTime *dt = new ScriptDateTime();
+    rval.SetDynamicObject(dt, dt);
+    assert(rval.MgrIndex == SCVAL_MGR_SELF && rval.GetDynamicManager() == dt);
+    delete dt;
+
+    // User objects all share one manager, no matter how many were created
+    const int32_t user_obj_size = 12;
+    int user_obj_handles[300];
+    uint8_t user_obj_mgr = 0;
+    for (int i = 0; i < 300; ++i)
+    {
+        char *address = globalScriptUserObject.CreateManaged(user_obj_size);
+        user_obj_handles[i] = ccGetObjectHandleFromAddress(address);
+        ccAddObjectReference(user_obj_handles[i]);
+        rval.SetDynamicObject(address, &globalScriptUserObject);
+        assert(rval.MgrIndex != SCVAL_MGR_SELF && rval.GetDynamicManager() == &globalScriptUserObject);
+        assert(i == 0 || rval.MgrIndex == user_obj_mgr);
+        user_obj_mgr = rval.MgrIndex;
+        assert(ScriptUserObject::GetSize(address) == user_obj_size);
+        rval.IValue = 8;
+        rval.WriteInt32(i);
+        assert(rval.ReadInt32() == i && *(int32_t*)(address + 8) == i);
+    }
+    for (int i = 0; i < 300; ++i)
+    {
+        int refs = ccReleaseObjectReference(user_obj_handles[i]);
+        assert(refs == 0);
+    }
+}
+
+#endif // _DEBUG
@@ -0,0 +1,273 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <chrono>
+#include <string.h>
+#include <vector>
+#include "debug/assert.h"
+#include "media/video/flcdecoder.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Builds FLC animations chunk by chunk
+struct FlcWriter
+{
+    std::vector<uint8_t> Data;
+    size_t FrameStart;
+    size_t ChunkStart;
+    int    Frames;
+    int    Chunks;
+
+    FlcWriter(int width, int height, int delay)
+        : Data(128, 0), FrameStart(0), ChunkStart(0), Frames(0), Chunks(0)
+    {
+        Put16At(4, 0xAF12);
+        Put16At(8, width);
+        Put16At(10, height);
+        Put16At(12, 8);
+        Put32At(16, delay);
+        Put32At(80, 128);
+    }
+
+    void Put8(int v) { Data.push_back((uint8_t)v); }
+    void Put16(int v) { Put8(v); Put8(v >> 8); }
+    void Put16At(size_t at, int v) { Data[at] = (uint8_t)v; Data[at + 1] = (uint8_t)(v >> 8); }
+    void Put32At(size_t at, int v) { Put16At(at, v); Put16At(at + 2, v >> 16); }
+
+    void BeginFrame()
+    {
+        FrameStart = Data.size();
+        Chunks = 0;
+        Data.resize(Data.size() + 16, 0);
+        Put16At(FrameStart + 4, 0xF1FA);
+    }
+    void EndFrame()
+    {
+        Put32At(FrameStart, (int)(Data.size() - FrameStart));
+        Put16At(FrameStart + 6, Chunks);
+        Put16At(6, ++Frames);
+        Put32At(0, (int)Data.size());
+    }
+    void BeginChunk(int type)
+    {
+        ChunkStart = Data.size();
+        Data.resize(Data.size() + 6, 0);
+        Put16At(ChunkStart + 4, type);
+    }
+    void EndChunk()
+    {
+        Put32At(ChunkStart, (int)(Data.size() - ChunkStart));
+        Chunks++;
+    }
+};
+
+static bool dirty_span_is(const FlcDecoder &flc, int y, int x1, int x2)
+{
+    int dx1, dx2;
+    return flc.GetDirtySpan(y, dx1, dx2) && dx1 == x1 && dx2 == x2;
+}
+
+void Test_FlcDecoder()
+{
+    FlcWriter w(8, 4, 50);
+    // 1: palette and the full image
+    w.BeginFrame();
+    w.BeginChunk(4); // COLOR_256
+    w.Put16(1); w.Put8(0); w.Put8(3);
+    w.Put8(0); w.Put8(0); w.Put8(0);
+    w.Put8(255); w.Put8(0); w.Put8(0);
+    w.Put8(0); w.Put8(128); w.Put8(255);
+    w.EndChunk();
+    w.BeginChunk(15); // BRUN
+    w.Put8(1); w.Put8(-8 & 0xFF);
+    for (int x = 0; x < 8; ++x)
+        w.Put8(x);
+    for (int y = 1; y < 4; ++y)
+    {
+        w.Put8(1); w.Put8(8); w.Put8(1);
+    }
+    w.EndChunk();
+    w.EndFrame();
+    // 2: a word run on the third line
+    w.BeginFrame();
+    w.BeginChunk(7); // SS2
+    w.Put16(1);
+    w.Put16(0x10000 - 2); // skip 2 lines
+    w.Put16(1);
+    w.Put8(2); w.Put8(-1 & 0xFF); w.Put8(5); w.Put8(6);
+    w.EndChunk();
+    w.EndFrame();
+    // 3: one palette entry and a byte run on the second line
+    w.BeginFrame();
+    w.BeginChunk(11); // COLOR_64
+    w.Put16(1); w.Put8(5); w.Put8(1);
+    w.Put8(63); w.Put8(0); w.Put8(32);
+    w.EndChunk();
+    w.BeginChunk(12); // LC
+    w.Put16(1); w.Put16(1);
+    w.Put8(1); w.Put8(6); w.Put8(-2 & 0xFF); w.Put8(9);
+    w.EndChunk();
+    w.EndFrame();
+    // 4: black
+    w.BeginFrame();
+    w.BeginChunk(13);
+    w.EndChunk();
+    w.EndFrame();
+
+    FlcDecoder flc;
+    assert(flc.Open(new MemoryStream(&w.Data.front(), w.Data.size())));
+    assert(flc.GetWidth() == 8 && flc.GetHeight() == 4);
+    assert(flc.GetFrameCount() == 4);
+    assert(flc.GetFrameDelay() == 50);
+
+    assert(flc.NextFrame());
+    for (int x = 0; x < 8; ++x)
+        assert(flc.GetLine(0)[x] == x && flc.GetLine(3)[x] == 1);
+    assert(flc.GetPalette()[1].R == 255 && flc.GetPalette()[2].G == 128 && flc.GetPalette()[2].B == 255);
+    assert(flc.GetDirtyFrom() == 0 && flc.GetDirtyTo() == 4);
+    assert(flc.GetPaletteDirtyFrom() == 0 && flc.GetPaletteDirtyTo() == 256);
+    flc.ClearDirty();
+
+    assert(flc.NextFrame());
+    assert(flc.GetLine(2)[1] == 1 && flc.GetLine(2)[2] == 5 && flc.GetLine(2)[3] == 6 && flc.GetLine(2)[4] == 1);
+    assert(flc.GetDirtyFrom() == 2 && flc.GetDirtyTo() == 3);
+    assert(dirty_span_is(flc, 2, 2, 4));
+    int x1, x2;
+    assert(!flc.GetDirtySpan(1, x1, x2));
+    assert(flc.GetPaletteDirtyFrom() >= flc.GetPaletteDirtyTo());
+    flc.ClearDirty();
+
+    assert(flc.NextFrame());
+    assert(flc.GetLine(1)[5] == 1 && flc.GetLine(1)[6] == 9 && flc.GetLine(1)[7] == 9);
+    assert(flc.GetDirtyFrom() == 1 && flc.GetDirtyTo() == 2);
+    assert(dirty_span_is(flc, 1, 6, 8));
+    assert(flc.GetPaletteDirtyFrom() == 5 && flc.GetPaletteDirtyTo() == 6);
+    assert(flc.GetPalette()[5].R == 255 && flc.GetPalette()[5].G == 0 && flc.GetPalette()[5].B == 130);
+    flc.ClearDirty();
+
+    assert(flc.NextFrame());
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 8; ++x)
+            assert(flc.GetLine(y)[x] == 0);
+    assert(dirty_span_is(flc, 0, 0, 8) && dirty_span_is(flc, 3, 0, 8));
+
+    assert(!flc.NextFrame());
+    assert(!flc.HasFailed());
+    assert(flc.GetFrameIndex() == 4);
+
+    // A chunk which claims to be larger than its frame fails the decoding
+    std::vector<uint8_t> broken = w.Data;
+    broken[128 + 16] = 0xFF;
+    assert(flc.Open(new MemoryStream(&broken.front(), broken.size())));
+    assert(!flc.NextFrame());
+    assert(flc.HasFailed());
+}
+
+// Compares converting whole frames through the palette, as done for every
+// frame played by the Allegro FLI player, with converting only the changed
+// spans, on an animation of a box moving over a still background
+void Test_FlcConvertSpeed()
+{
+    const int width = 320, height = 200, box = 32, frames = 60, runs = 20;
+    FlcWriter w(width, height, 1000 / 15);
+    w.BeginFrame();
+    w.BeginChunk(4);
+    w.Put16(1); w.Put8(0); w.Put8(0);
+    for (int i = 0; i < 256; ++i)
+    {
+        w.Put8(i); w.Put8(255 - i); w.Put8(i / 2);
+    }
+    w.EndChunk();
+    w.BeginChunk(15);
+    for (int y = 0; y < height; ++y)
+    {
+        w.Put8(0);
+        for (int x = 0; x < width; x += 64)
+        {
+            w.Put8(64); w.Put8((x + y) & 0xFF);
+        }
+    }
+    w.EndChunk();
+    w.EndFrame();
+    // Each frame redraws the lines of the box, from its old to its new place
+    const int box_y = (height - box) / 2;
+    for (int f = 1; f < frames; ++f)
+    {
+        const int x = (f - 1) * 4;
+        w.BeginFrame();
+        w.BeginChunk(7);
+        w.Put16(box);
+        w.Put16(0x10000 - box_y);
+        for (int y = box_y; y < box_y + box; ++y)
+        {
+            w.Put16(1);
+            w.Put8(x); w.Put8((box + 4) / 2);
+            for (int i = 0; i < box + 4; ++i)
+                w.Put8(i < 4 ? ((x + i + y) & 0xFF) : 200);
+        }
+        w.EndChunk();
+        w.EndFrame();
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    std::vector<uint32_t> full(width * height), partial(width * height);
+    uint32_t colors[256];
+    double time_full = 0.0, time_partial = 0.0;
+    for (int run = 0; run < runs; ++run)
+    {
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const bool dirty_only = pass == 1;
+            uint32_t *dst = dirty_only ? &partial.front() : &full.front();
+            FlcDecoder flc;
+            assert(flc.Open(new MemoryStream(&w.Data.front(), w.Data.size())));
+            const Clock::time_point start = Clock::now();
+            while (flc.NextFrame())
+            {
+                const FlcColor *pal = flc.GetPalette();
+                for (int i = flc.GetPaletteDirtyFrom(); i < flc.GetPaletteDirtyTo(); ++i)
+                    colors[i] = 0xFF000000 | (pal[i].R << 16) | (pal[i].G << 8) | pal[i].B;
+                const bool all = !dirty_only || flc.GetPaletteDirtyFrom() < flc.GetPaletteDirtyTo();
+                for (int y = all ? 0 : flc.GetDirtyFrom(); y < (all ? height : flc.GetDirtyTo()); ++y)
+                {
+                    int x1 = 0, x2 = width;
+                    if (!all && !flc.GetDirtySpan(y, x1, x2))
+                        continue;
+                    const uint8_t *src = flc.GetLine(y);
+                    for (int x = x1; x < x2; ++x)
+                        dst[y * width + x] = colors[src[x]];
+                }
+                flc.ClearDirty();
+            }
+            assert(!flc.HasFailed());
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            (dirty_only ? time_partial : time_full) += ms;
+        }
+    }
+    assert(full == partial);
+    AGSPlatformDriver::GetDriver()->WriteStdOut("FLC %dx%d, %d frames: full frame conversion %.2f ms, changed spans only %.2f ms",
+        width, height, frames, time_full / runs, time_partial / runs);
+}
+
+void Test_Video()
+{
+    Test_FlcDecoder();
+}
+
+#endif // _DEBUG
@@ -0,0 +1,84 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Fixed-size lock-free ring buffer for passing messages between exactly one
+// producer thread and exactly one consumer thread. Push must only be called
+// by the producer and Pop by the consumer; neither ever blocks.
+//
+//=============================================================================
+#ifndef __AGS_EE_UTIL__LOCKFREE_RING_H
+#define __AGS_EE_UTIL__LOCKFREE_RING_H
+
+#include <atomic>
+#include <stddef.h>
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Capacity must be a power of two
+template <typename T, size_t Capacity>
+class LockFreeRing
+{
+public:
+    LockFreeRing()
+        : _head(0)
+        , _tail(0)
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "LockFreeRing capacity must be a power of two");
+    }
+
+    // Puts a copy of the item into the ring; returns false if the ring is full
+    bool Push(const T &item)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        _items[tail & (Capacity - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Takes the oldest item out of the ring; returns false if the ring is empty
+    bool Pop(T &item)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        item = _items[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool IsEmpty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    LockFreeRing(const LockFreeRing &); // non-copyable
+    LockFreeRing &operator=(const LockFreeRing &); // not copy-assignable
+
+    // Head is advanced by consumer, tail by producer; both only grow and
+    // wrap around naturally, the difference being the number of queued items
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+    T _items[Capacity];
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_UTIL__LOCKFREE_RING_H
@@ -39,6 +39,21 @@ public:
     Stop();
   }
 
+  // Identifies a running thread, including the ones not made by this class
+  typedef SceUID Id;
+
+  // Returns the id of the calling thread
+  static inline Id GetCurrentId()
+  {
+    return sceKernelGetThreadId();
+  }
+
+  // Tells if the given id belongs to the calling thread
+  static inline bool IsCurrent(Id id)
+  {
+    return sceKernelGetThreadId() == id;
+  }
+
   inline bool Create(AGSThreadEntry entryPoint, bool looping)
   {
     _looping = looping;
@@ -36,6 +36,21 @@ public:
     Stop();
   }
 
+  // Identifies a running thread, including the ones not made by this class
+  typedef pthread_t Id;
+
+  // Returns the id of the calling thread
+  static inline Id GetCurrentId()
+  {
+    return pthread_self();
+  }
+
+  // Tells if the given id belongs to the calling thread
+  static inline bool IsCurrent(Id id)
+  {
+    return pthread_equal(pthread_self(), id) != 0;
+  }
+
   inline bool Create(AGSThreadEntry entryPoint, bool looping)
   {
     _looping = looping;
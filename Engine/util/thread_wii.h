@@ -36,6 +36,21 @@ public:
     Stop();
   }
 
+  // Identifies a running thread, including the ones not made by this class
+  typedef lwp_t Id;
+
+  // Returns the id of the calling thread
+  static inline Id GetCurrentId()
+  {
+    return LWP_GetSelf();
+  }
+
+  // Tells if the given id belongs to the calling thread
+  static inline bool IsCurrent(Id id)
+  {
+    return LWP_GetSelf() == id;
+  }
+
   inline bool Create(AGSThreadEntry entryPoint, bool looping)
   {
     _looping = looping;
@@ -41,6 +41,21 @@ public:
     Stop();
   }
 
+  // Identifies a running thread, including the ones not made by this class
+  typedef DWORD Id;
+
+  // Returns the id of the calling thread
+  static inline Id GetCurrentId()
+  {
+    return GetCurrentThreadId();
+  }
+
+  // Tells if the given id belongs to the calling thread
+  static inline bool IsCurrent(Id id)
+  {
+    return GetCurrentThreadId() == id;
+  }
+
   inline bool Create(AGSThreadEntry entryPoint, bool looping)
   {
     _looping = looping;
@@ -21,6 +21,11 @@ but a workalike plugin created by JJS for the AGS engine PSP port.
 #include <string.h>
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLASHLIGHT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #if defined(PSP_VERSION)
 #include <pspsdk.h>
 #include <pspmath.h>
@@ -35,7 +40,6 @@ namespace agsflashlight {
 #endif
 
 #if defined(__GNUC__)
-inline unsigned long _blender_alpha16_bgr(unsigned long y) __attribute__((always_inline));
 inline void calc_x_n(unsigned long bla) __attribute__((always_inline));
 #endif
 
@@ -51,6 +55,7 @@ int screen_color_depth = 16;
 IAGSEngine* engine;
 
 bool g_BitmapMustBeUpdated = true;
+bool g_TintMustBeUpdated = true;
 
 int g_RedTint = 0;
 int g_GreenTint = 0;
@@ -79,6 +84,24 @@ AGSCharacter* g_FollowCharacter = NULL;
 
 BITMAP* g_LightBitmap = NULL;
 
+// The light bitmap converted for blending onto the screen, so that the
+// per-frame compositing does no colour conversion at all. For 16-bit screens
+// the colour is spread as by calc_x_n() and the factor is in 0..32, for 32-bit
+// screens the colour has red and blue swapped and the factor (0..256) is
+// stored in both halves of the value.
+unsigned int* g_LightColor = NULL;
+unsigned int* g_LightFactor = NULL;
+// Per row: the run of pixels which are not changed by blending at all
+// (the fully lit middle of the circle), these are skipped.
+int* g_LightSkipFrom = NULL;
+int* g_LightSkipTo = NULL;
+int g_LightBufferDiameter = 0;
+
+// Tint lookup table for 16-bit screens, saturating add/subtract masks for 32-bit
+unsigned short* g_TintTable16 = NULL;
+unsigned int g_TintAdd32 = 0;
+unsigned int g_TintSub32 = 0;
+
 // Imported script functions
 typedef int (*SCAPI_CHARACTER_GETX)(AGSCharacter *ch);
 typedef int (*SCAPI_CHARACTER_GETY)(AGSCharacter *ch);
@@ -112,17 +135,199 @@ inline void calc_x_n(unsigned long _x)
 }
 
 
-inline unsigned long _blender_alpha16_bgr(unsigned long y)
+// Blends the source colour prepared by calc_x_n() onto a 16-bit pixel.
+// Only the lower 27 bits of the result are used, so 32-bit arithmetic
+// gives exactly the same pixels as the unsigned long version in Allegro.
+inline unsigned short BlendPixel16(unsigned int x, unsigned int n, unsigned int d)
+{
+  unsigned int y = (d | (d << 16)) & 0x7E0F81F;
+  unsigned int result = ((x - y) * n / 32 + y) & 0x7E0F81F;
+  return (unsigned short)((result & 0xFFFF) | (result >> 16));
+}
+
+
+// Blends 32-bit RGB source onto destination, factor is in 0..256;
+// destination alpha is kept.
+inline unsigned int BlendPixel32(unsigned int s, unsigned int n, unsigned int d)
+{
+  unsigned int m = 256 - n;
+  unsigned int rb = (((s & 0xFF00FF) * n + (d & 0xFF00FF) * m) >> 8) & 0xFF00FF;
+  unsigned int g = (((s & 0x00FF00) * n + (d & 0x00FF00) * m) >> 8) & 0x00FF00;
+  return (d & 0xFF000000) | rb | g;
+}
+
+
+inline unsigned int TintPixel32(unsigned int p)
+{
+  unsigned int result = p & 0xFF000000;
+  for (int shift = 0; shift < 24; shift += 8)
+  {
+    int c = (p >> shift) & 0xFF;
+    c += (g_TintAdd32 >> shift) & 0xFF;
+    c -= (g_TintSub32 >> shift) & 0xFF;
+    if (c > 255)
+      c = 255;
+    else if (c < 0)
+      c = 0;
+    result |= c << shift;
+  }
+  return result;
+}
+
+
+// Blend factor of the darkness colour with the given alpha
+inline unsigned int DarknessFactor(unsigned int alpha)
 {
-   unsigned long result;
+  if (screen_color_depth == 16)
+    return alpha ? (alpha + 1) / 8 : 0;
+  return alpha ? alpha + 1 : 0;
+}
 
-   y = ((y & 0xFFFF) | (y << 16)) & 0x7E0F81F;
 
-   result = ((x - y) * n / 32 + y) & 0x7E0F81F;
+#if defined(FLASHLIGHT_USE_SSE2)
 
-   return ((result & 0xFFFF) | (result >> 16));
+// SSE2 has no 32-bit low multiplication, emulate it with two 64-bit ones
+inline __m128i MultiplyLo32(__m128i a, __m128i b)
+{
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
 }
 
+// BlendPixel16 for four pixels, one in each 32-bit lane. The result is
+// sign-extended so that it survives _mm_packs_epi32 unchanged.
+inline __m128i BlendPixels16(__m128i x, __m128i n, __m128i d)
+{
+  const __m128i mask = _mm_set1_epi32(0x7E0F81F);
+  __m128i y = _mm_and_si128(_mm_or_si128(d, _mm_slli_epi32(d, 16)), mask);
+  __m128i result = _mm_srli_epi32(MultiplyLo32(_mm_sub_epi32(x, y), n), 5);
+  result = _mm_and_si128(_mm_add_epi32(result, y), mask);
+  result = _mm_or_si128(result, _mm_srli_epi32(result, 16));
+  return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+}
+
+// BlendPixel32 for two pixels unpacked to 16-bit channels; the factor
+// is expected in all four lanes of each pixel.
+inline __m128i BlendPixels32(__m128i s, __m128i n, __m128i d)
+{
+  __m128i m = _mm_sub_epi16(_mm_set1_epi16(256), n);
+  return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(s, n), _mm_mullo_epi16(d, m)), 8);
+}
+
+#endif // FLASHLIGHT_USE_SSE2
+
+
+// Blends a span of the prepared light bitmap onto a 16-bit screen line
+void BlendLightSpan16(unsigned short* dest, const unsigned int* color, const unsigned int* factor, int count)
+{
+  int i = 0;
+#if defined(FLASHLIGHT_USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+    __m128i lo = BlendPixels16(_mm_loadu_si128((const __m128i*)(color + i)),
+      _mm_loadu_si128((const __m128i*)(factor + i)), _mm_unpacklo_epi16(d, zero));
+    __m128i hi = BlendPixels16(_mm_loadu_si128((const __m128i*)(color + i + 4)),
+      _mm_loadu_si128((const __m128i*)(factor + i + 4)), _mm_unpackhi_epi16(d, zero));
+    _mm_storeu_si128((__m128i*)(dest + i), _mm_packs_epi32(lo, hi));
+  }
+#endif
+  for (; i < count; i++)
+    dest[i] = BlendPixel16(color[i], factor[i], dest[i]);
+}
+
+
+// Blends a span of the prepared light bitmap onto a 32-bit screen line
+void BlendLightSpan32(unsigned int* dest, const unsigned int* color, const unsigned int* factor, int count)
+{
+  int i = 0;
+#if defined(FLASHLIGHT_USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+    __m128i s = _mm_loadu_si128((const __m128i*)(color + i));
+    __m128i f = _mm_loadu_si128((const __m128i*)(factor + i));
+    __m128i lo = BlendPixels32(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi32(f, f), _mm_unpacklo_epi8(d, zero));
+    __m128i hi = BlendPixels32(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi32(f, f), _mm_unpackhi_epi8(d, zero));
+    __m128i result = _mm_andnot_si128(alpha_mask, _mm_packus_epi16(lo, hi));
+    _mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(result, _mm_and_si128(d, alpha_mask)));
+  }
+#endif
+  for (; i < count; i++)
+    dest[i] = BlendPixel32(color[i], factor[i] & 0xFFFF, dest[i]);
+}
+
+
+// Blends black with a constant factor onto a 16-bit screen line
+void DarkenSpan16(unsigned short* dest, unsigned int factor, int count)
+{
+  int i = 0;
+#if defined(FLASHLIGHT_USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i n = _mm_set1_epi32(factor);
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+    __m128i lo = BlendPixels16(zero, n, _mm_unpacklo_epi16(d, zero));
+    __m128i hi = BlendPixels16(zero, n, _mm_unpackhi_epi16(d, zero));
+    _mm_storeu_si128((__m128i*)(dest + i), _mm_packs_epi32(lo, hi));
+  }
+#endif
+  for (; i < count; i++)
+    dest[i] = BlendPixel16(0, factor, dest[i]);
+}
+
+
+// Blends black with a constant factor onto a 32-bit screen line
+void DarkenSpan32(unsigned int* dest, unsigned int factor, int count)
+{
+  int i = 0;
+#if defined(FLASHLIGHT_USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i n = _mm_set1_epi16((short)factor);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+    __m128i lo = BlendPixels32(zero, n, _mm_unpacklo_epi8(d, zero));
+    __m128i hi = BlendPixels32(zero, n, _mm_unpackhi_epi8(d, zero));
+    __m128i result = _mm_andnot_si128(alpha_mask, _mm_packus_epi16(lo, hi));
+    _mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(result, _mm_and_si128(d, alpha_mask)));
+  }
+#endif
+  for (; i < count; i++)
+    dest[i] = BlendPixel32(0, factor, dest[i]);
+}
+
+
+// Applies the screen tint to a 16-bit screen line
+void TintSpan16(unsigned short* dest, int count)
+{
+  for (int i = 0; i < count; i++)
+    dest[i] = g_TintTable16[dest[i]];
+}
+
+
+// Applies the screen tint to a 32-bit screen line
+void TintSpan32(unsigned int* dest, int count)
+{
+  int i = 0;
+#if defined(FLASHLIGHT_USE_SSE2)
+  const __m128i add = _mm_set1_epi32(g_TintAdd32);
+  const __m128i sub = _mm_set1_epi32(g_TintSub32);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+    _mm_storeu_si128((__m128i*)(dest + i), _mm_subs_epu8(_mm_adds_epu8(d, add), sub));
+  }
+#endif
+  for (; i < count; i++)
+    dest[i] = TintPixel32(dest[i]);
+}
 
 
 inline void setPixel(int x, int y, int color, unsigned int* pixel)
@@ -181,14 +386,6 @@ void ClipToRange(int &variable, int min, int max)
 
 void AlphaBlendBitmap()
 {
-  unsigned short* destpixel = *(unsigned short**)engine->GetRawBitmapSurface(engine->GetVirtualScreen());
-  unsigned int* sourcepixel = *(unsigned int**)engine->GetRawBitmapSurface(g_LightBitmap);
-
-  unsigned short* currentdestpixel = destpixel;
-  unsigned int* currentsourcepixel = sourcepixel;
-
-  int x, y;
-
   int targetX = (g_FlashlightDrawAtX > -1) ? g_FlashlightDrawAtX : 0;
   int targetY = (g_FlashlightDrawAtY > -1) ? g_FlashlightDrawAtY : 0;
 
@@ -198,39 +395,57 @@ void AlphaBlendBitmap()
   int startY = (g_FlashlightDrawAtY < 0) ? -1 * g_FlashlightDrawAtY : 0;
   int endY = (g_FlashlightDrawAtY + g_DarknessDiameter < screen_height) ? g_DarknessDiameter :  g_DarknessDiameter - ((g_FlashlightDrawAtY + g_DarknessDiameter) - screen_height);
 
-  for (y = 0; y < endY - startY; y++)
-  {
-    currentdestpixel = destpixel + (y + targetY) * screen_width + targetX;
-    currentsourcepixel = sourcepixel + (y + startY) * g_DarknessDiameter + startX;
+  if ((startX >= endX) || (startY >= endY))
+    return;
 
-    for (x = 0; x < endX - startX; x++)
-    {
-      calc_x_n(*currentsourcepixel);
-      *currentdestpixel = (unsigned short)_blender_alpha16_bgr(*currentdestpixel);
+  BITMAP* screen = engine->GetVirtualScreen();
+  unsigned char** lines = engine->GetRawBitmapSurface(screen);
 
-      currentdestpixel++;
-      currentsourcepixel++;
+  for (int y = startY; y < endY; y++)
+  {
+    unsigned char* line = lines[y - startY + targetY];
+    const unsigned int* color = g_LightColor + y * g_DarknessDiameter;
+    const unsigned int* factor = g_LightFactor + y * g_DarknessDiameter;
+
+    // Only blend the parts of the row left and right of the fully lit run
+    int skipFrom = g_LightSkipFrom[y];
+    int skipTo = g_LightSkipTo[y];
+    ClipToRange(skipFrom, startX, endX);
+    ClipToRange(skipTo, skipFrom, endX);
+
+    int spanStart[2] = { startX, skipTo };
+    int spanEnd[2] = { skipFrom, endX };
+    for (int span = 0; span < 2; span++)
+    {
+      int from = spanStart[span];
+      int count = spanEnd[span] - from;
+      if (count <= 0)
+        continue;
+
+      int destX = from - startX + targetX;
+      if (screen_color_depth == 16)
+        BlendLightSpan16((unsigned short*)line + destX, color + from, factor + from, count);
+      else
+        BlendLightSpan32((unsigned int*)line + destX, color + from, factor + from, count);
     }
   }
-  
-  engine->ReleaseBitmapSurface(engine->GetVirtualScreen());
-  engine->ReleaseBitmapSurface(g_LightBitmap);
+
+  engine->ReleaseBitmapSurface(screen);
 }
 
 
-void DrawTint()
+void UpdateTint()
 {
-  int x, y;
-  BITMAP* screen = engine->GetVirtualScreen();
-  unsigned short* destpixel = *(unsigned short**)engine->GetRawBitmapSurface(screen);
+  if (screen_color_depth == 16)
+  {
+    if (g_TintTable16 == NULL)
+      g_TintTable16 = new unsigned short[65536];
 
-  int32 red, blue, green, alpha;
+    int32 red, blue, green, alpha;
 
-  for (y = 0; y < screen_height; y++)
-  {
-    for (x = 0; x < screen_width; x++)
+    for (int pixel = 0; pixel < 65536; pixel++)
     {
-      engine->GetRawColorComponents(16, *destpixel, &red, &green, &blue, &alpha);
+      engine->GetRawColorComponents(16, pixel, &red, &green, &blue, &alpha);
 
       if (g_RedTint != 0)
       {
@@ -259,102 +474,152 @@ void DrawTint()
           green = 0;
       }
 
-      *destpixel = engine->MakeRawColorPixel(16, red, green, blue, alpha);
-      destpixel++;
+      g_TintTable16[pixel] = (unsigned short)engine->MakeRawColorPixel(16, red, green, blue, alpha);
     }
   }
+  else
+  {
+    // Tint values are clipped to -31..31, so the offsets fit in a channel
+    g_TintAdd32 = engine->MakeRawColorPixel(32,
+      (g_RedTint > 0) ? g_RedTint * 8 : 0, (g_GreenTint > 0) ? g_GreenTint * 8 : 0, (g_BlueTint > 0) ? g_BlueTint * 8 : 0, 0);
+    g_TintSub32 = engine->MakeRawColorPixel(32,
+      (g_RedTint < 0) ? -g_RedTint * 8 : 0, (g_GreenTint < 0) ? -g_GreenTint * 8 : 0, (g_BlueTint < 0) ? -g_BlueTint * 8 : 0, 0);
+  }
+}
+
+
+void DrawTint()
+{
+  BITMAP* screen = engine->GetVirtualScreen();
+  unsigned char** lines = engine->GetRawBitmapSurface(screen);
+
+  for (int y = 0; y < screen_height; y++)
+  {
+    if (screen_color_depth == 16)
+      TintSpan16((unsigned short*)lines[y], screen_width);
+    else
+      TintSpan32((unsigned int*)lines[y], screen_width);
+  }
 
   engine->ReleaseBitmapSurface(screen);
 }
 
 
+void DarkenRect(unsigned char** lines, int x1, int y1, int x2, int y2, unsigned int factor)
+{
+  ClipToRange(x1, 0, screen_width);
+  ClipToRange(x2, x1, screen_width);
+  ClipToRange(y1, 0, screen_height);
+  ClipToRange(y2, y1, screen_height);
+
+  if (x1 == x2)
+    return;
+
+  for (int y = y1; y < y2; y++)
+  {
+    if (screen_color_depth == 16)
+      DarkenSpan16((unsigned short*)lines[y] + x1, factor, x2 - x1);
+    else
+      DarkenSpan32((unsigned int*)lines[y] + x1, factor, x2 - x1);
+  }
+}
+
+
 void DrawDarkness()
 {
-  int x, y;
-  unsigned int color = (255 - (int)((float)g_DarknessLightLevel * 2.55f)) << 24;
+  unsigned int factor = DarknessFactor(255 - (int)((float)g_DarknessLightLevel * 2.55f));
   BITMAP* screen = engine->GetVirtualScreen();
-  unsigned short* destpixel = *(unsigned short**)engine->GetRawBitmapSurface(screen);
-  unsigned short* currentpixel;
-
-  calc_x_n(color);
+  unsigned char** lines = engine->GetRawBitmapSurface(screen);
 
   if (g_DarknessSize == 0)
   {
     // Whole screen.
-    for (x = 0; x < screen_width * screen_height; x++)
-    {
-      *destpixel = (unsigned short)_blender_alpha16_bgr(*destpixel);
-      destpixel++;
-    }
+    DarkenRect(lines, 0, 0, screen_width, screen_height, factor);
   }
   else
   {
+    // Everything around the light bitmap, which has the darkness
+    // already blended in.
+    int lightX1 = g_FlashlightDrawAtX;
+    int lightY1 = g_FlashlightDrawAtY;
+    int lightX2 = g_FlashlightDrawAtX + g_DarknessDiameter;
+    int lightY2 = g_FlashlightDrawAtY + g_DarknessDiameter;
+
     // Top.
-    if (g_FlashlightDrawAtY > -1)
+    DarkenRect(lines, 0, 0, screen_width, lightY1, factor);
+    // Bottom.
+    DarkenRect(lines, 0, lightY2, screen_width, screen_height, factor);
+    // Left.
+    DarkenRect(lines, 0, lightY1, lightX1, lightY2, factor);
+    // Right.
+    DarkenRect(lines, lightX2, lightY1, screen_width, lightY2, factor);
+  }
+
+  engine->ReleaseBitmapSurface(screen);
+}
+
+
+// Converts the light bitmap for the current screen color depth and finds
+// the pixels which do not need blending at all.
+void PrepareLightBitmap()
+{
+  if (g_LightBufferDiameter != g_DarknessDiameter)
+  {
+    delete [] g_LightColor;
+    delete [] g_LightFactor;
+    delete [] g_LightSkipFrom;
+    delete [] g_LightSkipTo;
+    g_LightColor = new unsigned int[g_DarknessDiameter * g_DarknessDiameter];
+    g_LightFactor = new unsigned int[g_DarknessDiameter * g_DarknessDiameter];
+    g_LightSkipFrom = new int[g_DarknessDiameter];
+    g_LightSkipTo = new int[g_DarknessDiameter];
+    g_LightBufferDiameter = g_DarknessDiameter;
+  }
+
+  const unsigned int* pixel = *(unsigned int**)engine->GetRawBitmapSurface(g_LightBitmap);
+
+  for (int i = 0; i < g_DarknessDiameter * g_DarknessDiameter; i++)
+  {
+    if (screen_color_depth == 16)
     {
-      currentpixel = destpixel;
-      for (y = 0; y < g_FlashlightDrawAtY; y++)
-      {
-        for (x = 0; x < screen_width; x++)
-        {
-          *currentpixel = (unsigned short)_blender_alpha16_bgr(*currentpixel);
-          currentpixel++;
-        }
-      }
+      calc_x_n(pixel[i]);
+      g_LightColor[i] = (unsigned int)x;
+      g_LightFactor[i] = (unsigned int)n;
     }
-
-    // Bottom.
-    if (g_FlashlightDrawAtY + g_DarknessDiameter < screen_height)
+    else
     {
-      currentpixel = destpixel + (g_FlashlightDrawAtY + g_DarknessDiameter) * screen_width;
-      for (y = g_FlashlightDrawAtY + g_DarknessDiameter; y < screen_height; y++)
-      {
-        for (x = 0; x < screen_width; x++)
-        {
-          *currentpixel = (unsigned short)_blender_alpha16_bgr(*currentpixel);
-          currentpixel++;
-        }
-      }
+      unsigned int factor = DarknessFactor(pixel[i] >> 24);
+      g_LightColor[i] = ((pixel[i] & 0xFF) << 16) | (pixel[i] & 0xFF00) | ((pixel[i] >> 16) & 0xFF);
+      g_LightFactor[i] = factor | (factor << 16);
     }
+  }
 
-    // Left.
-    if (g_FlashlightDrawAtX > 0)
+  for (int y = 0; y < g_DarknessDiameter; y++)
+  {
+    const unsigned int* factor = g_LightFactor + y * g_DarknessDiameter;
+    g_LightSkipFrom[y] = g_LightSkipTo[y] = g_DarknessDiameter;
+
+    for (int col = 0; col < g_DarknessDiameter; )
     {
-      currentpixel = destpixel;
-      int startpoint = (g_FlashlightDrawAtY > 0) ? g_FlashlightDrawAtY : 0;
-      int endpoint = (g_FlashlightDrawAtY + g_DarknessDiameter >= screen_height) ? screen_height + 1 : g_FlashlightDrawAtY + g_DarknessDiameter + 1;
-      for (y = startpoint; y < endpoint; y++)
+      if (factor[col] != 0)
       {
-        for (x = 0; x < g_FlashlightDrawAtX; x++)
-        {
-          *currentpixel = (unsigned short)_blender_alpha16_bgr(*currentpixel);
-          currentpixel++;
-        }
-
-        currentpixel = destpixel + screen_width * y;
+        col++;
+        continue;
       }
-    }
 
-    // Right.
-    if (g_FlashlightDrawAtX + g_DarknessDiameter < screen_width)
-    {
-      currentpixel = destpixel + (g_FlashlightDrawAtX + g_DarknessDiameter);
-      int startpoint = (g_FlashlightDrawAtY > 0) ? g_FlashlightDrawAtY : 0;
-      int endpoint = (g_FlashlightDrawAtY + g_DarknessDiameter >= screen_height) ? screen_height + 1 : g_FlashlightDrawAtY + g_DarknessDiameter + 1;
-      for (y = startpoint; y < endpoint; y++)
-      {
-        for (x = g_FlashlightDrawAtX + g_DarknessDiameter; x < screen_width; x++)
-        {
-          *currentpixel = (unsigned short)_blender_alpha16_bgr(*currentpixel);
-          currentpixel++;
-        }
+      int runStart = col;
+      while ((col < g_DarknessDiameter) && (factor[col] == 0))
+        col++;
 
-        currentpixel = destpixel + screen_width * y + (g_FlashlightDrawAtX + g_DarknessDiameter);
+      if (col - runStart > g_LightSkipTo[y] - g_LightSkipFrom[y])
+      {
+        g_LightSkipFrom[y] = runStart;
+        g_LightSkipTo[y] = col;
       }
     }
   }
 
-  engine->ReleaseBitmapSurface(screen);
+  engine->ReleaseBitmapSurface(g_LightBitmap);
 }
 
 
@@ -364,9 +629,18 @@ void CreateLightBitmap()
     return;
 
   if (g_LightBitmap)
-    engine->FreeBitmap(g_LightBitmap);
+  {
+    int32 width, height, depth;
+    engine->GetBitmapDimensions(g_LightBitmap, &width, &height, &depth);
+    if (width != g_DarknessDiameter)
+    {
+      engine->FreeBitmap(g_LightBitmap);
+      g_LightBitmap = NULL;
+    }
+  }
 
-  g_LightBitmap = engine->CreateBlankBitmap(g_DarknessDiameter, g_DarknessDiameter, 32);
+  if (!g_LightBitmap)
+    g_LightBitmap = engine->CreateBlankBitmap(g_DarknessDiameter, g_DarknessDiameter, 32);
 
   // Fill with darkness color.
   unsigned int color = (255 - (int)((float)g_DarknessLightLevel * 2.55f)) << 24;
@@ -377,7 +651,7 @@ void CreateLightBitmap()
     *pixel++ = (unsigned int)color;
 
   // Draw light circle if wanted.
-  if (g_DarknessSize > 0)
+  if (g_DarknessSize > g_BrightnessSize)
   {
     int current_value = 0;
     color = (255 - (int)((float)g_BrightnessLightLevel * 2.55f));
@@ -414,8 +688,10 @@ void CreateLightBitmap()
     for (i = 0; i < g_BrightnessSize; i++)
       plotCircle(g_DarknessSize, g_DarknessSize, i, color);
   }
-
+  
   engine->ReleaseBitmapSurface(g_LightBitmap);
+
+  PrepareLightBitmap();
 }
 
 
@@ -427,6 +703,12 @@ void CreateLightBitmap()
      g_BitmapMustBeUpdated = false;
    }
 
+   if (g_TintMustBeUpdated)
+   {
+     UpdateTint();
+     g_TintMustBeUpdated = false;
+   }
+
    if (g_FlashlightFollowMouse)
    {
 	   engine->GetMousePosition(&g_FlashlightX, &g_FlashlightY);
@@ -524,6 +806,7 @@ void RestoreGame(FILE* file)
       g_FollowCharacter = engine->GetCharacter(g_FollowCharacterId);
 
     g_BitmapMustBeUpdated = true;
+    g_TintMustBeUpdated = true;
   }
   else if ((SaveVersion & 0xFFFF0000) == Magic)
   {
@@ -592,7 +875,7 @@ void SetFlashlightTint(int RedTint, int GreenTint, int BlueTint)
   ClipToRange(BlueTint, -31, 31);
 
   if ((RedTint != g_RedTint) || (GreenTint != g_GreenTint) || (BlueTint != g_BlueTint))
-    g_BitmapMustBeUpdated = true;
+    g_TintMustBeUpdated = true;
 
   g_RedTint = RedTint;
   g_GreenTint = GreenTint;
@@ -847,8 +1130,12 @@ int AGS_EngineOnEvent(int event, int data)
     engine->GetScreenDimensions(&screen_width, &screen_height, &screen_color_depth);
     engine->UnrequestEventHook(AGSE_PRESCREENDRAW);
 
-    // Only 16 bit color depth is supported.
-    if (screen_color_depth != 16)
+    // The light and tint are prepared for the actual color depth.
+    g_BitmapMustBeUpdated = true;
+    g_TintMustBeUpdated = true;
+
+    // Only 16 and 32 bit color depths are supported.
+    if ((screen_color_depth != 16) && (screen_color_depth != 32))
     {
       engine->UnrequestEventHook(AGSE_PREGUIDRAW);
       engine->UnrequestEventHook(AGSE_PRESCREENDRAW);
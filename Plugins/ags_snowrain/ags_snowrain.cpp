@@ -21,6 +21,11 @@ but a workalike plugin created by JJS for the AGS engine PSP port.
 #include <string.h>
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SNOWRAIN_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifdef PSP_VERSION
 #include <pspsdk.h>
 #include <pspmath.h>
@@ -54,8 +59,15 @@ int screen_width = 320;
 int screen_height = 200;
 int screen_color_depth = 32;
 
+// Drops are drawn directly onto the virtual screen when using the software
+// renderer, other drivers get them through the engine's blitting functions.
+bool is_software_renderer = false;
+
 IAGSEngine* engine;
 
+const int MaxAmount = 10000;
+const int ViewCount = 5;
+
 
 typedef struct
 {
@@ -66,18 +78,25 @@ typedef struct
 } view_t;
 
 
+// Particles are stored as a structure of arrays, so that the per-frame
+// passes run over contiguous data.
 typedef struct
 {
-  float x;
-  float y;
-  int alpha;
-  float speed;
-  int max_y;
-  int kind_id;
-  int drift;
-  float drift_speed;
-  float drift_offset;
-} drop_t;
+  float* x;
+  float* y;
+  int* alpha;
+  float* speed;
+  int* max_y;
+  int* kind_id;
+  int* drift;
+  float* drift_speed;
+  float* drift_offset;
+  // Wind applied to each drop in the current frame
+  float* wind;
+  // Screen position for the current frame, draw_y is -1 if not visible
+  int* draw_x;
+  int* draw_y;
+} drops_t;
 
 
 class Weather
@@ -98,6 +117,7 @@ class Weather
     void Update();
     void UpdateWithDrift();
     void EnterRoom();
+    void FreeParticles();
     
     void SetDriftRange(int min_value, int max_value);
     void SetDriftSpeed(int min_value, int max_value);
@@ -112,6 +132,10 @@ class Weather
 
   private:
     void ClipToRange(int &variable, int min, int max);
+    void ReserveParticles(int count);
+    void InitializeParticle(int i);
+    void RespawnParticles(int count, bool with_drift);
+    void DrawParticles(int count);
     
     bool mIsSnow;
     
@@ -140,8 +164,11 @@ class Weather
     int mMaxFallSpeed;
     int mDeltaFallSpeed;
     
-    drop_t mParticles[2000];
-    view_t mViews[5];
+    drops_t mParticles;
+    int mCapacity;
+    // Draw order, grouped by view and transparency
+    int* mDrawOrder;
+    view_t mViews[ViewCount];
 
     bool mViewsInitialized;
 };
@@ -150,6 +177,9 @@ class Weather
 Weather::Weather()
 {
   mIsSnow = false;
+  mCapacity = 0;
+  memset(&mParticles, 0, sizeof(drops_t));
+  mDrawOrder = NULL;
   Initialize();
 }
 
@@ -157,12 +187,114 @@ Weather::Weather()
 Weather::Weather(bool IsSnow)
 {
   mIsSnow = IsSnow;
+  mCapacity = 0;
+  memset(&mParticles, 0, sizeof(drops_t));
+  mDrawOrder = NULL;
   Initialize();
 }
 
 
 Weather::~Weather()
 {
+  FreeParticles();
+}
+
+
+void Weather::FreeParticles()
+{
+  delete [] mParticles.x;
+  delete [] mParticles.y;
+  delete [] mParticles.alpha;
+  delete [] mParticles.speed;
+  delete [] mParticles.max_y;
+  delete [] mParticles.kind_id;
+  delete [] mParticles.drift;
+  delete [] mParticles.drift_speed;
+  delete [] mParticles.drift_offset;
+  delete [] mParticles.wind;
+  delete [] mParticles.draw_x;
+  delete [] mParticles.draw_y;
+  delete [] mDrawOrder;
+  memset(&mParticles, 0, sizeof(drops_t));
+  mDrawOrder = NULL;
+  mCapacity = 0;
+}
+
+
+template <typename T>
+void GrowArray(T*& array, int old_size, int new_size)
+{
+  T* new_array = new T[new_size];
+  if (old_size > 0)
+    memcpy(new_array, array, sizeof(T) * old_size);
+  delete [] array;
+  array = new_array;
+}
+
+
+// Makes sure that there is storage for the given number of drops,
+// new drops are initialized.
+void Weather::ReserveParticles(int count)
+{
+  if (count <= mCapacity)
+    return;
+
+  GrowArray(mParticles.x, mCapacity, count);
+  GrowArray(mParticles.y, mCapacity, count);
+  GrowArray(mParticles.alpha, mCapacity, count);
+  GrowArray(mParticles.speed, mCapacity, count);
+  GrowArray(mParticles.max_y, mCapacity, count);
+  GrowArray(mParticles.kind_id, mCapacity, count);
+  GrowArray(mParticles.drift, mCapacity, count);
+  GrowArray(mParticles.drift_speed, mCapacity, count);
+  GrowArray(mParticles.drift_offset, mCapacity, count);
+  GrowArray(mParticles.wind, mCapacity, count);
+  GrowArray(mParticles.draw_x, mCapacity, count);
+  GrowArray(mParticles.draw_y, mCapacity, count);
+  GrowArray(mDrawOrder, 0, count);
+
+  int i;
+  for (i = mCapacity; i < count; i++)
+    InitializeParticle(i);
+
+  mCapacity = count;
+}
+
+
+// Moves all drops down and along the wind; the wind for each drop is
+// given by wind_factor, or is the same for all if it is NULL.
+void MoveParticles(drops_t& p, int count, float wind_speed, const float* wind_factor)
+{
+  int i = 0;
+  const float width = (float)screen_width;
+#if defined(SNOWRAIN_USE_SSE2)
+  const __m128 zero_ps = _mm_setzero_ps();
+  const __m128 wind = _mm_set1_ps(wind_speed);
+  const __m128 screen_w = _mm_set1_ps(width);
+  const __m128 screen_right = _mm_set1_ps(width - 1);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 y = _mm_add_ps(_mm_loadu_ps(p.y + i), _mm_loadu_ps(p.speed + i));
+    _mm_storeu_ps(p.y + i, y);
+
+    __m128 x = _mm_loadu_ps(p.x + i);
+    x = _mm_add_ps(x, wind_factor ? _mm_loadu_ps(wind_factor + i) : wind);
+    x = _mm_add_ps(x, _mm_and_ps(_mm_cmplt_ps(x, zero_ps), screen_w));
+    x = _mm_sub_ps(x, _mm_and_ps(_mm_cmpgt_ps(x, screen_right), screen_w));
+    _mm_storeu_ps(p.x + i, x);
+  }
+#endif
+  for (; i < count; i++)
+  {
+    p.y[i] += p.speed[i];
+    p.x[i] += wind_factor ? wind_factor[i] : wind_speed;
+
+    if (p.x[i] < 0)
+      p.x[i] += width;
+
+    if (p.x[i] > width - 1)
+      p.x[i] -= width;
+  }
 }
 
 
@@ -176,29 +308,20 @@ void Weather::Update()
   if (!ReinitializeViews())
     return;
 
+  int count = mAmount * 2;
+  ReserveParticles(count);
+
+  MoveParticles(mParticles, count, mWindSpeed, NULL);
+  RespawnParticles(count, false);
+
   int i;
-  for (i = 0; i < mAmount * 2; i++)
+  for (i = 0; i < count; i++)
   {
-    mParticles[i].y += mParticles[i].speed;
-    mParticles[i].x += mWindSpeed;
-    
-    if (mParticles[i].x < 0)
-      mParticles[i].x += screen_width;
-      
-    if (mParticles[i].x > screen_width - 1)
-      mParticles[i].x -= screen_width;
-    
-    if (mParticles[i].y > mParticles[i].max_y)
-    {
-      mParticles[i].y = -1 * (rand() % screen_height);
-      mParticles[i].x = rand() % screen_width;
-      mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
-      mParticles[i].speed = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
-      mParticles[i].max_y = rand() % mDeltaBaseline + mTopBaseline;
-    }
-    else if ((mParticles[i].y > 0) && (mParticles[i].alpha > 0))
-      engine->BlitSpriteTranslucent(mParticles[i].x, mParticles[i].y, mViews[mParticles[i].kind_id].bitmap, mParticles[i].alpha);
+    mParticles.draw_x[i] = (int)mParticles.x[i];
+    mParticles.draw_y[i] = (mParticles.y[i] > 0) ? (int)mParticles.y[i] : -1;
   }
+
+  DrawParticles(count);
   
   engine->MarkRegionDirty(0, 0, screen_width, screen_height);
 }
@@ -214,41 +337,224 @@ void Weather::UpdateWithDrift()
   if (!ReinitializeViews())
     return;
 
-  int i, drift;
-  for (i = 0; i < mAmount * 2; i++)
+  int count = mAmount * 2;
+  ReserveParticles(count);
+
+  // The drift depends on the new vertical position, but is calculated
+  // before the drops are moved, because it decides the wind applied to
+  // each drop; draw_y temporarily holds the drift.
+  float* wind = mParticles.wind;
+  int* drift = mParticles.draw_y;
+
+  int i;
+  for (i = 0; i < count; i++)
   {
-    mParticles[i].y += mParticles[i].speed;
-    drift = mParticles[i].drift * sin((float)(mParticles[i].y + mParticles[i].drift_offset) * mParticles[i].drift_speed * 2.0f * PI / 360.0f);
+    float y = mParticles.y[i] + mParticles.speed[i];
+    drift[i] = mParticles.drift[i] * sin((float)(y + mParticles.drift_offset[i]) * mParticles.drift_speed[i] * 2.0f * PI / 360.0f);
 
-    if (signum(mWindSpeed) == signum(drift))
-      mParticles[i].x += mWindSpeed;
+    if (signum(mWindSpeed) == signum(drift[i]))
+      wind[i] = mWindSpeed;
     else
-      mParticles[i].x += mWindSpeed / 4;
-    
-    if (mParticles[i].x < 0)
-      mParticles[i].x += screen_width;
-      
-    if (mParticles[i].x > screen_width - 1)
-      mParticles[i].x -= screen_width;
-    
-    if (mParticles[i].y > mParticles[i].max_y)
-    {
-      mParticles[i].y = -1 * (rand() % screen_height);
-      mParticles[i].x = rand() % screen_width;
-      mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
-      mParticles[i].speed = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
-      mParticles[i].max_y = rand() % mDeltaBaseline + mTopBaseline;
-      mParticles[i].drift = rand() % mDeltaDrift + mMinDrift;
-      mParticles[i].drift_speed = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;
-    }
-    else if ((mParticles[i].y > 0) && (mParticles[i].alpha > 0))
-      engine->BlitSpriteTranslucent(mParticles[i].x + drift, mParticles[i].y, mViews[mParticles[i].kind_id].bitmap, mParticles[i].alpha);
+      wind[i] = mWindSpeed / 4;
   }
+
+  MoveParticles(mParticles, count, mWindSpeed, wind);
+
+  for (i = 0; i < count; i++)
+    mParticles.draw_x[i] = (int)(mParticles.x[i] + drift[i]);
+
+  RespawnParticles(count, true);
+
+  for (i = 0; i < count; i++)
+    mParticles.draw_y[i] = (mParticles.y[i] > 0) ? (int)mParticles.y[i] : -1;
+
+  DrawParticles(count);
   
   engine->MarkRegionDirty(0, 0, screen_width, screen_height);
 }
 
 
+void Weather::RespawnParticles(int count, bool with_drift)
+{
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    if (mParticles.y[i] > mParticles.max_y[i])
+    {
+      mParticles.y[i] = -1 * (rand() % screen_height);
+      mParticles.x[i] = rand() % screen_width;
+      mParticles.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
+      mParticles.speed[i] = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
+      mParticles.max_y[i] = rand() % mDeltaBaseline + mTopBaseline;
+
+      if (with_drift)
+      {
+        mParticles.drift[i] = rand() % mDeltaDrift + mMinDrift;
+        mParticles.drift_speed[i] = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;
+      }
+    }
+  }
+}
+
+
+// Blends a line of sprite onto a line of the screen, in the same way
+// as Allegro's draw_trans_sprite() with the translucency blender.
+void BlendSpriteLine16(unsigned short* dest, const unsigned short* src, int count, int alpha)
+{
+  unsigned long n = (alpha + 1) / 8;
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    unsigned long x = src[i];
+    if (x == 0xF81F)
+      continue;
+
+    unsigned long y = dest[i];
+    x = ((x & 0xFFFF) | (x << 16)) & 0x7E0F81F;
+    y = ((y & 0xFFFF) | (y << 16)) & 0x7E0F81F;
+    unsigned long result = ((x - y) * n / 32 + y) & 0x7E0F81F;
+    dest[i] = (unsigned short)((result & 0xFFFF) | (result >> 16));
+  }
+}
+
+
+void BlendSpriteLine32(unsigned int* dest, const unsigned int* src, int count, int alpha)
+{
+  unsigned long n = alpha + 1;
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    unsigned long x = src[i];
+    if (x == 0xFF00FF)
+      continue;
+
+    unsigned long y = dest[i];
+    unsigned long result = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+    y &= 0xFF00;
+    x &= 0xFF00;
+    unsigned long g = (x - y) * n / 256 + y;
+    dest[i] = (unsigned int)((result & 0xFF00FF) | (g & 0xFF00));
+  }
+}
+
+
+template <typename T>
+void CopySpriteLine(T* dest, const T* src, int count, T mask_color)
+{
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    if (src[i] != mask_color)
+      dest[i] = src[i];
+  }
+}
+
+
+// Draws all drops which share the sprite and transparency in one pass
+// straight onto the virtual screen.
+void BlitParticleBatch(BITMAP* sprite, int alpha, const int* order, int count, const int* draw_x, const int* draw_y)
+{
+  int32 width, height, depth;
+  engine->GetBitmapDimensions(sprite, &width, &height, &depth);
+
+  BITMAP* screen = engine->GetVirtualScreen();
+  unsigned char** dest_lines = engine->GetRawBitmapSurface(screen);
+  unsigned char** src_lines = engine->GetRawBitmapSurface(sprite);
+
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    int x = draw_x[order[i]];
+    int y = draw_y[order[i]];
+
+    int src_x = (x < 0) ? -x : 0;
+    int src_y = (y < 0) ? -y : 0;
+    int end_x = (x + width > screen_width) ? screen_width - x : width;
+    int end_y = (y + height > screen_height) ? screen_height - y : height;
+    if ((src_x >= end_x) || (src_y >= end_y))
+      continue;
+
+    int line;
+    for (line = src_y; line < end_y; line++)
+    {
+      if (depth == 16)
+      {
+        unsigned short* dest = (unsigned short*)dest_lines[y + line] + x + src_x;
+        const unsigned short* src = (const unsigned short*)src_lines[line] + src_x;
+        if (alpha < 255)
+          BlendSpriteLine16(dest, src, end_x - src_x, alpha);
+        else
+          CopySpriteLine<unsigned short>(dest, src, end_x - src_x, 0xF81F);
+      }
+      else
+      {
+        unsigned int* dest = (unsigned int*)dest_lines[y + line] + x + src_x;
+        const unsigned int* src = (const unsigned int*)src_lines[line] + src_x;
+        if (alpha < 255)
+          BlendSpriteLine32(dest, src, end_x - src_x, alpha);
+        else
+          CopySpriteLine<unsigned int>(dest, src, end_x - src_x, 0xFF00FF);
+      }
+    }
+  }
+
+  engine->ReleaseBitmapSurface(sprite);
+  engine->ReleaseBitmapSurface(screen);
+}
+
+
+void Weather::DrawParticles(int count)
+{
+  // Group the visible drops by sprite kind and transparency (counting sort)
+  int batch_start[ViewCount * 256 + 1];
+  memset(batch_start, 0, sizeof(batch_start));
+
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    if ((mParticles.draw_y[i] >= 0) && (mParticles.alpha[i] > 0))
+      batch_start[mParticles.kind_id[i] * 256 + (mParticles.alpha[i] & 0xFF) + 1]++;
+  }
+
+  for (i = 1; i <= ViewCount * 256; i++)
+    batch_start[i] += batch_start[i - 1];
+
+  int batch_fill[ViewCount * 256];
+  memcpy(batch_fill, batch_start, sizeof(batch_fill));
+
+  for (i = 0; i < count; i++)
+  {
+    if ((mParticles.draw_y[i] >= 0) && (mParticles.alpha[i] > 0))
+      mDrawOrder[batch_fill[mParticles.kind_id[i] * 256 + (mParticles.alpha[i] & 0xFF)]++] = i;
+  }
+
+  int batch;
+  for (batch = 0; batch < ViewCount * 256; batch++)
+  {
+    int batch_count = batch_start[batch + 1] - batch_start[batch];
+    if (batch_count == 0)
+      continue;
+
+    BITMAP* bitmap = mViews[batch / 256].bitmap;
+    int alpha = batch % 256;
+    const int* order = mDrawOrder + batch_start[batch];
+
+    int32 width, height, depth;
+    engine->GetBitmapDimensions(bitmap, &width, &height, &depth);
+
+    if (is_software_renderer && (depth == screen_color_depth) && ((depth == 16) || (depth == 32)))
+    {
+      BlitParticleBatch(bitmap, alpha, order, batch_count, mParticles.draw_x, mParticles.draw_y);
+    }
+    else
+    {
+      for (i = 0; i < batch_count; i++)
+        engine->BlitSpriteTranslucent(mParticles.draw_x[order[i]], mParticles.draw_y[order[i]], bitmap, alpha);
+    }
+  }
+}
+
+
 void Weather::RestoreGame(FILE* file)
 {
   unsigned int Position = ftell(file);
@@ -418,20 +724,28 @@ void Weather::Initialize()
 
 void Weather::InitializeParticles()
 {
-  memset(mParticles, 0, sizeof(drop_t) * 2000);
+  ReserveParticles(mAmount * 2);
+
   int i;
-  for (i = 0; i < 2000; i++)
-  {
-    mParticles[i].kind_id = rand() % 5;
-    mParticles[i].y = rand() % (screen_height * 2) - screen_height;
-    mParticles[i].x = rand() % screen_width;
-    mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
-    mParticles[i].speed = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
-    mParticles[i].max_y = rand() % mDeltaBaseline + mTopBaseline;
-    mParticles[i].drift = rand() % mDeltaDrift + mMinDrift;
-    mParticles[i].drift_speed = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;  
-    mParticles[i].drift_offset = rand() % 100;
-  }
+  for (i = 0; i < mCapacity; i++)
+    InitializeParticle(i);
+}
+
+
+void Weather::InitializeParticle(int i)
+{
+  mParticles.kind_id[i] = rand() % ViewCount;
+  mParticles.y[i] = rand() % (screen_height * 2) - screen_height;
+  mParticles.x[i] = rand() % screen_width;
+  mParticles.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
+  mParticles.speed[i] = (float)(rand() % mDeltaFallSpeed + mMinFallSpeed) / 50.0f;
+  mParticles.max_y[i] = rand() % mDeltaBaseline + mTopBaseline;
+  mParticles.drift[i] = rand() % mDeltaDrift + mMinDrift;
+  mParticles.drift_speed[i] = (rand() % mDeltaDriftSpeed + mMinDriftSpeed) / 50.0f;  
+  mParticles.drift_offset[i] = rand() % 100;
+  mParticles.wind[i] = 0;
+  mParticles.draw_x[i] = 0;
+  mParticles.draw_y[i] = -1;
 }
 
 
@@ -489,9 +803,10 @@ void Weather::ChangeAmount(int amount)
   engine->PrintDebugConsole(buffer);
 #endif
 
-  ClipToRange(amount, 0, 1000);
+  ClipToRange(amount, 0, MaxAmount);
   
   mTargetAmount = amount;
+  ReserveParticles(mTargetAmount * 2);
 }
 
 
@@ -562,8 +877,8 @@ void Weather::SetTransparency(int min_value, int max_value)
     mDeltaAlpha = 1;
 
   int i;
-  for (i = 0; i < 2000; i++)
-    mParticles[i].alpha = rand() % mDeltaAlpha + mMinAlpha;
+  for (i = 0; i < mCapacity; i++)
+    mParticles.alpha[i] = rand() % mDeltaAlpha + mMinAlpha;
 }
 
 
@@ -615,7 +930,7 @@ void Weather::SetAmount(int amount)
   engine->PrintDebugConsole(buffer);
 #endif
 
-  ClipToRange(amount, 0, 1000);
+  ClipToRange(amount, 0, MaxAmount);
 
   mAmount = mTargetAmount = amount;
 
@@ -885,6 +1200,7 @@ int AGS_EngineDebugHook(const char *scriptName, int lineNum, int reserved)
 
 void AGS_EngineInitGfx(const char *driverID, void *data)
 {
+  is_software_renderer = (strcmp(driverID, "Software") == 0);
 }
 
 